@@ -0,0 +1,23 @@
+import sys
+import time
+import pyfastx
+
+#compare inflate backends on full file passes of a gzip (bgzf) file
+#usage: python pyfastx_gzip_inflate_backend.py input.fq.gz [repeats]
+gfile = sys.argv[1]
+repeats = int(sys.argv[2]) if len(sys.argv) > 2 else 3
+
+def iterate():
+	for _ in pyfastx.Fastx(gfile):
+		pass
+
+for backend in ['zlib', 'libdeflate']:
+	pyfastx.inflate_backend(backend)
+
+	elapsed = []
+	for _ in range(repeats):
+		start = time.time()
+		iterate()
+		elapsed.append(time.time() - start)
+
+	print("{}\t{:.3f}".format(backend, min(elapsed)))
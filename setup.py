@@ -13,6 +13,7 @@ sources = glob.glob(os.path.join(root_dir, 'src', '*.c'))
 link_args = []
 comp_args = []
 include_dirs = []
+define_macros = []
 
 def prepare_zlib():
     global include_dirs
@@ -68,17 +69,70 @@ def prepare_indexed_gzip():
     include_dirs.append(igzip_dir)
     sources.extend(glob.glob(os.path.join(igzip_dir, 'zran*.c')))
 
+def prepare_zstd():
+    global include_dirs
+    global sources
+
+    zstd_dir = os.path.join(root_dir, "zstd-1.5.7")
+    zstd_file = os.path.join(root_dir, "zstd-1.5.7.tar.gz")
+    url = "https://github.com/facebook/zstd/releases/download/v1.5.7/zstd-1.5.7.tar.gz"
+
+    if not os.path.exists(zstd_dir):
+        if not os.path.isfile(zstd_file):
+            urllib.request.urlretrieve(url, zstd_file)
+
+        with tarfile.open(zstd_file) as _tar:
+            _tar.extractall()
+
+    seekable_dir = os.path.join(zstd_dir, 'contrib', 'seekable_format')
+    include_dirs.append(os.path.join(zstd_dir, 'lib'))
+    include_dirs.append(os.path.join(zstd_dir, 'lib', 'common'))
+    include_dirs.append(seekable_dir)
+    sources.extend(glob.glob(os.path.join(zstd_dir, 'lib', 'common', '*.c')))
+    sources.extend(glob.glob(os.path.join(zstd_dir, 'lib', 'decompress', '*.c')))
+    sources.append(os.path.join(seekable_dir, 'zstdseek_decompress.c'))
+
+def prepare_libdeflate():
+    global include_dirs
+    global sources
+    global define_macros
+
+    deflate_dir = os.path.join(root_dir, "libdeflate-1.24")
+    deflate_file = os.path.join(root_dir, "libdeflate-1.24.zip")
+    url = "https://github.com/ebiggers/libdeflate/archive/refs/tags/v1.24.zip"
+
+    if not os.path.exists(deflate_dir):
+        if not os.path.isfile(deflate_file):
+            urllib.request.urlretrieve(url, deflate_file)
+
+        with zipfile.ZipFile(deflate_file) as _zip:
+            _zip.extractall()
+
+    #only whole buffer gzip decompression is used
+    include_dirs.append(deflate_dir)
+    sources.extend([
+        os.path.join(deflate_dir, 'lib', 'deflate_decompress.c'),
+        os.path.join(deflate_dir, 'lib', 'gzip_decompress.c'),
+        os.path.join(deflate_dir, 'lib', 'crc32.c'),
+        os.path.join(deflate_dir, 'lib', 'utils.c'),
+        os.path.join(deflate_dir, 'lib', 'x86', 'cpu_features.c'),
+        os.path.join(deflate_dir, 'lib', 'arm', 'cpu_features.c')
+    ])
+    define_macros.append(('PYFASTX_LIBDEFLATE', None))
+
 
 if sys.platform.startswith('win'):
     comp_args.extend([
         '/D_LFS64_LARGEFILE',
         '/D_LARGEFILE64_SOURCE',
-        '/D_FILE_OFFSET_BITS=64'
+        '/D_FILE_OFFSET_BITS=64',
+        '/DZSTD_DISABLE_ASM'
     ])
 else:
     comp_args.extend([
         '-Wno-unused-result',
-        '-D_FILE_OFFSET_BITS=64'
+        '-D_FILE_OFFSET_BITS=64',
+        '-DZSTD_DISABLE_ASM'
     ])
 
     if sys.platform.startswith('darwin'):
@@ -128,17 +182,23 @@ class CustomBuildExt(build_ext.build_ext):
 prepare_sqlite3()
 prepare_zlib()
 prepare_indexed_gzip()
+prepare_zstd()
+
+#set PYFASTX_NO_LIBDEFLATE to build with zlib inflate only
+if not os.environ.get('PYFASTX_NO_LIBDEFLATE'):
+    prepare_libdeflate()
 
 extension = Extension('pyfastx',
     sources = sources,
     include_dirs = include_dirs,
+    define_macros = define_macros,
     extra_compile_args = comp_args,
     extra_link_args = link_args
 )
 
 description = (
     "Fast random access to sequences from"
-    "plain and gzipped FASTA/Q file"
+    "plain, gzipped and zstd compressed FASTA/Q file"
 )
 
 with open(os.path.join(root_dir, 'README.rst')) as fh:
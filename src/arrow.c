@@ -0,0 +1,410 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "arrow.h"
+#include "kseq.h"
+#include "util.h"
+
+void pyfastx_arrow_release_schema(struct ArrowSchema *schema) {
+	int64_t i;
+
+	for (i = 0; i < schema->n_children; ++i) {
+		if (schema->children[i]->release) {
+			schema->children[i]->release(schema->children[i]);
+		}
+		free(schema->children[i]);
+	}
+
+	free(schema->children);
+	schema->release = NULL;
+}
+
+void pyfastx_arrow_release_child_schema(struct ArrowSchema *schema) {
+	schema->release = NULL;
+}
+
+//export columns as the schema of a struct array
+int pyfastx_arrow_export_schema(struct ArrowSchema *schema, pyfastx_ArrowColumn *columns, int num) {
+	int i;
+	struct ArrowSchema *child;
+
+	memset(schema, 0, sizeof(struct ArrowSchema));
+	schema->format = "+s";
+	schema->name = "";
+	schema->n_children = num;
+	schema->children = (struct ArrowSchema **)calloc(num, sizeof(struct ArrowSchema *));
+	schema->release = pyfastx_arrow_release_schema;
+
+	if (!schema->children) {
+		schema->n_children = 0;
+		return -1;
+	}
+
+	for (i = 0; i < num; ++i) {
+		child = (struct ArrowSchema *)calloc(1, sizeof(struct ArrowSchema));
+
+		if (!child) {
+			schema->n_children = i;
+			return -1;
+		}
+
+		child->format = columns[i].format;
+		child->name = columns[i].name;
+		child->flags = columns[i].nullable ? ARROW_FLAG_NULLABLE : 0;
+		child->release = pyfastx_arrow_release_child_schema;
+		schema->children[i] = child;
+	}
+
+	return 0;
+}
+
+void pyfastx_arrow_release_child_array(struct ArrowArray *array) {
+	free((void *)array->buffers);
+	array->release = NULL;
+}
+
+void pyfastx_arrow_release_array(struct ArrowArray *array) {
+	int64_t i;
+	PyGILState_STATE state;
+
+	for (i = 0; i < array->n_children; ++i) {
+		if (array->children[i]->release) {
+			array->children[i]->release(array->children[i]);
+		}
+		free(array->children[i]);
+	}
+
+	free(array->children);
+	free((void *)array->buffers);
+
+	//consumer may release array in any thread
+	state = PyGILState_Ensure();
+	Py_XDECREF((PyObject *)array->private_data);
+	PyGILState_Release(state);
+
+	array->release = NULL;
+}
+
+//number of unset bits in the first count bits of validity bitmap
+static int64_t pyfastx_arrow_null_count(PyObject *validity, Py_ssize_t count) {
+	const uint8_t *bits = (const uint8_t *)PyBytes_AS_STRING(validity);
+	int64_t valid = 0;
+	Py_ssize_t i;
+
+	for (i = 0; i < count; ++i) {
+		valid += (bits[i >> 3] >> (i & 7)) & 1;
+	}
+
+	return count - valid;
+}
+
+//export columns as a struct array, buffers are owned by owner object
+int pyfastx_arrow_export_array(struct ArrowArray *array, PyObject *owner, pyfastx_ArrowColumn *columns, int num, Py_ssize_t count) {
+	int i;
+	struct ArrowArray *child;
+
+	memset(array, 0, sizeof(struct ArrowArray));
+	array->length = count;
+	array->n_buffers = 1;
+	array->buffers = (const void **)calloc(1, sizeof(void *));
+	array->n_children = num;
+	array->children = (struct ArrowArray **)calloc(num, sizeof(struct ArrowArray *));
+	array->private_data = Py_NewRef(owner);
+	array->release = pyfastx_arrow_release_array;
+
+	if (!array->buffers || !array->children) {
+		array->n_children = 0;
+		return -1;
+	}
+
+	for (i = 0; i < num; ++i) {
+		child = (struct ArrowArray *)calloc(1, sizeof(struct ArrowArray));
+
+		if (!child) {
+			array->n_children = i;
+			return -1;
+		}
+
+		array->children[i] = child;
+		child->length = count;
+		child->release = pyfastx_arrow_release_child_array;
+
+		//values are all valid without validity bitmap
+		if (columns[i].validity) {
+			child->null_count = pyfastx_arrow_null_count(columns[i].validity, count);
+		}
+
+		if (columns[i].offsets) {
+			child->n_buffers = 3;
+			child->buffers = (const void **)calloc(3, sizeof(void *));
+
+			if (child->buffers) {
+				child->buffers[0] = columns[i].validity ? PyBytes_AS_STRING(columns[i].validity) : NULL;
+				child->buffers[1] = PyBytes_AS_STRING(columns[i].offsets);
+				child->buffers[2] = PyBytes_AS_STRING(columns[i].data);
+			}
+		} else {
+			child->n_buffers = 2;
+			child->buffers = (const void **)calloc(2, sizeof(void *));
+
+			if (child->buffers) {
+				child->buffers[1] = PyBytes_AS_STRING(columns[i].data);
+			}
+		}
+
+		if (!child->buffers) {
+			array->n_children = i;
+			free(child);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+void pyfastx_arrow_schema_capsule_free(PyObject *capsule) {
+	struct ArrowSchema *schema = (struct ArrowSchema *)PyCapsule_GetPointer(capsule, "arrow_schema");
+
+	if (schema->release) {
+		schema->release(schema);
+	}
+
+	free(schema);
+}
+
+void pyfastx_arrow_array_capsule_free(PyObject *capsule) {
+	struct ArrowArray *array = (struct ArrowArray *)PyCapsule_GetPointer(capsule, "arrow_array");
+
+	if (array->release) {
+		array->release(array);
+	}
+
+	free(array);
+}
+
+//create arrow_schema capsule
+PyObject *pyfastx_arrow_schema(pyfastx_ArrowColumn *columns, int num) {
+	struct ArrowSchema *schema = (struct ArrowSchema *)malloc(sizeof(struct ArrowSchema));
+
+	if (!schema) {
+		return PyErr_NoMemory();
+	}
+
+	if (pyfastx_arrow_export_schema(schema, columns, num) < 0) {
+		schema->release(schema);
+		free(schema);
+		return PyErr_NoMemory();
+	}
+
+	return PyCapsule_New(schema, "arrow_schema", pyfastx_arrow_schema_capsule_free);
+}
+
+//create (arrow_schema, arrow_array) capsule pair
+PyObject *pyfastx_arrow_array(PyObject *owner, pyfastx_ArrowColumn *columns, int num, Py_ssize_t count) {
+	PyObject *schema_capsule;
+	PyObject *array_capsule;
+	struct ArrowArray *array;
+
+	schema_capsule = pyfastx_arrow_schema(columns, num);
+
+	if (!schema_capsule) {
+		return NULL;
+	}
+
+	array = (struct ArrowArray *)malloc(sizeof(struct ArrowArray));
+
+	if (!array) {
+		Py_DECREF(schema_capsule);
+		return PyErr_NoMemory();
+	}
+
+	if (pyfastx_arrow_export_array(array, owner, columns, num, count) < 0) {
+		array->release(array);
+		free(array);
+		Py_DECREF(schema_capsule);
+		return PyErr_NoMemory();
+	}
+
+	array_capsule = PyCapsule_New(array, "arrow_array", pyfastx_arrow_array_capsule_free);
+
+	if (!array_capsule) {
+		array->release(array);
+		free(array);
+		Py_DECREF(schema_capsule);
+		return NULL;
+	}
+
+	return Py_BuildValue("NN", schema_capsule, array_capsule);
+}
+
+void pyfastx_arrow_buffer_append(kstring_t *buff, const void *s, Py_ssize_t l) {
+	if (!l) {
+		return;
+	}
+
+	if (buff->l + l > buff->m) {
+		buff->m = buff->l + l;
+
+		if (buff->m < buff->l * 2) {
+			buff->m = buff->l * 2;
+		}
+
+		buff->s = (char *)realloc(buff->s, buff->m);
+	}
+
+	memcpy(buff->s + buff->l, s, l);
+	buff->l += l;
+}
+
+//export rows of query from index file into columns
+PyObject *pyfastx_table_from_query(sqlite3 *index_db, const char *sql, const char **names, const char **formats, int num) {
+	int i;
+	int ret;
+	int64_t value;
+	Py_ssize_t count = 0;
+	sqlite3_stmt *stmt;
+	pyfastx_Table *table;
+
+	kstring_t data[PYFASTX_ARROW_MAX_COLUMNS];
+	kstring_t offsets[PYFASTX_ARROW_MAX_COLUMNS];
+
+	for (i = 0; i < num; ++i) {
+		kstring_init(data[i]);
+		kstring_init(offsets[i]);
+
+		if (formats[i][0] == 'U') {
+			value = 0;
+			pyfastx_arrow_buffer_append(&offsets[i], &value, sizeof(int64_t));
+		}
+	}
+
+	PYFASTX_SQLITE_CALL(
+		ret = sqlite3_prepare_v2(index_db, sql, -1, &stmt, NULL);
+
+		if (ret == SQLITE_OK) {
+			while (sqlite3_step(stmt) == SQLITE_ROW) {
+				for (i = 0; i < num; ++i) {
+					if (formats[i][0] == 'U') {
+						pyfastx_arrow_buffer_append(&data[i], sqlite3_column_text(stmt, i), sqlite3_column_bytes(stmt, i));
+						value = data[i].l;
+						pyfastx_arrow_buffer_append(&offsets[i], &value, sizeof(int64_t));
+					} else {
+						value = sqlite3_column_int64(stmt, i);
+						pyfastx_arrow_buffer_append(&data[i], &value, sizeof(int64_t));
+					}
+				}
+				++count;
+			}
+		}
+
+		sqlite3_finalize(stmt);
+	);
+
+	table = PyObject_New(pyfastx_Table, &pyfastx_TableType);
+
+	if (table) {
+		table->count = count;
+		table->num = num;
+
+		for (i = 0; i < num; ++i) {
+			table->columns[i].name = names[i];
+			table->columns[i].format = formats[i];
+			table->columns[i].data = PyBytes_FromStringAndSize(data[i].s, data[i].l);
+			table->columns[i].offsets = offsets[i].l ? PyBytes_FromStringAndSize(offsets[i].s, offsets[i].l) : NULL;
+			table->columns[i].validity = NULL;
+			table->columns[i].nullable = 0;
+		}
+	}
+
+	for (i = 0; i < num; ++i) {
+		free(data[i].s);
+		free(offsets[i].s);
+	}
+
+	if (table && (ret != SQLITE_OK || PyErr_Occurred())) {
+		Py_DECREF(table);
+
+		if (ret != SQLITE_OK) {
+			PyErr_SetString(PyExc_RuntimeError, "read index file error");
+		}
+
+		return NULL;
+	}
+
+	return (PyObject *)table;
+}
+
+void pyfastx_table_dealloc(pyfastx_Table *self) {
+	int i;
+
+	for (i = 0; i < self->num; ++i) {
+		Py_XDECREF(self->columns[i].data);
+		Py_XDECREF(self->columns[i].offsets);
+	}
+
+	PyObject_Del(self);
+}
+
+Py_ssize_t pyfastx_table_length(pyfastx_Table *self) {
+	return self->count;
+}
+
+PyObject *pyfastx_table_repr(pyfastx_Table *self) {
+	return PyUnicode_FromFormat("<Table> contains %zd rows and %d columns", self->count, self->num);
+}
+
+PyObject *pyfastx_table_columns(pyfastx_Table *self, void* closure) {
+	int i;
+	PyObject *ret = PyTuple_New(self->num);
+
+	if (!ret) {
+		return NULL;
+	}
+
+	for (i = 0; i < self->num; ++i) {
+		PyTuple_SET_ITEM(ret, i, PyUnicode_FromString(self->columns[i].name));
+	}
+
+	return ret;
+}
+
+PyObject *pyfastx_table_arrow_schema(pyfastx_Table *self, PyObject *args) {
+	return pyfastx_arrow_schema(self->columns, self->num);
+}
+
+PyObject *pyfastx_table_arrow_array(pyfastx_Table *self, PyObject *args, PyObject *kwargs) {
+	PyObject *requested_schema = NULL;
+
+	static char* keywords[] = {"requested_schema", NULL};
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", keywords, &requested_schema)) {
+		return NULL;
+	}
+
+	return pyfastx_arrow_array((PyObject *)self, self->columns, self->num, self->count);
+}
+
+static PyMethodDef pyfastx_table_methods[] = {
+	{"__arrow_c_schema__", (PyCFunction)pyfastx_table_arrow_schema, METH_NOARGS, NULL},
+	{"__arrow_c_array__", (PyCFunction)pyfastx_table_arrow_array, METH_VARARGS|METH_KEYWORDS, NULL},
+	{NULL, NULL, 0, NULL}
+};
+
+static PyGetSetDef pyfastx_table_getsets[] = {
+	{"columns", (getter)pyfastx_table_columns, NULL, NULL, NULL},
+	{NULL}
+};
+
+static PySequenceMethods pyfastx_table_as_sequence = {
+	.sq_length = (lenfunc)pyfastx_table_length,
+};
+
+PyTypeObject pyfastx_TableType = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "Table",
+	.tp_basicsize = sizeof(pyfastx_Table),
+	.tp_dealloc = (destructor)pyfastx_table_dealloc,
+	.tp_repr = (reprfunc)pyfastx_table_repr,
+	.tp_as_sequence = &pyfastx_table_as_sequence,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_methods = pyfastx_table_methods,
+	.tp_getset = pyfastx_table_getsets,
+};
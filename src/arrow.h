@@ -0,0 +1,98 @@
+#ifndef PYFASTX_ARROW_H
+#define PYFASTX_ARROW_H
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "sqlite3.h"
+
+//Arrow C data interface, the structures are ABI stable
+//https://arrow.apache.org/docs/format/CDataInterface.html
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+	const char* format;
+	const char* name;
+	const char* metadata;
+	int64_t flags;
+	int64_t n_children;
+	struct ArrowSchema** children;
+	struct ArrowSchema* dictionary;
+	void (*release)(struct ArrowSchema*);
+	void* private_data;
+};
+
+struct ArrowArray {
+	int64_t length;
+	int64_t null_count;
+	int64_t offset;
+	int64_t n_buffers;
+	int64_t n_children;
+	const void** buffers;
+	struct ArrowArray** children;
+	struct ArrowArray* dictionary;
+	void (*release)(struct ArrowArray*);
+	void* private_data;
+};
+
+#endif
+
+#ifndef ARROW_C_STREAM_INTERFACE
+#define ARROW_C_STREAM_INTERFACE
+
+struct ArrowArrayStream {
+	int (*get_schema)(struct ArrowArrayStream*, struct ArrowSchema* out);
+	int (*get_next)(struct ArrowArrayStream*, struct ArrowArray* out);
+	const char* (*get_last_error)(struct ArrowArrayStream*);
+	void (*release)(struct ArrowArrayStream*);
+	void* private_data;
+};
+
+#endif
+
+//max number of columns in exported record batch
+#define PYFASTX_ARROW_MAX_COLUMNS 16
+
+//a column backed by bytes objects
+typedef struct {
+	const char *name;
+
+	//U: large utf8 string with int64 offsets, l: int64
+	const char *format;
+
+	//column values
+	PyObject *data;
+
+	//count+1 int64 offsets for string column, NULL for int64 column
+	PyObject *offsets;
+
+	//validity bitmap of nullable column, NULL if all values are valid
+	PyObject *validity;
+	int nullable;
+
+} pyfastx_ArrowColumn;
+
+//columns exported from index file
+typedef struct {
+	PyObject_HEAD
+
+	//number of rows
+	Py_ssize_t count;
+
+	int num;
+	pyfastx_ArrowColumn columns[PYFASTX_ARROW_MAX_COLUMNS];
+
+} pyfastx_Table;
+
+extern PyTypeObject pyfastx_TableType;
+
+PyObject *pyfastx_arrow_schema(pyfastx_ArrowColumn *columns, int num);
+PyObject *pyfastx_arrow_array(PyObject *owner, pyfastx_ArrowColumn *columns, int num, Py_ssize_t count);
+int pyfastx_arrow_export_schema(struct ArrowSchema *schema, pyfastx_ArrowColumn *columns, int num);
+int pyfastx_arrow_export_array(struct ArrowArray *array, PyObject *owner, pyfastx_ArrowColumn *columns, int num, Py_ssize_t count);
+PyObject *pyfastx_table_from_query(sqlite3 *index_db, const char *sql, const char **names, const char **formats, int num);
+
+#endif
@@ -0,0 +1,686 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <errno.h>
+#include "batch.h"
+#include "util.h"
+#include "arrow.h"
+
+//return 0 if offsets can not be allocated, column can be freed anyway
+int pyfastx_batch_column_init(pyfastx_BatchColumn *column, Py_ssize_t size) {
+	kstring_init(column->data);
+	column->offsets = (int64_t *)malloc((size + 1) * sizeof(int64_t));
+	column->validity = NULL;
+
+	if (!column->offsets) {
+		return 0;
+	}
+
+	column->offsets[0] = 0;
+	return 1;
+}
+
+//column with missing values, e.g. comment of header without comment
+int pyfastx_batch_column_nullable(pyfastx_BatchColumn *column, Py_ssize_t size) {
+	column->validity = (uint8_t *)calloc((size + 7) / 8, 1);
+	return column->validity != NULL;
+}
+
+void pyfastx_batch_column_free(pyfastx_BatchColumn *column) {
+	free(column->data.s);
+	free(column->offsets);
+	free(column->validity);
+}
+
+//mark the ith record of column as valid or null, can be called without GIL
+void pyfastx_batch_column_valid(pyfastx_BatchColumn *column, Py_ssize_t i, int valid) {
+	if (!column->validity) {
+		return;
+	}
+
+	if (valid) {
+		column->validity[i >> 3] |= 1 << (i & 7);
+	} else {
+		column->validity[i >> 3] &= ~(1 << (i & 7));
+	}
+}
+
+//append string to column data, can be called without GIL, return 0 and
+//keep column data unchanged if data can not be enlarged
+int pyfastx_batch_column_append(pyfastx_BatchColumn *column, char *s, Py_ssize_t l) {
+	size_t m;
+	char *data;
+
+	if (column->data.l + l > column->data.m) {
+		m = column->data.l + l;
+
+		if (m < column->data.l * 2) {
+			m = column->data.l * 2;
+		}
+
+		data = (char *)realloc(column->data.s, m);
+
+		if (!data) {
+			return 0;
+		}
+
+		column->data.s = data;
+		column->data.m = m;
+	}
+
+	memcpy(column->data.s + column->data.l, s, l);
+	column->data.l += l;
+	return 1;
+}
+
+//copy column data and offsets of n records into bytes objects
+void pyfastx_batch_column_export(pyfastx_BatchColumn *column, Py_ssize_t n, PyObject **data, PyObject **offsets) {
+	*data = PyBytes_FromStringAndSize(column->data.s, column->data.l);
+	*offsets = PyBytes_FromStringAndSize((char *)column->offsets, (n + 1) * sizeof(int64_t));
+}
+
+//copy validity bitmap of n records into bytes object, NULL if not nullable
+PyObject *pyfastx_batch_column_export_validity(pyfastx_BatchColumn *column, Py_ssize_t n) {
+	if (!column->validity) {
+		return NULL;
+	}
+
+	return PyBytes_FromStringAndSize((char *)column->validity, (n + 7) / 8);
+}
+
+//arrow columns of batch, data is NULL if batch is not given
+int pyfastx_batch_arrow_columns(pyfastx_Batch *batch, int format, int comment, pyfastx_ArrowColumn *columns) {
+	int num = 0;
+
+	memset(columns, 0, 4 * sizeof(pyfastx_ArrowColumn));
+
+	columns[num].name = "name";
+	columns[num].format = "U";
+	columns[num].data = batch ? batch->names : NULL;
+	columns[num++].offsets = batch ? batch->name_offsets : NULL;
+
+	columns[num].name = "seq";
+	columns[num].format = "U";
+	columns[num].data = batch ? batch->seqs : NULL;
+	columns[num++].offsets = batch ? batch->seq_offsets : NULL;
+
+	if (format == 2) {
+		columns[num].name = "qual";
+		columns[num].format = "U";
+		columns[num].data = batch ? batch->quals : NULL;
+		columns[num++].offsets = batch ? batch->qual_offsets : NULL;
+	}
+
+	if (comment) {
+		columns[num].name = "comment";
+		columns[num].format = "U";
+		columns[num].data = batch ? batch->comments : NULL;
+		columns[num].validity = batch ? batch->comment_validity : NULL;
+		columns[num].nullable = 1;
+		columns[num++].offsets = batch ? batch->comment_offsets : NULL;
+	}
+
+	return num;
+}
+
+PyObject *pyfastx_batch_iter_create(PyObject *parent, PyObject *file_obj, Py_ssize_t size, int threads, int ordered, int format, int uppercase, int comment, int full_name, pyfastx_Filter *filter) {
+	pyfastx_BatchIter *obj;
+
+	if (size <= 0) {
+		PyErr_SetString(PyExc_ValueError, "batch size must be greater than 0");
+		return NULL;
+	}
+
+	if (threads <= 0) {
+		PyErr_SetString(PyExc_ValueError, "threads must be greater than 0");
+		return NULL;
+	}
+
+	obj = PyObject_New(pyfastx_BatchIter, &pyfastx_BatchIterType);
+
+	if (!obj) {
+		return NULL;
+	}
+
+	obj->parent = Py_NewRef(parent);
+	obj->stream = NULL;
+	obj->kseq = NULL;
+	obj->parallel = NULL;
+	obj->size = size;
+	obj->format = format;
+	obj->uppercase = uppercase;
+	obj->comment = comment;
+	obj->full_name = full_name;
+	obj->filter = filter;
+
+	if (filter) {
+		pyfastx_filter_reset(filter);
+	}
+
+	//all columns are initialized before checking, so that they can be freed
+	if (!(pyfastx_batch_column_init(&obj->name, size) & pyfastx_batch_column_init(&obj->seq, size) & pyfastx_batch_column_init(&obj->qual, size) & pyfastx_batch_column_init(&obj->desc, size)) || !pyfastx_batch_column_nullable(&obj->desc, size)) {
+		Py_DECREF(obj);
+		return PyErr_NoMemory();
+	}
+
+	//parse from the beginning of file in a full pass
+	obj->stream = pyfastx_stream_open(file_obj);
+
+	if (!obj->stream) {
+		Py_DECREF(obj);
+
+		if (!PyErr_Occurred()) {
+			PyErr_Format(PyExc_RuntimeError, "can not open %U", file_obj);
+		}
+
+		return NULL;
+	}
+
+	pyfastx_stream_readahead(obj->stream, 1);
+	obj->kseq = kseq_init(obj->stream);
+
+	if (threads > 1) {
+		obj->parallel = pyfastx_parallel_create(obj->stream, threads, ordered, size, format, uppercase, comment, full_name, filter);
+
+		if (!obj->parallel) {
+			Py_DECREF(obj);
+
+			if (!PyErr_Occurred()) {
+				PyErr_SetString(PyExc_RuntimeError, "can not start parsing threads");
+			}
+
+			return NULL;
+		}
+	}
+
+	return (PyObject *)obj;
+}
+
+void pyfastx_batch_iter_dealloc(pyfastx_BatchIter *self) {
+	if (self->parallel) {
+		Py_BEGIN_ALLOW_THREADS
+		pyfastx_parallel_free(self->parallel);
+		Py_END_ALLOW_THREADS
+	}
+
+	pyfastx_batch_column_free(&self->name);
+	pyfastx_batch_column_free(&self->seq);
+	pyfastx_batch_column_free(&self->qual);
+	pyfastx_batch_column_free(&self->desc);
+
+	if (self->kseq) {
+		kseq_destroy(self->kseq);
+	}
+
+	if (self->stream) {
+		pyfastx_stream_close(self->stream);
+	}
+
+	Py_DECREF(self->parent);
+	PyObject_Del(self);
+}
+
+//append the record in kseq as the nth record of columns, return 0 if
+//column data can not be enlarged
+int pyfastx_batch_append_kseq(kseq_t *kseq, pyfastx_BatchColumn *name, pyfastx_BatchColumn *seq, pyfastx_BatchColumn *qual, pyfastx_BatchColumn *desc, Py_ssize_t n, int format, int uppercase, int comment, int full_name) {
+	if (!pyfastx_batch_column_append(name, kseq->name.s, kseq->name.l)) {
+		return 0;
+	}
+
+	if (full_name && kseq->comment.l) {
+		if (!pyfastx_batch_column_append(name, " ", 1) || !pyfastx_batch_column_append(name, kseq->comment.s, kseq->comment.l)) {
+			return 0;
+		}
+	}
+
+	if (uppercase) {
+		upper_string(kseq->seq.s, kseq->seq.l);
+	}
+
+	if (!pyfastx_batch_column_append(seq, kseq->seq.s, kseq->seq.l)) {
+		return 0;
+	}
+
+	if (format == 2 && !pyfastx_batch_column_append(qual, kseq->qual.s, kseq->qual.l)) {
+		return 0;
+	}
+
+	if (comment) {
+		if (!pyfastx_batch_column_append(desc, kseq->comment.s, kseq->comment.l)) {
+			return 0;
+		}
+
+		pyfastx_batch_column_valid(desc, n - 1, kseq->comment.l > 0);
+	}
+
+	name->offsets[n] = name->data.l;
+	seq->offsets[n] = seq->data.l;
+	qual->offsets[n] = qual->data.l;
+	desc->offsets[n] = desc->data.l;
+	return 1;
+}
+
+//read at most size records into column buffers, called without GIL,
+//return -1 if column data can not be enlarged
+Py_ssize_t pyfastx_batch_iter_parse(pyfastx_BatchIter *self) {
+	Py_ssize_t n = 0;
+	int reason;
+
+	self->name.data.l = 0;
+	self->seq.data.l = 0;
+	self->qual.data.l = 0;
+	self->desc.data.l = 0;
+
+	while (n < self->size && kseq_read(self->kseq) >= 0) {
+		if (self->filter) {
+			reason = pyfastx_filter_test(self->filter, self->kseq->name.s, self->kseq->name.l, self->kseq->seq.s, self->kseq->seq.l, self->kseq->qual.s, self->kseq->qual.l);
+			++self->filter->counts[reason];
+
+			if (reason) {
+				continue;
+			}
+		}
+
+		if (!pyfastx_batch_append_kseq(self->kseq, &self->name, &self->seq, &self->qual, &self->desc, ++n, self->format, self->uppercase, self->comment, self->full_name)) {
+			return -1;
+		}
+	}
+
+	return n;
+}
+
+PyObject *pyfastx_batch_iter_iter(pyfastx_BatchIter *self) {
+	return Py_NewRef(self);
+}
+
+//create batch from n records in parsed columns
+PyObject *pyfastx_batch_create(pyfastx_BatchColumn *name, pyfastx_BatchColumn *seq, pyfastx_BatchColumn *qual, pyfastx_BatchColumn *desc, Py_ssize_t n, int format, int comment) {
+	pyfastx_Batch *batch = PyObject_New(pyfastx_Batch, &pyfastx_BatchType);
+
+	if (!batch) {
+		return NULL;
+	}
+
+	batch->count = n;
+	batch->format = format;
+	batch->quals = NULL;
+	batch->qual_offsets = NULL;
+	batch->comments = NULL;
+	batch->comment_offsets = NULL;
+	batch->comment_validity = NULL;
+
+	pyfastx_batch_column_export(name, n, &batch->names, &batch->name_offsets);
+	pyfastx_batch_column_export(seq, n, &batch->seqs, &batch->seq_offsets);
+
+	if (format == 2) {
+		pyfastx_batch_column_export(qual, n, &batch->quals, &batch->qual_offsets);
+	}
+
+	if (comment) {
+		pyfastx_batch_column_export(desc, n, &batch->comments, &batch->comment_offsets);
+		batch->comment_validity = pyfastx_batch_column_export_validity(desc, n);
+	}
+
+	if (!batch->names || !batch->name_offsets || !batch->seqs || !batch->seq_offsets || PyErr_Occurred()) {
+		Py_DECREF(batch);
+		return NULL;
+	}
+
+	return (PyObject *)batch;
+}
+
+PyObject *pyfastx_batch_iter_next_parallel(pyfastx_BatchIter *self) {
+	pyfastx_ParallelJob *job;
+	PyObject *batch;
+
+	Py_BEGIN_ALLOW_THREADS
+	job = pyfastx_parallel_next(self->parallel);
+	Py_END_ALLOW_THREADS
+
+	if (!job) {
+		pyfastx_parallel_raise(self->parallel->error);
+		return NULL;
+	}
+
+	batch = pyfastx_batch_create(&job->name, &job->seq, &job->qual, &job->desc, job->count, self->format, self->comment);
+
+	//parse next chunk while the batch is being consumed
+	Py_BEGIN_ALLOW_THREADS
+	pyfastx_parallel_feed(self->parallel, job);
+	Py_END_ALLOW_THREADS
+
+	return batch;
+}
+
+PyObject *pyfastx_batch_iter_next(pyfastx_BatchIter *self) {
+	Py_ssize_t n;
+
+	if (self->parallel) {
+		return pyfastx_batch_iter_next_parallel(self);
+	}
+
+	Py_BEGIN_ALLOW_THREADS
+	n = pyfastx_batch_iter_parse(self);
+	Py_END_ALLOW_THREADS
+
+	if (n < 0) {
+		return PyErr_NoMemory();
+	}
+
+	if (!n) {
+		return NULL;
+	}
+
+	return pyfastx_batch_create(&self->name, &self->seq, &self->qual, &self->desc, n, self->format, self->comment);
+}
+
+PyObject *pyfastx_batch_iter_repr(pyfastx_BatchIter *self) {
+	return PyUnicode_FromFormat("<BatchIterator> batch size %zd", self->size);
+}
+
+PyObject *pyfastx_batch_iter_arrow_schema(pyfastx_BatchIter *self, PyObject *args) {
+	pyfastx_ArrowColumn columns[4];
+	int num = pyfastx_batch_arrow_columns(NULL, self->format, self->comment, columns);
+	return pyfastx_arrow_schema(columns, num);
+}
+
+//arrow stream reads the remaining batches of iterator
+int pyfastx_batch_stream_get_schema(struct ArrowArrayStream *stream, struct ArrowSchema *out) {
+	pyfastx_BatchIter *self = (pyfastx_BatchIter *)stream->private_data;
+	pyfastx_ArrowColumn columns[4];
+	int num = pyfastx_batch_arrow_columns(NULL, self->format, self->comment, columns);
+
+	if (pyfastx_arrow_export_schema(out, columns, num) < 0) {
+		out->release(out);
+		return ENOMEM;
+	}
+
+	return 0;
+}
+
+int pyfastx_batch_stream_get_next(struct ArrowArrayStream *stream, struct ArrowArray *out) {
+	int ret = 0;
+	int num;
+	pyfastx_ArrowColumn columns[4];
+	pyfastx_Batch *batch;
+	pyfastx_BatchIter *self = (pyfastx_BatchIter *)stream->private_data;
+	PyGILState_STATE state = PyGILState_Ensure();
+
+	batch = (pyfastx_Batch *)pyfastx_batch_iter_next(self);
+
+	if (batch) {
+		num = pyfastx_batch_arrow_columns(batch, self->format, self->comment, columns);
+
+		if (pyfastx_arrow_export_array(out, (PyObject *)batch, columns, num, batch->count) < 0) {
+			out->release(out);
+			ret = ENOMEM;
+		}
+
+		Py_DECREF(batch);
+	} else if (PyErr_Occurred()) {
+		PyErr_Clear();
+		ret = EIO;
+	} else {
+		//end of stream
+		out->release = NULL;
+	}
+
+	PyGILState_Release(state);
+	return ret;
+}
+
+const char *pyfastx_batch_stream_get_last_error(struct ArrowArrayStream *stream) {
+	return "failed to read batch from sequence file";
+}
+
+void pyfastx_batch_stream_release(struct ArrowArrayStream *stream) {
+	PyGILState_STATE state = PyGILState_Ensure();
+	Py_XDECREF((PyObject *)stream->private_data);
+	PyGILState_Release(state);
+	stream->release = NULL;
+}
+
+void pyfastx_batch_stream_capsule_free(PyObject *capsule) {
+	struct ArrowArrayStream *stream = (struct ArrowArrayStream *)PyCapsule_GetPointer(capsule, "arrow_array_stream");
+
+	if (stream->release) {
+		stream->release(stream);
+	}
+
+	free(stream);
+}
+
+PyObject *pyfastx_batch_iter_arrow_stream(pyfastx_BatchIter *self, PyObject *args, PyObject *kwargs) {
+	PyObject *requested_schema = NULL;
+	struct ArrowArrayStream *stream;
+
+	static char* keywords[] = {"requested_schema", NULL};
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", keywords, &requested_schema)) {
+		return NULL;
+	}
+
+	stream = (struct ArrowArrayStream *)malloc(sizeof(struct ArrowArrayStream));
+
+	if (!stream) {
+		return PyErr_NoMemory();
+	}
+
+	stream->get_schema = pyfastx_batch_stream_get_schema;
+	stream->get_next = pyfastx_batch_stream_get_next;
+	stream->get_last_error = pyfastx_batch_stream_get_last_error;
+	stream->release = pyfastx_batch_stream_release;
+	stream->private_data = Py_NewRef(self);
+
+	return PyCapsule_New(stream, "arrow_array_stream", pyfastx_batch_stream_capsule_free);
+}
+
+static PyMethodDef pyfastx_batch_iter_methods[] = {
+	{"__arrow_c_schema__", (PyCFunction)pyfastx_batch_iter_arrow_schema, METH_NOARGS, NULL},
+	{"__arrow_c_stream__", (PyCFunction)pyfastx_batch_iter_arrow_stream, METH_VARARGS|METH_KEYWORDS, NULL},
+	{NULL, NULL, 0, NULL}
+};
+
+PyTypeObject pyfastx_BatchIterType = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "BatchIterator",
+	.tp_basicsize = sizeof(pyfastx_BatchIter),
+	.tp_dealloc = (destructor)pyfastx_batch_iter_dealloc,
+	.tp_repr = (reprfunc)pyfastx_batch_iter_repr,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_iter = (getiterfunc)pyfastx_batch_iter_iter,
+	.tp_iternext = (iternextfunc)pyfastx_batch_iter_next,
+	.tp_methods = pyfastx_batch_iter_methods,
+};
+
+void pyfastx_batch_dealloc(pyfastx_Batch *self) {
+	Py_XDECREF(self->names);
+	Py_XDECREF(self->name_offsets);
+	Py_XDECREF(self->seqs);
+	Py_XDECREF(self->seq_offsets);
+	Py_XDECREF(self->quals);
+	Py_XDECREF(self->qual_offsets);
+	Py_XDECREF(self->comments);
+	Py_XDECREF(self->comment_offsets);
+	Py_XDECREF(self->comment_validity);
+	PyObject_Del(self);
+}
+
+PyObject *pyfastx_batch_repr(pyfastx_Batch *self) {
+	return PyUnicode_FromFormat("<Batch> contains %zd %s", self->count, self->format == 2 ? "reads" : "sequences");
+}
+
+Py_ssize_t pyfastx_batch_length(pyfastx_Batch *self) {
+	return self->count;
+}
+
+//get the string of ith record in column
+PyObject *pyfastx_batch_column_item(PyObject *data, PyObject *offsets, Py_ssize_t i) {
+	int64_t *offs = (int64_t *)PyBytes_AS_STRING(offsets);
+	return PyUnicode_FromStringAndSize(PyBytes_AS_STRING(data) + offs[i], offs[i+1] - offs[i]);
+}
+
+PyObject *pyfastx_batch_item(pyfastx_Batch *self, Py_ssize_t i) {
+	PyObject *ret;
+	PyObject *item;
+	Py_ssize_t j = 0;
+
+	if (i < 0) {
+		i += self->count;
+	}
+
+	if (i < 0 || i >= self->count) {
+		PyErr_SetString(PyExc_IndexError, "index out of range");
+		return NULL;
+	}
+
+	ret = PyTuple_New(2 + (self->quals != NULL) + (self->comments != NULL));
+
+	if (!ret) {
+		return NULL;
+	}
+
+	item = pyfastx_batch_column_item(self->names, self->name_offsets, i);
+	PyTuple_SET_ITEM(ret, j++, item);
+
+	item = pyfastx_batch_column_item(self->seqs, self->seq_offsets, i);
+	PyTuple_SET_ITEM(ret, j++, item);
+
+	if (self->quals) {
+		item = pyfastx_batch_column_item(self->quals, self->qual_offsets, i);
+		PyTuple_SET_ITEM(ret, j++, item);
+	}
+
+	if (self->comments) {
+		//header without comment is None as Fastx iteration
+		if (self->comment_validity && !(PyBytes_AS_STRING(self->comment_validity)[i >> 3] & (1 << (i & 7)))) {
+			item = Py_NewRef(Py_None);
+		} else {
+			item = pyfastx_batch_column_item(self->comments, self->comment_offsets, i);
+		}
+
+		PyTuple_SET_ITEM(ret, j++, item);
+	}
+
+	for (j = 0; j < PyTuple_GET_SIZE(ret); ++j) {
+		if (!PyTuple_GET_ITEM(ret, j)) {
+			Py_DECREF(ret);
+			return NULL;
+		}
+	}
+
+	return ret;
+}
+
+//expose offsets as int64 memoryview
+PyObject *pyfastx_batch_offsets(PyObject *offsets) {
+	PyObject *view;
+	PyObject *ret;
+
+	if (!offsets) {
+		Py_RETURN_NONE;
+	}
+
+	view = PyMemoryView_FromObject(offsets);
+
+	if (!view) {
+		return NULL;
+	}
+
+	ret = PyObject_CallMethod(view, "cast", "s", "q");
+	Py_DECREF(view);
+	return ret;
+}
+
+PyObject *pyfastx_batch_column(PyObject *data) {
+	if (!data) {
+		Py_RETURN_NONE;
+	}
+
+	return Py_NewRef(data);
+}
+
+PyObject *pyfastx_batch_names(pyfastx_Batch *self, void* closure) {
+	return pyfastx_batch_column(self->names);
+}
+
+PyObject *pyfastx_batch_name_offsets(pyfastx_Batch *self, void* closure) {
+	return pyfastx_batch_offsets(self->name_offsets);
+}
+
+PyObject *pyfastx_batch_seqs(pyfastx_Batch *self, void* closure) {
+	return pyfastx_batch_column(self->seqs);
+}
+
+PyObject *pyfastx_batch_seq_offsets(pyfastx_Batch *self, void* closure) {
+	return pyfastx_batch_offsets(self->seq_offsets);
+}
+
+PyObject *pyfastx_batch_quals(pyfastx_Batch *self, void* closure) {
+	return pyfastx_batch_column(self->quals);
+}
+
+PyObject *pyfastx_batch_qual_offsets(pyfastx_Batch *self, void* closure) {
+	return pyfastx_batch_offsets(self->qual_offsets);
+}
+
+PyObject *pyfastx_batch_comments(pyfastx_Batch *self, void* closure) {
+	return pyfastx_batch_column(self->comments);
+}
+
+PyObject *pyfastx_batch_comment_offsets(pyfastx_Batch *self, void* closure) {
+	return pyfastx_batch_offsets(self->comment_offsets);
+}
+
+PyObject *pyfastx_batch_arrow_schema(pyfastx_Batch *self, PyObject *args) {
+	pyfastx_ArrowColumn columns[4];
+	int num = pyfastx_batch_arrow_columns(self, self->format, self->comments != NULL, columns);
+	return pyfastx_arrow_schema(columns, num);
+}
+
+PyObject *pyfastx_batch_arrow_array(pyfastx_Batch *self, PyObject *args, PyObject *kwargs) {
+	PyObject *requested_schema = NULL;
+	pyfastx_ArrowColumn columns[4];
+	int num;
+
+	static char* keywords[] = {"requested_schema", NULL};
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", keywords, &requested_schema)) {
+		return NULL;
+	}
+
+	num = pyfastx_batch_arrow_columns(self, self->format, self->comments != NULL, columns);
+	return pyfastx_arrow_array((PyObject *)self, columns, num, self->count);
+}
+
+static PyMethodDef pyfastx_batch_methods[] = {
+	{"__arrow_c_schema__", (PyCFunction)pyfastx_batch_arrow_schema, METH_NOARGS, NULL},
+	{"__arrow_c_array__", (PyCFunction)pyfastx_batch_arrow_array, METH_VARARGS|METH_KEYWORDS, NULL},
+	{NULL, NULL, 0, NULL}
+};
+
+static PyGetSetDef pyfastx_batch_getsets[] = {
+	{"names", (getter)pyfastx_batch_names, NULL, NULL, NULL},
+	{"name_offsets", (getter)pyfastx_batch_name_offsets, NULL, NULL, NULL},
+	{"seqs", (getter)pyfastx_batch_seqs, NULL, NULL, NULL},
+	{"seq_offsets", (getter)pyfastx_batch_seq_offsets, NULL, NULL, NULL},
+	{"quals", (getter)pyfastx_batch_quals, NULL, NULL, NULL},
+	{"qual_offsets", (getter)pyfastx_batch_qual_offsets, NULL, NULL, NULL},
+	{"comments", (getter)pyfastx_batch_comments, NULL, NULL, NULL},
+	{"comment_offsets", (getter)pyfastx_batch_comment_offsets, NULL, NULL, NULL},
+	{NULL}
+};
+
+static PySequenceMethods pyfastx_batch_as_sequence = {
+	.sq_length = (lenfunc)pyfastx_batch_length,
+	.sq_item = (ssizeargfunc)pyfastx_batch_item,
+};
+
+PyTypeObject pyfastx_BatchType = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "Batch",
+	.tp_basicsize = sizeof(pyfastx_Batch),
+	.tp_dealloc = (destructor)pyfastx_batch_dealloc,
+	.tp_repr = (reprfunc)pyfastx_batch_repr,
+	.tp_as_sequence = &pyfastx_batch_as_sequence,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_methods = pyfastx_batch_methods,
+	.tp_getset = pyfastx_batch_getsets,
+};
@@ -0,0 +1,81 @@
+#ifndef PYFASTX_BATCH_H
+#define PYFASTX_BATCH_H
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "kseq.h"
+#include "parallel.h"
+
+//records parsed together, each column is stored as a contiguous bytes
+//with an int64 offset array of count+1 items
+typedef struct {
+	PyObject_HEAD
+
+	//number of records
+	Py_ssize_t count;
+
+	//1: fasta, 2: fastq
+	int format;
+
+	//column data and offsets, NULL if column is not available
+	PyObject *names;
+	PyObject *name_offsets;
+	PyObject *seqs;
+	PyObject *seq_offsets;
+	PyObject *quals;
+	PyObject *qual_offsets;
+	PyObject *comments;
+	PyObject *comment_offsets;
+
+	//bit is 0 if the record has no comment, NULL if all records have
+	PyObject *comment_validity;
+
+} pyfastx_Batch;
+
+typedef struct {
+	PyObject_HEAD
+
+	//Fastx, Fasta or Fastq object that owns the reader
+	PyObject *parent;
+
+	//own stream and reader of file, so that batches do not share buffers
+	//with iteration of parent or other batch iterators
+	pyfastx_Stream *stream;
+	kseq_t *kseq;
+
+	//max number of records in each batch
+	Py_ssize_t size;
+
+	//1: fasta, 2: fastq
+	int format;
+
+	//convert sequence to uppercase
+	int uppercase;
+
+	//output comment as a separate column
+	int comment;
+
+	//join name and comment as name
+	int full_name;
+
+	//record filters of parent, NULL if not available
+	pyfastx_Filter *filter;
+
+	//records are parsed by worker threads if not NULL
+	pyfastx_Parallel *parallel;
+
+	//reused buffers for parsing records
+	pyfastx_BatchColumn name;
+	pyfastx_BatchColumn seq;
+	pyfastx_BatchColumn qual;
+	pyfastx_BatchColumn desc;
+
+} pyfastx_BatchIter;
+
+extern PyTypeObject pyfastx_BatchType;
+extern PyTypeObject pyfastx_BatchIterType;
+
+int pyfastx_batch_append_kseq(kseq_t *kseq, pyfastx_BatchColumn *name, pyfastx_BatchColumn *seq, pyfastx_BatchColumn *qual, pyfastx_BatchColumn *desc, Py_ssize_t n, int format, int uppercase, int comment, int full_name);
+PyObject *pyfastx_batch_create(pyfastx_BatchColumn *name, pyfastx_BatchColumn *seq, pyfastx_BatchColumn *qual, pyfastx_BatchColumn *desc, Py_ssize_t n, int format, int comment);
+PyObject *pyfastx_batch_iter_create(PyObject *parent, PyObject *file_obj, Py_ssize_t size, int threads, int ordered, int format, int uppercase, int comment, int full_name, pyfastx_Filter *filter);
+
+#endif
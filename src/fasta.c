@@ -3,6 +3,14 @@
 #include "fasta.h"
 #include "util.h"
 #include "fakeys.h"
+#include "batch.h"
+#include "arrow.h"
+#include "range.h"
+#include "kmer.h"
+#include "sketch.h"
+#include "motif.h"
+#include "profile.h"
+#include "mask.h"
 #include "structmember.h"
 #include "sequence.h"
 #include "stdint.h"
@@ -52,6 +60,9 @@ PyObject *pyfastx_fasta_new(PyTypeObject *type, PyObject *args, PyObject *kwargs
 	//use full name instead of identifier before first whitespace
 	int full_name = 0;
 
+	//record soft-masked and gap intervals
+	int mask_index = 0;
+
 	//fasta file path
 	PyObject *file_obj;
 	PyObject *index_obj = NULL;
@@ -62,9 +73,9 @@ PyObject *pyfastx_fasta_new(PyTypeObject *type, PyObject *args, PyObject *kwargs
 	pyfastx_Fasta *obj;
 
 	//paramters for fasta object construction
-	static char* keywords[] = {"file_name", "index_file", "uppercase", "build_index", "full_index", "full_name", "memory_index", "key_func", NULL};
+	static char* keywords[] = {"file_name", "index_file", "uppercase", "build_index", "full_index", "full_name", "memory_index", "key_func", "mask_index", NULL};
 	
-	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OiiiiiO", keywords, &file_obj, &index_obj, &uppercase, &build_index, &full_index, &full_name, &memory_index, &key_func)){
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OiiiiiOi", keywords, &file_obj, &index_obj, &uppercase, &build_index, &full_index, &full_name, &memory_index, &key_func, &mask_index)){
 		return NULL;
 	}
 
@@ -105,7 +116,7 @@ PyObject *pyfastx_fasta_new(PyTypeObject *type, PyObject *args, PyObject *kwargs
 
 	//check is correct fasta format
 	if (!fasta_validator(obj->index->gzfd)) {
-		PyErr_Format(PyExc_RuntimeError, "%U is not plain or gzip compressed fasta formatted file", file_obj);
+		PyErr_Format(PyExc_RuntimeError, "%U is not plain, gzip or zstd compressed fasta formatted file", file_obj);
 		return NULL;
 	}
 
@@ -118,10 +129,13 @@ PyObject *pyfastx_fasta_new(PyTypeObject *type, PyObject *args, PyObject *kwargs
 			pyfastx_fasta_calc_composition(obj);
 		}
 
+		if (mask_index) {
+			pyfastx_mask_calc(obj->index);
+		}
+
 		PYFASTX_SQLITE_CALL(
 			sqlite3_prepare_v2(obj->index->index_db, "SELECT * FROM seq WHERE chrom=? LIMIT 1;", -1, &obj->index->seq_stmt, NULL);
 			sqlite3_prepare_v2(obj->index->index_db, "SELECT * FROM seq WHERE ID=? LIMIT 1;", -1, &obj->index->uid_stmt, NULL);
-			sqlite3_prepare_v2(obj->index->index_db, "SELECT * FROM comp WHERE seqid=?;", -1, &obj->index->comp_stmt, NULL);
 		);
 	}
 
@@ -155,22 +169,29 @@ PyObject *pyfastx_fasta_iter(pyfastx_Fasta *self){
 		);
 
 		self->func = pyfastx_index_next_with_index_seq;
+		pyfastx_stream_readahead(self->index->gzfd, 0);
 	} else {
-		if (self->index->uppercase && self->index->full_name) {
-			self->func = pyfastx_index_next_full_name_upper_seq;
-		} else if (self->index->uppercase) {
-			self->func = pyfastx_index_next_upper_seq;
-		} else if (self->index->full_name) {
-			self->func = pyfastx_index_next_full_name_seq;
-		} else {
-			self->func = pyfastx_index_next_seq;
-		}
+		pyfastx_stream_readahead(self->index->gzfd, 1);
+		pyfastx_fasta_select_next(self);
 	}
 
 	Py_INCREF(self);
 	return (PyObject *)self;
 }
 
+//select iteration function for file without index
+void pyfastx_fasta_select_next(pyfastx_Fasta *self) {
+	if (self->index->uppercase && self->index->full_name) {
+		self->func = pyfastx_index_next_full_name_upper_seq;
+	} else if (self->index->uppercase) {
+		self->func = pyfastx_index_next_upper_seq;
+	} else if (self->index->full_name) {
+		self->func = pyfastx_index_next_full_name_seq;
+	} else {
+		self->func = pyfastx_index_next_seq;
+	}
+}
+
 PyObject *pyfastx_fasta_next(pyfastx_Fasta *self) {
 	return self->func(self->index);
 }
@@ -290,7 +311,7 @@ void pyfastx_fasta_cache_full(pyfastx_Fasta *self, Py_ssize_t chrom, Py_ssize_t
 	self->index->cache_full = 1;
 }
 
-char *pyfastx_fasta_slice_seq(pyfastx_Fasta *self, Py_ssize_t offset, Py_ssize_t bytelen, Py_ssize_t line_len, int end_len, Py_ssize_t slice_start, Py_ssize_t slice_stop) {
+char *pyfastx_fasta_slice_seq(pyfastx_Fasta *self, Py_ssize_t chrom, int normal, Py_ssize_t offset, Py_ssize_t bytelen, Py_ssize_t line_len, int end_len, Py_ssize_t slice_start, Py_ssize_t slice_stop) {
 	char *ret;
 
 	Py_ssize_t before_sline;
@@ -298,11 +319,19 @@ char *pyfastx_fasta_slice_seq(pyfastx_Fasta *self, Py_ssize_t offset, Py_ssize_t
 	Py_ssize_t cross_line;
 
 	if (slice_stop >= slice_start) {
-		before_sline = slice_start/(line_len - end_len);
-		before_eline = slice_stop/(line_len - end_len);
-		cross_line = before_eline - before_sline;
-		offset = offset + slice_start + end_len*before_sline;
-		bytelen = slice_stop - slice_start + cross_line*end_len;
+		if (normal) {
+			before_sline = slice_start/(line_len - end_len);
+			before_eline = slice_stop/(line_len - end_len);
+			cross_line = before_eline - before_sline;
+			offset = offset + slice_start + end_len*before_sline;
+			bytelen = slice_stop - slice_start + cross_line*end_len;
+		} else if (slice_stop > slice_start) {
+			//irregular lines are located by line runs in index
+			offset = pyfastx_index_line_offset(self->index, chrom, slice_start);
+			bytelen = pyfastx_index_line_offset(self->index, chrom, slice_stop - 1) - offset + 1;
+		} else {
+			bytelen = 0;
+		}
 
 		ret = (char *)malloc(bytelen + 1);
 		pyfastx_index_random_read(self->index, ret, offset, bytelen);
@@ -353,7 +382,8 @@ PyObject *pyfastx_fasta_flank(pyfastx_Fasta *self, PyObject *args, PyObject *kwa
 
 	pyfastx_fasta_seq_info(self, name, &chrom, &offset, &bytes, &seq_len, &line_len, &end_len, &normal);
 
-	if (use_cache || !normal) {
+	//irregular sequence without line runs in index is read into cache
+	if (use_cache || (!normal && pyfastx_index_line_offset(self->index, chrom, 0) < 0)) {
 		pyfastx_fasta_cache_full(self, chrom, offset, bytes);
 		ret = pyfastx_fasta_slice_from_cache(self, start, end, flank_len);
 	} else {
@@ -364,7 +394,7 @@ PyObject *pyfastx_fasta_flank(pyfastx_Fasta *self, PyObject *args, PyObject *kwa
 		slice_stop = start - 1;
 
 		//slice_start 0-base, slice_stop 1-base
-		left = pyfastx_fasta_slice_seq(self, offset, bytes, line_len, end_len, slice_start, slice_stop);
+		left = pyfastx_fasta_slice_seq(self, chrom, normal, offset, bytes, line_len, end_len, slice_start, slice_stop);
 
 		slice_stop = end + flank_len;
 		if (slice_stop > seq_len) {
@@ -372,7 +402,7 @@ PyObject *pyfastx_fasta_flank(pyfastx_Fasta *self, PyObject *args, PyObject *kwa
 		}
 		slice_start = end;
 
-		right = pyfastx_fasta_slice_seq(self, offset, bytes, line_len, end_len, slice_start, slice_stop);
+		right = pyfastx_fasta_slice_seq(self, chrom, normal, offset, bytes, line_len, end_len, slice_start, slice_stop);
 		ret = Py_BuildValue("ss", left, right);
 		free(left);
 		free(right);
@@ -505,10 +535,11 @@ PyObject *pyfastx_fasta_fetch(pyfastx_Fasta *self, PyObject *args, PyObject *kwa
 			j += seq_len;
 		}
 		sub_seq[j] = '\0';
+		seq_len = j;
 	}
 
 	if (strand == '-') {
-		reverse_complement_seq(sub_seq);
+		reverse_complement_seq(sub_seq, seq_len);
 	}
 	
 	return Py_BuildValue("s", sub_seq);
@@ -848,12 +879,96 @@ PyObject *pyfastx_fasta_format(pyfastx_Fasta *self, void* closure) {
 	Py_RETURN_FALSE;
 }
 
-void pyfastx_fasta_calc_composition(pyfastx_Fasta *self) {
-	int c;
+/*
+copy bases of sequence line into block buffer, bases are counted when the
+block is full so that letter counts are computed on long runs of bases, and
+cumulative counts of block letters are appended to blocks
+*/
+static void pyfastx_fasta_count_line(Py_ssize_t *counts, Py_ssize_t *pos, char *buff, kstring_t *blocks, const char *s, Py_ssize_t l) {
+	int i;
+	Py_ssize_t n;
+	Py_ssize_t filled;
+	uint32_t *p;
+	size_t bytes = PYFASTX_BLOCK_CLASSES * sizeof(uint32_t);
+
+	while (l > 0) {
+		filled = *pos % PYFASTX_BLOCK_SIZE;
+		n = PYFASTX_BLOCK_SIZE - filled;
+
+		if (n > l) {
+			n = l;
+		}
+
+		memcpy(buff + filled, s, n);
+
+		s += n;
+		l -= n;
+		*pos += n;
+
+		if (*pos % PYFASTX_BLOCK_SIZE == 0) {
+			count_bytes(buff, PYFASTX_BLOCK_SIZE, counts);
+
+			if (blocks->l + bytes > blocks->m) {
+				blocks->m = blocks->l + bytes;
+				kroundup32(blocks->m);
+				blocks->s = (char *)realloc(blocks->s, blocks->m);
+			}
+
+			p = (uint32_t *)(blocks->s + blocks->l);
+
+			for (i = 0; i < PYFASTX_BLOCK_CLASSES; ++i) {
+				p[i] = counts[(unsigned char)PYFASTX_BLOCK_BASES[i]];
+			}
+
+			blocks->l += bytes;
+		}
+	}
+}
+
+//write block counts of sequence, sequence shorter than a block has no row
+static void pyfastx_fasta_write_blocks(sqlite3_stmt *stmt, Py_ssize_t seqid, kstring_t *blocks) {
+	if (stmt && blocks->l) {
+		sqlite3_bind_int64(stmt, 1, seqid);
+		sqlite3_bind_blob(stmt, 2, blocks->s, blocks->l, NULL);
+		sqlite3_step(stmt);
+		sqlite3_reset(stmt);
+	}
+
+	blocks->l = 0;
+}
+
+//write packed letter counts of sequence and add them to total counts
+static void pyfastx_fasta_write_comp(sqlite3_stmt *stmt, Py_ssize_t seqid, Py_ssize_t *counts, Py_ssize_t *total, kstring_t *packed) {
 	int j;
+
+	pyfastx_index_pack_composition(counts, packed);
+
+	sqlite3_bind_int64(stmt, 1, seqid);
+	sqlite3_bind_blob(stmt, 2, packed->s, packed->l, NULL);
+	sqlite3_step(stmt);
+	sqlite3_reset(stmt);
+
+	if (total) {
+		for (j = 0; j < 128; ++j) {
+			total[j] += counts[j];
+		}
+	}
+}
+
+void pyfastx_fasta_calc_composition(pyfastx_Fasta *self) {
 	int ret;
 	const char *sql;
 	sqlite3_stmt *stmt;
+	sqlite3_stmt *block_stmt = NULL;
+
+	//bases of sequence, bases of the last block and letter counts at block boundaries
+	Py_ssize_t block_pos = 0;
+	char block_buff[PYFASTX_BLOCK_SIZE];
+	kstring_t blocks = {0, 0, 0};
+	Py_ssize_t l;
+
+	//packed letter counts of sequence
+	kstring_t packed = {0, 0, 0};
 
 	//reading file for kseq
 	kstream_t* ks;
@@ -861,22 +976,25 @@ void pyfastx_fasta_calc_composition(pyfastx_Fasta *self) {
 	//read for line
 	kstring_t line = {0, 0, 0};
 
-	//ascii char statistics
-	Py_ssize_t seq_comp[128] = {0};
-	Py_ssize_t fa_comp[128] = {0};
+	//byte statistics
+	Py_ssize_t seq_comp[256] = {0};
+	Py_ssize_t fa_comp[256] = {0};
 
-	Py_ssize_t i;
 	Py_ssize_t seqid = 0;
 
 	if (self->index->full_index) {
 		return;
 	}
 
-	sql = "SELECT * FROM comp LIMIT 1";
+	sql = "SELECT counts FROM comp LIMIT 1";
 
 	PYFASTX_SQLITE_CALL(
-		sqlite3_prepare_v2(self->index->index_db, sql, -1, &stmt, NULL);
-		ret = sqlite3_step(stmt);
+		ret = sqlite3_prepare_v2(self->index->index_db, sql, -1, &stmt, NULL);
+
+		if (ret == SQLITE_OK) {
+			ret = sqlite3_step(stmt);
+		}
+
 		sqlite3_finalize(stmt);
 	);
 	
@@ -885,15 +1003,36 @@ void pyfastx_fasta_calc_composition(pyfastx_Fasta *self) {
 		return;
 	}
 
+	//index files created by old versions store one row for each letter
+	if (ret == SQLITE_ERROR) {
+		sql = " \
+			DROP TABLE comp; \
+			CREATE TABLE comp (ID INTEGER PRIMARY KEY, counts BLOB); \
+			CREATE TABLE IF NOT EXISTS block (ID INTEGER PRIMARY KEY, counts BLOB);";
+
+		PYFASTX_SQLITE_CALL(
+			if (self->index->comp_stmt) {
+				sqlite3_finalize(self->index->comp_stmt);
+				self->index->comp_stmt = NULL;
+			}
+
+			sqlite3_exec(self->index->index_db, sql, NULL, NULL, NULL);
+		);
+	}
+
 	stmt = NULL;
 
 	sql = "PRAGMA synchronous=OFF;BEGIN TRANSACTION;";
 	PYFASTX_SQLITE_CALL(sqlite3_exec(self->index->index_db, sql, NULL, NULL, NULL));
 
-	sql = "INSERT INTO comp VALUES (?,?,?,?);";
+	sql = "INSERT INTO comp VALUES (?,?);";
 	PYFASTX_SQLITE_CALL(sqlite3_prepare_v2(self->index->index_db, sql, -1, &stmt, NULL));
+
+	sql = "INSERT INTO block VALUES (?,?);";
+	PYFASTX_SQLITE_CALL(sqlite3_prepare_v2(self->index->index_db, sql, -1, &block_stmt, NULL));
 	
-	gzrewind(self->index->gzfd);
+	pyfastx_stream_rewind(self->index->gzfd);
+	pyfastx_stream_readahead(self->index->gzfd, 1);
 	ks = ks_init(self->index->gzfd);
 	
 	Py_BEGIN_ALLOW_THREADS
@@ -901,113 +1040,64 @@ void pyfastx_fasta_calc_composition(pyfastx_Fasta *self) {
 	while (ks_getuntil(ks, '\n', &line, 0) >= 0) {
 		if (line.s[0] == 62) {
 			if (seqid > 0) {
-				for (j = 0; j < 128; ++j) {
-					if (seq_comp[j] > 0) {
-						sqlite3_bind_null(stmt, 1);
-						sqlite3_bind_int64(stmt, 2, seqid);
-						sqlite3_bind_int(stmt, 3, j);
-						sqlite3_bind_int64(stmt, 4, seq_comp[j]);
-						sqlite3_step(stmt);
-						sqlite3_reset(stmt);
-						fa_comp[j] += seq_comp[j];
-					}
-				}
+				count_bytes(block_buff, block_pos % PYFASTX_BLOCK_SIZE, seq_comp);
+				pyfastx_fasta_write_comp(stmt, seqid, seq_comp, fa_comp, &packed);
+				pyfastx_fasta_write_blocks(block_stmt, seqid, &blocks);
 			}
 
 			memset(seq_comp, 0, sizeof(seq_comp));
+			block_pos = 0;
 			seqid++;
 			continue;
 		}
 
-		for (i = 0; i < line.l; ++i) {
-			c = line.s[i];
+		l = line.l;
 
-			++seq_comp[c];
+		if (l && line.s[l-1] == '\r') {
+			--l;
 		}
+
+		pyfastx_fasta_count_line(seq_comp, &block_pos, block_buff, &blocks, line.s, l);
 	}
 
 	//write the last sequence
-	for (j = 0; j < 128; ++j) {
-		if (seq_comp[j] > 0) {
-			sqlite3_bind_null(stmt, 1);
-			sqlite3_bind_int64(stmt, 2, seqid);
-			sqlite3_bind_int(stmt, 3, j);
-			sqlite3_bind_int64(stmt, 4, seq_comp[j]);
-			sqlite3_step(stmt);
-			sqlite3_reset(stmt);
-			fa_comp[j] += seq_comp[j];
-		}
+	if (seqid > 0) {
+		count_bytes(block_buff, block_pos % PYFASTX_BLOCK_SIZE, seq_comp);
+		pyfastx_fasta_write_comp(stmt, seqid, seq_comp, fa_comp, &packed);
+		pyfastx_fasta_write_blocks(block_stmt, seqid, &blocks);
 	}
 
 	//write total composition to db
-	for (j = 0; j < 128; ++j) {
-		sqlite3_bind_null(stmt, 1);
-		sqlite3_bind_int64(stmt, 2, 0);
-		sqlite3_bind_int(stmt, 3, j);
-		sqlite3_bind_int64(stmt, 4, fa_comp[j]);
-		sqlite3_step(stmt);
-		sqlite3_reset(stmt);
-	}
+	pyfastx_fasta_write_comp(stmt, 0, fa_comp, NULL, &packed);
 
 	sqlite3_finalize(stmt);
-	sqlite3_exec(self->index->index_db, "CREATE INDEX seqidx ON comp (seqid);", NULL, NULL, NULL);
+	sqlite3_finalize(block_stmt);
 	sqlite3_exec(self->index->index_db, "COMMIT;", NULL, NULL, NULL);
 
 	Py_END_ALLOW_THREADS
 
+	pyfastx_stream_readahead(self->index->gzfd, 0);
 	self->index->full_index = 1;
 	ks_destroy(ks);
 	free(line.s);
+	free(blocks.s);
+	free(packed.s);
 }
 
 PyObject *pyfastx_fasta_gc_content(pyfastx_Fasta *self, void* closure) {
-	int ret;
-
-	int l;
-	Py_ssize_t n;
-	Py_ssize_t a = 0;
-	Py_ssize_t c = 0;
-	Py_ssize_t g = 0;
-	Py_ssize_t t = 0;
+	Py_ssize_t a;
+	Py_ssize_t c;
+	Py_ssize_t g;
+	Py_ssize_t t;
+	Py_ssize_t fa_comp[128];
 
 	pyfastx_fasta_calc_composition(self);
-	
-	PYFASTX_SQLITE_CALL(
-		sqlite3_bind_int64(self->index->comp_stmt, 1, 0);
-		ret = sqlite3_step(self->index->comp_stmt);
-	);
-
-	while (ret == SQLITE_ROW) {
-		PYFASTX_SQLITE_CALL(
-			l = sqlite3_column_int(self->index->comp_stmt, 2);
-			n = sqlite3_column_int64(self->index->comp_stmt, 3);
-			ret = sqlite3_step(self->index->comp_stmt);
-		);
-
-		switch (l) {
-			case 65:
-			case 97:
-				a += n;
-				break;
+	pyfastx_index_composition(self->index, 0, fa_comp);
 
-			case 67:
-			case 99:
-				c += n;
-				break;
-
-			case 71:
-			case 103:
-				g += n;
-				break;
-
-			case 84:
-			case 116:
-				t += n;
-				break;
-		}
-	}
-
-	PYFASTX_SQLITE_CALL(sqlite3_reset(self->index->comp_stmt));
+	a = fa_comp['A'] + fa_comp['a'];
+	c = fa_comp['C'] + fa_comp['c'];
+	g = fa_comp['G'] + fa_comp['g'];
+	t = fa_comp['T'] + fa_comp['t'];
 
 	if (a + c + g + t > 0) {
 		return Py_BuildValue("f", (float)(g+c)/(a+c+g+t)*100);
@@ -1018,41 +1108,15 @@ PyObject *pyfastx_fasta_gc_content(pyfastx_Fasta *self, void* closure) {
 }
 
 PyObject *pyfastx_fasta_gc_skew(pyfastx_Fasta *self, void* closure) {
-	int ret;
-
-	int l;
-	Py_ssize_t n;
-	Py_ssize_t c = 0;
-	Py_ssize_t g = 0;
+	Py_ssize_t c;
+	Py_ssize_t g;
+	Py_ssize_t fa_comp[128];
 
 	pyfastx_fasta_calc_composition(self);
-	
-	PYFASTX_SQLITE_CALL(
-		sqlite3_bind_int64(self->index->comp_stmt, 1, 0);
-		ret = sqlite3_step(self->index->comp_stmt);
-	);
+	pyfastx_index_composition(self->index, 0, fa_comp);
 
-	while (ret == SQLITE_ROW) {
-		PYFASTX_SQLITE_CALL(
-			l = sqlite3_column_int(self->index->comp_stmt, 2);
-			n = sqlite3_column_int64(self->index->comp_stmt, 3);
-			ret = sqlite3_step(self->index->comp_stmt);
-		);
-
-		switch (l) {
-			case 67:
-			case 99:
-				c += n;
-				break;
-
-			case 71:
-			case 103:
-				g += n;
-				break;
-		}
-	}
-
-	PYFASTX_SQLITE_CALL(sqlite3_reset(self->index->comp_stmt));
+	c = fa_comp['C'] + fa_comp['c'];
+	g = fa_comp['G'] + fa_comp['g'];
 
 	if (c + g > 0) {
 		return Py_BuildValue("f", (float)(g-c)/(g+c));
@@ -1064,9 +1128,8 @@ PyObject *pyfastx_fasta_gc_skew(pyfastx_Fasta *self, void* closure) {
 
 PyObject *pyfastx_fasta_composition(pyfastx_Fasta *self, void* closure) {
 	int l;
-	int ret;
 
-	Py_ssize_t n;
+	Py_ssize_t fa_comp[128];
 
 	PyObject *d;
 	PyObject *b;
@@ -1074,32 +1137,21 @@ PyObject *pyfastx_fasta_composition(pyfastx_Fasta *self, void* closure) {
 
 	pyfastx_fasta_calc_composition(self);
 
-	//the last row store the sum of the each base
-	PYFASTX_SQLITE_CALL(
-		sqlite3_bind_int64(self->index->comp_stmt, 1, 0);
-		ret = sqlite3_step(self->index->comp_stmt);
-	);
+	//the row with id 0 store the sum of the each base
+	pyfastx_index_composition(self->index, 0, fa_comp);
 
 	d = PyDict_New();
 
-	while (ret == SQLITE_ROW) {
-		PYFASTX_SQLITE_CALL(
-			l = sqlite3_column_int(self->index->comp_stmt, 2);
-			n = sqlite3_column_int64(self->index->comp_stmt, 3);
-			ret = sqlite3_step(self->index->comp_stmt);
-		);
-
-		if (n > 0 && l >= 32 && l < 127) {
+	for (l = 32; l < 127; ++l) {
+		if (fa_comp[l] > 0) {
 			b = Py_BuildValue("C", l);
-			c = Py_BuildValue("n", n);
+			c = Py_BuildValue("n", fa_comp[l]);
 			PyDict_SetItem(d, b, c);
 			Py_DECREF(b);
 			Py_DECREF(c);
 		}
 	}
 
-	PYFASTX_SQLITE_CALL(sqlite3_step(self->index->comp_stmt));
-
 	return d;
 }
 
@@ -1107,38 +1159,26 @@ PyObject *pyfastx_fasta_composition(pyfastx_Fasta *self, void* closure) {
 //https://www.bioinformatics.org/sms/iupac.html
 PyObject *pyfastx_fasta_guess_type(pyfastx_Fasta *self, void* closure) {
 	int l;
-	int ret;
 	int i;
 
 	char *alphabets;
 	char *retval;
 
-	Py_ssize_t n;
+	Py_ssize_t fa_comp[128];
 
 	pyfastx_fasta_calc_composition(self);
-
-	PYFASTX_SQLITE_CALL(
-		sqlite3_bind_int64(self->index->comp_stmt, 1, 0);
-		ret = sqlite3_step(self->index->comp_stmt);
-	);
+	pyfastx_index_composition(self->index, 0, fa_comp);
 
 	i = 0;
 	alphabets = (char *)malloc(128);
 
-	while (ret == SQLITE_ROW) {
-		PYFASTX_SQLITE_CALL(
-			l = sqlite3_column_int(self->index->comp_stmt, 2);
-			n = sqlite3_column_int64(self->index->comp_stmt, 3);
-			ret = sqlite3_step(self->index->comp_stmt);
-		);
-
-		if (l > 32 && l < 127 && n > 0) {
+	for (l = 33; l < 127; ++l) {
+		if (fa_comp[l] > 0) {
 			alphabets[i++] = l;
 		}
 	}
 
 	alphabets[i] = '\0';
-	PYFASTX_SQLITE_CALL(sqlite3_reset(self->index->comp_stmt));
 
 	if (is_subset("ACGTNacgtn", alphabets) || is_subset("abcdghkmnrstvwyABCDGHKMNRSTVWY*-", alphabets)) {
 		retval = "DNA";
@@ -1150,9 +1190,194 @@ PyObject *pyfastx_fasta_guess_type(pyfastx_Fasta *self, void* closure) {
 		retval = "unknown";
 	}
 
+	free(alphabets);
 	return Py_BuildValue("s", retval);
 }
 
+PyObject *pyfastx_fasta_batches(pyfastx_Fasta *self, PyObject *args, PyObject *kwargs) {
+	Py_ssize_t size = 1000;
+	int threads = 1;
+	int ordered = 1;
+
+	static char* keywords[] = {"size", "threads", "ordered", NULL};
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|nii", keywords, &size, &threads, &ordered)) {
+		return NULL;
+	}
+
+	return pyfastx_batch_iter_create((PyObject *)self, self->file_obj, size, threads, ordered, 1, self->index->uppercase, 0, self->index->full_name, NULL);
+}
+
+PyObject *pyfastx_fasta_kmers(pyfastx_Fasta *self, PyObject *args, PyObject *kwargs) {
+	return pyfastx_kmer_iter_create((PyObject *)self, self->index->kseqs, NULL, args, kwargs);
+}
+
+PyObject *pyfastx_fasta_count_kmers(pyfastx_Fasta *self, PyObject *args, PyObject *kwargs) {
+	return pyfastx_kmer_count(self->index->kseqs, 1, NULL, args, kwargs);
+}
+
+PyObject *pyfastx_fasta_sketch(pyfastx_Fasta *self, PyObject *args, PyObject *kwargs) {
+	return pyfastx_sketch_create((PyObject *)self, self->index->kseqs, 1, NULL, args, kwargs);
+}
+
+PyObject *pyfastx_fasta_search_all(pyfastx_Fasta *self, PyObject *args, PyObject *kwargs) {
+	return pyfastx_motif_search((PyObject *)self, self->index->kseqs, args, kwargs);
+}
+
+PyObject *pyfastx_fasta_search_approx(pyfastx_Fasta *self, PyObject *args, PyObject *kwargs) {
+	return pyfastx_motif_search_approx((PyObject *)self, self->index->kseqs, self->index->full_name, args, kwargs);
+}
+
+PyObject *pyfastx_fasta_gc_profile(pyfastx_Fasta *self, PyObject *args, PyObject *kwargs) {
+	return pyfastx_gc_profile((PyObject *)self, self->index->kseqs, args, kwargs);
+}
+
+PyObject *pyfastx_fasta_range_next_with_index(pyfastx_RangeIter *it) {
+	return pyfastx_index_next_with_index_seq(((pyfastx_Fasta *)it->parent)->index);
+}
+
+PyObject *pyfastx_fasta_range_next(pyfastx_RangeIter *it) {
+	pyfastx_Fasta *self = (pyfastx_Fasta *)it->parent;
+
+	if (pyfastx_range_tell(it->kseq) >= it->end_offset) {
+		return NULL;
+	}
+
+	return self->func(self->index);
+}
+
+//shard of unindexed plain file, start and end are snapped to sequence headers
+PyObject *pyfastx_fasta_iter_shard(pyfastx_Fasta *self, Py_ssize_t shards, Py_ssize_t shard) {
+	Py_ssize_t start;
+	Py_ssize_t end;
+	Py_ssize_t offset;
+	pyfastx_RangeIter *it;
+
+	if (!shards) {
+		PyErr_SetString(PyExc_RuntimeError, "index has not been built, call build_index() first");
+		return NULL;
+	}
+
+	if (self->index->gzip_format || self->index->zstd_format) {
+		PyErr_SetString(PyExc_RuntimeError, "compressed file without index can not be sharded, call build_index() first");
+		return NULL;
+	}
+
+	if (!pyfastx_range_file_shard(self->index->fd, shards, shard, &start, &end)) {
+		return NULL;
+	}
+
+	it = pyfastx_range_iter_create((PyObject *)self, pyfastx_fasta_range_next);
+
+	if (!it) {
+		return NULL;
+	}
+
+	pyfastx_stream_readahead(self->index->gzfd, 0);
+	offset = pyfastx_range_sync(self->index->kseqs, start, 1);
+	pyfastx_fasta_select_next(self);
+
+	it->kseq = self->index->kseqs;
+	it->end_offset = offset < 0 ? -1 : end;
+
+	return (PyObject *)it;
+}
+
+/*
+iterate sequences with id from start_id to end_id or in the kth of
+shards that split file into byte ranges, sequence reading starts from
+the first sequence in range instead of the start of file
+*/
+PyObject *pyfastx_fasta_iter_range(pyfastx_Fasta *self, PyObject *args, PyObject *kwargs) {
+	Py_ssize_t start_id = 0;
+	Py_ssize_t end_id = 0;
+	Py_ssize_t shards = 0;
+	Py_ssize_t shard = 0;
+	Py_ssize_t offset;
+	pyfastx_RangeIter *it;
+
+	const char *header_sql = "SELECT boff-dlen-elen-1 FROM seq WHERE ID=?";
+
+	if (!pyfastx_range_parse_args(args, kwargs, &start_id, &end_id, &shards, &shard)) {
+		return NULL;
+	}
+
+	if (!self->has_index) {
+		return pyfastx_fasta_iter_shard(self, shards, shard);
+	}
+
+	if (shards) {
+		pyfastx_range_index_shard(self->index->index_db, header_sql, "SELECT boff+blen FROM seq WHERE ID=?", self->seq_counts, shards, shard, &start_id, &end_id);
+	}
+
+	if (!start_id) {
+		start_id = 1;
+	}
+
+	if (!end_id || end_id > self->seq_counts) {
+		end_id = self->seq_counts;
+	}
+
+	it = pyfastx_range_iter_create((PyObject *)self, pyfastx_fasta_range_next_with_index);
+
+	if (!it) {
+		return NULL;
+	}
+
+	pyfastx_rewind_index(self->index);
+	pyfastx_stream_readahead(self->index->gzfd, 0);
+
+	self->index->iterating = 1;
+	PYFASTX_SQLITE_CALL(
+		sqlite3_finalize(self->index->iter_stmt);
+		self->index->iter_stmt = NULL;
+		sqlite3_prepare_v2(self->index->index_db, "SELECT * FROM seq WHERE ID BETWEEN ? AND ?", -1, &self->index->iter_stmt, NULL);
+		sqlite3_bind_int64(self->index->iter_stmt, 1, start_id);
+		sqlite3_bind_int64(self->index->iter_stmt, 2, end_id);
+	);
+
+	//sequences are read continuously from the first header in range
+	if (start_id <= end_id) {
+		offset = pyfastx_range_offset(self->index->index_db, header_sql, start_id);
+
+		if (self->index->gzip_format) {
+			pyfastx_stream_seek_index(self->index->gzfd, self->index->gzip_index, offset);
+		} else {
+			pyfastx_stream_seek(self->index->gzfd, offset);
+		}
+	}
+
+	return (PyObject *)it;
+}
+
+PyObject *pyfastx_fasta_index_table(pyfastx_Fasta *self, PyObject *args) {
+	static const char *names[] = {"id", "name", "offset", "bytes", "length", "line_length", "end_length", "normal", "desc_length"};
+	static const char *formats[] = {"l", "U", "l", "l", "l", "l", "l", "l", "l"};
+
+	if (!self->has_index) {
+		PyErr_SetString(PyExc_RuntimeError, "index has not been built, call build_index() first");
+		return NULL;
+	}
+
+	return pyfastx_table_from_query(self->index->index_db, "SELECT * FROM seq ORDER BY ID", names, formats, 9);
+}
+
+static PyObject *pyfastx_fasta_intervals(pyfastx_Fasta *self, int track) {
+	if (!self->has_index) {
+		PyErr_SetString(PyExc_RuntimeError, "index has not been built, call build_index() first");
+		return NULL;
+	}
+
+	return pyfastx_mask_intervals(self->index, 1, self->seq_counts, 0, PY_SSIZE_T_MAX, track);
+}
+
+PyObject *pyfastx_fasta_masks(pyfastx_Fasta *self, PyObject *args) {
+	return pyfastx_fasta_intervals(self, PYFASTX_MASK_SOFT);
+}
+
+PyObject *pyfastx_fasta_gaps(pyfastx_Fasta *self, PyObject *args) {
+	return pyfastx_fasta_intervals(self, PYFASTX_MASK_GAP);
+}
+
 static PyGetSetDef pyfastx_fasta_getsets[] = {
 	{"longest", (getter)pyfastx_fasta_longest, NULL, NULL, NULL},
 	{"shortest", (getter)pyfastx_fasta_shortest, NULL, NULL, NULL},
@@ -1179,6 +1404,17 @@ static PyMethodDef pyfastx_fasta_methods[] = {
 	{"count", (PyCFunction)pyfastx_fasta_count, METH_VARARGS, NULL},
 	{"keys", (PyCFunction)pyfastx_fasta_keys, METH_NOARGS, NULL},
 	{"nl", (PyCFunction)pyfastx_fasta_nl, METH_VARARGS, NULL},
+	{"batches", (PyCFunction)pyfastx_fasta_batches, METH_VARARGS|METH_KEYWORDS, NULL},
+	{"index_table", (PyCFunction)pyfastx_fasta_index_table, METH_NOARGS, NULL},
+	{"iter_range", (PyCFunction)pyfastx_fasta_iter_range, METH_VARARGS|METH_KEYWORDS, NULL},
+	{"kmers", (PyCFunction)pyfastx_fasta_kmers, METH_VARARGS|METH_KEYWORDS, NULL},
+	{"count_kmers", (PyCFunction)pyfastx_fasta_count_kmers, METH_VARARGS|METH_KEYWORDS, NULL},
+	{"sketch", (PyCFunction)pyfastx_fasta_sketch, METH_VARARGS|METH_KEYWORDS, NULL},
+	{"search_all", (PyCFunction)pyfastx_fasta_search_all, METH_VARARGS|METH_KEYWORDS, NULL},
+	{"search_approx", (PyCFunction)pyfastx_fasta_search_approx, METH_VARARGS|METH_KEYWORDS, NULL},
+	{"gc_profile", (PyCFunction)pyfastx_fasta_gc_profile, METH_VARARGS|METH_KEYWORDS, NULL},
+	{"masks", (PyCFunction)pyfastx_fasta_masks, METH_NOARGS, NULL},
+	{"gaps", (PyCFunction)pyfastx_fasta_gaps, METH_NOARGS, NULL},
 	{NULL, NULL, 0, NULL}
 };
 
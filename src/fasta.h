@@ -43,6 +43,7 @@ Py_ssize_t pyfastx_fasta_length(pyfastx_Fasta *self);
 PyObject *pyfastx_fasta_new(PyTypeObject *type, PyObject *args, PyObject *kwargs);
 PyObject *pyfastx_fasta_iter(pyfastx_Fasta *self);
 PyObject *pyfastx_fasta_next(pyfastx_Fasta *self);
+void pyfastx_fasta_select_next(pyfastx_Fasta *self);
 PyObject *pyfastx_fasta_repr(pyfastx_Fasta *self);
 PyObject *pyfastx_fasta_build_index(pyfastx_Fasta *self);
 PyObject *pyfastx_fasta_rebuild_index(pyfastx_Fasta *self);
@@ -3,6 +3,11 @@
 #include "fastq.h"
 #include "read.h"
 #include "fqkeys.h"
+#include "batch.h"
+#include "arrow.h"
+#include "range.h"
+#include "kmer.h"
+#include "sketch.h"
 #include "structmember.h"
 
 void pyfastx_fastq_create_index(pyfastx_Fastq *self) {
@@ -81,7 +86,8 @@ void pyfastx_fastq_create_index(pyfastx_Fastq *self) {
 	sql = "INSERT INTO read VALUES (?,?,?,?,?,?);";
 	PYFASTX_SQLITE_CALL(sqlite3_prepare_v2(self->index_db, sql, -1, &stmt, NULL));
 
-	gzrewind(self->middle->gzfd);
+	pyfastx_stream_rewind(self->middle->gzfd);
+	pyfastx_stream_readahead(self->middle->gzfd, 1);
 	ks_rewind(self->ks);
 
 	//Py_BEGIN_ALLOW_THREADS
@@ -172,6 +178,7 @@ void pyfastx_fastq_create_index(pyfastx_Fastq *self) {
 
 	//Py_END_ALLOW_THREADS
 
+	pyfastx_stream_readahead(self->middle->gzfd, 0);
 	free(line.s);
 	free(name.s);
 
@@ -291,15 +298,16 @@ PyObject *pyfastx_fastq_new(PyTypeObject *type, PyObject *args, PyObject *kwargs
 
 	//check input file is gzip or not
 	obj->middle->gzip_format = is_gzip_format(file_obj);
+	obj->middle->zstd_format = is_zstd_format(file_obj);
 
 	//initial kstream and kseq
-	obj->middle->gzfd = pyfastx_gzip_open(file_obj, "rb");
+	obj->middle->gzfd = pyfastx_stream_open(file_obj);
 	obj->ks = ks_init(obj->middle->gzfd);
 	obj->middle->kseq = kseq_init(obj->middle->gzfd);
 
 	//check is correct fastq format
 	if (!fastq_validator(obj->middle->gzfd)) {
-		PyErr_Format(PyExc_RuntimeError, "%U is not plain or gzip compressed fastq formatted file", file_obj);
+		PyErr_Format(PyExc_RuntimeError, "%U is not plain, gzip or zstd compressed fastq formatted file", file_obj);
 		return NULL;
 	}
 
@@ -321,7 +329,6 @@ PyObject *pyfastx_fastq_new(PyTypeObject *type, PyObject *args, PyObject *kwargs
 
 	//initail index connection
 	obj->index_db = 0;
-	obj->middle->iter_stmt = NULL;
 	obj->id_stmt = NULL;
 	obj->name_stmt = NULL;
 
@@ -338,8 +345,12 @@ PyObject *pyfastx_fastq_new(PyTypeObject *type, PyObject *args, PyObject *kwargs
 
 	//is gzip file
 	if (obj->middle->gzip_format) {
-		obj->middle->gzip_index = (zran_index_t *)malloc(sizeof(zran_index_t));
-		zran_init(obj->middle->gzip_index, obj->middle->fd, NULL, 1048576, 32768, 16384, ZRAN_AUTO_BUILD);
+		obj->middle->gzip_index = pyfastx_gzip_index_init(obj->middle->fd);
+	}
+
+	//is zstd file
+	if (obj->middle->zstd_format) {
+		obj->middle->zstd_index = pyfastx_zstd_open(obj->middle->fd, 0);
 	}
 
 	index_obj = PyUnicode_FromString(obj->index_file);
@@ -365,21 +376,12 @@ PyObject *pyfastx_fastq_new(PyTypeObject *type, PyObject *args, PyObject *kwargs
 	//iter function
 	obj->func = pyfastx_fastq_next_null;
 
-	//initialize cache buffer
-	obj->middle->cache_buff = NULL;
-	obj->middle->cache_soff = 0;
-	obj->middle->cache_eoff = 0;
-
 	obj->middle->fastq = (PyObject *)obj;
 
 	return (PyObject *)obj;
 }
 
 void pyfastx_fastq_dealloc(pyfastx_Fastq *self) {
-	if (self->middle->iter_stmt) {
-		PYFASTX_SQLITE_CALL(sqlite3_finalize(self->middle->iter_stmt));
-	}
-
 	if (self->id_stmt) {
 		PYFASTX_SQLITE_CALL(sqlite3_finalize(self->id_stmt));
 	}
@@ -388,16 +390,16 @@ void pyfastx_fastq_dealloc(pyfastx_Fastq *self) {
 		PYFASTX_SQLITE_CALL(sqlite3_finalize(self->name_stmt));
 	}
 
-	if (self->index_db) {
-		PYFASTX_SQLITE_CALL(sqlite3_close(self->index_db));
+	if (self->middle->gzip_format) {
+		pyfastx_gzip_index_free(self->middle->gzip_index);
 	}
 
-	if (self->middle->gzip_format) {
-		zran_free(self->middle->gzip_index);
+	if (self->middle->zstd_format) {
+		pyfastx_zstd_close(self->middle->zstd_index);
 	}
 
-	if (self->middle->cache_buff) {
-		free(self->middle->cache_buff);
+	if (self->index_db) {
+		PYFASTX_SQLITE_CALL(sqlite3_close(self->index_db));
 	}
 
 	self->middle->fastq = NULL;
@@ -405,7 +407,7 @@ void pyfastx_fastq_dealloc(pyfastx_Fastq *self) {
 	ks_destroy(self->ks);
 	kseq_destroy(self->middle->kseq);
 	fclose(self->middle->fd);
-	gzclose(self->middle->gzfd);
+	pyfastx_stream_close(self->middle->gzfd);
 
 	Py_DECREF(self->file_obj);
 
@@ -416,44 +418,10 @@ Py_ssize_t pyfastx_fastq_length(pyfastx_Fastq *self) {
 	return self->read_counts;
 }
 
-pyfastx_Read* pyfastx_fastq_new_read(pyfastx_FastqMiddleware *middle) {
-	pyfastx_Read* read = (pyfastx_Read *)PyObject_CallObject((PyObject *)&pyfastx_ReadType, NULL);
-	read->middle = middle;
-	read->seq = NULL;
-	read->qual = NULL;
-	read->raw = NULL;
-	read->desc = NULL;
-
-	Py_INCREF(middle->fastq);
-
-	return read;
-}
-
-PyObject* pyfastx_fastq_make_read(pyfastx_FastqMiddleware *middle) {
-	int nbytes;
-
-	//pyfastx_Read *read = PyObject_New(pyfastx_Read, &pyfastx_ReadType);
-	pyfastx_Read *read = pyfastx_fastq_new_read(middle);
-
-	PYFASTX_SQLITE_CALL(
-		read->id = sqlite3_column_int64(middle->iter_stmt, 0);
-		nbytes = sqlite3_column_bytes(middle->iter_stmt, 1);
-		read->name = (char *)malloc(nbytes + 1);
-		memcpy(read->name, sqlite3_column_text(middle->iter_stmt, 1), nbytes);
-		read->name[nbytes] = '\0';
-		read->desc_len = sqlite3_column_int(middle->iter_stmt, 2);
-		read->read_len = sqlite3_column_int64(middle->iter_stmt, 3);
-		read->seq_offset = sqlite3_column_int64(middle->iter_stmt, 4);
-		read->qual_offset = sqlite3_column_int64(middle->iter_stmt, 5);
-		//sqlite3_finalize(stmt);
-	);
-
-	return (PyObject *)read;
-}
-
 PyObject* pyfastx_fastq_get_read_by_id(pyfastx_Fastq *self, Py_ssize_t read_id) {
 	int ret;
 	int nbytes;
+	char *block;
 	pyfastx_Read *obj;
 
 	PYFASTX_SQLITE_CALL(
@@ -462,13 +430,23 @@ PyObject* pyfastx_fastq_get_read_by_id(pyfastx_Fastq *self, Py_ssize_t read_id)
 	);
 
 	if (ret == SQLITE_ROW) {
-		obj = pyfastx_fastq_new_read(self->middle);
+		obj = pyfastx_read_new(self->middle);
+
+		if (!obj) {
+			PYFASTX_SQLITE_CALL(sqlite3_reset(self->id_stmt));
+			return NULL;
+		}
+
 		obj->id = read_id;
 		PYFASTX_SQLITE_CALL(
 			nbytes = sqlite3_column_bytes(self->id_stmt, 1);
-			obj->name = (char *)malloc(nbytes + 1);
-			memcpy(obj->name, sqlite3_column_text(self->id_stmt, 1), nbytes);
-			obj->name[nbytes] = '\0';
+			block = pyfastx_read_reserve(obj, nbytes + 1);
+
+			if (block) {
+				memcpy(obj->name, sqlite3_column_text(self->id_stmt, 1), nbytes);
+				obj->name[nbytes] = '\0';
+			}
+
 			obj->desc_len = sqlite3_column_int(self->id_stmt, 2);
 			obj->read_len = sqlite3_column_int64(self->id_stmt, 3);
 			obj->seq_offset = sqlite3_column_int64(self->id_stmt, 4);
@@ -476,6 +454,11 @@ PyObject* pyfastx_fastq_get_read_by_id(pyfastx_Fastq *self, Py_ssize_t read_id)
 			sqlite3_reset(self->id_stmt);
 		);
 
+		if (!block) {
+			Py_DECREF(obj);
+			return PyErr_NoMemory();
+		}
+
 		return (PyObject *)obj;
 	} else {
 		PyErr_SetString(PyExc_IndexError, "Index Error");
@@ -497,8 +480,19 @@ PyObject* pyfastx_fastq_get_read_by_name(pyfastx_Fastq *self, PyObject* rname) {
 	);
 
 	if (ret == SQLITE_ROW) {
-		obj = pyfastx_fastq_new_read(self->middle);
-		obj->name = (char *)malloc(nbytes + 1);
+		obj = pyfastx_read_new(self->middle);
+
+		if (!obj) {
+			PYFASTX_SQLITE_CALL(sqlite3_reset(self->name_stmt));
+			return NULL;
+		}
+
+		if (!pyfastx_read_reserve(obj, nbytes + 1)) {
+			PYFASTX_SQLITE_CALL(sqlite3_reset(self->name_stmt));
+			Py_DECREF(obj);
+			return PyErr_NoMemory();
+		}
+
 		memcpy(obj->name, name, nbytes);
 		obj->name[nbytes] = '\0';
 
@@ -521,8 +515,6 @@ PyObject* pyfastx_fastq_get_read_by_name(pyfastx_Fastq *self, PyObject* rname) {
 PyObject* pyfastx_fastq_subscript(pyfastx_Fastq *self, PyObject *item) {
 	Py_ssize_t i;
 
-	self->middle->iterating = 0;
-
 	if (PyUnicode_Check(item)) {
 		return pyfastx_fastq_get_read_by_name(self, item);
 	} else if (PyIndex_Check(item)) {
@@ -575,25 +567,100 @@ int pyfastx_fastq_contains(pyfastx_Fastq *self, PyObject *key) {
 	return ret==SQLITE_ROW ? 1 : 0;
 }
 
+//read a line and move iteration offset, return -1 at the end of file
+Py_ssize_t pyfastx_fastq_next_line(pyfastx_FastqMiddleware *middle, kstring_t *line) {
+	Py_ssize_t l = ks_getuntil(middle->kseq->f, '\n', line, 0);
+
+	if (l >= 0) {
+		middle->iter_offset += l + 1;
+	}
+
+	return l;
+}
+
+/*
+parse the next four line record from stream instead of stepping index rows,
+read id and offsets are counted in the same way as building index, kseq
+strings are reused as buffers of header, sequence, plus and quality lines
+*/
 PyObject *pyfastx_fastq_next_with_index_read(pyfastx_FastqMiddleware *middle) {
-	int ret;
+	kseq_t *kseq = middle->kseq;
+	pyfastx_Read *read;
+	Py_ssize_t soff;
+	Py_ssize_t qoff;
+	Py_ssize_t rlen;
+	Py_ssize_t nlen;
+	Py_ssize_t hlen;
+	char *space;
+
+	if (pyfastx_fastq_next_line(middle, &kseq->comment) < 1) {
+		return NULL;
+	}
 
-	PYFASTX_SQLITE_CALL(ret = sqlite3_step(middle->iter_stmt));
+	soff = middle->iter_offset;
 
-	if (ret == SQLITE_ROW) {
-		return pyfastx_fastq_make_read(middle);
+	if (pyfastx_fastq_next_line(middle, &kseq->seq) < 0 || pyfastx_fastq_next_line(middle, &kseq->name) < 0) {
+		return NULL;
 	}
 
-	PYFASTX_SQLITE_CALL(sqlite3_finalize(middle->iter_stmt));
-	middle->iter_stmt = NULL;
-	middle->iterating = 0;
+	qoff = middle->iter_offset;
 
-	if (middle->cache_buff) {
-		free(middle->cache_buff);
-		middle->cache_buff = NULL;
+	if (pyfastx_fastq_next_line(middle, &kseq->qual) < 0) {
+		return NULL;
 	}
 
-	return NULL;
+	rlen = kseq->seq.l;
+
+	if (rlen && kseq->seq.s[rlen-1] == '\r') {
+		--rlen;
+	}
+
+	read = pyfastx_read_new(middle);
+
+	if (!read) {
+		return NULL;
+	}
+
+	read->id = ++middle->iter_id;
+	read->read_len = rlen;
+	read->desc_len = kseq->comment.l;
+	read->seq_offset = soff;
+	read->qual_offset = qoff;
+
+	//name is the part of header before first space
+	hlen = kseq->comment.l;
+
+	if (kseq->comment.s[hlen-1] == '\r') {
+		kseq->comment.s[--hlen] = '\0';
+	}
+
+	space = strchr(kseq->comment.s, ' ');
+	nlen = space ? space - kseq->comment.s - 1 : hlen - 1;
+
+	//name, header line with leading @ as description, seq and qual are
+	//packed into one block
+	if (!pyfastx_read_reserve(read, nlen + hlen + rlen * 2 + 4)) {
+		Py_DECREF(read);
+		return PyErr_NoMemory();
+	}
+
+	read->packed = 1;
+
+	memcpy(read->name, kseq->comment.s + 1, nlen);
+	read->name[nlen] = '\0';
+
+	read->desc = read->name + nlen + 1;
+	memcpy(read->desc, kseq->comment.s, hlen + 1);
+
+	read->seq = read->desc + hlen + 1;
+	memcpy(read->seq, kseq->seq.s, rlen);
+	read->seq[rlen] = '\0';
+
+	read->qual = read->seq + rlen + 1;
+	memcpy(read->qual, kseq->qual.s, rlen);
+	read->qual[rlen] = '\0';
+
+	return (PyObject *)read;
 }
 
 PyObject *pyfastx_fastq_next_read(pyfastx_FastqMiddleware *middle) {
@@ -623,39 +690,157 @@ PyObject *pyfastx_fastq_next_full_name_read(pyfastx_FastqMiddleware *middle) {
 }
 
 PyObject *pyfastx_fastq_iter(pyfastx_Fastq *self) {
-	gzrewind(self->middle->gzfd);
-	rewind(self->middle->fd);
-	
-	if (self->has_index) {
-		self->middle->iterating = 1;
-
-		if (!self->middle->cache_buff) {
-			self->middle->cache_buff = (char *)malloc(CACHE_SIZE);
-		}
-		self->middle->cache_soff = 0;
-		self->middle->cache_eoff = 0;
+	pyfastx_stream_rewind(self->middle->gzfd);
 
-		PYFASTX_SQLITE_CALL(
-			sqlite3_finalize(self->middle->iter_stmt);
-			self->middle->iter_stmt = NULL;
-			sqlite3_prepare_v2(self->index_db, "SELECT * FROM read", -1, &self->middle->iter_stmt, NULL);
-		);
+	//zstd reader keeps the position of file handle by itself
+	if (self->middle->zstd_format) {
+		pyfastx_zstd_rewind(self->middle->zstd_index);
+	} else {
+		rewind(self->middle->fd);
+	}
+	
+	pyfastx_stream_readahead(self->middle->gzfd, 1);
+	kseq_rewind(self->middle->kseq);
 
+	if (self->has_index) {
+		self->middle->iter_id = 0;
+		self->middle->iter_offset = 0;
 		self->func = pyfastx_fastq_next_with_index_read;
+	} else if (self->full_name) {
+		self->func = pyfastx_fastq_next_full_name_read;
 	} else {
-		kseq_rewind(self->middle->kseq);
-
-		if (self->full_name) {
-			self->func = pyfastx_fastq_next_full_name_read;
-		} else {
-			self->func = pyfastx_fastq_next_read;
-		}
+		self->func = pyfastx_fastq_next_read;
 	}
 	
 	Py_INCREF(self);
 	return (PyObject *)self;
 }
 
+PyObject *pyfastx_fastq_range_next_with_index(pyfastx_RangeIter *it) {
+	pyfastx_FastqMiddleware *middle = ((pyfastx_Fastq *)it->parent)->middle;
+
+	if (middle->iter_id >= it->end_id) {
+		return NULL;
+	}
+
+	return pyfastx_fastq_next_with_index_read(middle);
+}
+
+PyObject *pyfastx_fastq_range_next(pyfastx_RangeIter *it) {
+	pyfastx_Fastq *self = (pyfastx_Fastq *)it->parent;
+
+	if (pyfastx_range_tell(it->kseq) >= it->end_offset) {
+		return NULL;
+	}
+
+	return self->func(self->middle);
+}
+
+//shard of unindexed plain file, start and end are snapped to read headers
+PyObject *pyfastx_fastq_iter_shard(pyfastx_Fastq *self, Py_ssize_t shards, Py_ssize_t shard) {
+	Py_ssize_t start;
+	Py_ssize_t end;
+	Py_ssize_t offset;
+	pyfastx_RangeIter *it;
+
+	if (!shards) {
+		PyErr_SetString(PyExc_RuntimeError, "index has not been built, call build_index() first");
+		return NULL;
+	}
+
+	if (self->middle->gzip_format || self->middle->zstd_format) {
+		PyErr_SetString(PyExc_RuntimeError, "compressed file without index can not be sharded, call build_index() first");
+		return NULL;
+	}
+
+	if (!pyfastx_range_file_shard(self->middle->fd, shards, shard, &start, &end)) {
+		return NULL;
+	}
+
+	it = pyfastx_range_iter_create((PyObject *)self, pyfastx_fastq_range_next);
+
+	if (!it) {
+		return NULL;
+	}
+
+	pyfastx_stream_readahead(self->middle->gzfd, 0);
+	offset = pyfastx_range_sync(self->middle->kseq, start, 2);
+
+	if (self->full_name) {
+		self->func = pyfastx_fastq_next_full_name_read;
+	} else {
+		self->func = pyfastx_fastq_next_read;
+	}
+
+	it->kseq = self->middle->kseq;
+	it->end_offset = offset < 0 ? -1 : end;
+
+	return (PyObject *)it;
+}
+
+/*
+iterate reads with id from start_id to end_id or in the kth of shards
+that split file into byte ranges, stream is moved to the first read in
+range by index or checkpoints of gzip index before parsing
+*/
+PyObject *pyfastx_fastq_iter_range(pyfastx_Fastq *self, PyObject *args, PyObject *kwargs) {
+	Py_ssize_t start_id = 0;
+	Py_ssize_t end_id = 0;
+	Py_ssize_t shards = 0;
+	Py_ssize_t shard = 0;
+	Py_ssize_t offset;
+	pyfastx_RangeIter *it;
+	pyfastx_FastqMiddleware *middle = self->middle;
+
+	const char *header_sql = "SELECT soff-dlen-1 FROM read WHERE ID=?";
+
+	if (!pyfastx_range_parse_args(args, kwargs, &start_id, &end_id, &shards, &shard)) {
+		return NULL;
+	}
+
+	if (!self->has_index) {
+		return pyfastx_fastq_iter_shard(self, shards, shard);
+	}
+
+	if (shards) {
+		pyfastx_range_index_shard(self->index_db, header_sql, "SELECT qoff+rlen FROM read WHERE ID=?", self->read_counts, shards, shard, &start_id, &end_id);
+	}
+
+	if (!start_id) {
+		start_id = 1;
+	}
+
+	if (!end_id || end_id > self->read_counts) {
+		end_id = self->read_counts;
+	}
+
+	it = pyfastx_range_iter_create((PyObject *)self, pyfastx_fastq_range_next_with_index);
+
+	if (!it) {
+		return NULL;
+	}
+
+	if (start_id > end_id) {
+		return (PyObject *)it;
+	}
+
+	offset = pyfastx_range_offset(self->index_db, header_sql, start_id);
+
+	if (middle->gzip_format) {
+		pyfastx_stream_seek_index(middle->gzfd, middle->gzip_index, offset);
+	} else {
+		pyfastx_stream_seek(middle->gzfd, offset);
+		pyfastx_stream_readahead(middle->gzfd, 1);
+	}
+
+	kseq_rewind(middle->kseq);
+	middle->iter_id = start_id - 1;
+	middle->iter_offset = offset;
+	it->end_id = end_id;
+
+	return (PyObject *)it;
+}
+
 PyObject *pyfastx_fastq_next(pyfastx_Fastq *self) {
 	return self->func(self->middle);
 }
@@ -679,6 +864,7 @@ void pyfastx_fastq_calc_composition(pyfastx_Fastq *self) {
 
 	//base number
 	Py_ssize_t a = 0, c = 0, g = 0, t = 0, n = 0;
+	Py_ssize_t bases[256] = {0};
 	Py_ssize_t line_num = 0;
 	
 
@@ -709,7 +895,8 @@ void pyfastx_fastq_calc_composition(pyfastx_Fastq *self) {
 	PYFASTX_SQLITE_CALL(sqlite3_finalize(stmt));
 	stmt = NULL;
 
-	gzrewind(self->middle->gzfd);
+	pyfastx_stream_rewind(self->middle->gzfd);
+	pyfastx_stream_readahead(self->middle->gzfd, 1);
 	ks_rewind(self->ks);
 
 	while (ks_getuntil(self->ks, '\n', &line, 0) >= 0) {
@@ -718,16 +905,8 @@ void pyfastx_fastq_calc_composition(pyfastx_Fastq *self) {
 		j = line_num % 4;
 
 		if (j == 2) {
-			for (i = 0; i < line.l; i++) {
-				switch (line.s[i]) {
-					case 65: ++a; break;
-					case 67: ++c; break;
-					case 71: ++g; break;
-					case 84: ++t; break;
-					case 13: break;
-					default: ++n;
-				}
-			}
+			count_bytes(line.s, line.l, bases);
+			n += line.l;
 		} else if (j == 0) {
 			for (i = 0; i < line.l; i++) {
 				if (line.s[i] == 13) {
@@ -752,6 +931,15 @@ void pyfastx_fastq_calc_composition(pyfastx_Fastq *self) {
 		}
 	}
 
+	pyfastx_stream_readahead(self->middle->gzfd, 0);
+
+	//bases other than ACGT are counted as N, except for \r of line end
+	a = bases['A'];
+	c = bases['C'];
+	g = bases['G'];
+	t = bases['T'];
+	n -= a + c + g + t + bases['\r'];
+
 	sql = "INSERT INTO base VALUES (?,?,?,?,?);";
 	PYFASTX_SQLITE_CALL(
 		sqlite3_prepare_v2(self->index_db, sql, -1, &stmt, NULL);
@@ -1054,6 +1242,43 @@ PyObject *pyfastx_fastq_keys(pyfastx_Fastq *self, void* closure) {
 	return pyfastx_fastq_keys_create(self->index_db, self->read_counts);
 }
 
+PyObject *pyfastx_fastq_batches(pyfastx_Fastq *self, PyObject *args, PyObject *kwargs) {
+	Py_ssize_t size = 1000;
+	int threads = 1;
+	int ordered = 1;
+
+	static char* keywords[] = {"size", "threads", "ordered", NULL};
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|nii", keywords, &size, &threads, &ordered)) {
+		return NULL;
+	}
+
+	return pyfastx_batch_iter_create((PyObject *)self, self->file_obj, size, threads, ordered, 2, 0, 0, self->full_name, NULL);
+}
+
+PyObject *pyfastx_fastq_kmers(pyfastx_Fastq *self, PyObject *args, PyObject *kwargs) {
+	return pyfastx_kmer_iter_create((PyObject *)self, self->middle->kseq, NULL, args, kwargs);
+}
+
+PyObject *pyfastx_fastq_count_kmers(pyfastx_Fastq *self, PyObject *args, PyObject *kwargs) {
+	return pyfastx_kmer_count(self->middle->kseq, 2, NULL, args, kwargs);
+}
+
+PyObject *pyfastx_fastq_sketch(pyfastx_Fastq *self, PyObject *args, PyObject *kwargs) {
+	return pyfastx_sketch_create((PyObject *)self, self->middle->kseq, 2, NULL, args, kwargs);
+}
+
+PyObject *pyfastx_fastq_index_table(pyfastx_Fastq *self, PyObject *args) {
+	static const char *names[] = {"id", "name", "desc_length", "length", "seq_offset", "qual_offset"};
+	static const char *formats[] = {"l", "U", "l", "l", "l", "l"};
+
+	if (!self->has_index) {
+		PyErr_SetString(PyExc_RuntimeError, "index has not been built, call build_index() first");
+		return NULL;
+	}
+
+	return pyfastx_table_from_query(self->index_db, "SELECT * FROM read ORDER BY ID", names, formats, 6);
+}
+
 static PySequenceMethods pyfastx_fastq_as_sequence = {
 	.sq_contains = (objobjproc)pyfastx_fastq_contains,
 };
@@ -1066,6 +1291,12 @@ static PyMappingMethods pyfastx_fastq_as_mapping = {
 static PyMethodDef pyfastx_fastq_methods[] = {
 	{"build_index", (PyCFunction)pyfastx_fastq_build_index, METH_NOARGS, NULL},
 	{"keys", (PyCFunction)pyfastx_fastq_keys, METH_NOARGS, NULL},
+	{"batches", (PyCFunction)pyfastx_fastq_batches, METH_VARARGS|METH_KEYWORDS, NULL},
+	{"index_table", (PyCFunction)pyfastx_fastq_index_table, METH_NOARGS, NULL},
+	{"iter_range", (PyCFunction)pyfastx_fastq_iter_range, METH_VARARGS|METH_KEYWORDS, NULL},
+	{"kmers", (PyCFunction)pyfastx_fastq_kmers, METH_VARARGS|METH_KEYWORDS, NULL},
+	{"count_kmers", (PyCFunction)pyfastx_fastq_count_kmers, METH_VARARGS|METH_KEYWORDS, NULL},
+	{"sketch", (PyCFunction)pyfastx_fastq_sketch, METH_VARARGS|METH_KEYWORDS, NULL},
 	{NULL, NULL, 0, NULL}
 };
 
@@ -8,8 +8,6 @@
 #include "util.h"
 #include "sqlite3.h"
 
-#define CACHE_SIZE 1048576
-
 typedef struct {
 	PyObject_HEAD
 
@@ -19,32 +17,29 @@ typedef struct {
 	//is gzip file
 	int gzip_format;
 
+	//is zstd file
+	int zstd_format;
+
 	//file handle for zran index
 	FILE* fd;
 
-	//gzip file handle
-	gzFile gzfd;
+	//plain, gzip or zstd file stream
+	pyfastx_Stream *gzfd;
 
 	//gzip index
-	zran_index_t* gzip_index;
+	pyfastx_GzipIndex* gzip_index;
 
-	//iteration stmt
-	sqlite3_stmt *iter_stmt;
+	//zstd random access reader
+	pyfastx_ZstdReader* zstd_index;
 
 	//kseq for iteration
 	kseq_t *kseq;
 
-	//buffer cache
-	char* cache_buff;
-
-	//cache start offset
-	Py_ssize_t cache_soff;
-
-	//cache end offset
-	Py_ssize_t cache_eoff;
+	//id of the last read in indexed iteration
+	Py_ssize_t iter_id;
 
-	//iteration mode
-	int iterating;
+	//offset of the next line in indexed iteration
+	Py_ssize_t iter_offset;
 
 	PyObject *fastq;
 
@@ -2,13 +2,17 @@
 #include <Python.h>
 #include "fastx.h"
 #include "util.h"
+#include "batch.h"
+#include "kmer.h"
+#include "sketch.h"
 
 PyObject *pyfastx_fastx_fasta(kseq_t* kseqs) {
 	return Py_BuildValue("ss", kseqs->name.s, kseqs->seq.s);
 }
 
 PyObject *pyfastx_fastx_fasta_comment(kseq_t* kseqs) {
-	return Py_BuildValue("sss#", kseqs->name.s, kseqs->seq.s, kseqs->comment.s, kseqs->comment.l);
+	//header without comment gives None
+	return Py_BuildValue("sss#", kseqs->name.s, kseqs->seq.s, kseqs->comment.l ? kseqs->comment.s : NULL, kseqs->comment.l);
 }
 
 PyObject *pyfastx_fastx_fasta_upper(kseq_t* kseqs) {
@@ -26,7 +30,7 @@ PyObject *pyfastx_fastx_fastq(kseq_t* kseqs) {
 }
 
 PyObject *pyfastx_fastx_fastq_comment(kseq_t* kseqs) {
-	return Py_BuildValue("ssss#", kseqs->name.s, kseqs->seq.s, kseqs->qual.s, kseqs->comment.s, kseqs->comment.l);
+	return Py_BuildValue("ssss#", kseqs->name.s, kseqs->seq.s, kseqs->qual.s, kseqs->comment.l ? kseqs->comment.s : NULL, kseqs->comment.l);
 }
 
 PyObject *pyfastx_fastx_new(PyTypeObject *type, PyObject *args, PyObject *kwargs) {
@@ -35,12 +39,19 @@ PyObject *pyfastx_fastx_new(PyTypeObject *type, PyObject *args, PyObject *kwargs
 
 	char *format = "auto";
 
+	//record filters
+	Py_ssize_t min_len = 0;
+	Py_ssize_t max_len = 0;
+	double min_mean_qual = 0;
+	double max_n_frac = 1;
+	PyObject *names = Py_None;
+
 	PyObject *file_obj;
 
 	pyfastx_Fastx *obj;
 
-	static char* keywords[] = {"file_name", "format", "uppercase", "comment", NULL};
-	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|sii", keywords, &file_obj, &format, &uppercase, &comment)) {
+	static char* keywords[] = {"file_name", "format", "uppercase", "comment", "min_len", "max_len", "min_mean_qual", "max_n_frac", "names", NULL};
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|sii$nnddO", keywords, &file_obj, &format, &uppercase, &comment, &min_len, &max_len, &min_mean_qual, &max_n_frac, &names)) {
 		return NULL;
 	}
 
@@ -55,7 +66,7 @@ PyObject *pyfastx_fastx_new(PyTypeObject *type, PyObject *args, PyObject *kwargs
 	obj->file_obj = Py_NewRef(file_obj);
 
 	//open the sequence file
-	obj->gzfd = pyfastx_gzip_open(file_obj, "rb");
+	obj->gzfd = pyfastx_stream_open(file_obj);
 
 	//set file format
 	if (strcmp(format, "auto") == 0) {
@@ -76,8 +87,19 @@ PyObject *pyfastx_fastx_new(PyTypeObject *type, PyObject *args, PyObject *kwargs
 	obj->uppercase = uppercase;
 	obj->comment = comment;
 
+	//records are filtered on kseq buffers before building objects
+	if (min_len > 0 || max_len > 0 || min_mean_qual > 0 || max_n_frac < 1 || names != Py_None) {
+		obj->filter = pyfastx_filter_create(min_len, max_len, max_n_frac, min_mean_qual, names);
+
+		if (!obj->filter) {
+			Py_DECREF(obj);
+			return NULL;
+		}
+	}
+
 	//initial kseq
-	gzrewind(obj->gzfd);
+	pyfastx_stream_rewind(obj->gzfd);
+	pyfastx_stream_readahead(obj->gzfd, 1);
 	obj->kseqs = kseq_init(obj->gzfd);
 
 	if (obj->format == 1) {
@@ -106,26 +128,71 @@ PyObject *pyfastx_fastx_new(PyTypeObject *type, PyObject *args, PyObject *kwargs
 }
 
 void pyfastx_fastx_dealloc(pyfastx_Fastx *self) {
+	if (self->filter) {
+		pyfastx_filter_free(self->filter);
+	}
+
 	kseq_destroy(self->kseqs);
-	gzclose(self->gzfd);
+	pyfastx_stream_close(self->gzfd);
 	Py_DECREF(self->file_obj);
 	Py_TYPE(self)->tp_free((PyObject *)self);
 }
 
 PyObject *pyfastx_fastx_iter(pyfastx_Fastx *self) {
-	gzrewind(self->gzfd);
+	pyfastx_stream_rewind(self->gzfd);
+
+	if (self->filter) {
+		pyfastx_filter_reset(self->filter);
+	}
+
 	Py_INCREF(self);
 	return (PyObject *)self;
 }
 
 PyObject *pyfastx_fastx_next(pyfastx_Fastx *self) {
-	if (kseq_read(self->kseqs) >= 0) {
+	int reason;
+
+	while (kseq_read(self->kseqs) >= 0) {
+		if (self->filter) {
+			reason = pyfastx_filter_test(self->filter, self->kseqs->name.s, self->kseqs->name.l, self->kseqs->seq.s, self->kseqs->seq.l, self->kseqs->qual.s, self->kseqs->qual.l);
+			++self->filter->counts[reason];
+
+			if (reason) {
+				continue;
+			}
+		}
+
 		return self->func(self->kseqs);
 	}
 
 	return NULL;
 }
 
+PyObject *pyfastx_fastx_batches(pyfastx_Fastx *self, PyObject *args, PyObject *kwargs) {
+	Py_ssize_t size = 1000;
+	int threads = 1;
+	int ordered = 1;
+
+	static char* keywords[] = {"size", "threads", "ordered", NULL};
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|nii", keywords, &size, &threads, &ordered)) {
+		return NULL;
+	}
+
+	return pyfastx_batch_iter_create((PyObject *)self, self->file_obj, size, threads, ordered, self->format, self->uppercase && self->format == 1, self->comment, 0, self->filter);
+}
+
+PyObject *pyfastx_fastx_kmers(pyfastx_Fastx *self, PyObject *args, PyObject *kwargs) {
+	return pyfastx_kmer_iter_create((PyObject *)self, self->kseqs, self->filter, args, kwargs);
+}
+
+PyObject *pyfastx_fastx_count_kmers(pyfastx_Fastx *self, PyObject *args, PyObject *kwargs) {
+	return pyfastx_kmer_count(self->kseqs, self->format, self->filter, args, kwargs);
+}
+
+PyObject *pyfastx_fastx_sketch(pyfastx_Fastx *self, PyObject *args, PyObject *kwargs) {
+	return pyfastx_sketch_create((PyObject *)self, self->kseqs, self->format, self->filter, args, kwargs);
+}
+
 PyObject *pyfastx_fastx_repr(pyfastx_Fastx *self) {
 	if (self->format == 1) {
 		return PyUnicode_FromFormat("<Fastx> fasta %U", self->file_obj);
@@ -134,6 +201,27 @@ PyObject *pyfastx_fastx_repr(pyfastx_Fastx *self) {
 	}
 }
 
+PyObject *pyfastx_fastx_filter_counts(pyfastx_Fastx *self, void* closure) {
+	if (!self->filter) {
+		Py_RETURN_NONE;
+	}
+
+	return pyfastx_filter_counts(self->filter);
+}
+
+static PyGetSetDef pyfastx_fastx_getsets[] = {
+	{"filter_counts", (getter)pyfastx_fastx_filter_counts, NULL, NULL, NULL},
+	{NULL}
+};
+
+static PyMethodDef pyfastx_fastx_methods[] = {
+	{"batches", (PyCFunction)pyfastx_fastx_batches, METH_VARARGS|METH_KEYWORDS, NULL},
+	{"kmers", (PyCFunction)pyfastx_fastx_kmers, METH_VARARGS|METH_KEYWORDS, NULL},
+	{"count_kmers", (PyCFunction)pyfastx_fastx_count_kmers, METH_VARARGS|METH_KEYWORDS, NULL},
+	{"sketch", (PyCFunction)pyfastx_fastx_sketch, METH_VARARGS|METH_KEYWORDS, NULL},
+	{NULL, NULL, 0, NULL}
+};
+
 PyTypeObject pyfastx_FastxType = {
     PyVarObject_HEAD_INIT(NULL, 0)
     .tp_name = "Fastx",
@@ -143,5 +231,7 @@ PyTypeObject pyfastx_FastxType = {
     .tp_flags = Py_TPFLAGS_DEFAULT,
     .tp_iter = (getiterfunc)pyfastx_fastx_iter,
     .tp_iternext = (iternextfunc)pyfastx_fastx_next,
+    .tp_methods = pyfastx_fastx_methods,
+    .tp_getset = pyfastx_fastx_getsets,
     .tp_new = pyfastx_fastx_new,
 };
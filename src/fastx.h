@@ -3,6 +3,7 @@
 #include <Python.h>
 #include "zlib.h"
 #include "kseq.h"
+#include "filter.h"
 
 typedef struct {
 	PyObject_HEAD
@@ -19,14 +20,17 @@ typedef struct {
 	//output comment or not
 	int comment;
 
-	//gzip open file handle
-	gzFile gzfd;
+	//plain, gzip or zstd file stream
+	pyfastx_Stream *gzfd;
 
 	//kseqs for reading from fasta/q
 	kseq_t* kseqs;
 
 	PyObject* (*func) (kseq_t *);
 
+	//record filters, NULL if no filter was given
+	pyfastx_Filter *filter;
+
 } pyfastx_Fastx;
 
 extern PyTypeObject pyfastx_FastxType;
@@ -0,0 +1,200 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "filter.h"
+
+static const char *pyfastx_filter_reasons[PYFASTX_FILTER_REASONS] = {
+	"passed", "min_len", "max_len", "names", "max_n_frac", "min_mean_qual"
+};
+
+//FNV-1a hash of name
+uint64_t pyfastx_filter_hash(const char *s, Py_ssize_t l) {
+	uint64_t h = 14695981039346656037ULL;
+	Py_ssize_t i;
+
+	for (i = 0; i < l; ++i) {
+		h ^= (unsigned char)s[i];
+		h *= 1099511628211ULL;
+	}
+
+	return h;
+}
+
+//find the slot of name, return the empty slot if name is not in set
+Py_ssize_t pyfastx_filter_slot(pyfastx_Filter *filter, const char *s, Py_ssize_t l) {
+	Py_ssize_t mask = filter->name_slots - 1;
+	Py_ssize_t i = pyfastx_filter_hash(s, l) & mask;
+
+	while (filter->names[i]) {
+		if (filter->name_lens[i] == l && memcmp(filter->names[i], s, l) == 0) {
+			break;
+		}
+
+		i = (i + 1) & mask;
+	}
+
+	return i;
+}
+
+int pyfastx_filter_add_names(pyfastx_Filter *filter, PyObject *names) {
+	PyObject *seq;
+	Py_ssize_t num;
+	Py_ssize_t slot;
+	Py_ssize_t i;
+	Py_ssize_t l;
+	const char *s;
+
+	seq = PySequence_Fast(names, "names must be an iterable of str");
+
+	if (!seq) {
+		return 0;
+	}
+
+	num = PySequence_Fast_GET_SIZE(seq);
+
+	//keep load factor below 0.5
+	filter->name_slots = 16;
+	while (filter->name_slots < num * 2) {
+		filter->name_slots <<= 1;
+	}
+
+	filter->names = (char **)calloc(filter->name_slots, sizeof(char *));
+	filter->name_lens = (Py_ssize_t *)calloc(filter->name_slots, sizeof(Py_ssize_t));
+
+	if (!filter->names || !filter->name_lens) {
+		Py_DECREF(seq);
+		PyErr_NoMemory();
+		return 0;
+	}
+
+	for (i = 0; i < num; ++i) {
+		s = PyUnicode_AsUTF8AndSize(PySequence_Fast_GET_ITEM(seq, i), &l);
+
+		if (!s) {
+			break;
+		}
+
+		slot = pyfastx_filter_slot(filter, s, l);
+
+		if (!filter->names[slot]) {
+			filter->names[slot] = (char *)malloc(l + 1);
+			memcpy(filter->names[slot], s, l + 1);
+			filter->name_lens[slot] = l;
+		}
+	}
+
+	Py_DECREF(seq);
+
+	return !PyErr_Occurred();
+}
+
+pyfastx_Filter *pyfastx_filter_create(Py_ssize_t min_len, Py_ssize_t max_len, double max_n_frac, double min_mean_qual, PyObject *names) {
+	pyfastx_Filter *filter = (pyfastx_Filter *)calloc(1, sizeof(pyfastx_Filter));
+
+	if (!filter) {
+		PyErr_NoMemory();
+		return NULL;
+	}
+
+	filter->min_len = min_len;
+	filter->max_len = max_len;
+	filter->max_n_frac = max_n_frac;
+	filter->min_mean_qual = min_mean_qual;
+
+	if (names && names != Py_None && !pyfastx_filter_add_names(filter, names)) {
+		pyfastx_filter_free(filter);
+		return NULL;
+	}
+
+	return filter;
+}
+
+void pyfastx_filter_free(pyfastx_Filter *filter) {
+	Py_ssize_t i;
+
+	if (filter->names) {
+		for (i = 0; i < filter->name_slots; ++i) {
+			free(filter->names[i]);
+		}
+	}
+
+	free(filter->names);
+	free(filter->name_lens);
+	free(filter);
+}
+
+void pyfastx_filter_reset(pyfastx_Filter *filter) {
+	memset(filter->counts, 0, sizeof(filter->counts));
+}
+
+/*
+test whether the record is kept, return the reason if filtered,
+cheap length checks are performed first, called without GIL and
+counts are not updated here
+*/
+int pyfastx_filter_test(pyfastx_Filter *filter, char *name, Py_ssize_t name_len, char *seq, Py_ssize_t seq_len, char *qual, Py_ssize_t qual_len) {
+	Py_ssize_t i;
+	Py_ssize_t c;
+
+	if (seq_len < filter->min_len) {
+		return PYFASTX_FILTER_MIN_LEN;
+	}
+
+	if (filter->max_len > 0 && seq_len > filter->max_len) {
+		return PYFASTX_FILTER_MAX_LEN;
+	}
+
+	if (filter->names && !filter->names[pyfastx_filter_slot(filter, name, name_len)]) {
+		return PYFASTX_FILTER_NAMES;
+	}
+
+	if (filter->max_n_frac < 1 && seq_len > 0) {
+		c = 0;
+		for (i = 0; i < seq_len; ++i) {
+			c += (seq[i] | 0x20) == 'n';
+		}
+
+		if (c > filter->max_n_frac * seq_len) {
+			return PYFASTX_FILTER_N_FRAC;
+		}
+	}
+
+	if (filter->min_mean_qual > 0 && qual_len > 0) {
+		c = 0;
+		for (i = 0; i < qual_len; ++i) {
+			c += (unsigned char)qual[i];
+		}
+
+		if (c - 33 * qual_len < filter->min_mean_qual * qual_len) {
+			return PYFASTX_FILTER_MEAN_QUAL;
+		}
+	}
+
+	return PYFASTX_FILTER_PASSED;
+}
+
+//counts of passed and filtered records as a dict
+PyObject *pyfastx_filter_counts(pyfastx_Filter *filter) {
+	PyObject *ret;
+	PyObject *val;
+	int i;
+
+	ret = PyDict_New();
+
+	if (!ret) {
+		return NULL;
+	}
+
+	for (i = 0; i < PYFASTX_FILTER_REASONS; ++i) {
+		val = PyLong_FromSsize_t(filter->counts[i]);
+
+		if (!val || PyDict_SetItemString(ret, pyfastx_filter_reasons[i], val) < 0) {
+			Py_XDECREF(val);
+			Py_DECREF(ret);
+			return NULL;
+		}
+
+		Py_DECREF(val);
+	}
+
+	return ret;
+}
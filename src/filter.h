@@ -0,0 +1,43 @@
+#ifndef PYFASTX_FILTER_H
+#define PYFASTX_FILTER_H
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+//reasons of filtered records, 0 means the record is passed
+#define PYFASTX_FILTER_PASSED 0
+#define PYFASTX_FILTER_MIN_LEN 1
+#define PYFASTX_FILTER_MAX_LEN 2
+#define PYFASTX_FILTER_NAMES 3
+#define PYFASTX_FILTER_N_FRAC 4
+#define PYFASTX_FILTER_MEAN_QUAL 5
+#define PYFASTX_FILTER_REASONS 6
+
+//record filters evaluated on raw buffers before building python objects
+typedef struct {
+	//sequence length range, 0 means no limit
+	Py_ssize_t min_len;
+	Py_ssize_t max_len;
+
+	//max fraction of N bases, disabled if >= 1
+	double max_n_frac;
+
+	//min mean phred+33 quality, disabled if <= 0
+	double min_mean_qual;
+
+	//open addressing hash set of allowed names, NULL if not provided
+	char **names;
+	Py_ssize_t *name_lens;
+	Py_ssize_t name_slots;
+
+	//number of passed records and filtered records of each reason
+	Py_ssize_t counts[PYFASTX_FILTER_REASONS];
+
+} pyfastx_Filter;
+
+pyfastx_Filter *pyfastx_filter_create(Py_ssize_t min_len, Py_ssize_t max_len, double max_n_frac, double min_mean_qual, PyObject *names);
+void pyfastx_filter_free(pyfastx_Filter *filter);
+void pyfastx_filter_reset(pyfastx_Filter *filter);
+int pyfastx_filter_test(pyfastx_Filter *filter, char *name, Py_ssize_t name_len, char *seq, Py_ssize_t seq_len, char *qual, Py_ssize_t qual_len);
+PyObject *pyfastx_filter_counts(pyfastx_Filter *filter);
+
+#endif
@@ -0,0 +1,499 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "fqpair.h"
+#include "util.h"
+
+//status of reading a pair
+#define PYFASTX_PAIR_OK 0
+#define PYFASTX_PAIR_END 1
+#define PYFASTX_PAIR_UNEQUAL 2
+#define PYFASTX_PAIR_MISMATCH 3
+#define PYFASTX_PAIR_NOMEM 4
+
+pyfastx_Stream *pyfastx_fastq_pair_open(PyObject *file_obj) {
+	pyfastx_Stream *stream;
+
+	if (!file_exists(file_obj)) {
+		PyErr_Format(PyExc_FileExistsError, "the input file %U does not exists", file_obj);
+		return NULL;
+	}
+
+	stream = pyfastx_stream_open(file_obj);
+
+	if (!stream) {
+		if (!PyErr_Occurred()) {
+			PyErr_Format(PyExc_RuntimeError, "can not open %U", file_obj);
+		}
+
+		return NULL;
+	}
+
+	if (fasta_or_fastq(stream) != 2) {
+		pyfastx_stream_close(stream);
+		PyErr_Format(PyExc_RuntimeError, "%U is not plain or gzip compressed fastq file", file_obj);
+		return NULL;
+	}
+
+	return stream;
+}
+
+//open readers of read1 and read2 file, file2 is Py_None for interleaved file
+pyfastx_FastqPair *pyfastx_fastq_pair_create(PyTypeObject *type, PyObject *file1, PyObject *file2, int check_name, int comment) {
+	pyfastx_FastqPair *obj;
+
+	obj = (pyfastx_FastqPair *)type->tp_alloc(type, 0);
+	if (!obj) return NULL;
+
+	obj->file1 = Py_NewRef(file1);
+	obj->check = check_name;
+	obj->comment = comment;
+
+	obj->stream1 = pyfastx_fastq_pair_open(file1);
+
+	if (!obj->stream1) {
+		Py_DECREF(obj);
+		return NULL;
+	}
+
+	obj->kseq1 = kseq_init(obj->stream1);
+
+	//read1 and read2 are adjacent records in interleaved file
+	if (file2 == Py_None) {
+		obj->kseq2 = obj->kseq1;
+	} else {
+		obj->file2 = Py_NewRef(file2);
+		obj->stream2 = pyfastx_fastq_pair_open(file2);
+
+		if (!obj->stream2) {
+			Py_DECREF(obj);
+			return NULL;
+		}
+
+		obj->kseq2 = kseq_init(obj->stream2);
+	}
+
+	return obj;
+}
+
+PyObject *pyfastx_fastq_pair_new(PyTypeObject *type, PyObject *args, PyObject *kwargs) {
+	int check_name = 1;
+	int comment = 0;
+
+	PyObject *file1;
+	PyObject *file2 = Py_None;
+
+	static char* keywords[] = {"read1", "read2", "check_name", "comment", NULL};
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|Opp", keywords, &file1, &file2, &check_name, &comment)) {
+		return NULL;
+	}
+
+	return (PyObject *)pyfastx_fastq_pair_create(type, file1, file2, check_name, comment);
+}
+
+void pyfastx_fastq_pair_dealloc(pyfastx_FastqPair *self) {
+	if (self->kseq2 && self->kseq2 != self->kseq1) {
+		kseq_destroy(self->kseq2);
+	}
+
+	if (self->kseq1) {
+		kseq_destroy(self->kseq1);
+	}
+
+	if (self->stream2) {
+		pyfastx_stream_close(self->stream2);
+	}
+
+	if (self->stream1) {
+		pyfastx_stream_close(self->stream1);
+	}
+
+	free(self->first.name.s);
+	free(self->first.comment.s);
+	free(self->first.seq.s);
+	free(self->first.qual.s);
+
+	Py_XDECREF(self->file1);
+	Py_XDECREF(self->file2);
+	Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+//start a full pass, each file is decompressed in its own read ahead thread
+void pyfastx_fastq_pair_rewind(pyfastx_FastqPair *self) {
+	pyfastx_stream_rewind(self->stream1);
+	pyfastx_stream_readahead(self->stream1, 1);
+	kseq_rewind(self->kseq1);
+
+	if (self->stream2) {
+		pyfastx_stream_rewind(self->stream2);
+		pyfastx_stream_readahead(self->stream2, 1);
+		kseq_rewind(self->kseq2);
+	}
+
+	self->pairs = 0;
+}
+
+//mate number in illumina comment like 1:N:0:ATCACG, 0 if not available
+int pyfastx_fastq_pair_mate_number(kstring_t *comment) {
+	if (comment->l > 2 && comment->s[1] == ':' && (comment->s[0] == '1' || comment->s[0] == '2')) {
+		return comment->s[0] - '0';
+	}
+
+	return 0;
+}
+
+/*
+names of mates should be identical after removing the trailing /1 and /2,
+the mate numbers in illumina comments should be 1 and 2 if available
+*/
+int pyfastx_fastq_pair_match(kseq_t *r1, kseq_t *r2) {
+	Py_ssize_t l1 = r1->name.l;
+	Py_ssize_t l2 = r2->name.l;
+	int m1, m2;
+
+	if (l1 > 1 && r1->name.s[l1-2] == '/' && r1->name.s[l1-1] == '1') {
+		l1 -= 2;
+	}
+
+	if (l2 > 1 && r2->name.s[l2-2] == '/' && r2->name.s[l2-1] == '2') {
+		l2 -= 2;
+	}
+
+	if (l1 != l2 || memcmp(r1->name.s, r2->name.s, l1) != 0) {
+		return 0;
+	}
+
+	m1 = pyfastx_fastq_pair_mate_number(&r1->comment);
+	m2 = pyfastx_fastq_pair_mate_number(&r2->comment);
+
+	if (m1 && m2 && (m1 != 1 || m2 != 2)) {
+		return 0;
+	}
+
+	return 1;
+}
+
+//read1 of current pair
+kseq_t *pyfastx_fastq_pair_read1(pyfastx_FastqPair *self) {
+	return self->file2 ? self->kseq1 : &self->first;
+}
+
+//read next pair in lockstep, called without GIL
+int pyfastx_fastq_pair_read(pyfastx_FastqPair *self) {
+	kstring_t tmp;
+
+	if (kseq_read(self->kseq1) < 0) {
+		if (self->file2 && kseq_read(self->kseq2) >= 0) {
+			return PYFASTX_PAIR_UNEQUAL;
+		}
+
+		return PYFASTX_PAIR_END;
+	}
+
+	//swap read1 buffers out of reader before reading read2 from interleaved file
+	if (!self->file2) {
+		#define PYFASTX_PAIR_SWAP(a, b) (tmp = (a), (a) = (b), (b) = tmp)
+		PYFASTX_PAIR_SWAP(self->first.name, self->kseq1->name);
+		PYFASTX_PAIR_SWAP(self->first.comment, self->kseq1->comment);
+		PYFASTX_PAIR_SWAP(self->first.seq, self->kseq1->seq);
+		PYFASTX_PAIR_SWAP(self->first.qual, self->kseq1->qual);
+		#undef PYFASTX_PAIR_SWAP
+	}
+
+	if (kseq_read(self->kseq2) < 0) {
+		return PYFASTX_PAIR_UNEQUAL;
+	}
+
+	if (self->check && !pyfastx_fastq_pair_match(pyfastx_fastq_pair_read1(self), self->kseq2)) {
+		return PYFASTX_PAIR_MISMATCH;
+	}
+
+	return PYFASTX_PAIR_OK;
+}
+
+void pyfastx_fastq_pair_raise(pyfastx_FastqPair *self, int status) {
+	if (status == PYFASTX_PAIR_UNEQUAL) {
+		PyErr_Format(PyExc_ValueError, "read1 and read2 have unequal number of reads after %zd pairs", self->pairs);
+	} else if (status == PYFASTX_PAIR_MISMATCH) {
+		PyErr_Format(PyExc_ValueError, "mate names of pair %zd do not match: %s and %s", self->pairs + 1, pyfastx_fastq_pair_read1(self)->name.s, self->kseq2->name.s);
+	} else if (status == PYFASTX_PAIR_NOMEM) {
+		PyErr_NoMemory();
+	}
+}
+
+PyObject *pyfastx_fastq_pair_repr(pyfastx_FastqPair *self) {
+	if (self->file2) {
+		return PyUnicode_FromFormat("<FastqPair> %U and %U", self->file1, self->file2);
+	}
+
+	return PyUnicode_FromFormat("<FastqPair> interleaved %U", self->file1);
+}
+
+PyObject *pyfastx_fastq_pair_iter(pyfastx_FastqPair *self) {
+	pyfastx_fastq_pair_rewind(self);
+	return Py_NewRef(self);
+}
+
+PyObject *pyfastx_fastq_pair_mate(pyfastx_FastqPair *self, kseq_t *kseq) {
+	if (self->comment) {
+		return Py_BuildValue("(s#s#s#s#)", kseq->name.s, kseq->name.l, kseq->seq.s, kseq->seq.l, kseq->qual.s, kseq->qual.l, kseq->comment.l ? kseq->comment.s : NULL, kseq->comment.l);
+	}
+
+	return Py_BuildValue("(s#s#s#)", kseq->name.s, kseq->name.l, kseq->seq.s, kseq->seq.l, kseq->qual.s, kseq->qual.l);
+}
+
+PyObject *pyfastx_fastq_pair_next(pyfastx_FastqPair *self) {
+	PyObject *read1;
+	PyObject *read2;
+	int status;
+
+	status = pyfastx_fastq_pair_read(self);
+
+	if (status != PYFASTX_PAIR_OK) {
+		pyfastx_fastq_pair_raise(self, status);
+		return NULL;
+	}
+
+	read1 = pyfastx_fastq_pair_mate(self, pyfastx_fastq_pair_read1(self));
+
+	if (!read1) {
+		return NULL;
+	}
+
+	read2 = pyfastx_fastq_pair_mate(self, self->kseq2);
+
+	if (!read2) {
+		Py_DECREF(read1);
+		return NULL;
+	}
+
+	++self->pairs;
+	return Py_BuildValue("(NN)", read1, read2);
+}
+
+PyObject *pyfastx_fastq_pair_batches(pyfastx_FastqPair *self, PyObject *args, PyObject *kwargs) {
+	Py_ssize_t size = 1000;
+	pyfastx_FastqPairBatchIter *iter;
+
+	static char* keywords[] = {"size", NULL};
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|n", keywords, &size)) {
+		return NULL;
+	}
+
+	if (size <= 0) {
+		PyErr_SetString(PyExc_ValueError, "batch size must be greater than 0");
+		return NULL;
+	}
+
+	iter = PyObject_New(pyfastx_FastqPairBatchIter, &pyfastx_FastqPairBatchIterType);
+
+	if (!iter) {
+		return NULL;
+	}
+
+	iter->size = size;
+	iter->pair = pyfastx_fastq_pair_create(Py_TYPE(self), self->file1, self->file2 ? self->file2 : Py_None, self->check, self->comment);
+
+	if (!iter->pair) {
+		PyObject_Del(iter);
+		return NULL;
+	}
+
+	pyfastx_fastq_pair_rewind(iter->pair);
+
+	//all columns are initialized before checking, so that they can be freed
+	if (!(pyfastx_batch_column_init(&iter->name1, size) & pyfastx_batch_column_init(&iter->seq1, size) & pyfastx_batch_column_init(&iter->qual1, size) & pyfastx_batch_column_init(&iter->desc1, size)
+		& pyfastx_batch_column_init(&iter->name2, size) & pyfastx_batch_column_init(&iter->seq2, size) & pyfastx_batch_column_init(&iter->qual2, size) & pyfastx_batch_column_init(&iter->desc2, size))
+		|| !pyfastx_batch_column_nullable(&iter->desc1, size) || !pyfastx_batch_column_nullable(&iter->desc2, size)) {
+		Py_DECREF(iter);
+		return PyErr_NoMemory();
+	}
+
+	return (PyObject *)iter;
+}
+
+//write a read in fastq format
+int pyfastx_fastq_pair_write_read(gzFile fh, kseq_t *kseq) {
+	gzputc(fh, '@');
+	gzwrite(fh, kseq->name.s, kseq->name.l);
+
+	if (kseq->comment.l) {
+		gzputc(fh, ' ');
+		gzwrite(fh, kseq->comment.s, kseq->comment.l);
+	}
+
+	gzputc(fh, '\n');
+	gzwrite(fh, kseq->seq.s, kseq->seq.l);
+	gzputs(fh, "\n+\n");
+	gzwrite(fh, kseq->qual.s, kseq->qual.l);
+
+	return gzputc(fh, '\n');
+}
+
+PyObject *pyfastx_fastq_pair_write_interleaved(pyfastx_FastqPair *self, PyObject *args, PyObject *kwargs) {
+	PyObject *file_obj;
+	PyObject *suffix;
+	gzFile fh;
+	int status;
+	int ret = 0;
+	int gzip;
+
+	static char* keywords[] = {"file_name", NULL};
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", keywords, &file_obj)) {
+		return NULL;
+	}
+
+	if (!PyUnicode_Check(file_obj)) {
+		PyErr_SetString(PyExc_TypeError, "file_name must be a str");
+		return NULL;
+	}
+
+	//write gzip compressed file when the file name ends with .gz
+	suffix = PyUnicode_FromString(".gz");
+	gzip = PyUnicode_Tailmatch(file_obj, suffix, 0, PY_SSIZE_T_MAX, 1) == 1;
+	Py_DECREF(suffix);
+
+	fh = pyfastx_gzip_open(file_obj, gzip ? "wb" : "wT");
+
+	if (!fh) {
+		PyErr_Format(PyExc_RuntimeError, "can not open %U for writing", file_obj);
+		return NULL;
+	}
+
+	pyfastx_fastq_pair_rewind(self);
+
+	Py_BEGIN_ALLOW_THREADS
+	while ((status = pyfastx_fastq_pair_read(self)) == PYFASTX_PAIR_OK) {
+		pyfastx_fastq_pair_write_read(fh, pyfastx_fastq_pair_read1(self));
+		ret = pyfastx_fastq_pair_write_read(fh, self->kseq2);
+
+		if (ret < 0) {
+			break;
+		}
+
+		++self->pairs;
+	}
+
+	if (gzclose(fh) != Z_OK) {
+		ret = -1;
+	}
+	Py_END_ALLOW_THREADS
+
+	if (ret < 0) {
+		PyErr_Format(PyExc_RuntimeError, "failed to write pairs to %U", file_obj);
+		return NULL;
+	}
+
+	if (status != PYFASTX_PAIR_END) {
+		pyfastx_fastq_pair_raise(self, status);
+		return NULL;
+	}
+
+	return Py_BuildValue("n", self->pairs);
+}
+
+static PyMethodDef pyfastx_fastq_pair_methods[] = {
+	{"batches", (PyCFunction)pyfastx_fastq_pair_batches, METH_VARARGS|METH_KEYWORDS, NULL},
+	{"write_interleaved", (PyCFunction)pyfastx_fastq_pair_write_interleaved, METH_VARARGS|METH_KEYWORDS, NULL},
+	{NULL, NULL, 0, NULL}
+};
+
+PyTypeObject pyfastx_FastqPairType = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "FastqPair",
+	.tp_basicsize = sizeof(pyfastx_FastqPair),
+	.tp_dealloc = (destructor)pyfastx_fastq_pair_dealloc,
+	.tp_repr = (reprfunc)pyfastx_fastq_pair_repr,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_iter = (getiterfunc)pyfastx_fastq_pair_iter,
+	.tp_iternext = (iternextfunc)pyfastx_fastq_pair_next,
+	.tp_methods = pyfastx_fastq_pair_methods,
+	.tp_new = pyfastx_fastq_pair_new,
+};
+
+void pyfastx_fastq_pair_batch_iter_dealloc(pyfastx_FastqPairBatchIter *self) {
+	pyfastx_batch_column_free(&self->name1);
+	pyfastx_batch_column_free(&self->seq1);
+	pyfastx_batch_column_free(&self->qual1);
+	pyfastx_batch_column_free(&self->desc1);
+	pyfastx_batch_column_free(&self->name2);
+	pyfastx_batch_column_free(&self->seq2);
+	pyfastx_batch_column_free(&self->qual2);
+	pyfastx_batch_column_free(&self->desc2);
+	Py_DECREF(self->pair);
+	PyObject_Del(self);
+}
+
+PyObject *pyfastx_fastq_pair_batch_iter_iter(pyfastx_FastqPairBatchIter *self) {
+	return Py_NewRef(self);
+}
+
+//read at most size pairs into column buffers, called without GIL
+int pyfastx_fastq_pair_batch_iter_parse(pyfastx_FastqPairBatchIter *self, Py_ssize_t *n) {
+	pyfastx_FastqPair *pair = self->pair;
+	int status = PYFASTX_PAIR_OK;
+
+	self->name1.data.l = self->seq1.data.l = self->qual1.data.l = self->desc1.data.l = 0;
+	self->name2.data.l = self->seq2.data.l = self->qual2.data.l = self->desc2.data.l = 0;
+
+	while (*n < self->size && (status = pyfastx_fastq_pair_read(pair)) == PYFASTX_PAIR_OK) {
+		if (!pyfastx_batch_append_kseq(pyfastx_fastq_pair_read1(pair), &self->name1, &self->seq1, &self->qual1, &self->desc1, *n + 1, 2, 0, pair->comment, 0)
+			|| !pyfastx_batch_append_kseq(pair->kseq2, &self->name2, &self->seq2, &self->qual2, &self->desc2, *n + 1, 2, 0, pair->comment, 0)) {
+			return PYFASTX_PAIR_NOMEM;
+		}
+
+		++*n;
+		++pair->pairs;
+	}
+
+	return status;
+}
+
+PyObject *pyfastx_fastq_pair_batch_iter_next(pyfastx_FastqPairBatchIter *self) {
+	PyObject *batch1;
+	PyObject *batch2;
+	Py_ssize_t n = 0;
+	int status;
+
+	Py_BEGIN_ALLOW_THREADS
+	status = pyfastx_fastq_pair_batch_iter_parse(self, &n);
+	Py_END_ALLOW_THREADS
+
+	if (status != PYFASTX_PAIR_OK && status != PYFASTX_PAIR_END) {
+		pyfastx_fastq_pair_raise(self->pair, status);
+		return NULL;
+	}
+
+	if (!n) {
+		return NULL;
+	}
+
+	batch1 = pyfastx_batch_create(&self->name1, &self->seq1, &self->qual1, &self->desc1, n, 2, self->pair->comment);
+
+	if (!batch1) {
+		return NULL;
+	}
+
+	batch2 = pyfastx_batch_create(&self->name2, &self->seq2, &self->qual2, &self->desc2, n, 2, self->pair->comment);
+
+	if (!batch2) {
+		Py_DECREF(batch1);
+		return NULL;
+	}
+
+	return Py_BuildValue("(NN)", batch1, batch2);
+}
+
+PyObject *pyfastx_fastq_pair_batch_iter_repr(pyfastx_FastqPairBatchIter *self) {
+	return PyUnicode_FromFormat("<FastqPairBatchIterator> batch size %zd", self->size);
+}
+
+PyTypeObject pyfastx_FastqPairBatchIterType = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "FastqPairBatchIterator",
+	.tp_basicsize = sizeof(pyfastx_FastqPairBatchIter),
+	.tp_dealloc = (destructor)pyfastx_fastq_pair_batch_iter_dealloc,
+	.tp_repr = (reprfunc)pyfastx_fastq_pair_batch_iter_repr,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_iter = (getiterfunc)pyfastx_fastq_pair_batch_iter_iter,
+	.tp_iternext = (iternextfunc)pyfastx_fastq_pair_batch_iter_next,
+};
@@ -0,0 +1,61 @@
+#ifndef PYFASTX_FASTQ_PAIR_H
+#define PYFASTX_FASTQ_PAIR_H
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "kseq.h"
+#include "batch.h"
+
+typedef struct {
+	PyObject_HEAD
+
+	//read1 and read2 fastq file, file2 is NULL for interleaved file
+	PyObject *file1;
+	PyObject *file2;
+
+	//plain, gzip or zstd file streams
+	pyfastx_Stream *stream1;
+	pyfastx_Stream *stream2;
+
+	//readers of mates, the same reader for interleaved file
+	kseq_t *kseq1;
+	kseq_t *kseq2;
+
+	//check whether the names of mates are matched
+	int check;
+
+	//output comment
+	int comment;
+
+	//read1 kept before reading read2 from interleaved file
+	kseq_t first;
+
+	//number of pairs have been read
+	Py_ssize_t pairs;
+
+} pyfastx_FastqPair;
+
+typedef struct {
+	PyObject_HEAD
+
+	//own readers of the same files, independent of iterating the FastqPair
+	pyfastx_FastqPair *pair;
+
+	//max number of pairs in each batch
+	Py_ssize_t size;
+
+	//reused buffers for parsing read1 and read2
+	pyfastx_BatchColumn name1;
+	pyfastx_BatchColumn seq1;
+	pyfastx_BatchColumn qual1;
+	pyfastx_BatchColumn desc1;
+	pyfastx_BatchColumn name2;
+	pyfastx_BatchColumn seq2;
+	pyfastx_BatchColumn qual2;
+	pyfastx_BatchColumn desc2;
+
+} pyfastx_FastqPairBatchIter;
+
+extern PyTypeObject pyfastx_FastqPairType;
+extern PyTypeObject pyfastx_FastqPairBatchIterType;
+
+#endif
@@ -33,12 +33,14 @@ pyfastx_Index* pyfastx_init_index(PyObject *obj, PyObject* file_obj, PyObject* i
 
 	//full index
 	index->full_index = 0;
+	index->mask_index = 0;
 
 	//check input file is gzip or not
 	index->gzip_format = is_gzip_format(file_obj);
+	index->zstd_format = is_zstd_format(file_obj);
 
 	//initial kseqs
-	index->gzfd = pyfastx_gzip_open(file_obj, "rb");
+	index->gzfd = pyfastx_stream_open(file_obj);
 	index->kseqs = kseq_init(index->gzfd);
 
 	//create index file or memory index
@@ -65,9 +67,12 @@ pyfastx_Index* pyfastx_init_index(PyObject *obj, PyObject* file_obj, PyObject* i
 	index->index_db = 0;
 
 	if(index->gzip_format){
-		index->gzip_index = (zran_index_t *)malloc(sizeof(zran_index_t));
-		//initial zran index
-		zran_init(index->gzip_index, index->fd, NULL, 1048576, 32768, 16384, ZRAN_AUTO_BUILD);
+		index->gzip_index = pyfastx_gzip_index_init(index->fd);
+	}
+
+	//seek table of zstd seekable file is stored in itself
+	if (index->zstd_format) {
+		index->zstd_index = pyfastx_zstd_open(index->fd, 0);
 	}
 
 	//cache name
@@ -95,6 +100,11 @@ pyfastx_Index* pyfastx_init_index(PyObject *obj, PyObject* file_obj, PyObject* i
 	kstring_init(index->cache_name);
 	kstring_init(index->cache_seq);
 
+	//line runs
+	index->runs_chrom = 0;
+	index->runs_num = 0;
+	index->runs = NULL;
+
 	//parent fasta
 	index->fasta = obj;
 
@@ -103,7 +113,38 @@ pyfastx_Index* pyfastx_init_index(PyObject *obj, PyObject* file_obj, PyObject* i
 
 void pyfastx_rewind_index(pyfastx_Index *self){
 	kseq_rewind(self->kseqs);
-	gzrewind(self->gzfd);
+	pyfastx_stream_rewind(self->gzfd);
+}
+
+//append run of lines with the same number of bases and start a new run
+static void pyfastx_index_add_run(kstring_t *runs, int64_t *run) {
+	if (run[1]) {
+		if (runs->l + 2 * sizeof(int64_t) > runs->m) {
+			runs->m = runs->l + 2 * sizeof(int64_t);
+			kroundup32(runs->m);
+			runs->s = (char *)realloc(runs->s, runs->m);
+		}
+
+		memcpy(runs->s + runs->l, run, 2 * sizeof(int64_t));
+		runs->l += 2 * sizeof(int64_t);
+	}
+
+	run[0] = 0;
+	run[1] = 0;
+}
+
+//save line runs of irregular sequence just inserted into seq table
+static void pyfastx_index_write_runs(sqlite3 *db, sqlite3_stmt *stmt, kstring_t *runs, int64_t *run, int normal) {
+	pyfastx_index_add_run(runs, run);
+
+	if (!normal) {
+		sqlite3_bind_int64(stmt, 1, sqlite3_last_insert_rowid(db));
+		sqlite3_bind_blob(stmt, 2, runs->s, runs->l, NULL);
+		sqlite3_step(stmt);
+		sqlite3_reset(stmt);
+	}
+
+	runs->l = 0;
 }
 
 void pyfastx_create_index(pyfastx_Index *self){
@@ -112,6 +153,7 @@ void pyfastx_create_index(pyfastx_Index *self){
 	
 	// sqlite3 prepare object
 	sqlite3_stmt *stmt;
+	sqlite3_stmt *line_stmt = NULL;
 	
 	// 1: normal fasta sequence with the same length in line
 	// 0: not normal fasta sequence with different length in line
@@ -141,6 +183,10 @@ void pyfastx_create_index(pyfastx_Index *self){
 	//real line len
 	Py_ssize_t real_len;
 
+	//runs of lines with the same bases, current run is bases and lines
+	kstring_t runs = {0, 0, 0};
+	int64_t run[2] = {0, 0};
+
 	//total sequence count
 	Py_ssize_t total_seq = 0;
 
@@ -196,10 +242,21 @@ void pyfastx_create_index(pyfastx_Index *self){
 			l50 INTEGER --L50 seq count \n \
 		); \
 		CREATE TABLE comp ( \
-			ID INTEGER PRIMARY KEY, --comp identifier\n \
-			seqid INTEGER, --seq id\n \
-			abc INTEGER, --seq letter\n \
-			num INTEGER -- letter count\n \
+			ID INTEGER PRIMARY KEY, --seq id, 0 for all sequences\n \
+			counts BLOB --packed letter counts\n \
+		); \
+		CREATE TABLE line ( \
+			ID INTEGER PRIMARY KEY, --seq id\n \
+			runs BLOB --bases and count of lines in each run of lines with the same length\n \
+		); \
+		CREATE TABLE mask ( \
+			ID INTEGER PRIMARY KEY, --seq id\n \
+			soft BLOB, --soft-masked runs of lowercase letters\n \
+			gap BLOB --gap runs of N\n \
+		); \
+		CREATE TABLE block ( \
+			ID INTEGER PRIMARY KEY, --seq id\n \
+			counts BLOB --cumulative letter counts at block boundaries\n \
 		); \
 		CREATE TABLE gzindex ( \
 			ID INTEGER PRIMARY KEY, \
@@ -222,8 +279,12 @@ void pyfastx_create_index(pyfastx_Index *self){
 
 	sql = "INSERT INTO seq VALUES (?,?,?,?,?,?,?,?,?);";
 	PYFASTX_SQLITE_CALL(sqlite3_prepare_v2(self->index_db, sql, -1, &stmt, NULL));
+
+	sql = "INSERT INTO line VALUES (?,?);";
+	PYFASTX_SQLITE_CALL(sqlite3_prepare_v2(self->index_db, sql, -1, &line_stmt, NULL));
 	
-	gzrewind(self->gzfd);
+	pyfastx_stream_rewind(self->gzfd);
+	pyfastx_stream_readahead(self->gzfd, 1);
 	ks = ks_init(self->gzfd);
 
 	//Py_BEGIN_ALLOW_THREADS
@@ -233,8 +294,9 @@ void pyfastx_create_index(pyfastx_Index *self){
 		//first char is >
 		if (line.s[0] == 62) {
 			if (start > 0) {
-				//end of sequence and check whether normal fasta
-				seq_normal = (bad_line > 1) ? 0 : 1;
+				//end of sequence and check whether normal fasta, only the
+				//last line can be shorter than the others
+				seq_normal = (bad_line > 1 || temp_len > line_len) ? 0 : 1;
 				
 				PYFASTX_SQLITE_CALL(
 					sqlite3_bind_null(stmt, 1);
@@ -248,6 +310,7 @@ void pyfastx_create_index(pyfastx_Index *self){
 					sqlite3_bind_int(stmt, 9, desc_len);
 					sqlite3_step(stmt);
 					sqlite3_reset(stmt);
+					pyfastx_index_write_runs(self->index_db, line_stmt, &runs, run, seq_normal);
 				);
 
 				++total_seq;
@@ -336,10 +399,17 @@ void pyfastx_create_index(pyfastx_Index *self){
 
 		//calculate seq len
 		seq_len += real_len;
+
+		if (run[0] != real_len) {
+			pyfastx_index_add_run(&runs, run);
+			run[0] = real_len;
+		}
+
+		++run[1];
 	}
 
 	//end of sequence and check whether normal fasta
-	seq_normal = (bad_line > 1) ? 0 : 1;
+	seq_normal = (bad_line > 1 || temp_len > line_len) ? 0 : 1;
 	
 	PYFASTX_SQLITE_CALL(
 		sqlite3_bind_null(stmt, 1);
@@ -353,6 +423,8 @@ void pyfastx_create_index(pyfastx_Index *self){
 		sqlite3_bind_int(stmt, 9, desc_len);
 		sqlite3_step(stmt);
 		sqlite3_finalize(stmt);
+		pyfastx_index_write_runs(self->index_db, line_stmt, &runs, run, seq_normal);
+		sqlite3_finalize(line_stmt);
 	);
 
 	stmt = NULL;
@@ -373,14 +445,16 @@ void pyfastx_create_index(pyfastx_Index *self){
 	
 	//Py_END_ALLOW_THREADS
 
+	pyfastx_stream_readahead(self->gzfd, 0);
 	ks_destroy(ks);
 	free(line.s);
 	free(chrom.s);
+	free(runs.s);
 
 	//create gzip random access index
 	if (self->gzip_format) {
 		if (strcmp(self->index_file, ":memory:") == 0) {
-			zran_build_index(self->gzip_index, 0, 0);
+			zran_build_index(&self->gzip_index->zran, 0, 0);
 		} else {
 			pyfastx_build_gzip_index(self->gzip_index, self->index_db);
 		}
@@ -430,7 +504,11 @@ void pyfastx_build_index(pyfastx_Index *self){
 
 void pyfastx_index_free(pyfastx_Index *self){
 	if (self->gzip_format && self->gzip_index) {
-		zran_free(self->gzip_index);
+		pyfastx_gzip_index_free(self->gzip_index);
+	}
+
+	if (self->zstd_format && self->zstd_index) {
+		pyfastx_zstd_close(self->zstd_index);
 	}
 
 	if (self->index_file) {
@@ -466,15 +544,193 @@ void pyfastx_index_free(pyfastx_Index *self){
 		free(self->cache_name.s);
 	}
 
+	if (self->runs) {
+		free(self->runs);
+	}
+
 	self->fasta = NULL;
 
 	kseq_destroy(self->kseqs);
 	fclose(self->fd);
-	gzclose(self->gzfd);
+	pyfastx_stream_close(self->gzfd);
+}
+
+/*
+pack nonzero letter counts into a blob, each letter is followed by its count
+as a varint of 7-bit groups with the lowest group first
+*/
+void pyfastx_index_pack_composition(Py_ssize_t *counts, kstring_t *packed) {
+	int i;
+
+	packed->l = 0;
+
+	if (packed->m < 128 * 11) {
+		packed->m = 128 * 11;
+		packed->s = (char *)realloc(packed->s, packed->m);
+	}
+
+	for (i = 0; i < 128; ++i) {
+		if (counts[i] <= 0) {
+			continue;
+		}
+
+		packed->s[packed->l++] = i;
+		pyfastx_varint_put(packed, counts[i]);
+	}
+}
+
+/*
+get letter counts of sequence from comp table, seqid 0 for all sequences
+@param counts, 128 counts indexed by letter
+@return 0 if composition was not calculated
+*/
+int pyfastx_index_composition(pyfastx_Index *self, Py_ssize_t seqid, Py_ssize_t *counts) {
+	int ret;
+	int bytes = 0;
+	size_t n;
+	const unsigned char *p = NULL;
+	const unsigned char *end;
+
+	memset(counts, 0, 128 * sizeof(Py_ssize_t));
+
+	PYFASTX_SQLITE_CALL(
+		ret = SQLITE_OK;
+
+		if (!self->comp_stmt) {
+			ret = sqlite3_prepare_v2(self->index_db, "SELECT counts FROM comp WHERE ID=? LIMIT 1;", -1, &self->comp_stmt, NULL);
+		}
+
+		if (ret == SQLITE_OK) {
+			sqlite3_bind_int64(self->comp_stmt, 1, seqid);
+			ret = sqlite3_step(self->comp_stmt);
+		}
+
+		if (ret == SQLITE_ROW) {
+			p = (const unsigned char *)sqlite3_column_blob(self->comp_stmt, 0);
+			bytes = sqlite3_column_bytes(self->comp_stmt, 0);
+		}
+	);
+
+	if (ret != SQLITE_ROW) {
+		if (self->comp_stmt) {
+			PYFASTX_SQLITE_CALL(sqlite3_reset(self->comp_stmt));
+		}
+
+		return 0;
+	}
+
+	for (end = p + bytes; p < end;) {
+		ret = *p++ & 127;
+		p = pyfastx_varint_get(p, end, &n);
+		counts[ret] = n;
+	}
+
+	PYFASTX_SQLITE_CALL(sqlite3_reset(self->comp_stmt));
+	return 1;
+}
+
+//load line runs of irregular sequence, return 0 if it has no line runs
+static int pyfastx_index_load_runs(pyfastx_Index *self, Py_ssize_t chrom) {
+	int ret;
+	int end_len = 0;
+	Py_ssize_t i;
+	Py_ssize_t num = 0;
+	Py_ssize_t pos = 0;
+	Py_ssize_t offset = 0;
+	const int64_t *p = NULL;
+	sqlite3_stmt *stmt;
+
+	const char *sql = "SELECT seq.boff, seq.elen, line.runs FROM line JOIN seq ON seq.ID=line.ID WHERE line.ID=? LIMIT 1;";
+
+	if (self->runs_chrom == chrom) {
+		return self->runs_num > 0;
+	}
+
+	self->runs_chrom = chrom;
+	self->runs_num = 0;
+
+	PYFASTX_SQLITE_CALL(
+		ret = sqlite3_prepare_v2(self->index_db, sql, -1, &stmt, NULL);
+
+		if (ret == SQLITE_OK) {
+			sqlite3_bind_int64(stmt, 1, chrom);
+			ret = sqlite3_step(stmt);
+		}
+	);
+
+	if (ret == SQLITE_ROW) {
+		PYFASTX_SQLITE_CALL(
+			offset = sqlite3_column_int64(stmt, 0);
+			end_len = sqlite3_column_int(stmt, 1);
+			p = (const int64_t *)sqlite3_column_blob(stmt, 2);
+			num = sqlite3_column_bytes(stmt, 2) / (2 * sizeof(int64_t));
+		);
+
+		self->runs = (Py_ssize_t *)realloc(self->runs, num * 4 * sizeof(Py_ssize_t));
+
+		for (i = 0; i < num; ++i) {
+			self->runs[i*4] = pos;
+			self->runs[i*4+1] = offset;
+			self->runs[i*4+2] = p[i*2];
+			self->runs[i*4+3] = p[i*2] + end_len;
+
+			pos += p[i*2] * p[i*2+1];
+			offset += (p[i*2] + end_len) * p[i*2+1];
+		}
+
+		self->runs_num = num;
+	}
+
+	PYFASTX_SQLITE_CALL(sqlite3_finalize(stmt));
+
+	return self->runs_num > 0;
+}
+
+/*
+get file offset of base at 0-based position of irregular sequence from its
+line runs, return -1 if the sequence has no line runs
+*/
+Py_ssize_t pyfastx_index_line_offset(pyfastx_Index *self, Py_ssize_t chrom, Py_ssize_t pos) {
+	Py_ssize_t lo = 0;
+	Py_ssize_t hi;
+	Py_ssize_t mid;
+	Py_ssize_t *run;
+
+	if (!pyfastx_index_load_runs(self, chrom)) {
+		return -1;
+	}
+
+	//the last run starts at or before position, runs of empty lines share
+	//the start with next run and are skipped
+	hi = self->runs_num - 1;
+
+	while (lo < hi) {
+		mid = (lo + hi + 1) / 2;
+
+		if (self->runs[mid*4] <= pos) {
+			lo = mid;
+		} else {
+			hi = mid - 1;
+		}
+	}
+
+	run = self->runs + lo * 4;
+
+	if (run[2] == 0 || pos < run[0]) {
+		return -1;
+	}
+
+	pos -= run[0];
+	return run[1] + pos / run[2] * run[3] + pos % run[2];
 }
 
 pyfastx_Sequence* pyfastx_index_new_seq(pyfastx_Index *self) {
-	pyfastx_Sequence *seq = (pyfastx_Sequence *)PyObject_CallObject((PyObject *)&pyfastx_SequenceType, NULL);
+	pyfastx_Sequence *seq = pyfastx_sequence_alloc();
+
+	if (!seq) {
+		return NULL;
+	}
+
 	//is full sequence
 	seq->complete = 1;
 
@@ -502,15 +758,24 @@ pyfastx_Sequence* pyfastx_index_new_seq(pyfastx_Index *self) {
 PyObject *pyfastx_index_make_seq(pyfastx_Index *self, sqlite3_stmt *stmt){
 	//int32_t a, c, g, t, n;
 	int nbytes;
+	char *block;
 
 	pyfastx_Sequence *seq = pyfastx_index_new_seq(self);
 
+	if (!seq) {
+		return NULL;
+	}
+
 	PYFASTX_SQLITE_CALL(
 		seq->id = sqlite3_column_int64(stmt, 0);
 		nbytes = sqlite3_column_bytes(stmt, 1);
-		seq->name = (char *)malloc(nbytes + 1);
-		memcpy(seq->name, sqlite3_column_text(stmt, 1), nbytes);
-		seq->name[nbytes] = '\0';
+		block = pyfastx_sequence_reserve(seq, nbytes + 1);
+
+		if (block) {
+			memcpy(seq->name, sqlite3_column_text(stmt, 1), nbytes);
+			seq->name[nbytes] = '\0';
+		}
+
 		seq->offset = sqlite3_column_int64(stmt, 2);
 		seq->byte_len = sqlite3_column_int64(stmt, 3);
 		seq->seq_len = sqlite3_column_int64(stmt, 4);
@@ -519,6 +784,12 @@ PyObject *pyfastx_index_make_seq(pyfastx_Index *self, sqlite3_stmt *stmt){
 		seq->normal = sqlite3_column_int(stmt, 7);
 		seq->desc_len = sqlite3_column_int(stmt, 8);
 	);
+
+	if (!block) {
+		Py_DECREF(seq);
+		return PyErr_NoMemory();
+	}
+
 	seq->end = seq->seq_len;
 
 	return (PyObject *)seq;
@@ -541,7 +812,18 @@ PyObject *pyfastx_index_get_seq_by_name(pyfastx_Index *self, PyObject *sname){
 
 	if (ret == SQLITE_ROW) {
 		obj = pyfastx_index_new_seq(self);
-		obj->name = (char *)malloc(nbytes + 1);
+
+		if (!obj) {
+			PYFASTX_SQLITE_CALL(sqlite3_reset(self->seq_stmt));
+			return NULL;
+		}
+
+		if (!pyfastx_sequence_reserve(obj, nbytes + 1)) {
+			PYFASTX_SQLITE_CALL(sqlite3_reset(self->seq_stmt));
+			Py_DECREF(obj);
+			return PyErr_NoMemory();
+		}
+
 		memcpy(obj->name, name, nbytes);
 		obj->name[nbytes] = '\0';
 
@@ -567,6 +849,7 @@ PyObject *pyfastx_index_get_seq_by_name(pyfastx_Index *self, PyObject *sname){
 
 PyObject *pyfastx_index_get_seq_by_id(pyfastx_Index *self, Py_ssize_t chrom){
 	int ret;
+	char *block;
 	Py_ssize_t nbytes;
 	pyfastx_Sequence *obj;
 
@@ -577,12 +860,22 @@ PyObject *pyfastx_index_get_seq_by_id(pyfastx_Index *self, Py_ssize_t chrom){
 
 	if (ret == SQLITE_ROW){
 		obj = pyfastx_index_new_seq(self);
+
+		if (!obj) {
+			PYFASTX_SQLITE_CALL(sqlite3_reset(self->uid_stmt));
+			return NULL;
+		}
+
 		obj->id = chrom;
 		PYFASTX_SQLITE_CALL(
 			nbytes = sqlite3_column_bytes(self->uid_stmt, 1);
-			obj->name = (char *)malloc(nbytes + 1);
-			memcpy(obj->name, sqlite3_column_text(self->uid_stmt, 1), nbytes);
-			obj->name[nbytes] = '\0';
+			block = pyfastx_sequence_reserve(obj, nbytes + 1);
+
+			if (block) {
+				memcpy(obj->name, sqlite3_column_text(self->uid_stmt, 1), nbytes);
+				obj->name[nbytes] = '\0';
+			}
+
 			obj->offset = sqlite3_column_int64(self->uid_stmt, 2);
 			obj->byte_len = sqlite3_column_int64(self->uid_stmt, 3);
 			obj->seq_len = sqlite3_column_int64(self->uid_stmt, 4);
@@ -593,6 +886,11 @@ PyObject *pyfastx_index_get_seq_by_id(pyfastx_Index *self, Py_ssize_t chrom){
 			sqlite3_reset(self->uid_stmt);
 		);
 
+		if (!block) {
+			Py_DECREF(obj);
+			return PyErr_NoMemory();
+		}
+
 		return (PyObject *)obj;
 	} else {
 		PYFASTX_SQLITE_CALL(sqlite3_reset(self->uid_stmt));
@@ -682,8 +980,11 @@ PyObject *pyfastx_index_next_with_index_seq(pyfastx_Index *self) {
 
 void pyfastx_index_random_read(pyfastx_Index* self, char* buff, Py_ssize_t offset, Py_ssize_t bytes) {
 	if (self->gzip_format) {
-		zran_seek(self->gzip_index, offset, SEEK_SET, NULL);
-		zran_read(self->gzip_index, buff, bytes);
+		pyfastx_gzip_index_seek(self->gzip_index, offset);
+		pyfastx_gzip_index_read(self->gzip_index, buff, bytes);
+	} else if (self->zstd_format) {
+		pyfastx_zstd_seek(self->zstd_index, offset);
+		pyfastx_zstd_read(self->zstd_index, buff, bytes);
 	} else {
 		FSEEK(self->fd, offset, SEEK_SET);
 		fread(buff, bytes, 1, self->fd);
@@ -6,6 +6,14 @@
 #include "zlib.h"
 #include "kseq.h"
 #include "zran.h"
+#include "util.h"
+
+//bases between boundaries of block composition index
+#define PYFASTX_BLOCK_SIZE 4096
+
+//letters counted at block boundaries
+#define PYFASTX_BLOCK_BASES "ACGTNacgtn"
+#define PYFASTX_BLOCK_CLASSES 10
 
 typedef struct {
 	PyObject_HEAD
@@ -22,16 +30,22 @@ typedef struct {
 	//full index
 	int full_index;
 
+	//soft-masked and gap intervals
+	int mask_index;
+
 	//is gzip compressed file
 	//0 not gzip file
 	//1 is gzip file
 	int gzip_format;
 
+	//is zstd compressed file
+	int zstd_format;
+
 	//open file handle
 	FILE* fd;
 
-	//gzip open file handle
-	gzFile gzfd;
+	//plain, gzip or zstd file stream
+	pyfastx_Stream *gzfd;
 	
 	//kseqs for reading from fasta
 	kseq_t* kseqs;
@@ -40,7 +54,10 @@ typedef struct {
 	sqlite3* index_db;
 
 	//gzip random access index
-	zran_index_t* gzip_index;
+	pyfastx_GzipIndex* gzip_index;
+
+	//zstd random access reader
+	pyfastx_ZstdReader* zstd_index;
 
 	//cahce seq id
 	Py_ssize_t cache_chrom;
@@ -58,6 +75,13 @@ typedef struct {
 	//cache real seq
 	kstring_t cache_seq;
 
+	//line runs of the last irregular sequence located, each run has the
+	//position of its first base, file offset of its first line, bases and
+	//bytes of each line
+	Py_ssize_t runs_chrom;
+	Py_ssize_t runs_num;
+	Py_ssize_t *runs;
+
 	//key function
 	PyObject* key_func;
 
@@ -101,5 +125,8 @@ pyfastx_Index *pyfastx_init_index(PyObject* obj, PyObject* file_obj, PyObject* i
 //char *pyfastx_index_get_full_seq(pyfastx_Index *self, uint32_t chrom);
 void pyfastx_index_random_read(pyfastx_Index* self, char* buff, Py_ssize_t offset, Py_ssize_t bytes);
 void pyfastx_index_fill_cache(pyfastx_Index* self, Py_ssize_t offset, Py_ssize_t size);
+void pyfastx_index_pack_composition(Py_ssize_t *counts, kstring_t *packed);
+int pyfastx_index_composition(pyfastx_Index *self, Py_ssize_t seqid, Py_ssize_t *counts);
+Py_ssize_t pyfastx_index_line_offset(pyfastx_Index *self, Py_ssize_t chrom, Py_ssize_t pos);
 
 #endif
\ No newline at end of file
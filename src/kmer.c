@@ -0,0 +1,799 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "kmer.h"
+#include "util.h"
+#include "parallel.h"
+
+const uint8_t pyfastx_kmer_code[256] = {
+	4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+	4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+	4, 0, 4, 1, 4, 4, 4, 2, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+	4, 0, 4, 1, 4, 4, 4, 2, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+	4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+	4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+	4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+	4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+};
+
+int pyfastx_kmer_roll_init(pyfastx_KmerRoll *roll, int k, int canonical) {
+	if (k < 1 || k > PYFASTX_KMER_MAX) {
+		PyErr_Format(PyExc_ValueError, "k must be between 1 and %d", PYFASTX_KMER_MAX);
+		return 0;
+	}
+
+	roll->k = k;
+	roll->canonical = canonical;
+	roll->mask = ((uint64_t)1 << (2 * k)) - 1;
+	roll->shift = 2 * (k - 1);
+	roll->fwd = 0;
+	roll->rev = 0;
+	roll->valid = 0;
+
+	return 1;
+}
+
+//pack k-mer string, return 0 if it is not k bases of ACGT
+int pyfastx_kmer_encode(const char *s, Py_ssize_t l, int k, int canonical, uint64_t *kmer) {
+	pyfastx_KmerRoll roll;
+	Py_ssize_t i;
+
+	if (l != k || !pyfastx_kmer_roll_init(&roll, k, canonical)) {
+		return 0;
+	}
+
+	for (i = 0; i < l; ++i) {
+		if (pyfastx_kmer_push(&roll, s[i], kmer)) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+#define pyfastx_kmer_shard_of(h) ((h) >> 56)
+
+int pyfastx_kmer_shard_alloc(pyfastx_KmerShard *shard, Py_ssize_t size) {
+	Py_ssize_t i;
+
+	shard->keys = (uint64_t *)malloc(size * sizeof(uint64_t));
+	shard->counts = (uint32_t *)malloc(size * sizeof(uint32_t));
+
+	if (!shard->keys || !shard->counts) {
+		free(shard->keys);
+		free(shard->counts);
+		shard->keys = NULL;
+		shard->counts = NULL;
+		return 0;
+	}
+
+	for (i = 0; i < size; ++i) {
+		shard->keys[i] = PYFASTX_KMER_EMPTY;
+	}
+
+	shard->size = size;
+	shard->used = 0;
+
+	return 1;
+}
+
+//insert k-mer with count into shard without growing
+void pyfastx_kmer_shard_put(pyfastx_KmerShard *shard, uint64_t kmer, uint32_t count) {
+	Py_ssize_t mask = shard->size - 1;
+	Py_ssize_t i = pyfastx_kmer_hash(kmer) & mask;
+
+	while (shard->keys[i] != PYFASTX_KMER_EMPTY && shard->keys[i] != kmer) {
+		i = (i + 1) & mask;
+	}
+
+	if (shard->keys[i] == kmer) {
+		//counts are saturated instead of overflowed
+		shard->counts[i] = shard->counts[i] > UINT32_MAX - count ? UINT32_MAX : shard->counts[i] + count;
+	} else {
+		shard->keys[i] = kmer;
+		shard->counts[i] = count;
+		++shard->used;
+	}
+}
+
+//double the slots when shard is 3/4 full
+int pyfastx_kmer_shard_grow(pyfastx_KmerShard *shard) {
+	pyfastx_KmerShard old = *shard;
+	Py_ssize_t i;
+
+	if (!pyfastx_kmer_shard_alloc(shard, old.size * 2)) {
+		*shard = old;
+		return 0;
+	}
+
+	for (i = 0; i < old.size; ++i) {
+		if (old.keys[i] != PYFASTX_KMER_EMPTY) {
+			pyfastx_kmer_shard_put(shard, old.keys[i], old.counts[i]);
+		}
+	}
+
+	free(old.keys);
+	free(old.counts);
+
+	return 1;
+}
+
+pyfastx_KmerTable *pyfastx_kmer_table_create(void) {
+	int i;
+	pyfastx_KmerTable *table = (pyfastx_KmerTable *)calloc(1, sizeof(pyfastx_KmerTable));
+
+	if (!table) {
+		return NULL;
+	}
+
+	for (i = 0; i < PYFASTX_KMER_SHARDS; ++i) {
+		if (!pyfastx_kmer_shard_alloc(&table->shards[i], PYFASTX_KMER_SLOTS)) {
+			break;
+		}
+
+		table->shards[i].lock = PyThread_allocate_lock();
+
+		if (!table->shards[i].lock) {
+			break;
+		}
+	}
+
+	if (i < PYFASTX_KMER_SHARDS) {
+		table->error = 1;
+	}
+
+	return table;
+}
+
+void pyfastx_kmer_table_free(pyfastx_KmerTable *table) {
+	int i;
+
+	for (i = 0; i < PYFASTX_KMER_SHARDS; ++i) {
+		free(table->shards[i].keys);
+		free(table->shards[i].counts);
+
+		if (table->shards[i].lock) {
+			PyThread_free_lock(table->shards[i].lock);
+		}
+	}
+
+	free(table);
+}
+
+//insert buffered k-mers of a shard while holding its lock
+void pyfastx_kmer_table_flush(pyfastx_KmerTable *table, pyfastx_KmerBuffer *buffer, int s) {
+	pyfastx_KmerShard *shard = &table->shards[s];
+	uint64_t *kmers = buffer->kmers + (Py_ssize_t)s * PYFASTX_KMER_BUFFER;
+	int i;
+
+	PyThread_acquire_lock(shard->lock, WAIT_LOCK);
+
+	for (i = 0; i < buffer->nums[s]; ++i) {
+		if (shard->used * 4 >= shard->size * 3 && !pyfastx_kmer_shard_grow(shard)) {
+			table->error = 1;
+			break;
+		}
+
+		pyfastx_kmer_shard_put(shard, kmers[i], 1);
+	}
+
+	shard->total += buffer->nums[s];
+	PyThread_release_lock(shard->lock);
+
+	buffer->nums[s] = 0;
+}
+
+int pyfastx_kmer_buffer_init(pyfastx_KmerBuffer *buffer) {
+	memset(buffer->nums, 0, sizeof(buffer->nums));
+	buffer->kmers = (uint64_t *)malloc(sizeof(uint64_t) * PYFASTX_KMER_SHARDS * PYFASTX_KMER_BUFFER);
+	return buffer->kmers != NULL;
+}
+
+void pyfastx_kmer_buffer_free(pyfastx_KmerTable *table, pyfastx_KmerBuffer *buffer) {
+	int s;
+
+	for (s = 0; s < PYFASTX_KMER_SHARDS; ++s) {
+		if (buffer->nums[s]) {
+			pyfastx_kmer_table_flush(table, buffer, s);
+		}
+	}
+
+	free(buffer->kmers);
+}
+
+//count k-mers of a sequence, k-mers never span sequences
+void pyfastx_kmer_table_add(pyfastx_KmerTable *table, pyfastx_KmerBuffer *buffer, pyfastx_KmerRoll *roll, char *seq, Py_ssize_t len) {
+	Py_ssize_t i;
+	uint64_t kmer;
+	int s;
+
+	roll->valid = 0;
+
+	for (i = 0; i < len; ++i) {
+		if (pyfastx_kmer_push(roll, seq[i], &kmer)) {
+			s = pyfastx_kmer_shard_of(pyfastx_kmer_hash(kmer));
+			buffer->kmers[(Py_ssize_t)s * PYFASTX_KMER_BUFFER + buffer->nums[s]] = kmer;
+
+			if (++buffer->nums[s] == PYFASTX_KMER_BUFFER) {
+				pyfastx_kmer_table_flush(table, buffer, s);
+			}
+		}
+	}
+}
+
+//count k-mers of parsed chunk in worker thread
+typedef struct {
+	pyfastx_KmerTable *table;
+	pyfastx_KmerRoll roll;
+} pyfastx_KmerJob;
+
+void pyfastx_kmer_count_job(pyfastx_ParallelJob *job, void *data) {
+	pyfastx_KmerJob *kjob = (pyfastx_KmerJob *)data;
+	pyfastx_KmerRoll roll = kjob->roll;
+	pyfastx_KmerBuffer buffer;
+	Py_ssize_t i;
+
+	if (!pyfastx_kmer_buffer_init(&buffer)) {
+		kjob->table->error = 1;
+		return;
+	}
+
+	for (i = 0; i < job->count; ++i) {
+		pyfastx_kmer_table_add(kjob->table, &buffer, &roll, job->seq.data.s + job->seq.offsets[i], job->seq.offsets[i+1] - job->seq.offsets[i]);
+	}
+
+	pyfastx_kmer_buffer_free(kjob->table, &buffer);
+}
+
+typedef struct {
+	uint64_t kmer;
+	uint32_t count;
+} pyfastx_KmerItem;
+
+/*
+LSD radix sort of items by k-mer with 11-bit digits, only the 2k bits of
+k-mer are sorted, items and tmp have n items, return the sorted array
+*/
+pyfastx_KmerItem *pyfastx_kmer_item_sort(pyfastx_KmerItem *items, pyfastx_KmerItem *tmp, Py_ssize_t n, int k) {
+	Py_ssize_t counts[2048];
+	Py_ssize_t i;
+	Py_ssize_t sum;
+	Py_ssize_t c;
+	pyfastx_KmerItem *swap;
+	int shift;
+	int d;
+
+	for (shift = 0; shift < 2 * k; shift += 11) {
+		memset(counts, 0, sizeof(counts));
+
+		for (i = 0; i < n; ++i) {
+			++counts[(items[i].kmer >> shift) & 2047];
+		}
+
+		for (d = 0, sum = 0; d < 2048; ++d) {
+			c = counts[d];
+			counts[d] = sum;
+			sum += c;
+		}
+
+		for (i = 0; i < n; ++i) {
+			tmp[counts[(items[i].kmer >> shift) & 2047]++] = items[i];
+		}
+
+		swap = items;
+		items = tmp;
+		tmp = swap;
+	}
+
+	return items;
+}
+
+//export counts in table as arrays sorted by k-mer
+PyObject *pyfastx_kmer_counts_create(pyfastx_KmerTable *table, int k, int canonical) {
+	pyfastx_KmerCounts *obj;
+	pyfastx_KmerItem *items;
+	pyfastx_KmerItem *tmp;
+	pyfastx_KmerItem *sorted;
+	pyfastx_KmerShard *shard;
+	uint64_t *kmers;
+	uint32_t *counts;
+	Py_ssize_t n = 0;
+	Py_ssize_t total = 0;
+	Py_ssize_t i;
+	int s;
+
+	for (s = 0; s < PYFASTX_KMER_SHARDS; ++s) {
+		n += table->shards[s].used;
+		total += table->shards[s].total;
+	}
+
+	items = (pyfastx_KmerItem *)malloc((n ? n : 1) * sizeof(pyfastx_KmerItem));
+	tmp = (pyfastx_KmerItem *)malloc((n ? n : 1) * sizeof(pyfastx_KmerItem));
+
+	if (!items || !tmp) {
+		free(items);
+		free(tmp);
+		return PyErr_NoMemory();
+	}
+
+	Py_BEGIN_ALLOW_THREADS
+	n = 0;
+
+	for (s = 0; s < PYFASTX_KMER_SHARDS; ++s) {
+		shard = &table->shards[s];
+
+		for (i = 0; i < shard->size; ++i) {
+			if (shard->keys[i] != PYFASTX_KMER_EMPTY) {
+				items[n].kmer = shard->keys[i];
+				items[n].count = shard->counts[i];
+				++n;
+			}
+		}
+	}
+
+	sorted = pyfastx_kmer_item_sort(items, tmp, n, k);
+	Py_END_ALLOW_THREADS
+
+	obj = PyObject_New(pyfastx_KmerCounts, &pyfastx_KmerCountsType);
+
+	if (!obj) {
+		free(items);
+		free(tmp);
+		return NULL;
+	}
+
+	obj->k = k;
+	obj->canonical = canonical;
+	obj->count = n;
+	obj->total = total;
+	obj->kmers = PyBytes_FromStringAndSize(NULL, n * sizeof(uint64_t));
+	obj->counts = PyBytes_FromStringAndSize(NULL, n * sizeof(uint32_t));
+
+	if (!obj->kmers || !obj->counts) {
+		free(items);
+		free(tmp);
+		Py_DECREF(obj);
+		return NULL;
+	}
+
+	kmers = (uint64_t *)PyBytes_AS_STRING(obj->kmers);
+	counts = (uint32_t *)PyBytes_AS_STRING(obj->counts);
+
+	for (i = 0; i < n; ++i) {
+		kmers[i] = sorted[i].kmer;
+		counts[i] = sorted[i].count;
+	}
+
+	free(items);
+	free(tmp);
+
+	return (PyObject *)obj;
+}
+
+/*
+count k-mers of all records read by kseq, records are parsed and counted
+by worker threads if threads > 1, each thread buffers k-mers by shard and
+inserts them into the shard under its lock, so threads rarely wait for
+each other. format 1 is fasta and 2 is fastq
+*/
+PyObject *pyfastx_kmer_count(kseq_t *kseq, int format, pyfastx_Filter *filter, PyObject *args, PyObject *kwargs) {
+	int k;
+	int canonical = 0;
+	int threads = 1;
+	int reason;
+	int error = 0;
+	pyfastx_Stream *stream = kseq->f->f;
+	pyfastx_Parallel *pool;
+	pyfastx_ParallelJob *job;
+	pyfastx_KmerTable *table;
+	pyfastx_KmerBuffer buffer;
+	pyfastx_KmerJob kjob;
+	PyObject *ret;
+
+	static char* keywords[] = {"k", "canonical", "threads", NULL};
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "i|pi", keywords, &k, &canonical, &threads)) {
+		return NULL;
+	}
+
+	if (!pyfastx_kmer_roll_init(&kjob.roll, k, canonical)) {
+		return NULL;
+	}
+
+	if (threads <= 0) {
+		PyErr_SetString(PyExc_ValueError, "threads must be greater than 0");
+		return NULL;
+	}
+
+	table = pyfastx_kmer_table_create();
+
+	if (!table || table->error) {
+		if (table) {
+			pyfastx_kmer_table_free(table);
+		}
+
+		return PyErr_NoMemory();
+	}
+
+	kjob.table = table;
+
+	if (filter) {
+		pyfastx_filter_reset(filter);
+	}
+
+	//count from the beginning of file in a full pass
+	pyfastx_stream_rewind(stream);
+	pyfastx_stream_readahead(stream, 1);
+	kseq_rewind(kseq);
+
+	if (threads > 1) {
+		pool = pyfastx_parallel_create(stream, threads, 0, PYFASTX_KMER_CHUNK, format, 0, 0, 0, filter);
+
+		if (!pool) {
+			pyfastx_kmer_table_free(table);
+
+			if (!PyErr_Occurred()) {
+				PyErr_SetString(PyExc_RuntimeError, "can not start counting threads");
+			}
+
+			return NULL;
+		}
+
+		pool->handler = pyfastx_kmer_count_job;
+		pool->data = &kjob;
+
+		Py_BEGIN_ALLOW_THREADS
+		while ((job = pyfastx_parallel_next(pool)) != NULL) {
+			pyfastx_parallel_feed(pool, job);
+		}
+
+		error = pool->error;
+		pyfastx_parallel_free(pool);
+		Py_END_ALLOW_THREADS
+
+		if (pyfastx_parallel_raise(error) < 0) {
+			pyfastx_kmer_table_free(table);
+			return NULL;
+		}
+	} else if (pyfastx_kmer_buffer_init(&buffer)) {
+		Py_BEGIN_ALLOW_THREADS
+		while (kseq_read(kseq) >= 0) {
+			if (filter) {
+				reason = pyfastx_filter_test(filter, kseq->name.s, kseq->name.l, kseq->seq.s, kseq->seq.l, kseq->qual.s, kseq->qual.l);
+				++filter->counts[reason];
+
+				if (reason) {
+					continue;
+				}
+			}
+
+			pyfastx_kmer_table_add(table, &buffer, &kjob.roll, kseq->seq.s, kseq->seq.l);
+		}
+
+		pyfastx_kmer_buffer_free(table, &buffer);
+		Py_END_ALLOW_THREADS
+	} else {
+		table->error = 1;
+	}
+
+	if (table->error) {
+		pyfastx_kmer_table_free(table);
+		return PyErr_NoMemory();
+	}
+
+	ret = pyfastx_kmer_counts_create(table, k, canonical);
+	pyfastx_kmer_table_free(table);
+
+	return ret;
+}
+
+void pyfastx_kmer_counts_dealloc(pyfastx_KmerCounts *self) {
+	Py_XDECREF(self->kmers);
+	Py_XDECREF(self->counts);
+	PyObject_Del(self);
+}
+
+Py_ssize_t pyfastx_kmer_counts_length(pyfastx_KmerCounts *self) {
+	return self->count;
+}
+
+//count of k-mer string or packed integer, 0 if k-mer was not found
+PyObject *pyfastx_kmer_counts_subscript(pyfastx_KmerCounts *self, PyObject *item) {
+	uint64_t *kmers = (uint64_t *)PyBytes_AS_STRING(self->kmers);
+	uint32_t *counts = (uint32_t *)PyBytes_AS_STRING(self->counts);
+	uint64_t kmer;
+	Py_ssize_t lo = 0;
+	Py_ssize_t hi = self->count;
+	Py_ssize_t mid;
+	Py_ssize_t l;
+	const char *s;
+
+	if (PyUnicode_Check(item)) {
+		s = PyUnicode_AsUTF8AndSize(item, &l);
+
+		if (!s) {
+			return NULL;
+		}
+
+		if (!pyfastx_kmer_encode(s, l, self->k, self->canonical, &kmer)) {
+			PyErr_Format(PyExc_ValueError, "%R is not a %d-mer of ACGT bases", item, self->k);
+			return NULL;
+		}
+	} else if (PyLong_Check(item)) {
+		kmer = PyLong_AsUnsignedLongLong(item);
+
+		if (PyErr_Occurred()) {
+			return NULL;
+		}
+	} else {
+		PyErr_SetString(PyExc_TypeError, "k-mer must be a string or an integer");
+		return NULL;
+	}
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+
+		if (kmers[mid] < kmer) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	if (lo < self->count && kmers[lo] == kmer) {
+		return PyLong_FromUnsignedLong(counts[lo]);
+	}
+
+	return PyLong_FromLong(0);
+}
+
+//expose bytes as typed memoryview
+PyObject *pyfastx_kmer_counts_view(PyObject *data, const char *format) {
+	PyObject *view = PyMemoryView_FromObject(data);
+	PyObject *ret;
+
+	if (!view) {
+		return NULL;
+	}
+
+	ret = PyObject_CallMethod(view, "cast", "s", format);
+	Py_DECREF(view);
+	return ret;
+}
+
+PyObject *pyfastx_kmer_counts_kmers(pyfastx_KmerCounts *self, void* closure) {
+	return pyfastx_kmer_counts_view(self->kmers, "Q");
+}
+
+PyObject *pyfastx_kmer_counts_counts(pyfastx_KmerCounts *self, void* closure) {
+	return pyfastx_kmer_counts_view(self->counts, "I");
+}
+
+PyObject *pyfastx_kmer_counts_k(pyfastx_KmerCounts *self, void* closure) {
+	return Py_BuildValue("i", self->k);
+}
+
+PyObject *pyfastx_kmer_counts_canonical(pyfastx_KmerCounts *self, void* closure) {
+	return PyBool_FromLong(self->canonical);
+}
+
+PyObject *pyfastx_kmer_counts_total(pyfastx_KmerCounts *self, void* closure) {
+	return Py_BuildValue("n", self->total);
+}
+
+PyObject *pyfastx_kmer_counts_repr(pyfastx_KmerCounts *self) {
+	return PyUnicode_FromFormat("<KmerCounts> %zd distinct %d-mers", self->count, self->k);
+}
+
+pyfastx_KmerIter *pyfastx_kmer_iter_new(PyObject *parent, kseq_t *kseq, pyfastx_Filter *filter, int k, int canonical) {
+	pyfastx_KmerIter *obj = PyObject_New(pyfastx_KmerIter, &pyfastx_KmerIterType);
+
+	if (!obj) {
+		return NULL;
+	}
+
+	obj->parent = Py_NewRef(parent);
+	obj->kseq = kseq;
+	obj->filter = filter;
+	obj->windows = NULL;
+	obj->bases = NULL;
+	obj->len = 0;
+	obj->pos = 0;
+	obj->start = 0;
+	obj->record = -1;
+
+	if (!pyfastx_kmer_roll_init(&obj->roll, k, canonical)) {
+		Py_DECREF(obj);
+		return NULL;
+	}
+
+	if (kseq) {
+		if (filter) {
+			pyfastx_filter_reset(filter);
+		}
+
+		pyfastx_stream_rewind(kseq->f->f);
+		pyfastx_stream_readahead(kseq->f->f, 1);
+		kseq_rewind(kseq);
+	} else {
+		obj->windows = pyfastx_sequence_windows_create((pyfastx_Sequence *)parent, PYFASTX_WINDOW_CHUNK + k - 1, PYFASTX_WINDOW_CHUNK, 0, 0);
+
+		if (!obj->windows) {
+			Py_DECREF(obj);
+			return NULL;
+		}
+	}
+
+	return obj;
+}
+
+/*
+create k-mer iterator of records read by kseq, or of sequence if kseq is
+NULL, sequence is read in windows overlapped by k-1 bases so that memory
+does not grow with sequence length
+*/
+PyObject *pyfastx_kmer_iter_create(PyObject *parent, kseq_t *kseq, pyfastx_Filter *filter, PyObject *args, PyObject *kwargs) {
+	int k;
+	int canonical = 0;
+
+	static char* keywords[] = {"k", "canonical", NULL};
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "i|p", keywords, &k, &canonical)) {
+		return NULL;
+	}
+
+	return (PyObject *)pyfastx_kmer_iter_new(parent, kseq, filter, k, canonical);
+}
+
+void pyfastx_kmer_iter_dealloc(pyfastx_KmerIter *self) {
+	Py_XDECREF(self->windows);
+	Py_DECREF(self->parent);
+	PyObject_Del(self);
+}
+
+PyObject *pyfastx_kmer_iter_iter(pyfastx_KmerIter *self) {
+	Py_INCREF(self);
+	return (PyObject *)self;
+}
+
+//load bases of next record or window, return 0 if no more bases
+int pyfastx_kmer_iter_fill(pyfastx_KmerIter *self) {
+	kseq_t *kseq = self->kseq;
+	int reason;
+
+	self->pos = 0;
+	self->roll.valid = 0;
+
+	if (self->windows) {
+		self->start = self->windows->next;
+		self->len = pyfastx_sequence_windows_step(self->windows, &self->bases);
+		return self->len >= 0;
+	}
+
+	while (kseq_read(kseq) >= 0) {
+		if (self->filter) {
+			reason = pyfastx_filter_test(self->filter, kseq->name.s, kseq->name.l, kseq->seq.s, kseq->seq.l, kseq->qual.s, kseq->qual.l);
+			++self->filter->counts[reason];
+
+			if (reason) {
+				continue;
+			}
+		}
+
+		self->bases = kseq->seq.s;
+		self->len = kseq->seq.l;
+		++self->record;
+		return 1;
+	}
+
+	self->len = 0;
+	return 0;
+}
+
+//get next k-mer and its 0-based start position in record or sequence,
+//return 0 if no more k-mers
+int pyfastx_kmer_iter_step(pyfastx_KmerIter *self, uint64_t *kmer, Py_ssize_t *pos) {
+	do {
+		while (self->pos < self->len) {
+			if (pyfastx_kmer_push(&self->roll, self->bases[self->pos++], kmer)) {
+				*pos = self->start + self->pos - self->roll.k;
+				return 1;
+			}
+		}
+	} while (pyfastx_kmer_iter_fill(self));
+
+	return 0;
+}
+
+PyObject *pyfastx_kmer_iter_next(pyfastx_KmerIter *self) {
+	uint64_t kmer;
+	Py_ssize_t pos;
+
+	if (pyfastx_kmer_iter_step(self, &kmer, &pos)) {
+		return PyLong_FromUnsignedLongLong(kmer);
+	}
+
+	return NULL;
+}
+
+//decode packed k-mer integer to string
+PyObject *pyfastx_kmer_decode(PyObject *self, PyObject *args) {
+	static const char bases[] = "ACGT";
+	unsigned long long kmer;
+	PyObject *kmer_obj;
+	PyObject *ret;
+	Py_UCS1 *s;
+	int k;
+	int i;
+
+	if (!PyArg_ParseTuple(args, "Oi", &kmer_obj, &k)) {
+		return NULL;
+	}
+
+	if (k < 1 || k > PYFASTX_KMER_MAX) {
+		PyErr_Format(PyExc_ValueError, "k must be between 1 and %d", PYFASTX_KMER_MAX);
+		return NULL;
+	}
+
+	//negative or too large int raises OverflowError instead of wrapping
+	kmer = PyLong_AsUnsignedLongLong(kmer_obj);
+
+	if (kmer == (unsigned long long)-1 && PyErr_Occurred()) {
+		return NULL;
+	}
+
+	if (kmer >> (2 * k)) {
+		PyErr_Format(PyExc_ValueError, "kmer must be less than 4**%d", k);
+		return NULL;
+	}
+
+	ret = PyUnicode_New(k, 127);
+
+	if (!ret) {
+		return NULL;
+	}
+
+	s = PyUnicode_1BYTE_DATA(ret);
+
+	for (i = k - 1; i >= 0; --i) {
+		s[i] = bases[kmer & 3];
+		kmer >>= 2;
+	}
+
+	return ret;
+}
+
+static PyMappingMethods pyfastx_kmer_counts_as_mapping = {
+	(lenfunc)pyfastx_kmer_counts_length,
+	(binaryfunc)pyfastx_kmer_counts_subscript,
+	0,
+};
+
+static PyGetSetDef pyfastx_kmer_counts_getsets[] = {
+	{"k", (getter)pyfastx_kmer_counts_k, NULL, NULL, NULL},
+	{"canonical", (getter)pyfastx_kmer_counts_canonical, NULL, NULL, NULL},
+	{"total", (getter)pyfastx_kmer_counts_total, NULL, NULL, NULL},
+	{"kmers", (getter)pyfastx_kmer_counts_kmers, NULL, NULL, NULL},
+	{"counts", (getter)pyfastx_kmer_counts_counts, NULL, NULL, NULL},
+	{NULL}
+};
+
+PyTypeObject pyfastx_KmerCountsType = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "KmerCounts",
+	.tp_basicsize = sizeof(pyfastx_KmerCounts),
+	.tp_dealloc = (destructor)pyfastx_kmer_counts_dealloc,
+	.tp_repr = (reprfunc)pyfastx_kmer_counts_repr,
+	.tp_as_mapping = &pyfastx_kmer_counts_as_mapping,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_getset = pyfastx_kmer_counts_getsets,
+};
+
+PyTypeObject pyfastx_KmerIterType = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "KmerIterator",
+	.tp_basicsize = sizeof(pyfastx_KmerIter),
+	.tp_dealloc = (destructor)pyfastx_kmer_iter_dealloc,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_iter = (getiterfunc)pyfastx_kmer_iter_iter,
+	.tp_iternext = (iternextfunc)pyfastx_kmer_iter_next,
+};
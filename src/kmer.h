@@ -0,0 +1,173 @@
+#ifndef PYFASTX_KMER_H
+#define PYFASTX_KMER_H
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "kseq.h"
+#include "filter.h"
+#include "sequence.h"
+
+//max k-mer size packed into 64-bit integer with 2 bits per base
+#define PYFASTX_KMER_MAX 31
+
+//number of hash table shards, each shard is guarded by its own lock
+#define PYFASTX_KMER_SHARDS 256
+
+//k-mers buffered for each shard by counting thread before taking the lock
+#define PYFASTX_KMER_BUFFER 256
+
+//initial number of slots in each shard
+#define PYFASTX_KMER_SLOTS 1024
+
+//number of records in each chunk parsed by counting threads
+#define PYFASTX_KMER_CHUNK 4096
+
+//empty slot of hash table, never a valid k-mer as k <= 31
+#define PYFASTX_KMER_EMPTY UINT64_MAX
+
+//2-bit code of base, A:0 C:1 G:2 T/U:3, others are 4
+extern const uint8_t pyfastx_kmer_code[256];
+extern int comp_map[128];
+
+//rolling forward and reverse complement k-mer over a stream of bases
+typedef struct {
+	int k;
+	int canonical;
+
+	//mask of 2k bits and shift of the first base in reverse k-mer
+	uint64_t mask;
+	int shift;
+
+	uint64_t fwd;
+	uint64_t rev;
+
+	//number of valid bases since last N or reset
+	int valid;
+
+} pyfastx_KmerRoll;
+
+//push base into k-mer, return 1 and set kmer if the last k bases are valid
+static inline int pyfastx_kmer_push(pyfastx_KmerRoll *roll, unsigned char c, uint64_t *kmer) {
+	uint64_t code = pyfastx_kmer_code[c];
+
+	if (code > 3) {
+		roll->valid = 0;
+		return 0;
+	}
+
+	roll->fwd = ((roll->fwd << 2) | code) & roll->mask;
+
+	if (roll->canonical) {
+		roll->rev = (roll->rev >> 2) | ((uint64_t)pyfastx_kmer_code[comp_map[c]] << roll->shift);
+	}
+
+	if (++roll->valid < roll->k) {
+		return 0;
+	}
+
+	*kmer = (roll->canonical && roll->rev < roll->fwd) ? roll->rev : roll->fwd;
+	return 1;
+}
+
+//murmur3 finalizer, high bits select shard and low bits select slot of
+//counting table, also orders k-mers of minimizers and sketches
+static inline uint64_t pyfastx_kmer_hash(uint64_t x) {
+	x ^= x >> 33;
+	x *= 0xff51afd7ed558ccdULL;
+	x ^= x >> 33;
+	x *= 0xc4ceb9fe1a85ec53ULL;
+	x ^= x >> 33;
+	return x;
+}
+
+//a shard of open addressing hash table of k-mer counts
+typedef struct {
+	uint64_t *keys;
+	uint32_t *counts;
+
+	//number of slots, power of 2
+	Py_ssize_t size;
+	Py_ssize_t used;
+
+	//number of k-mers inserted into shard
+	Py_ssize_t total;
+
+	PyThread_type_lock lock;
+
+} pyfastx_KmerShard;
+
+//k-mer counts sharded by the high bits of k-mer hash
+typedef struct {
+	pyfastx_KmerShard shards[PYFASTX_KMER_SHARDS];
+
+	//failed to allocate memory while counting
+	int error;
+
+} pyfastx_KmerTable;
+
+//k-mers of a counting thread waiting to be inserted into each shard
+typedef struct {
+	uint64_t *kmers;
+	int nums[PYFASTX_KMER_SHARDS];
+
+} pyfastx_KmerBuffer;
+
+typedef struct {
+	PyObject_HEAD
+
+	//k-mer size and counted in canonical form or not
+	int k;
+	int canonical;
+
+	//number of distinct k-mers
+	Py_ssize_t count;
+
+	//number of k-mers counted
+	Py_ssize_t total;
+
+	//ascending uint64 k-mers and uint32 counts
+	PyObject *kmers;
+	PyObject *counts;
+
+} pyfastx_KmerCounts;
+
+//k-mers streamed from records of kseq or from a sequence
+typedef struct {
+	PyObject_HEAD
+
+	//Fastx, Fasta, Fastq or Sequence object
+	PyObject *parent;
+
+	//read records from kseq if not NULL
+	kseq_t *kseq;
+	pyfastx_Filter *filter;
+
+	//read windows overlapped by k-1 bases from sequence if not NULL
+	pyfastx_SequenceWindows *windows;
+
+	//bases of current record or window
+	char *bases;
+	Py_ssize_t len;
+	Py_ssize_t pos;
+
+	//position of the first base of current bases in record or sequence
+	Py_ssize_t start;
+
+	//0-based index of current record read by kseq
+	Py_ssize_t record;
+
+	pyfastx_KmerRoll roll;
+
+} pyfastx_KmerIter;
+
+extern PyTypeObject pyfastx_KmerCountsType;
+extern PyTypeObject pyfastx_KmerIterType;
+
+int pyfastx_kmer_roll_init(pyfastx_KmerRoll *roll, int k, int canonical);
+int pyfastx_kmer_encode(const char *s, Py_ssize_t l, int k, int canonical, uint64_t *kmer);
+pyfastx_KmerIter *pyfastx_kmer_iter_new(PyObject *parent, kseq_t *kseq, pyfastx_Filter *filter, int k, int canonical);
+int pyfastx_kmer_iter_step(pyfastx_KmerIter *self, uint64_t *kmer, Py_ssize_t *pos);
+PyObject *pyfastx_kmer_iter_create(PyObject *parent, kseq_t *kseq, pyfastx_Filter *filter, PyObject *args, PyObject *kwargs);
+PyObject *pyfastx_kmer_count(kseq_t *kseq, int format, pyfastx_Filter *filter, PyObject *args, PyObject *kwargs);
+PyObject *pyfastx_kmer_decode(PyObject *self, PyObject *args);
+
+#endif
@@ -28,7 +28,7 @@
 #include <Python.h>
 #include "kseq.h"
 
-kstream_t *ks_init(gzFile f)						
+kstream_t *ks_init(pyfastx_Stream *f)						
 {																
 	kstream_t *ks = (kstream_t*)calloc(1, sizeof(kstream_t));	
 	ks->f = f;													
@@ -49,7 +49,7 @@ int ks_getc(kstream_t *ks)
 	if (ks->is_eof && ks->begin >= ks->end) return -1;	
 	if (ks->begin >= ks->end) {							
 		ks->begin = 0;									
-		ks->end = gzread(ks->f, ks->buf, BUF_SIZE);	
+		ks->end = pyfastx_stream_read(ks->f, ks->buf, BUF_SIZE);	
 		if (ks->end == 0) { ks->is_eof = 1; return -1;}	
 		if (ks->end == -1) { ks->is_eof = 1; return -3;}
 	}													
@@ -67,7 +67,7 @@ Py_ssize_t ks_getuntil2(kstream_t *ks, int delimiter, kstring_t *str, int *dret,
 		if (ks->begin >= ks->end) {									
 			if (!ks->is_eof) {										
 				ks->begin = 0;										
-				ks->end = gzread(ks->f, ks->buf, BUF_SIZE);		
+				ks->end = pyfastx_stream_read(ks->f, ks->buf, BUF_SIZE);		
 				if (ks->end == 0) { ks->is_eof = 1; break; }		
 				if (ks->end == -1) { ks->is_eof = 1; return -3; }	
 			} else break;											
@@ -114,7 +114,7 @@ Py_ssize_t ks_getuntil(kstream_t *ks, int delimiter, kstring_t *str, int *dret)
 void kseq_rewind(kseq_t *ks)
 { (ks)->last_char = (ks)->f->is_eof = (ks)->f->begin = (ks)->f->end = 0; }
 
-kseq_t *kseq_init(gzFile fd)									
+kseq_t *kseq_init(pyfastx_Stream *fd)									
 {																
 	kseq_t *s = (kseq_t*)calloc(1, sizeof(kseq_t));					
 	s->f = ks_init(fd);												
@@ -5,6 +5,7 @@
 //#include <stdint.h>
 #include <ctype.h>
 #include "zlib.h"
+#include "stream.h"
 
 #define KS_SEP_SPACE 0 // isspace(): \t, \n, \v, \f, \r
 #define KS_SEP_TAB   1 // isspace() && !' '
@@ -25,7 +26,7 @@ typedef struct __kstream_t {
 	unsigned char *buf;
 	//int64_t begin, end, is_eof;
 	Py_ssize_t begin, end, is_eof;
-	gzFile f;
+	pyfastx_Stream *f;
 } kstream_t;
 
 typedef struct __kstring_t {
@@ -40,12 +41,12 @@ typedef struct {
 	kstream_t *f;
 } kseq_t;
 
-kstream_t *ks_init(gzFile f);
+kstream_t *ks_init(pyfastx_Stream *f);
 void ks_destroy(kstream_t *ks);
 int ks_getc(kstream_t *ks);
 Py_ssize_t ks_getuntil2(kstream_t *ks, int delimiter, kstring_t *str, int *dret, int append);
 Py_ssize_t ks_getuntil(kstream_t *ks, int delimiter, kstring_t *str, int *dret);
-kseq_t *kseq_init(gzFile fd);
+kseq_t *kseq_init(pyfastx_Stream *fd);
 void kseq_rewind(kseq_t *ks);
 void kseq_destroy(kseq_t *ks);
 Py_ssize_t kseq_read(kseq_t *seq);
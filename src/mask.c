@@ -0,0 +1,377 @@
+#include "mask.h"
+#include "util.h"
+
+//bit 0 is set for lowercase letters and bit 1 for N or n
+static const unsigned char mask_flags[256] = {
+	['a'] = 1, ['b'] = 1, ['c'] = 1, ['d'] = 1, ['e'] = 1, ['f'] = 1, ['g'] = 1,
+	['h'] = 1, ['i'] = 1, ['j'] = 1, ['k'] = 1, ['l'] = 1, ['m'] = 1, ['n'] = 3,
+	['o'] = 1, ['p'] = 1, ['q'] = 1, ['r'] = 1, ['s'] = 1, ['t'] = 1, ['u'] = 1,
+	['v'] = 1, ['w'] = 1, ['x'] = 1, ['y'] = 1, ['z'] = 1, ['N'] = 2,
+};
+
+static void pyfastx_mask_track_reset(pyfastx_MaskTrack *track) {
+	track->start = -1;
+	track->last = 0;
+	track->packed.l = 0;
+}
+
+//start a run at pos or end the current run before pos
+static void pyfastx_mask_track_toggle(pyfastx_MaskTrack *track, Py_ssize_t pos) {
+	if (track->start < 0) {
+		track->start = pos;
+	} else {
+		pyfastx_varint_put(&track->packed, track->start - track->last);
+		pyfastx_varint_put(&track->packed, pos - track->start);
+		track->last = pos;
+		track->start = -1;
+	}
+}
+
+/*
+scan bases of one line starting at 0-based position pos of sequence, runs
+are only opened or closed where the flags of adjacent bases differ
+@param state, flags of the last base scanned
+*/
+static void pyfastx_mask_scan(pyfastx_MaskTrack *tracks, int *state, Py_ssize_t pos, const char *s, Py_ssize_t l) {
+	Py_ssize_t i;
+	int f;
+
+	for (i = 0; i < l; ++i) {
+		f = mask_flags[(unsigned char)s[i]];
+
+		if (f != *state) {
+			if ((f ^ *state) & 1) {
+				pyfastx_mask_track_toggle(&tracks[PYFASTX_MASK_SOFT], pos + i);
+			}
+
+			if ((f ^ *state) & 2) {
+				pyfastx_mask_track_toggle(&tracks[PYFASTX_MASK_GAP], pos + i);
+			}
+
+			*state = f;
+		}
+	}
+}
+
+//close runs at the end of sequence and save its tracks
+static void pyfastx_mask_write(sqlite3_stmt *stmt, Py_ssize_t seqid, pyfastx_MaskTrack *tracks, int *state, Py_ssize_t seq_len) {
+	int i;
+
+	for (i = 0; i < 2; ++i) {
+		if (tracks[i].start >= 0) {
+			pyfastx_mask_track_toggle(&tracks[i], seq_len);
+		}
+	}
+
+	sqlite3_bind_int64(stmt, 1, seqid);
+	sqlite3_bind_blob(stmt, 2, tracks[PYFASTX_MASK_SOFT].packed.s, tracks[PYFASTX_MASK_SOFT].packed.l, NULL);
+	sqlite3_bind_blob(stmt, 3, tracks[PYFASTX_MASK_GAP].packed.s, tracks[PYFASTX_MASK_GAP].packed.l, NULL);
+	sqlite3_step(stmt);
+	sqlite3_reset(stmt);
+
+	pyfastx_mask_track_reset(&tracks[PYFASTX_MASK_SOFT]);
+	pyfastx_mask_track_reset(&tracks[PYFASTX_MASK_GAP]);
+	*state = 0;
+}
+
+/*
+record soft-masked runs and gap runs of each sequence into mask table in a
+single pass over file, intervals of a sequence never change once indexed
+*/
+void pyfastx_mask_calc(pyfastx_Index *index) {
+	int ret;
+	int state = 0;
+
+	const char *sql;
+	sqlite3_stmt *stmt;
+
+	kstream_t* ks;
+	kstring_t line = {0, 0, 0};
+
+	Py_ssize_t l;
+	Py_ssize_t pos = 0;
+	Py_ssize_t seqid = 0;
+
+	pyfastx_MaskTrack tracks[2] = {{-1, 0, {0, 0, 0}}, {-1, 0, {0, 0, 0}}};
+
+	if (index->mask_index) {
+		return;
+	}
+
+	//index files created by old versions have no mask table
+	sql = "CREATE TABLE IF NOT EXISTS mask (ID INTEGER PRIMARY KEY, soft BLOB, gap BLOB);";
+
+	PYFASTX_SQLITE_CALL(
+		sqlite3_exec(index->index_db, sql, NULL, NULL, NULL);
+		ret = sqlite3_prepare_v2(index->index_db, "SELECT ID FROM mask LIMIT 1", -1, &stmt, NULL);
+
+		if (ret == SQLITE_OK) {
+			ret = sqlite3_step(stmt);
+		}
+
+		sqlite3_finalize(stmt);
+	);
+
+	if (ret == SQLITE_ROW) {
+		index->mask_index = 1;
+		return;
+	}
+
+	stmt = NULL;
+
+	sql = "PRAGMA synchronous=OFF;BEGIN TRANSACTION;";
+	PYFASTX_SQLITE_CALL(sqlite3_exec(index->index_db, sql, NULL, NULL, NULL));
+
+	sql = "INSERT INTO mask VALUES (?,?,?);";
+	PYFASTX_SQLITE_CALL(sqlite3_prepare_v2(index->index_db, sql, -1, &stmt, NULL));
+
+	pyfastx_stream_rewind(index->gzfd);
+	pyfastx_stream_readahead(index->gzfd, 1);
+	ks = ks_init(index->gzfd);
+
+	Py_BEGIN_ALLOW_THREADS
+
+	while (ks_getuntil(ks, '\n', &line, 0) >= 0) {
+		if (line.s[0] == 62) {
+			if (seqid > 0) {
+				pyfastx_mask_write(stmt, seqid, tracks, &state, pos);
+			}
+
+			pos = 0;
+			seqid++;
+			continue;
+		}
+
+		l = line.l;
+
+		if (l && line.s[l-1] == '\r') {
+			--l;
+		}
+
+		pyfastx_mask_scan(tracks, &state, pos, line.s, l);
+		pos += l;
+	}
+
+	if (seqid > 0) {
+		pyfastx_mask_write(stmt, seqid, tracks, &state, pos);
+	}
+
+	sqlite3_finalize(stmt);
+	sqlite3_exec(index->index_db, "COMMIT;", NULL, NULL, NULL);
+
+	Py_END_ALLOW_THREADS
+
+	pyfastx_stream_readahead(index->gzfd, 0);
+	index->mask_index = 1;
+	ks_destroy(ks);
+	free(line.s);
+	free(tracks[PYFASTX_MASK_SOFT].packed.s);
+	free(tracks[PYFASTX_MASK_GAP].packed.s);
+}
+
+static void pyfastx_interval_buffer_add(pyfastx_IntervalBuffer *buf, Py_ssize_t index, Py_ssize_t start, Py_ssize_t end) {
+	if (buf->n == buf->m) {
+		buf->m = buf->m ? buf->m * 2 : 1024;
+		buf->indexes = (int64_t *)realloc(buf->indexes, buf->m * sizeof(int64_t));
+		buf->starts = (int64_t *)realloc(buf->starts, buf->m * sizeof(int64_t));
+		buf->ends = (int64_t *)realloc(buf->ends, buf->m * sizeof(int64_t));
+
+		if (!buf->indexes || !buf->starts || !buf->ends) {
+			buf->error = 1;
+			buf->n = 0;
+			return;
+		}
+	}
+
+	buf->indexes[buf->n] = index;
+	buf->starts[buf->n] = start;
+	buf->ends[buf->n] = end;
+	++buf->n;
+}
+
+//decode runs of one sequence overlapping 0-based region [start, end)
+static void pyfastx_mask_unpack(pyfastx_IntervalBuffer *buf, Py_ssize_t index, const unsigned char *p, Py_ssize_t bytes, Py_ssize_t start, Py_ssize_t end) {
+	const unsigned char *e = p + bytes;
+	Py_ssize_t s = 0;
+	size_t dist;
+	size_t len;
+
+	while (p < e && !buf->error) {
+		p = pyfastx_varint_get(p, e, &dist);
+		p = pyfastx_varint_get(p, e, &len);
+		s += dist;
+
+		if (s >= end) {
+			break;
+		}
+
+		if (s + (Py_ssize_t)len > start) {
+			pyfastx_interval_buffer_add(buf, index, s + 1, s + len);
+		}
+
+		s += len;
+	}
+}
+
+static PyObject *pyfastx_intervals_new(pyfastx_IntervalBuffer *buf) {
+	pyfastx_Intervals *obj = PyObject_New(pyfastx_Intervals, &pyfastx_IntervalsType);
+
+	if (!obj) {
+		return NULL;
+	}
+
+	obj->count = buf->n;
+	obj->indexes = PyBytes_FromStringAndSize((char *)buf->indexes, buf->n * sizeof(int64_t));
+	obj->starts = PyBytes_FromStringAndSize((char *)buf->starts, buf->n * sizeof(int64_t));
+	obj->ends = PyBytes_FromStringAndSize((char *)buf->ends, buf->n * sizeof(int64_t));
+
+	if (!obj->indexes || !obj->starts || !obj->ends) {
+		Py_DECREF(obj);
+		return NULL;
+	}
+
+	return (PyObject *)obj;
+}
+
+/*
+get intervals of track overlapping 0-based region [start, end) of sequences
+with id from first to last, intervals are calculated on the first call
+*/
+PyObject *pyfastx_mask_intervals(pyfastx_Index *index, Py_ssize_t first, Py_ssize_t last, Py_ssize_t start, Py_ssize_t end, int track) {
+	int ret;
+	const char *sql;
+	sqlite3_stmt *stmt;
+	pyfastx_IntervalBuffer buf = {0};
+	PyObject *obj = NULL;
+
+	pyfastx_mask_calc(index);
+
+	if (track == PYFASTX_MASK_SOFT) {
+		sql = "SELECT ID, soft FROM mask WHERE ID BETWEEN ? AND ? ORDER BY ID";
+	} else {
+		sql = "SELECT ID, gap FROM mask WHERE ID BETWEEN ? AND ? ORDER BY ID";
+	}
+
+	PYFASTX_SQLITE_CALL(
+		ret = sqlite3_prepare_v2(index->index_db, sql, -1, &stmt, NULL);
+		sqlite3_bind_int64(stmt, 1, first);
+		sqlite3_bind_int64(stmt, 2, last);
+	);
+
+	if (ret != SQLITE_OK) {
+		PyErr_SetString(PyExc_RuntimeError, "can not read intervals from index");
+		return NULL;
+	}
+
+	Py_BEGIN_ALLOW_THREADS
+	while (!buf.error && sqlite3_step(stmt) == SQLITE_ROW) {
+		pyfastx_mask_unpack(&buf, sqlite3_column_int64(stmt, 0) - 1,
+			(const unsigned char *)sqlite3_column_blob(stmt, 1),
+			sqlite3_column_bytes(stmt, 1), start, end);
+	}
+	sqlite3_finalize(stmt);
+	Py_END_ALLOW_THREADS
+
+	if (buf.error) {
+		PyErr_NoMemory();
+	} else {
+		obj = pyfastx_intervals_new(&buf);
+	}
+
+	free(buf.indexes);
+	free(buf.starts);
+	free(buf.ends);
+	return obj;
+}
+
+void pyfastx_intervals_dealloc(pyfastx_Intervals *self) {
+	Py_XDECREF(self->indexes);
+	Py_XDECREF(self->starts);
+	Py_XDECREF(self->ends);
+	PyObject_Del(self);
+}
+
+Py_ssize_t pyfastx_intervals_length(pyfastx_Intervals *self) {
+	return self->count;
+}
+
+PyObject *pyfastx_intervals_item(pyfastx_Intervals *self, Py_ssize_t i) {
+	if (i < 0 || i >= self->count) {
+		PyErr_SetString(PyExc_IndexError, "index out of range");
+		return NULL;
+	}
+
+	return Py_BuildValue("LLL",
+		(long long)((int64_t *)PyBytes_AS_STRING(self->indexes))[i],
+		(long long)((int64_t *)PyBytes_AS_STRING(self->starts))[i],
+		(long long)((int64_t *)PyBytes_AS_STRING(self->ends))[i]
+	);
+}
+
+//expose bytes as typed memoryview
+static PyObject *pyfastx_intervals_view(PyObject *data, const char *format) {
+	PyObject *view = PyMemoryView_FromObject(data);
+	PyObject *ret;
+
+	if (!view) {
+		return NULL;
+	}
+
+	ret = PyObject_CallMethod(view, "cast", "s", format);
+	Py_DECREF(view);
+	return ret;
+}
+
+PyObject *pyfastx_intervals_indexes(pyfastx_Intervals *self, void* closure) {
+	return pyfastx_intervals_view(self->indexes, "q");
+}
+
+PyObject *pyfastx_intervals_starts(pyfastx_Intervals *self, void* closure) {
+	return pyfastx_intervals_view(self->starts, "q");
+}
+
+PyObject *pyfastx_intervals_ends(pyfastx_Intervals *self, void* closure) {
+	return pyfastx_intervals_view(self->ends, "q");
+}
+
+//total bases covered by intervals
+PyObject *pyfastx_intervals_bases(pyfastx_Intervals *self, void* closure) {
+	Py_ssize_t i;
+	Py_ssize_t bases = 0;
+	const int64_t *starts = (const int64_t *)PyBytes_AS_STRING(self->starts);
+	const int64_t *ends = (const int64_t *)PyBytes_AS_STRING(self->ends);
+
+	for (i = 0; i < self->count; ++i) {
+		bases += ends[i] - starts[i] + 1;
+	}
+
+	return Py_BuildValue("n", bases);
+}
+
+PyObject *pyfastx_intervals_repr(pyfastx_Intervals *self) {
+	return PyUnicode_FromFormat("<Intervals> %zd intervals", self->count);
+}
+
+static PyGetSetDef pyfastx_intervals_getsets[] = {
+	{"indexes", (getter)pyfastx_intervals_indexes, NULL, NULL, NULL},
+	{"starts", (getter)pyfastx_intervals_starts, NULL, NULL, NULL},
+	{"ends", (getter)pyfastx_intervals_ends, NULL, NULL, NULL},
+	{"bases", (getter)pyfastx_intervals_bases, NULL, NULL, NULL},
+	{NULL}
+};
+
+static PySequenceMethods pyfastx_intervals_as_sequence = {
+	.sq_length = (lenfunc)pyfastx_intervals_length,
+	.sq_item = (ssizeargfunc)pyfastx_intervals_item,
+};
+
+PyTypeObject pyfastx_IntervalsType = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "Intervals",
+	.tp_basicsize = sizeof(pyfastx_Intervals),
+	.tp_dealloc = (destructor)pyfastx_intervals_dealloc,
+	.tp_repr = (reprfunc)pyfastx_intervals_repr,
+	.tp_as_sequence = &pyfastx_intervals_as_sequence,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_getset = pyfastx_intervals_getsets,
+};
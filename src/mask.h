@@ -0,0 +1,55 @@
+#ifndef PYFASTX_MASK_H
+#define PYFASTX_MASK_H
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "kseq.h"
+#include "index.h"
+
+//soft-masked runs of lowercase letters and gap runs of N or n
+#define PYFASTX_MASK_SOFT 0
+#define PYFASTX_MASK_GAP 1
+
+//run of one track recorded while lines of sequence are scanned
+typedef struct {
+	//0-based start of current run, -1 if not in a run
+	Py_ssize_t start;
+
+	//end of the last run
+	Py_ssize_t last;
+
+	//runs packed as varints of distance from the last run and length
+	kstring_t packed;
+
+} pyfastx_MaskTrack;
+
+typedef struct {
+	int64_t *indexes;
+	int64_t *starts;
+	int64_t *ends;
+	Py_ssize_t n;
+	Py_ssize_t m;
+
+	//failed to allocate memory
+	int error;
+
+} pyfastx_IntervalBuffer;
+
+typedef struct {
+	PyObject_HEAD
+
+	//number of intervals
+	Py_ssize_t count;
+
+	//0-based index of sequence, 1-based start and end of interval
+	PyObject *indexes;
+	PyObject *starts;
+	PyObject *ends;
+
+} pyfastx_Intervals;
+
+extern PyTypeObject pyfastx_IntervalsType;
+
+void pyfastx_mask_calc(pyfastx_Index *index);
+PyObject *pyfastx_mask_intervals(pyfastx_Index *index, Py_ssize_t first, Py_ssize_t last, Py_ssize_t start, Py_ssize_t end, int track);
+
+#endif
@@ -7,9 +7,19 @@
 #include "sequence.h"
 #include "fakeys.h"
 #include "fqkeys.h"
+#include "batch.h"
+#include "fqpair.h"
+#include "range.h"
+#include "kmer.h"
+#include "sketch.h"
+#include "motif.h"
+#include "profile.h"
+#include "mask.h"
+#include "arrow.h"
 #include "version.h"
 #include "sqlite3.h"
 #include "zlib.h"
+#include "zstd.h"
 
 PyObject *pyfastx_version(PyObject *self, PyObject *args, PyObject *kwargs)	{
 	int debug = 0;
@@ -21,7 +31,7 @@ PyObject *pyfastx_version(PyObject *self, PyObject *args, PyObject *kwargs)	{
 	}
 
 	if (debug) {
-		return PyUnicode_FromFormat("pyfastx: %s; zlib: %s; sqlite: %s; zran: %s", PYFASTX_VERSION, ZLIB_VERSION, SQLITE_VERSION, ZRAN_VERSION);
+		return PyUnicode_FromFormat("pyfastx: %s; zlib: %s; sqlite: %s; zran: %s; zstd: %s", PYFASTX_VERSION, ZLIB_VERSION, SQLITE_VERSION, ZRAN_VERSION, ZSTD_VERSION_STRING);
 	}
 
 	return Py_BuildValue("s", PYFASTX_VERSION);
@@ -41,8 +51,55 @@ PyObject *pyfastx_gzip_check(PyObject *self, PyObject *args) {
 	Py_RETURN_FALSE;
 }
 
+PyObject *pyfastx_zstd_check(PyObject *self, PyObject *args) {
+	PyObject *file_name;
+
+	if (!PyArg_ParseTuple(args, "O", &file_name)) {
+		return NULL;
+	}
+
+	if (is_zstd_format(file_name)) {
+		Py_RETURN_TRUE;
+	}
+
+	Py_RETURN_FALSE;
+}
+
+PyObject *pyfastx_inflate_backend_switch(PyObject *self, PyObject *args, PyObject *kwargs) {
+	char *name = NULL;
+
+	static char* keywords[] = {"name", NULL};
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|s", keywords, &name)) {
+		return NULL;
+	}
+
+	if (name) {
+		if (strcmp(name, "zlib") == 0) {
+			pyfastx_inflate_backend = PYFASTX_INFLATE_ZLIB;
+		} else if (strcmp(name, "libdeflate") == 0) {
+#ifdef PYFASTX_LIBDEFLATE
+			pyfastx_inflate_backend = PYFASTX_INFLATE_LIBDEFLATE;
+#else
+			PyErr_SetString(PyExc_ValueError, "pyfastx was built without libdeflate");
+			return NULL;
+#endif
+		} else {
+			PyErr_Format(PyExc_ValueError, "unknown inflate backend %s", name);
+			return NULL;
+		}
+	}
+
+	if (pyfastx_inflate_backend == PYFASTX_INFLATE_LIBDEFLATE) {
+		return Py_BuildValue("s", "libdeflate");
+	}
+
+	return Py_BuildValue("s", "zlib");
+}
+
 PyObject *pyfastx_reverse_complement(PyObject *self, PyObject *args) {
 	const char *s;
+	Py_ssize_t l;
 
 	PyObject *seq_obj;
 	PyObject *rc_obj;
@@ -51,17 +108,35 @@ PyObject *pyfastx_reverse_complement(PyObject *self, PyObject *args) {
 		return NULL;
 	}
 
-	s = PyUnicode_AsUTF8(seq_obj);
-	rc_obj = PyUnicode_FromString(s);
-	s = PyUnicode_AsUTF8(rc_obj);
-	reverse_complement_seq(s);
+	s = PyUnicode_AsUTF8AndSize(seq_obj, &l);
+
+	if (s == NULL) {
+		return NULL;
+	}
+
+	if (!PyUnicode_IS_ASCII(seq_obj)) {
+		PyErr_SetString(PyExc_ValueError, "sequence should only contain ASCII characters");
+		return NULL;
+	}
+
+	rc_obj = PyUnicode_New(l, 127);
+
+	if (rc_obj == NULL) {
+		return NULL;
+	}
+
+	memcpy(PyUnicode_1BYTE_DATA(rc_obj), s, l);
+	reverse_complement_seq((char *)PyUnicode_1BYTE_DATA(rc_obj), l);
 	return rc_obj;
 }
 
 static PyMethodDef module_methods[] = {
 	{"version", (PyCFunction)pyfastx_version, METH_VARARGS | METH_KEYWORDS, NULL},
 	{"gzip_check", (PyCFunction)pyfastx_gzip_check, METH_VARARGS, NULL},
+	{"zstd_check", (PyCFunction)pyfastx_zstd_check, METH_VARARGS, NULL},
+	{"inflate_backend", (PyCFunction)pyfastx_inflate_backend_switch, METH_VARARGS | METH_KEYWORDS, NULL},
 	{"reverse_complement", (PyCFunction)pyfastx_reverse_complement, METH_VARARGS, NULL},
+	{"kmer_decode", (PyCFunction)pyfastx_kmer_decode, METH_VARARGS, NULL},
 	{NULL, NULL, 0, NULL}
 };
 
@@ -81,6 +156,9 @@ static PyObject* pyfastx_module_init(void){
 		return NULL;
 	}
 
+	//select sequence kernels supported by cpu
+	pyfastx_simd_init();
+
 	if(PyType_Ready(&pyfastx_FastaType) < 0){
 		return NULL;
 	}
@@ -104,6 +182,12 @@ static PyObject* pyfastx_module_init(void){
 	}
 	Py_INCREF(&pyfastx_SequenceType);
 	PyModule_AddObject(module, "Sequence", (PyObject *)&pyfastx_SequenceType);
+
+	if (PyType_Ready(&pyfastx_SequenceWindowsType) < 0) {
+		return NULL;
+	}
+	Py_INCREF(&pyfastx_SequenceWindowsType);
+	PyModule_AddObject(module, "SequenceWindows", (PyObject *)&pyfastx_SequenceWindowsType);
 	
 	if(PyType_Ready(&pyfastx_ReadType) < 0){
 		return NULL;
@@ -123,6 +207,84 @@ static PyObject* pyfastx_module_init(void){
 	Py_INCREF(&pyfastx_FastqKeysType);
 	PyModule_AddObject(module, "FastqKeys", (PyObject *)&pyfastx_FastqKeysType);
 
+	if (PyType_Ready(&pyfastx_BatchType) < 0) {
+		return NULL;
+	}
+	Py_INCREF(&pyfastx_BatchType);
+	PyModule_AddObject(module, "Batch", (PyObject *)&pyfastx_BatchType);
+
+	if (PyType_Ready(&pyfastx_BatchIterType) < 0) {
+		return NULL;
+	}
+	Py_INCREF(&pyfastx_BatchIterType);
+	PyModule_AddObject(module, "BatchIterator", (PyObject *)&pyfastx_BatchIterType);
+
+	if (PyType_Ready(&pyfastx_FastqPairType) < 0) {
+		return NULL;
+	}
+	Py_INCREF(&pyfastx_FastqPairType);
+	PyModule_AddObject(module, "FastqPair", (PyObject *)&pyfastx_FastqPairType);
+
+	if (PyType_Ready(&pyfastx_FastqPairBatchIterType) < 0) {
+		return NULL;
+	}
+	Py_INCREF(&pyfastx_FastqPairBatchIterType);
+	PyModule_AddObject(module, "FastqPairBatchIterator", (PyObject *)&pyfastx_FastqPairBatchIterType);
+
+	if (PyType_Ready(&pyfastx_RangeIterType) < 0) {
+		return NULL;
+	}
+	Py_INCREF(&pyfastx_RangeIterType);
+	PyModule_AddObject(module, "RangeIterator", (PyObject *)&pyfastx_RangeIterType);
+
+	if (PyType_Ready(&pyfastx_KmerIterType) < 0) {
+		return NULL;
+	}
+	Py_INCREF(&pyfastx_KmerIterType);
+	PyModule_AddObject(module, "KmerIterator", (PyObject *)&pyfastx_KmerIterType);
+
+	if (PyType_Ready(&pyfastx_KmerCountsType) < 0) {
+		return NULL;
+	}
+	Py_INCREF(&pyfastx_KmerCountsType);
+	PyModule_AddObject(module, "KmerCounts", (PyObject *)&pyfastx_KmerCountsType);
+
+	if (PyType_Ready(&pyfastx_MinimizerIterType) < 0) {
+		return NULL;
+	}
+	Py_INCREF(&pyfastx_MinimizerIterType);
+	PyModule_AddObject(module, "MinimizerIterator", (PyObject *)&pyfastx_MinimizerIterType);
+
+	if (PyType_Ready(&pyfastx_SketchType) < 0) {
+		return NULL;
+	}
+	Py_INCREF(&pyfastx_SketchType);
+	PyModule_AddObject(module, "Sketch", (PyObject *)&pyfastx_SketchType);
+
+	if (PyType_Ready(&pyfastx_MotifHitsType) < 0) {
+		return NULL;
+	}
+	Py_INCREF(&pyfastx_MotifHitsType);
+	PyModule_AddObject(module, "MotifHits", (PyObject *)&pyfastx_MotifHitsType);
+
+	if (PyType_Ready(&pyfastx_GCProfileType) < 0) {
+		return NULL;
+	}
+	Py_INCREF(&pyfastx_GCProfileType);
+	PyModule_AddObject(module, "GCProfile", (PyObject *)&pyfastx_GCProfileType);
+
+	if (PyType_Ready(&pyfastx_IntervalsType) < 0) {
+		return NULL;
+	}
+	Py_INCREF(&pyfastx_IntervalsType);
+	PyModule_AddObject(module, "Intervals", (PyObject *)&pyfastx_IntervalsType);
+
+	if (PyType_Ready(&pyfastx_TableType) < 0) {
+		return NULL;
+	}
+	Py_INCREF(&pyfastx_TableType);
+	PyModule_AddObject(module, "Table", (PyObject *)&pyfastx_TableType);
+
 	PyModule_AddStringConstant(module, "__version__", PYFASTX_VERSION);
 
 	if (!PyErr_Occurred()) {
@@ -0,0 +1,864 @@
+#include "motif.h"
+#include "util.h"
+
+/*
+bases matched by IUPAC codes, A:1 C:2 G:4 T/U:8
+
+References:
+https://www.bioinformatics.org/sms/iupac.html
+*/
+static const uint8_t iupac_bases[128] = {
+	['A'] = 1, ['C'] = 2, ['G'] = 4, ['T'] = 8, ['U'] = 8,
+	['M'] = 3, ['R'] = 5, ['W'] = 9, ['S'] = 6, ['Y'] = 10, ['K'] = 12,
+	['V'] = 7, ['H'] = 11, ['D'] = 13, ['B'] = 14, ['N'] = 15,
+};
+
+//set bit j of masks for the bases matched by pattern position j,
+//letters are matched case-insensitively and T also matches U
+static void pyfastx_motif_masks(uint64_t *masks, const char *pattern, int m, int iupac) {
+	int j;
+	int b;
+	uint8_t set;
+	unsigned char c;
+
+	static const char bases[] = "ACGT";
+
+	memset(masks, 0, sizeof(uint64_t) * 256);
+
+	for (j = 0; j < m; ++j) {
+		c = Py_TOUPPER(Py_CHARMASK(pattern[j]));
+		set = (iupac && c < 128) ? iupac_bases[c] : 0;
+
+		if (!set) {
+			masks[c] |= 1ULL << j;
+			masks[Py_TOLOWER(c)] |= 1ULL << j;
+			continue;
+		}
+
+		for (b = 0; b < 4; ++b) {
+			if (set & (1 << b)) {
+				masks[Py_CHARMASK(bases[b])] |= 1ULL << j;
+				masks[Py_TOLOWER(Py_CHARMASK(bases[b]))] |= 1ULL << j;
+			}
+		}
+
+		if (set & 8) {
+			masks['U'] |= 1ULL << j;
+			masks['u'] |= 1ULL << j;
+		}
+	}
+}
+
+static int pyfastx_motif_buffer_add(pyfastx_MotifBuffer *buf, Py_ssize_t index, Py_ssize_t pos, int strand) {
+	if (buf->n == buf->m) {
+		buf->m = buf->m ? buf->m * 2 : 1024;
+		buf->indexes = (int64_t *)realloc(buf->indexes, buf->m * sizeof(int64_t));
+		buf->positions = (int64_t *)realloc(buf->positions, buf->m * sizeof(int64_t));
+		buf->strands = (int8_t *)realloc(buf->strands, buf->m * sizeof(int8_t));
+
+		if (!buf->indexes || !buf->positions || !buf->strands) {
+			buf->error = 1;
+			return 0;
+		}
+	}
+
+	buf->indexes[buf->n] = index;
+	buf->positions[buf->n] = pos;
+	buf->strands[buf->n] = strand;
+	++buf->n;
+
+	return !buf->max || buf->n < buf->max;
+}
+
+/*
+scan bases with shift-and on both strands, offset is the 0-based position
+of the first base in sequence, return 0 if no more hits are wanted
+*/
+static int pyfastx_motif_scan(pyfastx_Motif *motif, pyfastx_MotifBuffer *buf, const char *seq, Py_ssize_t len, Py_ssize_t offset, Py_ssize_t index) {
+	Py_ssize_t i;
+	unsigned char c;
+	uint64_t f = motif->fstate;
+	uint64_t r = motif->rstate;
+	uint64_t hit = 1ULL << (motif->m - 1);
+	int ok = 1;
+
+	for (i = 0; i < len; ++i) {
+		c = seq[i];
+		f = ((f << 1) | 1) & motif->fwd[c];
+		r = ((r << 1) | 1) & motif->rev[c];
+
+		if ((f | r) & hit) {
+			if (f & hit) {
+				ok = pyfastx_motif_buffer_add(buf, index, offset + i - motif->m + 2, 1);
+			}
+
+			if (ok && (r & hit)) {
+				ok = pyfastx_motif_buffer_add(buf, index, offset + i - motif->m + 2, -1);
+			}
+
+			if (!ok) {
+				break;
+			}
+		}
+	}
+
+	motif->fstate = f;
+	motif->rstate = r;
+
+	return ok;
+}
+
+static PyObject *pyfastx_motif_hits_new(pyfastx_MotifBuffer *buf) {
+	pyfastx_MotifHits *obj = PyObject_New(pyfastx_MotifHits, &pyfastx_MotifHitsType);
+
+	if (!obj) {
+		return NULL;
+	}
+
+	obj->count = buf->n;
+	obj->indexes = PyBytes_FromStringAndSize((char *)buf->indexes, buf->n * sizeof(int64_t));
+	obj->positions = PyBytes_FromStringAndSize((char *)buf->positions, buf->n * sizeof(int64_t));
+	obj->strands = PyBytes_FromStringAndSize((char *)buf->strands, buf->n * sizeof(int8_t));
+
+	if (!obj->indexes || !obj->positions || !obj->strands) {
+		Py_DECREF(obj);
+		return NULL;
+	}
+
+	return (PyObject *)obj;
+}
+
+/*
+find all hits of pattern in records read by kseq, or in sequence if kseq
+is NULL, sequence is scanned in windows with shift-and states carried over
+*/
+PyObject *pyfastx_motif_search(PyObject *parent, kseq_t *kseq, PyObject *args, PyObject *kwargs) {
+	int iupac = 1;
+	int ok = 1;
+	char *strand = "both";
+	char *rc;
+	const char *pattern;
+	Py_ssize_t m;
+	Py_ssize_t index = 0;
+	Py_ssize_t pos;
+	Py_ssize_t l;
+	Py_ssize_t max_hits = 0;
+	char *window;
+
+	pyfastx_Motif motif;
+	pyfastx_MotifBuffer buf = {NULL, NULL, NULL, 0, 0, 0, 0};
+	pyfastx_SequenceWindows *windows;
+	PyObject *ret;
+
+	static char* keywords[] = {"pattern", "strand", "iupac", "max_hits", NULL};
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s#|spn", keywords, &pattern, &m, &strand, &iupac, &max_hits)) {
+		return NULL;
+	}
+
+	if (m < 1 || m > PYFASTX_MOTIF_MAX) {
+		PyErr_Format(PyExc_ValueError, "pattern length should be between 1 and %d", PYFASTX_MOTIF_MAX);
+		return NULL;
+	}
+
+	if (strcmp(strand, "+") != 0 && strcmp(strand, "-") != 0 && strcmp(strand, "both") != 0) {
+		PyErr_SetString(PyExc_ValueError, "strand should be +, - or both");
+		return NULL;
+	}
+
+	if (max_hits < 0) {
+		PyErr_SetString(PyExc_ValueError, "max_hits should not be negative");
+		return NULL;
+	}
+
+	motif.m = m;
+	motif.fstate = 0;
+	motif.rstate = 0;
+	buf.max = max_hits;
+
+	pyfastx_motif_masks(motif.fwd, pattern, m, iupac);
+
+	//hits on - strand are hits of reverse complement pattern on + strand
+	rc = (char *)malloc(m + 1);
+
+	if (!rc) {
+		return PyErr_NoMemory();
+	}
+
+	memcpy(rc, pattern, m);
+	rc[m] = '\0';
+	reverse_complement_seq(rc, m);
+	pyfastx_motif_masks(motif.rev, rc, m, iupac);
+	free(rc);
+
+	if (strand[0] == '+') {
+		memset(motif.rev, 0, sizeof(motif.rev));
+	} else if (strand[0] == '-') {
+		memset(motif.fwd, 0, sizeof(motif.fwd));
+	}
+
+	if (kseq) {
+		pyfastx_stream_rewind(kseq->f->f);
+		pyfastx_stream_readahead(kseq->f->f, 1);
+		kseq_rewind(kseq);
+
+		Py_BEGIN_ALLOW_THREADS
+		while (ok && kseq_read(kseq) >= 0) {
+			motif.fstate = 0;
+			motif.rstate = 0;
+			ok = pyfastx_motif_scan(&motif, &buf, kseq->seq.s, kseq->seq.l, 0, index++);
+		}
+		Py_END_ALLOW_THREADS
+	} else {
+		windows = pyfastx_sequence_windows_create((pyfastx_Sequence *)parent, PYFASTX_WINDOW_CHUNK, PYFASTX_WINDOW_CHUNK, 0, 0);
+
+		if (!windows) {
+			return NULL;
+		}
+
+		while (ok) {
+			pos = windows->next;
+			l = pyfastx_sequence_windows_step(windows, &window);
+
+			if (l < 0) {
+				break;
+			}
+
+			Py_BEGIN_ALLOW_THREADS
+			ok = pyfastx_motif_scan(&motif, &buf, window, l, pos, 0);
+			Py_END_ALLOW_THREADS
+		}
+
+		Py_DECREF(windows);
+
+		if (PyErr_Occurred()) {
+			goto end;
+		}
+	}
+
+	if (buf.error) {
+		PyErr_NoMemory();
+		goto end;
+	}
+
+	ret = pyfastx_motif_hits_new(&buf);
+
+	free(buf.indexes);
+	free(buf.positions);
+	free(buf.strands);
+	return ret;
+
+end:
+	free(buf.indexes);
+	free(buf.positions);
+	free(buf.strands);
+	return NULL;
+}
+
+static void pyfastx_approx_strand_reset(pyfastx_MyersStrand *st, int m) {
+	st->pv = ~0ULL;
+	st->mv = 0;
+	st->score = m;
+	st->start = -1;
+}
+
+//append string to names and return its offset, names are separated by NUL
+static Py_ssize_t pyfastx_approx_buffer_name(pyfastx_ApproxBuffer *buf, const char *name, Py_ssize_t l, const char *comment, Py_ssize_t cl) {
+	Py_ssize_t offset = buf->names.l;
+	Py_ssize_t size = offset + l + cl + 2;
+
+	if (size > buf->names.m) {
+		buf->names.m = size > buf->names.m * 2 ? size : buf->names.m * 2;
+		buf->names.s = (char *)realloc(buf->names.s, buf->names.m);
+
+		if (!buf->names.s) {
+			buf->error = 1;
+			return 0;
+		}
+	}
+
+	memcpy(buf->names.s + buf->names.l, name, l);
+	buf->names.l += l;
+
+	if (cl) {
+		buf->names.s[buf->names.l++] = ' ';
+		memcpy(buf->names.s + buf->names.l, comment, cl);
+		buf->names.l += cl;
+	}
+
+	buf->names.s[buf->names.l++] = '\0';
+
+	return offset;
+}
+
+static void pyfastx_approx_buffer_add(pyfastx_ApproxBuffer *buf, pyfastx_ApproxHit *hit) {
+	if (buf->n == buf->m) {
+		buf->m = buf->m ? buf->m * 2 : 64;
+		buf->hits = (pyfastx_ApproxHit *)realloc(buf->hits, buf->m * sizeof(pyfastx_ApproxHit));
+
+		if (!buf->hits) {
+			buf->error = 1;
+			buf->n = 0;
+			return;
+		}
+	}
+
+	buf->hits[buf->n++] = *hit;
+}
+
+//report pending hit of strand, s is 0 for + and 1 for -
+static void pyfastx_approx_flush(pyfastx_MyersStrand *st, int s, pyfastx_ApproxBuffer *buf, Py_ssize_t index, Py_ssize_t name) {
+	pyfastx_ApproxHit hit;
+
+	if (st->start < 0) {
+		return;
+	}
+
+	hit.index = index;
+	hit.start = st->start + 1;
+	hit.end = st->end + 1;
+	hit.strand = s ? -1 : 1;
+	hit.edits = st->edits;
+	hit.name = name;
+
+	pyfastx_approx_buffer_add(buf, &hit);
+	st->start = -1;
+}
+
+/*
+find the start of alignment with the fewest edits ending at seq[j] by
+dynamic programming over pattern and text from right to left, at most
+m + k bases before j are available in seq, return the number of edits
+*/
+static int pyfastx_approx_start(pyfastx_Myers *myers, uint64_t *peq, const char *seq, Py_ssize_t j, Py_ssize_t *start) {
+	int d[PYFASTX_MOTIF_MAX + 1];
+	int i;
+	int m = myers->m;
+	int diag;
+	int up;
+	int best = m + 1;
+	Py_ssize_t c;
+	Py_ssize_t l = j + 1 < m + myers->k ? j + 1 : m + myers->k;
+	Py_ssize_t gap = PY_SSIZE_T_MAX;
+	uint64_t eq;
+
+	//d[i] is edits of the last i bases of pattern against the last c bases of text
+	for (i = 0; i <= m; ++i) {
+		d[i] = i;
+	}
+
+	for (c = 1; c <= l; ++c) {
+		eq = peq[Py_CHARMASK(seq[j-c+1])];
+		diag = d[0];
+		d[0] = c;
+
+		for (i = 1; i <= m; ++i) {
+			up = d[i];
+			d[i] = diag + !((eq >> (m - i)) & 1);
+
+			if (up + 1 < d[i]) {
+				d[i] = up + 1;
+			}
+
+			if (d[i-1] + 1 < d[i]) {
+				d[i] = d[i-1] + 1;
+			}
+
+			diag = up;
+		}
+
+		//prefer the alignment with length closest to pattern
+		if (d[m] < best || (d[m] == best && (c > m ? c - m : m - c) < gap)) {
+			best = d[m];
+			gap = c > m ? c - m : m - c;
+			*start = j - c + 1;
+		}
+	}
+
+	return best;
+}
+
+/*
+scan seq[from:len] with Myers bit-vector algorithm on both strands, bases
+before from are context of alignments, offset is the 0-based position of
+seq[0] in sequence, hits with the same start are merged into the one with
+the fewest edits
+*/
+static void pyfastx_approx_scan(pyfastx_Myers *myers, pyfastx_MyersStrand *strands, pyfastx_ApproxBuffer *buf, const char *seq, Py_ssize_t from, Py_ssize_t len, Py_ssize_t offset, Py_ssize_t index, Py_ssize_t name) {
+	int s;
+	int edits;
+	uint64_t eq, xv, xh, ph, mh;
+	uint64_t hb = 1ULL << (myers->m - 1);
+	Py_ssize_t j;
+	Py_ssize_t start;
+	pyfastx_MyersStrand *st;
+
+	for (s = 0; s < 2; ++s) {
+		if (!myers->strands[s]) {
+			continue;
+		}
+
+		st = &strands[s];
+
+		for (j = from; j < len; ++j) {
+			eq = myers->masks[s][Py_CHARMASK(seq[j])];
+			xv = eq | st->mv;
+			xh = (((eq & st->pv) + st->pv) ^ st->pv) | eq;
+			ph = st->mv | ~(xh | st->pv);
+			mh = st->pv & xh;
+
+			if (ph & hb) {
+				++st->score;
+			} else if (mh & hb) {
+				--st->score;
+			}
+
+			ph <<= 1;
+			mh <<= 1;
+			st->pv = mh | ~(xv | ph);
+			st->mv = ph & xv;
+
+			if (st->score > myers->k) {
+				continue;
+			}
+
+			edits = pyfastx_approx_start(myers, myers->masks[s], seq, j, &start);
+			start += offset;
+
+			if (st->start == start) {
+				if (edits < st->edits) {
+					st->end = offset + j;
+					st->edits = edits;
+				}
+			} else {
+				pyfastx_approx_flush(st, s, buf, index, name);
+				st->start = start;
+				st->end = offset + j;
+				st->edits = edits;
+			}
+		}
+	}
+}
+
+//search a record from start to end, hits are added to buf
+static void pyfastx_approx_record(pyfastx_Myers *myers, pyfastx_ApproxBuffer *buf, const char *seq, Py_ssize_t len, Py_ssize_t index, Py_ssize_t name) {
+	pyfastx_MyersStrand strands[2];
+
+	pyfastx_approx_strand_reset(&strands[0], myers->m);
+	pyfastx_approx_strand_reset(&strands[1], myers->m);
+	pyfastx_approx_scan(myers, strands, buf, seq, 0, len, 0, index, name);
+	pyfastx_approx_flush(&strands[0], 0, buf, index, name);
+	pyfastx_approx_flush(&strands[1], 1, buf, index, name);
+}
+
+typedef struct {
+	pyfastx_Myers *myers;
+	pyfastx_ApproxBuffer *merged;
+	PyThread_type_lock lock;
+} pyfastx_ApproxJob;
+
+//search records of a parsed chunk, hits of chunk are merged under lock
+void pyfastx_approx_job(pyfastx_ParallelJob *job, void *data) {
+	pyfastx_ApproxJob *ajob = (pyfastx_ApproxJob *)data;
+	pyfastx_ApproxBuffer *merged = ajob->merged;
+	pyfastx_ApproxBuffer buf = {NULL, 0, 0, {0, 0, NULL}, 0};
+	Py_ssize_t i;
+	Py_ssize_t h;
+	Py_ssize_t name;
+
+	for (i = 0; i < job->count; ++i) {
+		h = buf.n;
+		pyfastx_approx_record(ajob->myers, &buf, job->seq.data.s + job->seq.offsets[i], job->seq.offsets[i+1] - job->seq.offsets[i], job->order * PYFASTX_MOTIF_CHUNK + i, 0);
+
+		if (buf.error) {
+			break;
+		}
+
+		if (h == buf.n) {
+			continue;
+		}
+
+		PyThread_acquire_lock(ajob->lock, WAIT_LOCK);
+		name = pyfastx_approx_buffer_name(merged, job->name.data.s + job->name.offsets[i], job->name.offsets[i+1] - job->name.offsets[i], NULL, 0);
+
+		for (; h < buf.n; ++h) {
+			buf.hits[h].name = name;
+			pyfastx_approx_buffer_add(merged, &buf.hits[h]);
+		}
+		PyThread_release_lock(ajob->lock);
+	}
+
+	if (buf.error) {
+		merged->error = 1;
+	}
+
+	free(buf.hits);
+}
+
+static int pyfastx_approx_hit_cmp(const void *a, const void *b) {
+	const pyfastx_ApproxHit *x = (const pyfastx_ApproxHit *)a;
+	const pyfastx_ApproxHit *y = (const pyfastx_ApproxHit *)b;
+
+	if (x->index != y->index) {
+		return x->index < y->index ? -1 : 1;
+	}
+
+	if (x->start != y->start) {
+		return x->start < y->start ? -1 : 1;
+	}
+
+	if (x->strand != y->strand) {
+		return y->strand - x->strand;
+	}
+
+	if (x->edits != y->edits) {
+		return x->edits - y->edits;
+	}
+
+	return x->end < y->end ? -1 : x->end > y->end;
+}
+
+//sort hits and convert them to a list of (name, start, end, strand, edits),
+//only the hit with the fewest edits is kept for each start and strand
+static PyObject *pyfastx_approx_hits_list(pyfastx_ApproxBuffer *buf) {
+	Py_ssize_t i;
+	Py_ssize_t n = 0;
+	pyfastx_ApproxHit *hit;
+	PyObject *name = NULL;
+	PyObject *item;
+	PyObject *ret;
+
+	qsort(buf->hits, buf->n, sizeof(pyfastx_ApproxHit), pyfastx_approx_hit_cmp);
+
+	for (i = 0; i < buf->n; ++i) {
+		hit = &buf->hits[i];
+
+		if (n && hit->index == buf->hits[n-1].index && hit->start == buf->hits[n-1].start && hit->strand == buf->hits[n-1].strand) {
+			continue;
+		}
+
+		buf->hits[n++] = *hit;
+	}
+
+	ret = PyList_New(n);
+
+	if (!ret) {
+		return NULL;
+	}
+
+	for (i = 0; i < n; ++i) {
+		hit = &buf->hits[i];
+
+		//hits of the same sequence share name object
+		if (!i || hit->index != buf->hits[i-1].index) {
+			Py_XDECREF(name);
+			name = PyUnicode_FromString(buf->names.s + hit->name);
+
+			if (!name) {
+				Py_DECREF(ret);
+				return NULL;
+			}
+		}
+
+		item = Py_BuildValue("OLLCi", name, (long long)hit->start, (long long)hit->end, hit->strand > 0 ? '+' : '-', hit->edits);
+
+		if (!item) {
+			Py_XDECREF(name);
+			Py_DECREF(ret);
+			return NULL;
+		}
+
+		PyList_SET_ITEM(ret, i, item);
+	}
+
+	Py_XDECREF(name);
+
+	return ret;
+}
+
+/*
+find all alignments of pattern with at most max_edits mismatches, insertions
+and deletions in records read by kseq, or in sequence if kseq is NULL,
+records are searched by worker threads if threads > 1
+*/
+PyObject *pyfastx_motif_search_approx(PyObject *parent, kseq_t *kseq, int full_name, PyObject *args, PyObject *kwargs) {
+	int iupac = 1;
+	int threads = 1;
+	int max_edits = 1;
+	int error = 0;
+	char *strand = "both";
+	char *rc;
+	char *window;
+	const char *pattern;
+	Py_ssize_t m;
+	Py_ssize_t l;
+	Py_ssize_t keep;
+	Py_ssize_t pos;
+	Py_ssize_t index = 0;
+	Py_ssize_t name;
+
+	pyfastx_Myers myers;
+	pyfastx_MyersStrand strands[2];
+	pyfastx_ApproxBuffer buf = {NULL, 0, 0, {0, 0, NULL}, 0};
+	pyfastx_ApproxJob ajob;
+	pyfastx_SequenceWindows *windows;
+	pyfastx_Parallel *pool;
+	pyfastx_ParallelJob *job;
+	pyfastx_Sequence *seq;
+	kstring_t ctx = {0, 0, NULL};
+	PyObject *ret = NULL;
+
+	static char* keywords[] = {"pattern", "max_edits", "strand", "iupac", "threads", NULL};
+	static char* seq_keywords[] = {"pattern", "max_edits", "strand", "iupac", NULL};
+
+	if (kseq) {
+		if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s#|ispi", keywords, &pattern, &m, &max_edits, &strand, &iupac, &threads)) {
+			return NULL;
+		}
+	} else {
+		if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s#|isp", seq_keywords, &pattern, &m, &max_edits, &strand, &iupac)) {
+			return NULL;
+		}
+	}
+
+	if (m < 1 || m > PYFASTX_MOTIF_MAX) {
+		PyErr_Format(PyExc_ValueError, "pattern length should be between 1 and %d", PYFASTX_MOTIF_MAX);
+		return NULL;
+	}
+
+	if (max_edits < 0 || max_edits >= m) {
+		PyErr_SetString(PyExc_ValueError, "max_edits should be between 0 and pattern length - 1");
+		return NULL;
+	}
+
+	if (strcmp(strand, "+") != 0 && strcmp(strand, "-") != 0 && strcmp(strand, "both") != 0) {
+		PyErr_SetString(PyExc_ValueError, "strand should be +, - or both");
+		return NULL;
+	}
+
+	if (threads <= 0) {
+		PyErr_SetString(PyExc_ValueError, "threads must be greater than 0");
+		return NULL;
+	}
+
+	myers.m = m;
+	myers.k = max_edits;
+	myers.strands[0] = strand[0] != '-';
+	myers.strands[1] = strand[0] != '+';
+
+	pyfastx_motif_masks(myers.masks[0], pattern, m, iupac);
+
+	rc = (char *)malloc(m + 1);
+
+	if (!rc) {
+		return PyErr_NoMemory();
+	}
+
+	memcpy(rc, pattern, m);
+	rc[m] = '\0';
+	reverse_complement_seq(rc, m);
+	pyfastx_motif_masks(myers.masks[1], rc, m, iupac);
+	free(rc);
+
+	if (!kseq) {
+		seq = (pyfastx_Sequence *)parent;
+		windows = pyfastx_sequence_windows_create(seq, PYFASTX_WINDOW_CHUNK, PYFASTX_WINDOW_CHUNK, 0, 0);
+
+		if (!windows) {
+			return NULL;
+		}
+
+		name = pyfastx_approx_buffer_name(&buf, seq->name, strlen(seq->name), NULL, 0);
+		pyfastx_approx_strand_reset(&strands[0], m);
+		pyfastx_approx_strand_reset(&strands[1], m);
+
+		while (!buf.error) {
+			pos = windows->next;
+			l = pyfastx_sequence_windows_step(windows, &window);
+
+			if (l < 0) {
+				break;
+			}
+
+			//keep m + k bases of previous windows as context of alignments
+			keep = ctx.l < m + max_edits ? ctx.l : m + max_edits;
+
+			if (keep + l > ctx.m) {
+				ctx.m = keep + l;
+				ctx.s = (char *)realloc(ctx.s, ctx.m);
+
+				if (!ctx.s) {
+					buf.error = 1;
+					break;
+				}
+			}
+
+			memmove(ctx.s, ctx.s + ctx.l - keep, keep);
+			memcpy(ctx.s + keep, window, l);
+			ctx.l = keep + l;
+
+			Py_BEGIN_ALLOW_THREADS
+			pyfastx_approx_scan(&myers, strands, &buf, ctx.s, keep, ctx.l, pos - keep, 0, name);
+			Py_END_ALLOW_THREADS
+		}
+
+		pyfastx_approx_flush(&strands[0], 0, &buf, 0, name);
+		pyfastx_approx_flush(&strands[1], 1, &buf, 0, name);
+
+		Py_DECREF(windows);
+		free(ctx.s);
+
+		if (PyErr_Occurred()) {
+			goto end;
+		}
+	} else if (threads > 1) {
+		pyfastx_stream_rewind(kseq->f->f);
+		pyfastx_stream_readahead(kseq->f->f, 1);
+		kseq_rewind(kseq);
+
+		ajob.myers = &myers;
+		ajob.merged = &buf;
+		ajob.lock = PyThread_allocate_lock();
+
+		pool = ajob.lock ? pyfastx_parallel_create(kseq->f->f, threads, 0, PYFASTX_MOTIF_CHUNK, 1, 0, 0, full_name, NULL) : NULL;
+
+		if (!pool) {
+			if (ajob.lock) {
+				PyThread_free_lock(ajob.lock);
+			}
+
+			if (!PyErr_Occurred()) {
+				PyErr_SetString(PyExc_RuntimeError, "can not start searching threads");
+			}
+
+			return NULL;
+		}
+
+		pool->handler = pyfastx_approx_job;
+		pool->data = &ajob;
+
+		Py_BEGIN_ALLOW_THREADS
+		while ((job = pyfastx_parallel_next(pool)) != NULL) {
+			pyfastx_parallel_feed(pool, job);
+		}
+
+		error = pool->error;
+		pyfastx_parallel_free(pool);
+		Py_END_ALLOW_THREADS
+
+		PyThread_free_lock(ajob.lock);
+
+		if (pyfastx_parallel_raise(error) < 0) {
+			goto end;
+		}
+	} else {
+		pyfastx_stream_rewind(kseq->f->f);
+		pyfastx_stream_readahead(kseq->f->f, 1);
+		kseq_rewind(kseq);
+
+		Py_BEGIN_ALLOW_THREADS
+		while (!buf.error && kseq_read(kseq) >= 0) {
+			l = buf.n;
+			pyfastx_approx_record(&myers, &buf, kseq->seq.s, kseq->seq.l, index++, 0);
+
+			if (l < buf.n) {
+				name = pyfastx_approx_buffer_name(&buf, kseq->name.s, kseq->name.l, kseq->comment.s, full_name ? kseq->comment.l : 0);
+
+				for (; l < buf.n; ++l) {
+					buf.hits[l].name = name;
+				}
+			}
+		}
+		Py_END_ALLOW_THREADS
+	}
+
+	if (buf.error) {
+		PyErr_NoMemory();
+		goto end;
+	}
+
+	ret = pyfastx_approx_hits_list(&buf);
+
+end:
+	free(buf.hits);
+	free(buf.names.s);
+	return ret;
+}
+
+void pyfastx_motif_hits_dealloc(pyfastx_MotifHits *self) {
+	Py_XDECREF(self->indexes);
+	Py_XDECREF(self->positions);
+	Py_XDECREF(self->strands);
+	PyObject_Del(self);
+}
+
+Py_ssize_t pyfastx_motif_hits_length(pyfastx_MotifHits *self) {
+	return self->count;
+}
+
+//get (index, position, strand) of hit
+PyObject *pyfastx_motif_hits_item(pyfastx_MotifHits *self, Py_ssize_t i) {
+	if (i < 0 || i >= self->count) {
+		PyErr_SetString(PyExc_IndexError, "index out of range");
+		return NULL;
+	}
+
+	return Py_BuildValue("LLC",
+		(long long)((int64_t *)PyBytes_AS_STRING(self->indexes))[i],
+		(long long)((int64_t *)PyBytes_AS_STRING(self->positions))[i],
+		PyBytes_AS_STRING(self->strands)[i] > 0 ? '+' : '-'
+	);
+}
+
+//expose bytes as typed memoryview
+static PyObject *pyfastx_motif_hits_view(PyObject *data, const char *format) {
+	PyObject *view = PyMemoryView_FromObject(data);
+	PyObject *ret;
+
+	if (!view) {
+		return NULL;
+	}
+
+	ret = PyObject_CallMethod(view, "cast", "s", format);
+	Py_DECREF(view);
+	return ret;
+}
+
+PyObject *pyfastx_motif_hits_indexes(pyfastx_MotifHits *self, void* closure) {
+	return pyfastx_motif_hits_view(self->indexes, "q");
+}
+
+PyObject *pyfastx_motif_hits_positions(pyfastx_MotifHits *self, void* closure) {
+	return pyfastx_motif_hits_view(self->positions, "q");
+}
+
+PyObject *pyfastx_motif_hits_strands(pyfastx_MotifHits *self, void* closure) {
+	return pyfastx_motif_hits_view(self->strands, "b");
+}
+
+PyObject *pyfastx_motif_hits_repr(pyfastx_MotifHits *self) {
+	return PyUnicode_FromFormat("<MotifHits> %zd hits", self->count);
+}
+
+static PyGetSetDef pyfastx_motif_hits_getsets[] = {
+	{"indexes", (getter)pyfastx_motif_hits_indexes, NULL, NULL, NULL},
+	{"positions", (getter)pyfastx_motif_hits_positions, NULL, NULL, NULL},
+	{"strands", (getter)pyfastx_motif_hits_strands, NULL, NULL, NULL},
+	{NULL}
+};
+
+static PySequenceMethods pyfastx_motif_hits_as_sequence = {
+	.sq_length = (lenfunc)pyfastx_motif_hits_length,
+	.sq_item = (ssizeargfunc)pyfastx_motif_hits_item,
+};
+
+PyTypeObject pyfastx_MotifHitsType = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "MotifHits",
+	.tp_basicsize = sizeof(pyfastx_MotifHits),
+	.tp_dealloc = (destructor)pyfastx_motif_hits_dealloc,
+	.tp_repr = (reprfunc)pyfastx_motif_hits_repr,
+	.tp_as_sequence = &pyfastx_motif_hits_as_sequence,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_getset = pyfastx_motif_hits_getsets,
+};
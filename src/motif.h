@@ -0,0 +1,116 @@
+#ifndef PYFASTX_MOTIF_H
+#define PYFASTX_MOTIF_H
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "kseq.h"
+#include "filter.h"
+#include "sequence.h"
+#include "parallel.h"
+
+//max pattern length matched by 64-bit shift-and state
+#define PYFASTX_MOTIF_MAX 64
+
+//number of records in each chunk searched by approximate matching threads
+#define PYFASTX_MOTIF_CHUNK 16
+
+//bit-parallel matcher of pattern on both strands
+typedef struct {
+	//pattern length
+	int m;
+
+	//bit j of masks[c] is set if base c matches pattern position j,
+	//masks of a strand not searched are all zero
+	uint64_t fwd[256];
+	uint64_t rev[256];
+
+	//shift-and states carried across windows of sequence
+	uint64_t fstate;
+	uint64_t rstate;
+
+} pyfastx_Motif;
+
+//hits collected while scanning without the GIL
+typedef struct {
+	int64_t *indexes;
+	int64_t *positions;
+	int8_t *strands;
+	Py_ssize_t n;
+	Py_ssize_t m;
+
+	//stop after max hits, 0 for no limit
+	Py_ssize_t max;
+
+	//failed to allocate memory
+	int error;
+
+} pyfastx_MotifBuffer;
+
+typedef struct {
+	PyObject_HEAD
+
+	//number of hits
+	Py_ssize_t count;
+
+	//0-based index of sequence, 1-based start position of hit on
+	//forward strand and strand of hit (1 for +, -1 for -)
+	PyObject *indexes;
+	PyObject *positions;
+	PyObject *strands;
+
+} pyfastx_MotifHits;
+
+//Myers bit-vector state and pending hit of one strand
+typedef struct {
+	uint64_t pv;
+	uint64_t mv;
+	int score;
+
+	//hit reported when next hit has another start, start is -1 if none
+	Py_ssize_t start;
+	Py_ssize_t end;
+	int edits;
+
+} pyfastx_MyersStrand;
+
+//approximate matcher of pattern within max edits, shared by threads
+typedef struct {
+	int m;
+	int k;
+
+	//masks of pattern on + strand and reverse complement on - strand
+	uint64_t masks[2][256];
+	int strands[2];
+
+} pyfastx_Myers;
+
+typedef struct {
+	int64_t index;
+	int64_t start;
+	int64_t end;
+	int8_t strand;
+	int edits;
+
+	//offset of sequence name in names of buffer
+	Py_ssize_t name;
+
+} pyfastx_ApproxHit;
+
+typedef struct {
+	pyfastx_ApproxHit *hits;
+	Py_ssize_t n;
+	Py_ssize_t m;
+
+	//names of sequences with hits, separated by NUL
+	kstring_t names;
+
+	//failed to allocate memory
+	int error;
+
+} pyfastx_ApproxBuffer;
+
+extern PyTypeObject pyfastx_MotifHitsType;
+
+PyObject *pyfastx_motif_search(PyObject *parent, kseq_t *kseq, PyObject *args, PyObject *kwargs);
+PyObject *pyfastx_motif_search_approx(PyObject *parent, kseq_t *kseq, int full_name, PyObject *args, PyObject *kwargs);
+
+#endif
@@ -0,0 +1,681 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "parallel.h"
+#include "util.h"
+
+//append string to column of job, mark job with error if column data can not
+//be enlarged
+void pyfastx_parallel_append(pyfastx_ParallelJob *job, pyfastx_BatchColumn *column, char *s, Py_ssize_t l) {
+	if (!pyfastx_batch_column_append(column, s, l)) {
+		job->error = PYFASTX_PARALLEL_NOMEM;
+	}
+}
+
+//parse name and comment from header line without leading > or @
+void pyfastx_parallel_header(pyfastx_ParallelJob *job, char *s, char *eol) {
+	char *p = s;
+	char *c = NULL;
+	Py_ssize_t l = 0;
+	pyfastx_Parallel *pool = job->pool;
+
+	while (p < eol && !isspace((unsigned char)*p)) {
+		++p;
+	}
+
+	//the rest of line after separator is comment
+	if (p < eol) {
+		c = p + 1;
+		l = eol - c;
+
+		if (l > 1 && c[l-1] == '\r') {
+			--l;
+		}
+	}
+
+	pyfastx_parallel_append(job, &job->name, s, p - s);
+	job->name_len = p - s;
+
+	if (pool->full_name && l) {
+		pyfastx_parallel_append(job, &job->name, " ", 1);
+		pyfastx_parallel_append(job, &job->name, c, l);
+	}
+
+	if (pool->comment) {
+		pyfastx_parallel_append(job, &job->desc, c, l);
+		pyfastx_batch_column_valid(&job->desc, job->count, l > 0);
+	}
+}
+
+void pyfastx_parallel_finish_record(pyfastx_ParallelJob *job) {
+	pyfastx_Filter *filter = job->pool->filter;
+	Py_ssize_t n = job->count;
+	int reason;
+
+	//drop the filtered record from the end of columns
+	if (filter) {
+		reason = pyfastx_filter_test(filter, job->name.data.s + job->name.offsets[n], job->name_len,
+			job->seq.data.s + job->seq.offsets[n], job->seq.data.l - job->seq.offsets[n],
+			job->qual.data.s + job->qual.offsets[n], job->qual.data.l - job->qual.offsets[n]);
+		++job->filtered[reason];
+
+		if (reason) {
+			job->name.data.l = job->name.offsets[n];
+			job->seq.data.l = job->seq.offsets[n];
+			job->qual.data.l = job->qual.offsets[n];
+			job->desc.data.l = job->desc.offsets[n];
+			return;
+		}
+	}
+
+	++job->count;
+	job->name.offsets[job->count] = job->name.data.l;
+	job->seq.offsets[job->count] = job->seq.data.l;
+	job->qual.offsets[job->count] = job->qual.data.l;
+	job->desc.offsets[job->count] = job->desc.data.l;
+}
+
+//parse fasta records in the same way as kseq
+void pyfastx_parallel_parse_fasta(pyfastx_ParallelJob *job) {
+	char *s = job->chunk.s;
+	char *end = s + job->chunk.l;
+	char *eol;
+	int in_record = 0;
+	Py_ssize_t start = 0;
+	Py_ssize_t l;
+
+	while (s < end) {
+		eol = (char *)memchr(s, '\n', end - s);
+
+		if (!eol) {
+			eol = end;
+		}
+
+		if (*s == '>') {
+			if (in_record) {
+				pyfastx_parallel_finish_record(job);
+			}
+
+			pyfastx_parallel_header(job, s + 1, eol);
+			start = job->seq.data.l;
+			in_record = 1;
+		} else if (in_record && eol > s) {
+			l = job->seq.data.l;
+			pyfastx_parallel_append(job, &job->seq, s, eol - s);
+
+			if (job->error) {
+				return;
+			}
+
+			if (job->pool->uppercase) {
+				upper_string(job->seq.data.s + l, eol - s);
+			}
+
+			if (job->seq.data.l - start > 1 && job->seq.data.s[job->seq.data.l - 1] == '\r') {
+				--job->seq.data.l;
+			}
+		}
+
+		if (job->error) {
+			return;
+		}
+
+		s = eol + 1;
+	}
+
+	if (in_record) {
+		pyfastx_parallel_finish_record(job);
+	}
+}
+
+//append line to column in the same way as kseq that strips \r at the end
+//of accumulated string, return the new length of accumulated string, or -1
+//if column data can not be enlarged
+Py_ssize_t pyfastx_parallel_append_line(pyfastx_BatchColumn *column, Py_ssize_t len, char *s, Py_ssize_t l) {
+	if (column && !pyfastx_batch_column_append(column, s, l)) {
+		return -1;
+	}
+
+	len += l;
+
+	if (l && len > 1 && s[l-1] == '\r') {
+		--len;
+
+		if (column) {
+			--column->data.l;
+		}
+	}
+
+	return len;
+}
+
+/*
+find the end of fastq record at s in the same way as kseq_read, data before
+header sign is skipped, sequence and quality may span multiple lines, lines
+are appended to columns of job if job is not NULL, end of data is treated as
+end of file if eof is set
+@return bytes from s to the end of record, 0 if no record or more data is
+required, -1 if quality and sequence differ in length or error of job is set
+*/
+Py_ssize_t pyfastx_parallel_fastq_record(pyfastx_ParallelJob *job, char *s, char *end, int eof) {
+	char *p = s;
+	char *eol;
+	char *head;
+	Py_ssize_t slen = 0;
+	Py_ssize_t qlen = 0;
+
+	while (p < end && *p != '@' && *p != '>') {
+		++p;
+	}
+
+	if (p >= end) {
+		return 0;
+	}
+
+	head = ++p;
+	eol = (char *)memchr(head, '\n', end - head);
+
+	if (!eol) {
+		if (!eof) {
+			return 0;
+		}
+
+		eol = end;
+	}
+
+	if (job) {
+		pyfastx_parallel_header(job, head, eol);
+
+		if (job->error) {
+			return -1;
+		}
+	}
+
+	p = eol < end ? eol + 1 : end;
+
+	//sequence lines until a line starts with +, > or @, empty lines are skipped
+	while (p < end && *p != '+' && *p != '>' && *p != '@') {
+		eol = (char *)memchr(p, '\n', end - p);
+
+		if (!eol) {
+			if (!eof) {
+				return 0;
+			}
+
+			eol = end;
+		}
+
+		if (eol > p) {
+			slen = pyfastx_parallel_append_line(job ? &job->seq : NULL, slen, p, eol - p);
+
+			if (slen < 0) {
+				job->error = PYFASTX_PARALLEL_NOMEM;
+				return -1;
+			}
+		}
+
+		p = eol < end ? eol + 1 : end;
+	}
+
+	if (p >= end && !eof) {
+		return 0;
+	}
+
+	//record without quality ends at the next header as kseq does
+	if (p >= end || *p != '+') {
+		if (job) {
+			pyfastx_parallel_finish_record(job);
+		}
+
+		return p - s;
+	}
+
+	//skip separator line
+	eol = (char *)memchr(p, '\n', end - p);
+
+	if (!eol) {
+		return eof ? -1 : 0;
+	}
+
+	p = eol + 1;
+
+	//quality lines until quality is not shorter than sequence
+	do {
+		if (p >= end) {
+			if (!eof) {
+				return 0;
+			}
+
+			break;
+		}
+
+		eol = (char *)memchr(p, '\n', end - p);
+
+		if (!eol) {
+			if (!eof) {
+				return 0;
+			}
+
+			eol = end;
+		}
+
+		qlen = pyfastx_parallel_append_line(job ? &job->qual : NULL, qlen, p, eol - p);
+
+		if (qlen < 0) {
+			job->error = PYFASTX_PARALLEL_NOMEM;
+			return -1;
+		}
+
+		p = eol < end ? eol + 1 : end;
+	} while (qlen < slen);
+
+	if (qlen != slen) {
+		return -1;
+	}
+
+	if (job) {
+		pyfastx_parallel_finish_record(job);
+	}
+
+	return p - s;
+}
+
+//parse fastq records in chunk cut at record boundary
+void pyfastx_parallel_parse_fastq(pyfastx_ParallelJob *job) {
+	char *s = job->chunk.s;
+	char *end = s + job->chunk.l;
+	Py_ssize_t ret;
+
+	while (s < end) {
+		ret = pyfastx_parallel_fastq_record(job, s, end, 1);
+
+		if (ret < 0) {
+			if (!job->error) {
+				job->error = PYFASTX_PARALLEL_MALFORMED;
+			}
+
+			break;
+		}
+
+		if (ret == 0) {
+			break;
+		}
+
+		s += ret;
+	}
+}
+
+void pyfastx_parallel_worker(void *arg) {
+	pyfastx_ParallelJob *job = (pyfastx_ParallelJob *)arg;
+
+	while (1) {
+		PyThread_acquire_lock(job->start_lock, WAIT_LOCK);
+
+		if (job->exit) {
+			break;
+		}
+
+		job->count = 0;
+		job->error = 0;
+		memset(job->filtered, 0, sizeof(job->filtered));
+		job->name.data.l = 0;
+		job->seq.data.l = 0;
+		job->qual.data.l = 0;
+		job->desc.data.l = 0;
+
+		if (job->pool->format == 1) {
+			pyfastx_parallel_parse_fasta(job);
+		} else {
+			pyfastx_parallel_parse_fastq(job);
+		}
+
+		if (job->pool->handler) {
+			job->pool->handler(job, job->pool->data);
+		}
+
+		PyThread_release_lock(job->done_lock);
+	}
+
+	PyThread_release_lock(job->done_lock);
+}
+
+//cut at most size records from stream into chunk, return 0 if no data or
+//error of pool is set when buffers can not be enlarged
+int pyfastx_parallel_cut(pyfastx_Parallel *pool, kstring_t *chunk) {
+	char *p;
+	char *tmp;
+	size_t m;
+	Py_ssize_t i = 0;
+	Py_ssize_t cut = -1;
+	Py_ssize_t found = 0;
+	Py_ssize_t ret;
+
+	//start with the data left by last cut
+	tmp = chunk->s;
+	chunk->s = pool->carry.s;
+	pool->carry.s = tmp;
+	ret = chunk->m;
+	chunk->m = pool->carry.m;
+	pool->carry.m = ret;
+	chunk->l = pool->carry.l;
+	pool->carry.l = 0;
+
+	while (1) {
+		if (pool->format == 1) {
+			//record starts with > at the beginning of line
+			while (i < chunk->l) {
+				p = (char *)memchr(chunk->s + i, '>', chunk->l - i);
+
+				if (!p) {
+					i = chunk->l;
+					break;
+				}
+
+				i = p - chunk->s;
+
+				if ((i == 0 || chunk->s[i-1] == '\n') && ++found > pool->size) {
+					cut = i;
+					break;
+				}
+
+				++i;
+			}
+		} else {
+			//walk records as kseq does, so that a blank line or a record
+			//with multiple lines does not move the cut off record start
+			while (found < pool->size) {
+				ret = pyfastx_parallel_fastq_record(NULL, chunk->s + i, chunk->s + chunk->l, pool->is_eof);
+
+				if (ret <= 0) {
+					break;
+				}
+
+				i += ret;
+				++found;
+			}
+
+			if (found == pool->size) {
+				cut = i;
+			} else if (ret < 0) {
+				//malformed record is left to worker to report
+				pool->is_eof = 1;
+			}
+		}
+
+		if (cut >= 0 || pool->is_eof) {
+			break;
+		}
+
+		if (chunk->m - chunk->l < PYFASTX_PARALLEL_READ_SIZE) {
+			m = chunk->l + PYFASTX_PARALLEL_READ_SIZE;
+			tmp = (char *)realloc(chunk->s, m);
+
+			if (!tmp) {
+				goto nomem;
+			}
+
+			chunk->s = tmp;
+			chunk->m = m;
+		}
+
+		ret = pyfastx_stream_read(pool->stream, chunk->s + chunk->l, PYFASTX_PARALLEL_READ_SIZE);
+
+		if (ret <= 0) {
+			pool->is_eof = 1;
+		} else {
+			chunk->l += ret;
+		}
+	}
+
+	if (cut >= 0 && cut < chunk->l) {
+		if (pool->carry.m < chunk->l - cut) {
+			m = chunk->l - cut;
+			tmp = (char *)realloc(pool->carry.s, m);
+
+			if (!tmp) {
+				goto nomem;
+			}
+
+			pool->carry.s = tmp;
+			pool->carry.m = m;
+		}
+
+		memcpy(pool->carry.s, chunk->s + cut, chunk->l - cut);
+		pool->carry.l = chunk->l - cut;
+		chunk->l = cut;
+	}
+
+	return chunk->l > 0;
+
+//no more chunks are cut, the error is raised after parsed chunks
+nomem:
+	pool->error = PYFASTX_PARALLEL_NOMEM;
+	pool->is_eof = 1;
+	chunk->l = 0;
+	return 0;
+}
+
+//cut next chunk for job and start parsing, called without GIL
+void pyfastx_parallel_feed(pyfastx_Parallel *pool, pyfastx_ParallelJob *job) {
+	if (pyfastx_parallel_cut(pool, &job->chunk)) {
+		job->order = pool->next_order++;
+		job->state = 1;
+		PyThread_release_lock(job->start_lock);
+	} else {
+		job->state = 0;
+	}
+}
+
+//called with GIL, return NULL with MemoryError set if buffers can not be
+//allocated, or NULL without error if threads can not be started
+pyfastx_Parallel *pyfastx_parallel_create(pyfastx_Stream *stream, int threads, int ordered, Py_ssize_t size, int format, int uppercase, int comment, int full_name, pyfastx_Filter *filter) {
+	int i;
+	pyfastx_ParallelJob *job;
+	pyfastx_Parallel *pool = (pyfastx_Parallel *)calloc(1, sizeof(pyfastx_Parallel));
+
+	if (!pool) {
+		PyErr_NoMemory();
+		return NULL;
+	}
+
+	pool->stream = stream;
+	pool->ordered = ordered;
+	pool->size = size;
+	pool->format = format;
+	pool->uppercase = uppercase;
+	pool->comment = comment;
+	pool->full_name = full_name;
+	pool->filter = filter;
+	pool->end_order = PY_SSIZE_T_MAX;
+	pool->jobs = (pyfastx_ParallelJob *)calloc(threads, sizeof(pyfastx_ParallelJob));
+
+	if (!pool->jobs) {
+		free(pool);
+		PyErr_NoMemory();
+		return NULL;
+	}
+
+	kstring_init(pool->carry);
+
+	for (i = 0; i < threads; ++i) {
+		job = &pool->jobs[i];
+		job->pool = pool;
+		kstring_init(job->chunk);
+
+		if (!(pyfastx_batch_column_init(&job->name, size) & pyfastx_batch_column_init(&job->seq, size) & pyfastx_batch_column_init(&job->qual, size) & pyfastx_batch_column_init(&job->desc, size)) || !pyfastx_batch_column_nullable(&job->desc, size)) {
+			PyErr_NoMemory();
+			break;
+		}
+
+		job->start_lock = PyThread_allocate_lock();
+		job->done_lock = PyThread_allocate_lock();
+
+		if (!job->start_lock || !job->done_lock) {
+			break;
+		}
+
+		//both locks are held until they are released by the other side
+		PyThread_acquire_lock(job->start_lock, NOWAIT_LOCK);
+		PyThread_acquire_lock(job->done_lock, NOWAIT_LOCK);
+
+		if (PyThread_start_new_thread(pyfastx_parallel_worker, job) == PYTHREAD_INVALID_THREAD_ID) {
+			break;
+		}
+
+		//only jobs with running worker are freed by stopping
+		pool->threads = i + 1;
+	}
+
+	if (pool->threads < threads) {
+		if (i < threads) {
+			job = &pool->jobs[i];
+
+			if (job->start_lock) {
+				PyThread_free_lock(job->start_lock);
+			}
+
+			if (job->done_lock) {
+				PyThread_free_lock(job->done_lock);
+			}
+
+			pyfastx_batch_column_free(&job->name);
+			pyfastx_batch_column_free(&job->seq);
+			pyfastx_batch_column_free(&job->qual);
+			pyfastx_batch_column_free(&job->desc);
+		}
+
+		pyfastx_parallel_free(pool);
+		return NULL;
+	}
+
+	return pool;
+}
+
+void pyfastx_parallel_free(pyfastx_Parallel *pool) {
+	int i;
+	pyfastx_ParallelJob *job;
+
+	for (i = 0; i < pool->threads; ++i) {
+		job = &pool->jobs[i];
+
+		//wait for parsing job
+		if (job->state == 1) {
+			PyThread_acquire_lock(job->done_lock, WAIT_LOCK);
+		}
+
+		job->exit = 1;
+		PyThread_release_lock(job->start_lock);
+		PyThread_acquire_lock(job->done_lock, WAIT_LOCK);
+
+		PyThread_free_lock(job->start_lock);
+		PyThread_free_lock(job->done_lock);
+		free(job->chunk.s);
+		pyfastx_batch_column_free(&job->name);
+		pyfastx_batch_column_free(&job->seq);
+		pyfastx_batch_column_free(&job->qual);
+		pyfastx_batch_column_free(&job->desc);
+	}
+
+	free(pool->jobs);
+	free(pool->carry.s);
+	free(pool);
+}
+
+//wait for the next parsed chunk, return NULL if all chunks were parsed or
+//error was found, job should be fed again after its records were consumed
+pyfastx_ParallelJob *pyfastx_parallel_next(pyfastx_Parallel *pool) {
+	int i;
+	pyfastx_ParallelJob *job;
+	pyfastx_ParallelJob *first;
+
+	if (pool->error) {
+		return NULL;
+	}
+
+	//start idle workers, only happens at the beginning
+	if (pool->next_order == 0) {
+		for (i = 0; i < pool->threads; ++i) {
+			pyfastx_parallel_feed(pool, &pool->jobs[i]);
+		}
+	}
+
+	while (1) {
+		first = NULL;
+
+		//the parsing job with the smallest order
+		for (i = 0; i < pool->threads; ++i) {
+			job = &pool->jobs[i];
+
+			if (job->state == 1 && (!first || job->order < first->order)) {
+				first = job;
+			}
+		}
+
+		if (!first) {
+			return NULL;
+		}
+
+		job = NULL;
+
+		//take any finished job if order is not required
+		if (!pool->ordered) {
+			for (i = 0; i < pool->threads; ++i) {
+				if (pool->jobs[i].state == 1 && PyThread_acquire_lock(pool->jobs[i].done_lock, NOWAIT_LOCK)) {
+					job = &pool->jobs[i];
+					break;
+				}
+			}
+		}
+
+		if (!job) {
+			PyThread_acquire_lock(first->done_lock, WAIT_LOCK);
+			job = first;
+		}
+
+		job->state = 2;
+
+		//drop chunks after malformed record as kseq stops there
+		if (job->order > pool->end_order) {
+			job->state = 0;
+			continue;
+		}
+
+		//collect filter counts of chunk in reader
+		if (pool->filter) {
+			for (i = 0; i < PYFASTX_FILTER_REASONS; ++i) {
+				pool->filter->counts[i] += job->filtered[i];
+			}
+		}
+
+		//stop at malformed record and report it instead of the records
+		if (job->error) {
+			pool->is_eof = 1;
+			pool->carry.l = 0;
+			pool->end_order = job->order;
+			pool->error = job->error;
+			job->state = 0;
+			return NULL;
+		}
+
+		if (job->count) {
+			return job;
+		}
+
+		pyfastx_parallel_feed(pool, job);
+	}
+}
+
+//raise error of pool found in chunks, return -1 if error was raised,
+//must be called with GIL
+int pyfastx_parallel_raise(int error) {
+	if (error == PYFASTX_PARALLEL_MALFORMED) {
+		PyErr_SetString(PyExc_RuntimeError, "malformed fastq record, quality and sequence differ in length");
+		return -1;
+	}
+
+	if (error == PYFASTX_PARALLEL_NOMEM) {
+		PyErr_NoMemory();
+		return -1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,120 @@
+#ifndef PYFASTX_PARALLEL_H
+#define PYFASTX_PARALLEL_H
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "kseq.h"
+#include "stream.h"
+#include "filter.h"
+
+//bytes read from stream each time when cutting chunks
+#define PYFASTX_PARALLEL_READ_SIZE 1048576
+
+//errors found by cutting and parsing chunks
+#define PYFASTX_PARALLEL_MALFORMED 1
+#define PYFASTX_PARALLEL_NOMEM 2
+
+//a growable column filled without GIL
+typedef struct {
+	kstring_t data;
+	int64_t *offsets;
+
+	//validity bitmap with a bit for each record, NULL if not nullable
+	uint8_t *validity;
+} pyfastx_BatchColumn;
+
+struct pyfastx_Parallel;
+
+//a chunk of records parsed by one worker thread
+typedef struct {
+	//records cut at record boundary
+	kstring_t chunk;
+
+	//parsed columns
+	pyfastx_BatchColumn name;
+	pyfastx_BatchColumn seq;
+	pyfastx_BatchColumn qual;
+	pyfastx_BatchColumn desc;
+	Py_ssize_t count;
+
+	//length of name without comment in current record
+	Py_ssize_t name_len;
+
+	//number of passed and filtered records in chunk
+	Py_ssize_t filtered[PYFASTX_FILTER_REASONS];
+
+	//error found in chunk, records after it are dropped
+	int error;
+
+	//order of chunk in file
+	Py_ssize_t order;
+
+	//0: idle, 1: parsing, 2: parsed and collected by reader
+	int state;
+
+	//released by reader to start parsing and by worker when parsed
+	PyThread_type_lock start_lock;
+	PyThread_type_lock done_lock;
+
+	//tell worker thread to exit
+	int exit;
+
+	struct pyfastx_Parallel *pool;
+
+} pyfastx_ParallelJob;
+
+//chunks are cut from stream by reader and parsed by worker threads
+typedef struct pyfastx_Parallel {
+	int threads;
+
+	//output batches in file order
+	int ordered;
+
+	//1: fasta, 2: fastq
+	int format;
+	int uppercase;
+	int comment;
+	int full_name;
+
+	//filters shared by workers, counts are collected by reader
+	pyfastx_Filter *filter;
+
+	//max number of records in each chunk
+	Py_ssize_t size;
+
+	pyfastx_Stream *stream;
+
+	//data after the last cut record boundary
+	kstring_t carry;
+	int is_eof;
+
+	//order of next cut chunk
+	Py_ssize_t next_order;
+
+	//order of chunk with error
+	Py_ssize_t end_order;
+
+	//error found in chunks or by cutting, raised by pyfastx_parallel_raise
+	int error;
+
+	pyfastx_ParallelJob *jobs;
+
+	//called by worker thread after a chunk was parsed, NULL if records
+	//are only consumed by reader
+	void (*handler)(pyfastx_ParallelJob *job, void *data);
+	void *data;
+
+} pyfastx_Parallel;
+
+int pyfastx_batch_column_init(pyfastx_BatchColumn *column, Py_ssize_t size);
+void pyfastx_batch_column_free(pyfastx_BatchColumn *column);
+int pyfastx_batch_column_append(pyfastx_BatchColumn *column, char *s, Py_ssize_t l);
+int pyfastx_batch_column_nullable(pyfastx_BatchColumn *column, Py_ssize_t size);
+void pyfastx_batch_column_valid(pyfastx_BatchColumn *column, Py_ssize_t i, int valid);
+
+pyfastx_Parallel *pyfastx_parallel_create(pyfastx_Stream *stream, int threads, int ordered, Py_ssize_t size, int format, int uppercase, int comment, int full_name, pyfastx_Filter *filter);
+void pyfastx_parallel_free(pyfastx_Parallel *pool);
+pyfastx_ParallelJob *pyfastx_parallel_next(pyfastx_Parallel *pool);
+void pyfastx_parallel_feed(pyfastx_Parallel *pool, pyfastx_ParallelJob *job);
+int pyfastx_parallel_raise(int error);
+
+#endif
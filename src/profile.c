@@ -0,0 +1,364 @@
+#include "profile.h"
+#include "util.h"
+#include <math.h>
+
+//G, C and A/T are counted in the 1st, 2nd and 3rd 16-bit fields
+static const uint64_t base_fields[256] = {
+	['G'] = 1, ['g'] = 1,
+	['C'] = 1ULL << 16, ['c'] = 1ULL << 16,
+	['A'] = 1ULL << 32, ['a'] = 1ULL << 32, ['T'] = 1ULL << 32, ['t'] = 1ULL << 32,
+};
+
+//count bases by summing packed fields, unpack before 16-bit fields overflow
+static void pyfastx_profile_count(const char *s, Py_ssize_t n, pyfastx_BaseCounts *counts) {
+	Py_ssize_t i = 0;
+	Py_ssize_t e;
+	uint64_t packed;
+
+	while (i < n) {
+		e = n - i > PYFASTX_PROFILE_BLOCK ? i + PYFASTX_PROFILE_BLOCK : n;
+		packed = 0;
+
+		for (; i < e; ++i) {
+			packed += base_fields[Py_CHARMASK(s[i])];
+		}
+
+		counts->g += packed & 0xFFFF;
+		counts->c += (packed >> 16) & 0xFFFF;
+		counts->at += (packed >> 32) & 0xFFFF;
+	}
+}
+
+static int pyfastx_profile_state_init(pyfastx_ProfileState *st, Py_ssize_t window, Py_ssize_t step, Py_ssize_t seq_len, int cumulative) {
+	Py_ssize_t slots = (window + step - 1) / step + 1;
+
+	if (slots > st->slots) {
+		free(st->starts);
+		st->starts = (pyfastx_BaseCounts *)malloc(slots * sizeof(pyfastx_BaseCounts));
+		st->slots = st->starts ? slots : 0;
+
+		if (!st->starts) {
+			return 0;
+		}
+	}
+
+	st->window = window;
+	st->step = step;
+	st->seq_len = seq_len;
+	st->cumulative = cumulative;
+	st->pos = 0;
+	st->total.g = st->total.c = st->total.at = 0;
+	st->next_start = 0;
+	st->next_end = 0;
+	st->skew_sum = 0;
+
+	return 1;
+}
+
+static void pyfastx_profile_buffer_add(pyfastx_ProfileBuffer *buf, Py_ssize_t index, Py_ssize_t start, Py_ssize_t end, double gc, double skew) {
+	if (buf->n == buf->m) {
+		buf->m = buf->m ? buf->m * 2 : 1024;
+		buf->indexes = (int64_t *)realloc(buf->indexes, buf->m * sizeof(int64_t));
+		buf->starts = (int64_t *)realloc(buf->starts, buf->m * sizeof(int64_t));
+		buf->ends = (int64_t *)realloc(buf->ends, buf->m * sizeof(int64_t));
+		buf->gc = (double *)realloc(buf->gc, buf->m * sizeof(double));
+		buf->skew = (double *)realloc(buf->skew, buf->m * sizeof(double));
+
+		if (!buf->indexes || !buf->starts || !buf->ends || !buf->gc || !buf->skew) {
+			buf->error = 1;
+			buf->n = 0;
+			return;
+		}
+	}
+
+	buf->indexes[buf->n] = index;
+	buf->starts[buf->n] = start;
+	buf->ends[buf->n] = end;
+	buf->gc[buf->n] = gc;
+	buf->skew[buf->n] = skew;
+	++buf->n;
+}
+
+//window j ends at current position, its counts are the difference of
+//counts at current position and at its start
+static void pyfastx_profile_finish(pyfastx_ProfileState *st, pyfastx_ProfileBuffer *buf, Py_ssize_t index) {
+	pyfastx_BaseCounts *s = &st->starts[st->next_end % st->slots];
+	Py_ssize_t g = st->total.g - s->g;
+	Py_ssize_t c = st->total.c - s->c;
+	Py_ssize_t at = st->total.at - s->at;
+	double gc = g + c + at ? (double)(g + c) / (g + c + at) * 100 : NAN;
+	double skew = g + c ? (double)(g - c) / (g + c) : NAN;
+
+	if (st->cumulative) {
+		if (!isnan(skew)) {
+			st->skew_sum += skew;
+		}
+
+		skew = st->skew_sum;
+	}
+
+	pyfastx_profile_buffer_add(buf, index, st->next_end * st->step + 1, st->pos, gc, skew);
+	++st->next_end;
+}
+
+/*
+feed the next len bases of sequence, counts are snapshotted at the start of
+each window and windows are finished when their last base is counted, so
+each base is counted once whatever the window size and step are
+*/
+static void pyfastx_profile_feed(pyfastx_ProfileState *st, pyfastx_ProfileBuffer *buf, const char *bases, Py_ssize_t len, Py_ssize_t index) {
+	Py_ssize_t n = (st->seq_len + st->step - 1) / st->step;
+	Py_ssize_t end = st->pos + len;
+	Py_ssize_t ws;
+	Py_ssize_t we;
+	Py_ssize_t b;
+
+	bases -= st->pos;
+
+	while (!buf->error) {
+		ws = st->next_start < n ? st->next_start * st->step : PY_SSIZE_T_MAX;
+		we = st->next_end < n ? st->next_end * st->step + st->window : PY_SSIZE_T_MAX;
+
+		if (we > st->seq_len && st->next_end < n) {
+			we = st->seq_len;
+		}
+
+		b = ws < we ? ws : we;
+
+		if (b > end) {
+			break;
+		}
+
+		pyfastx_profile_count(bases + st->pos, b - st->pos, &st->total);
+		st->pos = b;
+
+		if (b == we) {
+			pyfastx_profile_finish(st, buf, index);
+		}
+
+		if (b == ws) {
+			st->starts[st->next_start % st->slots] = st->total;
+			++st->next_start;
+		}
+	}
+
+	pyfastx_profile_count(bases + st->pos, end - st->pos, &st->total);
+	st->pos = end;
+}
+
+static PyObject *pyfastx_gc_profile_new(pyfastx_ProfileBuffer *buf, Py_ssize_t window, Py_ssize_t step) {
+	pyfastx_GCProfile *obj = PyObject_New(pyfastx_GCProfile, &pyfastx_GCProfileType);
+
+	if (!obj) {
+		return NULL;
+	}
+
+	obj->count = buf->n;
+	obj->window = window;
+	obj->step = step;
+	obj->indexes = PyBytes_FromStringAndSize((char *)buf->indexes, buf->n * sizeof(int64_t));
+	obj->starts = PyBytes_FromStringAndSize((char *)buf->starts, buf->n * sizeof(int64_t));
+	obj->ends = PyBytes_FromStringAndSize((char *)buf->ends, buf->n * sizeof(int64_t));
+	obj->gc = PyBytes_FromStringAndSize((char *)buf->gc, buf->n * sizeof(double));
+	obj->skew = PyBytes_FromStringAndSize((char *)buf->skew, buf->n * sizeof(double));
+
+	if (!obj->indexes || !obj->starts || !obj->ends || !obj->gc || !obj->skew) {
+		Py_DECREF(obj);
+		return NULL;
+	}
+
+	return (PyObject *)obj;
+}
+
+/*
+compute GC content and skew of windows of records read by kseq, or of
+sequence if kseq is NULL, sequence is read from file in chunks
+*/
+PyObject *pyfastx_gc_profile(PyObject *parent, kseq_t *kseq, PyObject *args, PyObject *kwargs) {
+	Py_ssize_t window;
+	Py_ssize_t step = 0;
+	Py_ssize_t index = 0;
+	Py_ssize_t l;
+	int cumulative = 0;
+	char *bases;
+
+	pyfastx_ProfileState st = {0};
+	pyfastx_ProfileBuffer buf = {0};
+	pyfastx_SequenceWindows *windows;
+	pyfastx_Sequence *seq;
+	PyObject *ret = NULL;
+
+	static char* keywords[] = {"window", "step", "cumulative", NULL};
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n|np", keywords, &window, &step, &cumulative)) {
+		return NULL;
+	}
+
+	if (!step) {
+		step = window;
+	}
+
+	if (window <= 0 || step <= 0) {
+		PyErr_SetString(PyExc_ValueError, "window size and step must be greater than 0");
+		return NULL;
+	}
+
+	if (kseq) {
+		pyfastx_stream_rewind(kseq->f->f);
+		pyfastx_stream_readahead(kseq->f->f, 1);
+		kseq_rewind(kseq);
+
+		Py_BEGIN_ALLOW_THREADS
+		while (!buf.error && kseq_read(kseq) >= 0) {
+			if (!pyfastx_profile_state_init(&st, window, step, kseq->seq.l, cumulative)) {
+				buf.error = 1;
+				break;
+			}
+
+			pyfastx_profile_feed(&st, &buf, kseq->seq.s, kseq->seq.l, index++);
+		}
+		Py_END_ALLOW_THREADS
+	} else {
+		seq = (pyfastx_Sequence *)parent;
+
+		if (!pyfastx_profile_state_init(&st, window, step, seq->seq_len, cumulative)) {
+			return PyErr_NoMemory();
+		}
+
+		windows = pyfastx_sequence_windows_create(seq, PYFASTX_WINDOW_CHUNK, PYFASTX_WINDOW_CHUNK, 0, 0);
+
+		if (!windows) {
+			free(st.starts);
+			return NULL;
+		}
+
+		while (!buf.error && (l = pyfastx_sequence_windows_step(windows, &bases)) >= 0) {
+			Py_BEGIN_ALLOW_THREADS
+			pyfastx_profile_feed(&st, &buf, bases, l, 0);
+			Py_END_ALLOW_THREADS
+		}
+
+		Py_DECREF(windows);
+
+		if (PyErr_Occurred()) {
+			goto end;
+		}
+	}
+
+	if (buf.error) {
+		PyErr_NoMemory();
+		goto end;
+	}
+
+	ret = pyfastx_gc_profile_new(&buf, window, step);
+
+end:
+	free(st.starts);
+	free(buf.indexes);
+	free(buf.starts);
+	free(buf.ends);
+	free(buf.gc);
+	free(buf.skew);
+	return ret;
+}
+
+void pyfastx_gc_profile_dealloc(pyfastx_GCProfile *self) {
+	Py_XDECREF(self->indexes);
+	Py_XDECREF(self->starts);
+	Py_XDECREF(self->ends);
+	Py_XDECREF(self->gc);
+	Py_XDECREF(self->skew);
+	PyObject_Del(self);
+}
+
+Py_ssize_t pyfastx_gc_profile_length(pyfastx_GCProfile *self) {
+	return self->count;
+}
+
+PyObject *pyfastx_gc_profile_item(pyfastx_GCProfile *self, Py_ssize_t i) {
+	if (i < 0 || i >= self->count) {
+		PyErr_SetString(PyExc_IndexError, "index out of range");
+		return NULL;
+	}
+
+	return Py_BuildValue("LLLdd",
+		(long long)((int64_t *)PyBytes_AS_STRING(self->indexes))[i],
+		(long long)((int64_t *)PyBytes_AS_STRING(self->starts))[i],
+		(long long)((int64_t *)PyBytes_AS_STRING(self->ends))[i],
+		((double *)PyBytes_AS_STRING(self->gc))[i],
+		((double *)PyBytes_AS_STRING(self->skew))[i]
+	);
+}
+
+//expose bytes as typed memoryview
+static PyObject *pyfastx_gc_profile_view(PyObject *data, const char *format) {
+	PyObject *view = PyMemoryView_FromObject(data);
+	PyObject *ret;
+
+	if (!view) {
+		return NULL;
+	}
+
+	ret = PyObject_CallMethod(view, "cast", "s", format);
+	Py_DECREF(view);
+	return ret;
+}
+
+PyObject *pyfastx_gc_profile_indexes(pyfastx_GCProfile *self, void* closure) {
+	return pyfastx_gc_profile_view(self->indexes, "q");
+}
+
+PyObject *pyfastx_gc_profile_starts(pyfastx_GCProfile *self, void* closure) {
+	return pyfastx_gc_profile_view(self->starts, "q");
+}
+
+PyObject *pyfastx_gc_profile_ends(pyfastx_GCProfile *self, void* closure) {
+	return pyfastx_gc_profile_view(self->ends, "q");
+}
+
+PyObject *pyfastx_gc_profile_gc(pyfastx_GCProfile *self, void* closure) {
+	return pyfastx_gc_profile_view(self->gc, "d");
+}
+
+PyObject *pyfastx_gc_profile_skew(pyfastx_GCProfile *self, void* closure) {
+	return pyfastx_gc_profile_view(self->skew, "d");
+}
+
+PyObject *pyfastx_gc_profile_window(pyfastx_GCProfile *self, void* closure) {
+	return Py_BuildValue("n", self->window);
+}
+
+PyObject *pyfastx_gc_profile_step(pyfastx_GCProfile *self, void* closure) {
+	return Py_BuildValue("n", self->step);
+}
+
+PyObject *pyfastx_gc_profile_repr(pyfastx_GCProfile *self) {
+	return PyUnicode_FromFormat("<GCProfile> %zd windows of size %zd and step %zd", self->count, self->window, self->step);
+}
+
+static PyGetSetDef pyfastx_gc_profile_getsets[] = {
+	{"indexes", (getter)pyfastx_gc_profile_indexes, NULL, NULL, NULL},
+	{"starts", (getter)pyfastx_gc_profile_starts, NULL, NULL, NULL},
+	{"ends", (getter)pyfastx_gc_profile_ends, NULL, NULL, NULL},
+	{"gc", (getter)pyfastx_gc_profile_gc, NULL, NULL, NULL},
+	{"skew", (getter)pyfastx_gc_profile_skew, NULL, NULL, NULL},
+	{"window", (getter)pyfastx_gc_profile_window, NULL, NULL, NULL},
+	{"step", (getter)pyfastx_gc_profile_step, NULL, NULL, NULL},
+	{NULL}
+};
+
+static PySequenceMethods pyfastx_gc_profile_as_sequence = {
+	.sq_length = (lenfunc)pyfastx_gc_profile_length,
+	.sq_item = (ssizeargfunc)pyfastx_gc_profile_item,
+};
+
+PyTypeObject pyfastx_GCProfileType = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "GCProfile",
+	.tp_basicsize = sizeof(pyfastx_GCProfile),
+	.tp_dealloc = (destructor)pyfastx_gc_profile_dealloc,
+	.tp_repr = (reprfunc)pyfastx_gc_profile_repr,
+	.tp_as_sequence = &pyfastx_gc_profile_as_sequence,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_getset = pyfastx_gc_profile_getsets,
+};
@@ -0,0 +1,80 @@
+#ifndef PYFASTX_PROFILE_H
+#define PYFASTX_PROFILE_H
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "kseq.h"
+#include "sequence.h"
+
+//bases counted by packed 16-bit counters before unpacking
+#define PYFASTX_PROFILE_BLOCK 65535
+
+//G, C and A+T counts of bases before a position
+typedef struct {
+	Py_ssize_t g;
+	Py_ssize_t c;
+	Py_ssize_t at;
+} pyfastx_BaseCounts;
+
+//windows of one sequence updated in a single pass over its bases
+typedef struct {
+	Py_ssize_t window;
+	Py_ssize_t step;
+	Py_ssize_t seq_len;
+	int cumulative;
+
+	//counts of bases before current position
+	Py_ssize_t pos;
+	pyfastx_BaseCounts total;
+
+	//counts at the starts of windows not ended, ring of size slots
+	pyfastx_BaseCounts *starts;
+	Py_ssize_t slots;
+
+	//next window to start and next window to end
+	Py_ssize_t next_start;
+	Py_ssize_t next_end;
+
+	//sum of window skews for cumulative skew
+	double skew_sum;
+
+} pyfastx_ProfileState;
+
+typedef struct {
+	int64_t *indexes;
+	int64_t *starts;
+	int64_t *ends;
+	double *gc;
+	double *skew;
+	Py_ssize_t n;
+	Py_ssize_t m;
+
+	//failed to allocate memory
+	int error;
+
+} pyfastx_ProfileBuffer;
+
+typedef struct {
+	PyObject_HEAD
+
+	//number of windows
+	Py_ssize_t count;
+
+	//window size and step
+	Py_ssize_t window;
+	Py_ssize_t step;
+
+	//0-based index of sequence, 1-based start and end of window, GC
+	//content in percent and GC skew of window
+	PyObject *indexes;
+	PyObject *starts;
+	PyObject *ends;
+	PyObject *gc;
+	PyObject *skew;
+
+} pyfastx_GCProfile;
+
+extern PyTypeObject pyfastx_GCProfileType;
+
+PyObject *pyfastx_gc_profile(PyObject *parent, kseq_t *kseq, PyObject *args, PyObject *kwargs);
+
+#endif
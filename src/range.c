@@ -0,0 +1,260 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "range.h"
+#include "util.h"
+
+pyfastx_RangeIter *pyfastx_range_iter_create(PyObject *parent, PyObject *(*func)(pyfastx_RangeIter *)) {
+	pyfastx_RangeIter *obj = PyObject_New(pyfastx_RangeIter, &pyfastx_RangeIterType);
+
+	if (!obj) {
+		return NULL;
+	}
+
+	obj->parent = Py_NewRef(parent);
+	obj->end_id = 0;
+	obj->end_offset = 0;
+	obj->kseq = NULL;
+	obj->func = func;
+
+	return obj;
+}
+
+void pyfastx_range_iter_dealloc(pyfastx_RangeIter *self) {
+	Py_DECREF(self->parent);
+	PyObject_Del(self);
+}
+
+PyObject *pyfastx_range_iter_iter(pyfastx_RangeIter *self) {
+	Py_INCREF(self);
+	return (PyObject *)self;
+}
+
+PyObject *pyfastx_range_iter_next(pyfastx_RangeIter *self) {
+	return self->func(self);
+}
+
+//parse arguments of iter_range, ids are 1-based and inclusive, 0 means no limit
+int pyfastx_range_parse_args(PyObject *args, PyObject *kwargs, Py_ssize_t *start_id, Py_ssize_t *end_id, Py_ssize_t *shards, Py_ssize_t *shard) {
+	static char* keywords[] = {"start_id", "end_id", "shards", "shard", NULL};
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|nn$nn", keywords, start_id, end_id, shards, shard)) {
+		return 0;
+	}
+
+	if (*start_id < 0 || *end_id < 0) {
+		PyErr_SetString(PyExc_ValueError, "start_id and end_id must be positive");
+		return 0;
+	}
+
+	if (*shards < 0 || *shard < 0 || (*shards ? *shard >= *shards : *shard != 0)) {
+		PyErr_SetString(PyExc_ValueError, "shard must be in range(shards)");
+		return 0;
+	}
+
+	if (*shards && (*start_id || *end_id)) {
+		PyErr_SetString(PyExc_ValueError, "start_id and end_id can not be used together with shards");
+		return 0;
+	}
+
+	return 1;
+}
+
+//byte range [start, end) of the kth shard, the last shard is open ended
+void pyfastx_range_bounds(Py_ssize_t size, Py_ssize_t shards, Py_ssize_t shard, Py_ssize_t *start, Py_ssize_t *end) {
+	*start = size / shards * shard + size % shards * shard / shards;
+
+	if (shard == shards - 1) {
+		*end = PY_SSIZE_T_MAX;
+	} else {
+		*end = size / shards * (shard + 1) + size % shards * (shard + 1) / shards;
+	}
+}
+
+//offset returned by statement of record id
+Py_ssize_t pyfastx_range_query(sqlite3_stmt *stmt, Py_ssize_t id) {
+	Py_ssize_t offset = -1;
+
+	PYFASTX_SQLITE_CALL(
+		sqlite3_bind_int64(stmt, 1, id);
+		if (sqlite3_step(stmt) == SQLITE_ROW) {
+			offset = sqlite3_column_int64(stmt, 0);
+		}
+		sqlite3_reset(stmt);
+	);
+
+	return offset;
+}
+
+//binary search the first record starts at or after offset, record start
+//offsets increase with ids, return count + 1 if no record is found
+Py_ssize_t pyfastx_range_locate(sqlite3_stmt *stmt, Py_ssize_t count, Py_ssize_t offset) {
+	Py_ssize_t lo = 1;
+	Py_ssize_t hi = count + 1;
+	Py_ssize_t mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+
+		if (pyfastx_range_query(stmt, mid) < offset) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return lo;
+}
+
+/*
+convert the kth shard of file to record id range using index, start_sql
+gets the offset of record header and end_sql gets the end offset of
+record by id, each record belongs to the shard that its header is in
+*/
+void pyfastx_range_index_shard(sqlite3 *index_db, const char *start_sql, const char *end_sql, Py_ssize_t count, Py_ssize_t shards, Py_ssize_t shard, Py_ssize_t *start_id, Py_ssize_t *end_id) {
+	sqlite3_stmt *start_stmt;
+	sqlite3_stmt *end_stmt;
+	Py_ssize_t start;
+	Py_ssize_t end;
+	Py_ssize_t size;
+
+	PYFASTX_SQLITE_CALL(
+		sqlite3_prepare_v2(index_db, start_sql, -1, &start_stmt, NULL);
+		sqlite3_prepare_v2(index_db, end_sql, -1, &end_stmt, NULL);
+	);
+
+	size = count ? pyfastx_range_query(end_stmt, count) : 0;
+	pyfastx_range_bounds(size, shards, shard, &start, &end);
+
+	*start_id = pyfastx_range_locate(start_stmt, count, start);
+
+	if (end == PY_SSIZE_T_MAX) {
+		*end_id = count;
+	} else {
+		*end_id = pyfastx_range_locate(start_stmt, count, end) - 1;
+	}
+
+	PYFASTX_SQLITE_CALL(
+		sqlite3_finalize(start_stmt);
+		sqlite3_finalize(end_stmt);
+	);
+}
+
+//offset of record by id returned by sql
+Py_ssize_t pyfastx_range_offset(sqlite3 *index_db, const char *sql, Py_ssize_t id) {
+	sqlite3_stmt *stmt;
+	Py_ssize_t offset;
+
+	PYFASTX_SQLITE_CALL(sqlite3_prepare_v2(index_db, sql, -1, &stmt, NULL));
+	offset = pyfastx_range_query(stmt, id);
+	PYFASTX_SQLITE_CALL(sqlite3_finalize(stmt));
+
+	return offset;
+}
+
+//byte range of the kth shard of plain file
+int pyfastx_range_file_shard(FILE *fd, Py_ssize_t shards, Py_ssize_t shard, Py_ssize_t *start, Py_ssize_t *end) {
+	Py_ssize_t size;
+
+	if (FSEEK(fd, 0, SEEK_END) != 0 || (size = FTELL(fd)) < 0) {
+		PyErr_SetFromErrno(PyExc_OSError);
+		return 0;
+	}
+
+	pyfastx_range_bounds(size, shards, shard, start, end);
+
+	return 1;
+}
+
+/*
+snap offset to the first record starts at or after it in unindexed plain
+file, then seek back to the record for kseq, a fastq record is recognized
+by four lines with @ header, + separator and the same length of sequence
+and quality, format 1 is fasta and 2 is fastq, return -1 if not found
+*/
+Py_ssize_t pyfastx_range_sync(kseq_t *kseq, Py_ssize_t offset, int format) {
+	kstream_t *ks = kseq->f;
+	kstring_t line = {0, 0, 0};
+
+	//start, first char and length without \r of last four lines
+	Py_ssize_t starts[4];
+	Py_ssize_t lens[4];
+	int heads[4];
+
+	Py_ssize_t pos = offset > 0 ? offset - 1 : 0;
+	Py_ssize_t ret = -1;
+	Py_ssize_t n = 0;
+	Py_ssize_t i;
+	Py_ssize_t l;
+
+	pyfastx_stream_seek(ks->f, pos);
+	kseq_rewind(kseq);
+
+	//skip the rest of line that the byte before offset is in
+	if (offset > 0) {
+		if ((l = ks_getuntil(ks, '\n', &line, 0)) < 0) {
+			goto end;
+		}
+
+		pos += l + 1;
+	}
+
+	while ((l = ks_getuntil(ks, '\n', &line, 0)) >= 0) {
+		i = n++ % 4;
+		starts[i] = pos;
+		heads[i] = l ? line.s[0] : 0;
+		lens[i] = (l && line.s[l-1] == '\r') ? l - 1 : l;
+		pos += l + 1;
+
+		if (format == 1) {
+			if (heads[i] == '>') {
+				ret = starts[i];
+				break;
+			}
+		} else if (n >= 4) {
+			i = n % 4;
+
+			if (heads[i] == '@' && heads[(i+2)%4] == '+' && lens[(i+1)%4] == lens[(i+3)%4]) {
+				ret = starts[i];
+				break;
+			}
+		}
+	}
+
+end:
+	free(line.s);
+
+	if (ret >= 0) {
+		pyfastx_stream_seek(ks->f, ret);
+	}
+
+	kseq_rewind(kseq);
+
+	return ret;
+}
+
+//uncompressed offset of the next record to be read by kseq
+Py_ssize_t pyfastx_range_tell(kseq_t *kseq) {
+	kstream_t *ks = kseq->f;
+	Py_ssize_t offset = pyfastx_stream_tell(ks->f);
+
+	if (ks->end > ks->begin) {
+		offset -= ks->end - ks->begin;
+	}
+
+	//header sign of next fasta record has been consumed
+	if (kseq->last_char) {
+		--offset;
+	}
+
+	return offset;
+}
+
+PyTypeObject pyfastx_RangeIterType = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "RangeIterator",
+	.tp_basicsize = sizeof(pyfastx_RangeIter),
+	.tp_dealloc = (destructor)pyfastx_range_iter_dealloc,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_iter = (getiterfunc)pyfastx_range_iter_iter,
+	.tp_iternext = (iternextfunc)pyfastx_range_iter_next,
+};
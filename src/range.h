@@ -0,0 +1,39 @@
+#ifndef PYFASTX_RANGE_H
+#define PYFASTX_RANGE_H
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "sqlite3.h"
+#include "kseq.h"
+
+//iterator over records in an id range or a shard of file
+typedef struct pyfastx_RangeIter {
+	PyObject_HEAD
+
+	//parent Fasta or Fastq object
+	PyObject *parent;
+
+	//last record id to yield in indexed file
+	Py_ssize_t end_id;
+
+	//stop before the record starts at or after this offset in unindexed file
+	Py_ssize_t end_offset;
+
+	//kseq to get the offset of next record in unindexed file
+	kseq_t *kseq;
+
+	//get next record from parent
+	PyObject *(*func)(struct pyfastx_RangeIter *);
+
+} pyfastx_RangeIter;
+
+extern PyTypeObject pyfastx_RangeIterType;
+
+pyfastx_RangeIter *pyfastx_range_iter_create(PyObject *parent, PyObject *(*func)(pyfastx_RangeIter *));
+int pyfastx_range_parse_args(PyObject *args, PyObject *kwargs, Py_ssize_t *start_id, Py_ssize_t *end_id, Py_ssize_t *shards, Py_ssize_t *shard);
+void pyfastx_range_index_shard(sqlite3 *index_db, const char *start_sql, const char *end_sql, Py_ssize_t count, Py_ssize_t shards, Py_ssize_t shard, Py_ssize_t *start_id, Py_ssize_t *end_id);
+Py_ssize_t pyfastx_range_offset(sqlite3 *index_db, const char *sql, Py_ssize_t id);
+int pyfastx_range_file_shard(FILE *fd, Py_ssize_t shards, Py_ssize_t shard, Py_ssize_t *start, Py_ssize_t *end);
+Py_ssize_t pyfastx_range_sync(kseq_t *kseq, Py_ssize_t offset, int format);
+Py_ssize_t pyfastx_range_tell(kseq_t *kseq);
+
+#endif
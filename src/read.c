@@ -5,28 +5,77 @@
 #include "time.h"
 #include "structmember.h"
 
-void pyfastx_read_dealloc(pyfastx_Read *self) {
-    free(self->name);
+//freed reads kept for reuse with their string blocks
+static pyfastx_Read *pyfastx_read_freelist[PYFASTX_FREELIST_SIZE];
+static int pyfastx_read_numfree = 0;
+
+//create a read without calling type, reuse freed read if available
+pyfastx_Read *pyfastx_read_new(pyfastx_FastqMiddleware *middle) {
+    pyfastx_Read *read;
+    char *block = NULL;
+    Py_ssize_t block_size = 0;
+
+    if (pyfastx_read_numfree) {
+        read = pyfastx_read_freelist[--pyfastx_read_numfree];
+        block = read->block;
+        block_size = read->block_size;
+        PyObject_Init((PyObject *)read, &pyfastx_ReadType);
+    } else {
+        read = PyObject_New(pyfastx_Read, &pyfastx_ReadType);
 
-    if (self->seq) {
-        free(self->seq);
+        if (!read) {
+            return NULL;
+        }
     }
 
-    if (self->qual) {
-        free(self->qual);
-    }
+    memset((char *)read + sizeof(PyObject), 0, sizeof(pyfastx_Read) - sizeof(PyObject));
+    read->block = block;
+    read->block_size = block_size;
+    read->name = block;
+    read->middle = middle;
+    Py_INCREF(middle->fastq);
 
-    if (self->raw) {
-        free(self->raw);
+    return read;
+}
+
+//make sure string block has at least size bytes, name points to block,
+//return NULL and keep the old block if failed to allocate memory
+char *pyfastx_read_reserve(pyfastx_Read *self, Py_ssize_t size) {
+    char *block;
+
+    if (self->block_size < size) {
+        block = (char *)realloc(self->block, size);
+
+        if (block == NULL) {
+            return NULL;
+        }
+
+        self->block = block;
+        self->block_size = size;
     }
 
-    if (self->desc) {
+    self->name = self->block;
+    return self->block;
+}
+
+void pyfastx_read_dealloc(pyfastx_Read *self) {
+    if (!self->packed) {
+        free(self->seq);
+        free(self->qual);
         free(self->desc);
     }
 
+    free(self->raw);
+
     Py_DECREF(self->middle->fastq);
     self->middle = NULL;
 
+    if (pyfastx_read_numfree < PYFASTX_FREELIST_SIZE && self->block_size <= PYFASTX_FREELIST_BLOCK) {
+        pyfastx_read_freelist[pyfastx_read_numfree++] = self;
+        return;
+    }
+
+    free(self->block);
     Py_TYPE(self)->tp_free((PyObject *)self);
 }
 
@@ -36,113 +85,35 @@ Py_ssize_t pyfastx_read_length(pyfastx_Read *self) {
 
 void pyfastx_read_random_reader(pyfastx_Read *self, char *buff, Py_ssize_t offset, Py_ssize_t bytes) {
     if (self->middle->gzip_format) {
-        zran_seek(self->middle->gzip_index, offset, SEEK_SET, NULL);
-        zran_read(self->middle->gzip_index, buff, bytes);
+        pyfastx_gzip_index_seek(self->middle->gzip_index, offset);
+        pyfastx_gzip_index_read(self->middle->gzip_index, buff, bytes);
+    } else if (self->middle->zstd_format) {
+        pyfastx_zstd_seek(self->middle->zstd_index, offset);
+        pyfastx_zstd_read(self->middle->zstd_index, buff, bytes);
     } else {
         FSEEK(self->middle->fd, offset, SEEK_SET);
         fread(buff, bytes, 1, self->middle->fd);
     }
 }
 
-//read content from buff or file
-void pyfastx_read_continue_reader(pyfastx_Read *self) {
-    Py_ssize_t slice_offset;
-    Py_ssize_t slice_length;
-    Py_ssize_t residue_len;
-    Py_ssize_t read_len;
-    Py_ssize_t cache_len;
-    Py_ssize_t offset;
-    Py_ssize_t offset1;
-
-    if (self->raw) {
-        return;
-    }
-
-    //read raw string offset
-    offset = self->seq_offset - self->desc_len - 1;
-    offset1 = offset;
-
-    //read raw string length
-    residue_len = self->qual_offset + self->read_len - offset + 1;
-    read_len = 0;
-    cache_len = 0;
-
-    self->raw = (char *)malloc(residue_len + 2);
-
-    if (offset < self->middle->cache_soff) {
-        pyfastx_read_random_reader(self, self->raw, offset, residue_len);
-    } else {
-        while (residue_len > 0) {
-            if (offset >= self->middle->cache_soff && offset < self->middle->cache_eoff) {
-                slice_offset = offset - self->middle->cache_soff;
-                slice_length = self->middle->cache_eoff - offset;
-
-                cache_len = slice_length >= residue_len ? residue_len : slice_length;
-
-                memcpy(self->raw+read_len, self->middle->cache_buff+slice_offset, cache_len);
-                read_len += cache_len;
-                residue_len -= cache_len;
-                offset += cache_len;
-            } else {
-                self->middle->cache_soff = self->middle->cache_eoff;
-                gzread(self->middle->gzfd, self->middle->cache_buff, CACHE_SIZE);
-                self->middle->cache_eoff = gztell(self->middle->gzfd);
-
-                if (self->middle->cache_soff == self->middle->cache_eoff) {
-                    break;
-                }
-            }
-        }
-    }
-
-    self->desc = (char *)malloc(self->desc_len + 1);
-    memcpy(self->desc, self->raw, self->desc_len);
-    if (self->desc[self->desc_len-1] == '\r') {
-        self->desc[self->desc_len-1] = '\0';
-    } else {
-       self->desc[self->desc_len] = '\0';
-    }
-
-    if (self->raw[read_len-1] == '\n') {
-        self->raw[read_len] = '\0';
-    } else if (self->raw[read_len-1] == '\r') {
-        self->raw[read_len] = '\n';
-        self->raw[read_len+1] = '\0';
-    } else {
-        self->raw[read_len] = '\0';
-    }
-
-    self->seq = (char *)malloc(self->read_len + 1);
-    memcpy(self->seq, self->raw + self->seq_offset - offset1, self->read_len);
-    self->seq[self->read_len] = '\0';
-
-    self->qual = (char *)malloc(self->read_len + 1);
-    memcpy(self->qual, self->raw + self->qual_offset - offset1, self->read_len);
-    self->qual[self->read_len] = '\0';
-}
-
 PyObject* pyfastx_read_raw(pyfastx_Read *self, void* closure) {
     Py_ssize_t new_offset;
     Py_ssize_t new_bytelen;
 
     if (! self->raw) {
-        if (self->middle->iterating) {
-            pyfastx_read_continue_reader(self);
-        } else {
-            new_offset = self->seq_offset - self->desc_len - 1;
-            new_bytelen = self->qual_offset + self->read_len - new_offset + 2;
+        new_offset = self->seq_offset - self->desc_len - 1;
+        new_bytelen = self->qual_offset + self->read_len - new_offset + 2;
 
-            self->raw = (char *)malloc(new_bytelen + 1);
+        self->raw = (char *)malloc(new_bytelen + 1);
 
-            pyfastx_read_random_reader(self, self->raw, new_offset, new_bytelen);
+        pyfastx_read_random_reader(self, self->raw, new_offset, new_bytelen);
 
-            if (self->raw[new_bytelen-2] == '\n') {
-                self->raw[new_bytelen-1] = '\0';
-            } else if (self->raw[new_bytelen-2] == '\r' && self->raw[new_bytelen-1] == '\n') {
-                self->raw[new_bytelen] = '\0';
-            } else {
-                self->raw[new_bytelen-2] = '\0';
-            }
+        if (self->raw[new_bytelen-2] == '\n') {
+            self->raw[new_bytelen-1] = '\0';
+        } else if (self->raw[new_bytelen-2] == '\r' && self->raw[new_bytelen-1] == '\n') {
+            self->raw[new_bytelen] = '\0';
+        } else {
+            self->raw[new_bytelen-2] = '\0';
         }
     }
 
@@ -151,13 +122,9 @@ PyObject* pyfastx_read_raw(pyfastx_Read *self, void* closure) {
 
 void pyfastx_read_get_seq(pyfastx_Read* self) {
     if (! self->seq) {
-        if (self->middle->iterating) {
-            pyfastx_read_continue_reader(self);
-        } else {
-            self->seq = (char *)malloc(self->read_len + 1);
-            pyfastx_read_random_reader(self, self->seq, self->seq_offset, self->read_len);
-            self->seq[self->read_len] = '\0';
-        }
+        self->seq = (char *)malloc(self->read_len + 1);
+        pyfastx_read_random_reader(self, self->seq, self->seq_offset, self->read_len);
+        self->seq[self->read_len] = '\0';
     }
 }
 
@@ -176,7 +143,7 @@ PyObject* pyfastx_read_reverse(pyfastx_Read *self, void* closure) {
     data = (char *)PyUnicode_1BYTE_DATA(ret);
     memcpy(data, self->seq, self->read_len);
  
-    reverse_seq(data);
+    reverse_seq(data, self->read_len);
 
     return ret;
 }
@@ -191,7 +158,7 @@ PyObject* pyfastx_read_complement(pyfastx_Read *self, void* closure) {
     data = (char *)PyUnicode_1BYTE_DATA(ret);
     memcpy(data, self->seq, self->read_len);
 
-    complement_seq(data);
+    complement_seq(data, self->read_len);
 
     return ret;
 }
@@ -206,7 +173,7 @@ PyObject* pyfastx_read_antisense(pyfastx_Read *self, void* closure) {
     data = (char *)PyUnicode_1BYTE_DATA(ret);
     memcpy(data, self->seq, self->read_len);
 
-    reverse_complement_seq(data);
+    reverse_complement_seq(data, self->read_len);
 
     return ret;
 }
@@ -215,19 +182,15 @@ PyObject* pyfastx_read_description(pyfastx_Read *self, void* closure) {
     Py_ssize_t new_offset;
 
     if (!self->desc) {
-        if (self->middle->iterating) {
-            pyfastx_read_continue_reader(self);
-        } else {
-            new_offset = self->seq_offset - self->desc_len - 1;
-            self->desc = (char *)malloc(self->desc_len + 1);
+        new_offset = self->seq_offset - self->desc_len - 1;
+        self->desc = (char *)malloc(self->desc_len + 1);
 
-            pyfastx_read_random_reader(self, self->desc, new_offset, self->desc_len);
+        pyfastx_read_random_reader(self, self->desc, new_offset, self->desc_len);
 
-            if (self->desc[self->desc_len-1] == '\r') {
-                self->desc[self->desc_len-1] = '\0';
-            } else {
-                self->desc[self->desc_len] = '\0';
-            }
+        if (self->desc[self->desc_len-1] == '\r') {
+            self->desc[self->desc_len-1] = '\0';
+        } else {
+            self->desc[self->desc_len] = '\0';
         }
     }
 
@@ -236,13 +199,9 @@ PyObject* pyfastx_read_description(pyfastx_Read *self, void* closure) {
 
 PyObject* pyfastx_read_qual(pyfastx_Read *self, void* closure) {
     if (!self->qual) {
-        if (self->middle->iterating) {
-            pyfastx_read_continue_reader(self);
-        } else {
-            self->qual = (char *)malloc(self->read_len + 1);
-            pyfastx_read_random_reader(self, self->qual, self->qual_offset, self->read_len);
-            self->qual[self->read_len] = '\0';
-        }
+        self->qual = (char *)malloc(self->read_len + 1);
+        pyfastx_read_random_reader(self, self->qual, self->qual_offset, self->read_len);
+        self->qual[self->read_len] = '\0';
     }
 
     return Py_BuildValue("s", self->qual);
@@ -256,13 +215,9 @@ PyObject* pyfastx_read_quali(pyfastx_Read *self, void* closure) {
     PyObject *q;
 
     if (!self->qual) {
-        if (self->middle->iterating) {
-            pyfastx_read_continue_reader(self);
-        } else {
-            self->qual = (char *)malloc(self->read_len + 1);
-            pyfastx_read_random_reader(self, self->qual, self->qual_offset, self->read_len);
-            self->qual[self->read_len] = '\0';
-        }
+        self->qual = (char *)malloc(self->read_len + 1);
+        pyfastx_read_random_reader(self, self->qual, self->qual_offset, self->read_len);
+        self->qual[self->read_len] = '\0';
     }
 
     phred = self->middle->phred ? self->middle->phred : 33;
@@ -29,6 +29,12 @@ typedef struct {
 	//parent fastq
 	pyfastx_FastqMiddleware *middle;
 
+	//string block kept across reuse of object, name is always at the
+	//start of block, followed by desc, seq and qual if packed
+	char *block;
+	Py_ssize_t block_size;
+	int packed;
+
 	//read name
 	char *name;
 
@@ -48,4 +54,7 @@ typedef struct {
 
 extern PyTypeObject pyfastx_ReadType;
 
+pyfastx_Read *pyfastx_read_new(pyfastx_FastqMiddleware *middle);
+char *pyfastx_read_reserve(pyfastx_Read *self, Py_ssize_t size);
+
 #endif
\ No newline at end of file
@@ -1,6 +1,12 @@
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
 #include "sequence.h"
+#include "batch.h"
+#include "kmer.h"
+#include "sketch.h"
+#include "motif.h"
+#include "profile.h"
+#include "mask.h"
 #include "structmember.h"
 
 void pyfastx_sequence_continue_read(pyfastx_Sequence* self) {
@@ -25,26 +31,26 @@ void pyfastx_sequence_continue_read(pyfastx_Sequence* self) {
 
 	self->raw = (char *)malloc(bytelen + 1);
 
-	current = gztell(self->index->gzfd);
+	current = pyfastx_stream_tell(self->index->gzfd);
 	gap = offset - current;
 
 	if (self->index->gzip_format) {
 		if (gap >= 0) {
 			while (gap > 0) {
 				rlen = gap > bytelen ? bytelen : gap;
-				gzread(self->index->gzfd, self->raw, rlen);
+				pyfastx_stream_read(self->index->gzfd, self->raw, rlen);
 				gap -= rlen;
 			}
-			gzread(self->index->gzfd, self->raw, bytelen);
+			pyfastx_stream_read(self->index->gzfd, self->raw, bytelen);
 		} else {
-			zran_seek(self->index->gzip_index, offset, SEEK_SET, NULL);
-			zran_read(self->index->gzip_index, self->raw, bytelen);
+			pyfastx_gzip_index_seek(self->index->gzip_index, offset);
+			pyfastx_gzip_index_read(self->index->gzip_index, self->raw, bytelen);
 		}
 	} else {
 		if (gap != 0) {
-			gzseek(self->index->gzfd, offset, SEEK_SET);
+			pyfastx_stream_seek(self->index->gzfd, offset);
 		}
-		gzread(self->index->gzfd, self->raw, bytelen);
+		pyfastx_stream_read(self->index->gzfd, self->raw, bytelen);
 	}
 	self->raw[bytelen] = '\0';
 
@@ -97,7 +103,7 @@ char *pyfastx_sequence_get_fullseq(pyfastx_Sequence* self) {
 }
 
 char *pyfastx_sequence_get_subseq(pyfastx_Sequence* self) {
-	if (self->complete || !self->normal) {
+	if (self->complete || !(self->normal || self->located)) {
 		pyfastx_sequence_get_fullseq(self);
 	}
 
@@ -124,9 +130,58 @@ char *pyfastx_sequence_get_subseq(pyfastx_Sequence* self) {
 	return self->index->cache_seq.s;
 }
 
-void pyfastx_sequence_dealloc(pyfastx_Sequence* self) {
-	free(self->name);
+//freed sequences kept for reuse with their name blocks
+static pyfastx_Sequence *pyfastx_sequence_freelist[PYFASTX_FREELIST_SIZE];
+static int pyfastx_sequence_numfree = 0;
+
+//create a zeroed sequence without calling type, reuse freed sequence if available
+pyfastx_Sequence *pyfastx_sequence_alloc(void) {
+	pyfastx_Sequence *seq;
+	char *block = NULL;
+	Py_ssize_t block_size = 0;
+
+	if (pyfastx_sequence_numfree) {
+		seq = pyfastx_sequence_freelist[--pyfastx_sequence_numfree];
+		block = seq->block;
+		block_size = seq->block_size;
+		PyObject_Init((PyObject *)seq, &pyfastx_SequenceType);
+	} else {
+		seq = PyObject_New(pyfastx_Sequence, &pyfastx_SequenceType);
+
+		if (!seq) {
+			return NULL;
+		}
+	}
+
+	memset((char *)seq + sizeof(PyObject), 0, sizeof(pyfastx_Sequence) - sizeof(PyObject));
+	seq->block = block;
+	seq->block_size = block_size;
+	seq->name = block;
+
+	return seq;
+}
+
+//make sure name block has at least size bytes, return NULL and keep
+//the old block if failed to allocate memory
+char *pyfastx_sequence_reserve(pyfastx_Sequence *self, Py_ssize_t size) {
+	char *block;
+
+	if (self->block_size < size) {
+		block = (char *)realloc(self->block, size);
+
+		if (block == NULL) {
+			return NULL;
+		}
+
+		self->block = block;
+		self->block_size = size;
+	}
+
+	self->name = self->block;
+	return self->block;
+}
 
+void pyfastx_sequence_dealloc(pyfastx_Sequence* self) {
 	if (self->desc) {
 		free(self->desc);
 	}
@@ -135,9 +190,7 @@ void pyfastx_sequence_dealloc(pyfastx_Sequence* self) {
 		free(self->raw);
 	}
 
-	if (self->line.l > 0) {
-		free(self->line.s);
-	}
+	free(self->line.s);
 
 	if (self->line_cache) {
 		free(self->line_cache);
@@ -148,6 +201,12 @@ void pyfastx_sequence_dealloc(pyfastx_Sequence* self) {
 	self->index = NULL;
 	self->cache_pos = NULL;
 
+	if (pyfastx_sequence_numfree < PYFASTX_FREELIST_SIZE && self->block_size <= PYFASTX_FREELIST_BLOCK) {
+		pyfastx_sequence_freelist[pyfastx_sequence_numfree++] = self;
+		return;
+	}
+
+	free(self->block);
 	Py_TYPE(self)->tp_free((PyObject *)self);
 }
 
@@ -166,9 +225,9 @@ PyObject *pyfastx_sequence_iter(pyfastx_Sequence* self){
 	}
 
 	if (self->index->gzip_format){
-		zran_seek(self->index->gzip_index, self->offset, SEEK_SET, NULL);
+		pyfastx_gzip_index_seek(self->index->gzip_index, self->offset);
 	} else {
-		gzseek(self->index->gzfd, self->offset, SEEK_SET);
+		pyfastx_stream_seek(self->index->gzfd, self->offset);
 	}
 
 	if (!self->line_cache) {
@@ -203,9 +262,9 @@ PyObject *pyfastx_sequence_next(pyfastx_Sequence* self) {
 	while (1) {
 		if (!self->cache_pos) {
 			if (self->index->gzip_format) {
-				rlen = zran_read(self->index->gzip_index, self->line_cache, 1048576);
+				rlen = pyfastx_gzip_index_read(self->index->gzip_index, self->line_cache, 1048576);
 			} else {
-				rlen = gzread(self->index->gzfd, self->line_cache, 1048576);
+				rlen = pyfastx_stream_read(self->index->gzfd, self->line_cache, 1048576);
 			}
 
 			if (rlen <= 0) {
@@ -360,7 +419,7 @@ PyObject *pyfastx_sequence_reverse(pyfastx_Sequence* self, void* closure){
 	data = (char *)PyUnicode_1BYTE_DATA(ret);
 	memcpy(data, seq, self->seq_len);
 
-	reverse_seq(data);
+	reverse_seq(data, self->seq_len);
 
 	return ret;
 }
@@ -376,7 +435,7 @@ PyObject *pyfastx_sequence_complement(pyfastx_Sequence* self, void* closure){
 	data = (char *)PyUnicode_1BYTE_DATA(ret);
 	memcpy(data, seq, self->seq_len);
 
-	complement_seq(data);
+	complement_seq(data, self->seq_len);
 
 	return ret;
 }
@@ -392,7 +451,7 @@ PyObject *pyfastx_sequence_antisense(pyfastx_Sequence* self, void* closure){
 	data = (char *)PyUnicode_1BYTE_DATA(ret);
 	memcpy(data, seq, self->seq_len);
 
-	reverse_complement_seq(data);
+	reverse_complement_seq(data, self->seq_len);
 
 	return ret;
 }
@@ -464,7 +523,7 @@ PyObject *pyfastx_sequence_subscript(pyfastx_Sequence* self, PyObject* item){
 		}
 
 		//create a new sequence
-		seq = (pyfastx_Sequence *)PyObject_CallObject((PyObject *)&pyfastx_SequenceType, NULL);
+		seq = pyfastx_sequence_alloc();
 		if (!seq) {
 			return NULL;
 		}
@@ -472,8 +531,6 @@ PyObject *pyfastx_sequence_subscript(pyfastx_Sequence* self, PyObject* item){
 		seq->start = slice_start + self->start;
 		seq->end = slice_stop + self->start - 1;
 		seq->id = self->id;
-		seq->name = (char *)malloc(strlen(self->name) + 1);
-		strcpy(seq->name, self->name);
 		seq->seq_len = slice_stop - slice_start;
 		//seq->parent_len = self->parent_len;
 		seq->line_len = self->line_len;
@@ -488,6 +545,13 @@ PyObject *pyfastx_sequence_subscript(pyfastx_Sequence* self, PyObject* item){
 
 		Py_INCREF(self->index->fasta);
 
+		if (!pyfastx_sequence_reserve(seq, strlen(self->name) + 1)) {
+			Py_DECREF(seq);
+			return PyErr_NoMemory();
+		}
+
+		strcpy(seq->name, self->name);
+
 		//check sequence is complete or not
 		if (self->complete && seq->seq_len == self->seq_len) {
 			seq->complete = 1;
@@ -507,6 +571,11 @@ PyObject *pyfastx_sequence_subscript(pyfastx_Sequence* self, PyObject* item){
 
 			seq->offset = self->offset + slice_start + self->end_len*before_sline;
 			seq->byte_len = seq->seq_len + cross_line*self->end_len;
+		} else if (seq->seq_len == 0) {
+			seq->located = 1;
+			seq->byte_len = 0;
+		} else if (!seq->complete) {
+			seq->located = pyfastx_sequence_locate(seq, seq->start, seq->end, &seq->offset, &seq->byte_len);
 		}
 
 		//Py_INCREF(seq);
@@ -519,6 +588,7 @@ PyObject *pyfastx_sequence_subscript(pyfastx_Sequence* self, PyObject* item){
 PyObject *pyfastx_sequence_search(pyfastx_Sequence *self, PyObject *args, PyObject *kwargs){
 	int strand = '+';
 
+	const char *query;
 	char *subseq;
 	char *seq;
 	char *result;
@@ -528,12 +598,22 @@ PyObject *pyfastx_sequence_search(pyfastx_Sequence *self, PyObject *args, PyObje
 
 	char* keywords[] = {"subseq", "strand", NULL};
 	
-	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "s#|C", keywords, &subseq, &sublen, &strand)){
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "s#|C", keywords, &query, &sublen, &strand)){
 		return NULL;
 	}
 
+	//reverse complement a copy, query is the buffer of caller's str
+	subseq = (char *)malloc(sublen + 1);
+
+	if (subseq == NULL) {
+		return PyErr_NoMemory();
+	}
+
+	memcpy(subseq, query, sublen);
+	subseq[sublen] = '\0';
+
 	if (strand == '-') {
-		reverse_complement_seq(subseq);
+		reverse_complement_seq(subseq, sublen);
 	}
 
 	if (self->index->iterating) {
@@ -543,6 +623,7 @@ PyObject *pyfastx_sequence_search(pyfastx_Sequence *self, PyObject *args, PyObje
 	seq = pyfastx_sequence_get_subseq(self);
 
 	result = str_n_str(seq, subseq, sublen, self->seq_len);
+	free(subseq);
 
 	if (result != NULL) {
 		if (strand == '-') {
@@ -559,196 +640,244 @@ PyObject *pyfastx_sequence_search(pyfastx_Sequence *self, PyObject *args, PyObje
 	return Py_BuildValue("n", start);
 }
 
-PyObject *pyfastx_sequence_gc_content(pyfastx_Sequence *self, void* closure) {
-	int l;
+/*
+locate file offset and byte length of bases from start to end, 1-based
+positions of parent sequence, bases of irregular sequence are located by line
+runs in index. return 0 if bases can not be located without reading sequence
+*/
+int pyfastx_sequence_locate(pyfastx_Sequence *self, Py_ssize_t start, Py_ssize_t end, Py_ssize_t *offset, Py_ssize_t *bytes) {
+	Py_ssize_t s;
+	Py_ssize_t e;
+	Py_ssize_t bases;
+
+	if (self->normal) {
+		//lines crossed from the start of subsequence
+		bases = self->line_len - self->end_len;
+		s = self->start - 1;
+
+		*offset = self->offset + start - 1 - s + self->end_len * ((start - 1) / bases - s / bases);
+		*bytes = end - start + 1 + self->end_len * ((end - 1) / bases - (start - 1) / bases);
+		return 1;
+	}
+
+	s = pyfastx_index_line_offset(self->index, self->id, start - 1);
+	e = pyfastx_index_line_offset(self->index, self->id, end - 1);
+
+	if (s < 0 || e < 0) {
+		return 0;
+	}
+
+	*offset = s;
+	*bytes = e - s + 1;
+	return 1;
+}
+
+//count block letters of bases from start to end of parent sequence
+static int pyfastx_sequence_count_bases(pyfastx_Sequence *self, Py_ssize_t start, Py_ssize_t end, Py_ssize_t *counts) {
+	int i;
+	char *buff;
+	Py_ssize_t offset;
+	Py_ssize_t bytes;
+	Py_ssize_t hist[256] = {0};
+
+	if (!pyfastx_sequence_locate(self, start, end, &offset, &bytes)) {
+		return 0;
+	}
+
+	buff = (char *)malloc(bytes);
+
+	if (!buff) {
+		return 0;
+	}
+
+	if (pyfastx_sequence_read_chunk(self, buff, offset, bytes) != bytes) {
+		free(buff);
+		return 0;
+	}
+
+	//line ends are not block letters
+	count_bytes(buff, bytes, hist);
+
+	for (i = 0; i < PYFASTX_BLOCK_CLASSES; ++i) {
+		counts[i + 1] += hist[(unsigned char)PYFASTX_BLOCK_BASES[i]];
+	}
+
+	free(buff);
+	return 1;
+}
+
+/*
+count letters of subsequence from cumulative counts at the first and last
+block boundaries inside it, plus bases of the partial blocks at both ends,
+counts[0] is the number of letters not in PYFASTX_BLOCK_BASES. return 0 if
+block counts can not be used, the subsequence is then scanned by caller
+*/
+int pyfastx_sequence_block_counts(pyfastx_Sequence *self, Py_ssize_t *counts) {
+	int i;
 	int ret;
-	char *seq;
+	int bytes = PYFASTX_BLOCK_CLASSES * sizeof(uint32_t);
+
+	Py_ssize_t s = self->start - 1;
+	Py_ssize_t e = self->end;
+	Py_ssize_t b1 = (s + PYFASTX_BLOCK_SIZE - 1) / PYFASTX_BLOCK_SIZE;
+	Py_ssize_t b2 = e / PYFASTX_BLOCK_SIZE;
+	Py_ssize_t total = 0;
+
+	//cumulative counts at the boundaries, wrapped differences are exact
+	//for subsequence shorter than 4G
+	uint32_t before[PYFASTX_BLOCK_CLASSES] = {0};
+	uint32_t after[PYFASTX_BLOCK_CLASSES];
+
+	sqlite3_blob *blob = NULL;
+
+	if (b2 <= b1 || e - s > UINT32_MAX) {
+		return 0;
+	}
 
-	Py_ssize_t i, n;
-	Py_ssize_t a = 0, c = 0, g = 0, t = 0;
-	
 	PYFASTX_SQLITE_CALL(
-		sqlite3_bind_int64(self->index->comp_stmt, 1, self->id);
-		ret = sqlite3_step(self->index->comp_stmt);
-	);
+		ret = sqlite3_blob_open(self->index->index_db, "main", "block", "counts", self->id, 0, &blob);
 
-	if (ret == SQLITE_ROW && self->start == 1 && self->end == self->seq_len) {
-		while (ret == SQLITE_ROW) {
-			
-			PYFASTX_SQLITE_CALL(
-				l = sqlite3_column_int(self->index->comp_stmt, 2);
-				n = sqlite3_column_int64(self->index->comp_stmt, 3);
-				ret = sqlite3_step(self->index->comp_stmt);
-			);
-
-			switch (l) {
-				case 65:
-				case 97:
-					a += n;
-					break;
-
-				case 67:
-				case 99:
-					c += n;
-					break;
-
-				case 71:
-				case 103:
-					g += n;
-					break;
-
-				case 84:
-				case 116:
-					t += n;
-					break;
-			}
+		if (ret == SQLITE_OK && b1 > 0) {
+			ret = sqlite3_blob_read(blob, before, bytes, (b1 - 1) * bytes);
 		}
-	} else {
-		seq = pyfastx_sequence_get_subseq(self);
 
-		for (i = 0; i < self->seq_len; ++i) {
-			switch (seq[i]) {
-				case 65:
-				case 97:
-					++a;
-					break;
-
-				case 84:
-				case 116:
-					++t;
-					break;
-
-				case 71:
-				case 103:
-					++g;
-					break;
-
-				case 67:
-				case 99:
-					++c;
-					break;
-			}
+		if (ret == SQLITE_OK) {
+			ret = sqlite3_blob_read(blob, after, bytes, (b2 - 1) * bytes);
 		}
+
+		sqlite3_blob_close(blob);
+	);
+
+	if (ret != SQLITE_OK) {
+		return 0;
+	}
+
+	memset(counts, 0, (PYFASTX_BLOCK_CLASSES + 1) * sizeof(Py_ssize_t));
+
+	for (i = 0; i < PYFASTX_BLOCK_CLASSES; ++i) {
+		counts[i + 1] = (uint32_t)(after[i] - before[i]);
+	}
+
+	//bases in partial blocks
+	if (s < b1 * PYFASTX_BLOCK_SIZE && !pyfastx_sequence_count_bases(self, s + 1, b1 * PYFASTX_BLOCK_SIZE, counts)) {
+		return 0;
+	}
+
+	if (b2 * PYFASTX_BLOCK_SIZE < e && !pyfastx_sequence_count_bases(self, b2 * PYFASTX_BLOCK_SIZE + 1, e, counts)) {
+		return 0;
+	}
+
+	for (i = 1; i <= PYFASTX_BLOCK_CLASSES; ++i) {
+		total += counts[i];
 	}
 
-	PYFASTX_SQLITE_CALL(sqlite3_reset(self->index->comp_stmt));
+	counts[0] = self->seq_len - total;
+
+	return 1;
+}
+
+PyObject *pyfastx_sequence_gc_content(pyfastx_Sequence *self, void* closure) {
+	char *seq;
+
+	Py_ssize_t a = 0, c = 0, g = 0, t = 0;
+	Py_ssize_t seq_comp[256];
+	Py_ssize_t counts[PYFASTX_BLOCK_CLASSES + 1];
+
+	if (self->complete && pyfastx_index_composition(self->index, self->id, seq_comp)) {
+		a = seq_comp['A'] + seq_comp['a'];
+		c = seq_comp['C'] + seq_comp['c'];
+		g = seq_comp['G'] + seq_comp['g'];
+		t = seq_comp['T'] + seq_comp['t'];
+	} else if (pyfastx_sequence_block_counts(self, counts)) {
+		a = counts[1] + counts[6];
+		c = counts[2] + counts[7];
+		g = counts[3] + counts[8];
+		t = counts[4] + counts[9];
+	} else {
+		seq = pyfastx_sequence_get_subseq(self);
+		memset(seq_comp, 0, sizeof(seq_comp));
+		count_bytes(seq, self->seq_len, seq_comp);
+
+		a = seq_comp['A'] + seq_comp['a'];
+		c = seq_comp['C'] + seq_comp['c'];
+		g = seq_comp['G'] + seq_comp['g'];
+		t = seq_comp['T'] + seq_comp['t'];
+	}
 
 	return Py_BuildValue("f", (float)(g+c)/(a+c+g+t)*100);
 }
 
 PyObject *pyfastx_sequence_gc_skew(pyfastx_Sequence *self, void* closure) {
-	int l;
-	int ret;
 	char *seq;
 
-	Py_ssize_t i, n;
 	Py_ssize_t c = 0, g = 0;
-	
-	PYFASTX_SQLITE_CALL(
-		sqlite3_bind_int64(self->index->comp_stmt, 1, self->id);
-		ret = sqlite3_step(self->index->comp_stmt);
-	);
-
-	if (ret == SQLITE_ROW && self->start == 1 && self->end == self->seq_len) {
-		while (ret == SQLITE_ROW) {
-			PYFASTX_SQLITE_CALL(
-				l = sqlite3_column_int(self->index->comp_stmt, 2);
-				n = sqlite3_column_int64(self->index->comp_stmt, 3);
-				ret = sqlite3_step(self->index->comp_stmt);
-			);
-
-			switch (l) {
-				case 67:
-				case 99:
-					c += n;
-					break;
-
-				case 71:
-				case 103:
-					g += n;
-					break;
-			}
-		}
+	Py_ssize_t seq_comp[256];
+	Py_ssize_t counts[PYFASTX_BLOCK_CLASSES + 1];
+
+	if (self->complete && pyfastx_index_composition(self->index, self->id, seq_comp)) {
+		c = seq_comp['C'] + seq_comp['c'];
+		g = seq_comp['G'] + seq_comp['g'];
+	} else if (pyfastx_sequence_block_counts(self, counts)) {
+		c = counts[2] + counts[7];
+		g = counts[3] + counts[8];
 	} else {
 		seq = pyfastx_sequence_get_subseq(self);
+		memset(seq_comp, 0, sizeof(seq_comp));
+		count_bytes(seq, self->seq_len, seq_comp);
 
-		for (i = 0; i < self->seq_len; ++i) {
-			switch (seq[i]) {
-				case 67:
-				case 99:
-					++c;
-					break;
-
-				case 71:
-				case 103:
-					++g;
-					break;	
-			}
-		}
+		c = seq_comp['C'] + seq_comp['c'];
+		g = seq_comp['G'] + seq_comp['g'];
 	}
 
-	PYFASTX_SQLITE_CALL(sqlite3_reset(self->index->comp_stmt));
-
 	return Py_BuildValue("f", (float)(g-c)/(g+c));
 }
 
 PyObject *pyfastx_sequence_composition(pyfastx_Sequence *self, void* closure) {
 	int i;
 	int l;
-	int ret;
 	char *seq;
 	
 	Py_ssize_t n;
-	Py_ssize_t seq_comp[128] = {0};
+	Py_ssize_t seq_comp[256] = {0};
+	Py_ssize_t counts[PYFASTX_BLOCK_CLASSES + 1];
 
 	PyObject *d;
 	PyObject *b;
 	PyObject *c;
 
-	PYFASTX_SQLITE_CALL(
-		sqlite3_bind_int64(self->index->comp_stmt, 1, self->id);
-		ret = sqlite3_step(self->index->comp_stmt);
-	);
+	//counts of complete sequence stored in index are letters as they are in file
+	if (!self->complete || !pyfastx_index_composition(self->index, self->id, seq_comp)) {
+		//block counts only answer subsequence without other letters
+		if (pyfastx_sequence_block_counts(self, counts) && !counts[0]) {
+			for (i = 0; i < PYFASTX_BLOCK_CLASSES; ++i) {
+				l = PYFASTX_BLOCK_BASES[i];
 
-	d = PyDict_New();
-	
-	if (ret == SQLITE_ROW && self->start == 1 && self->end == self->seq_len) {
-		while (ret == SQLITE_ROW) {
-			PYFASTX_SQLITE_CALL(
-				l = sqlite3_column_int(self->index->comp_stmt, 2);
-				n = sqlite3_column_int64(self->index->comp_stmt, 3);
-				ret = sqlite3_step(self->index->comp_stmt);
-			);
-
-			if (n > 0 && l >= 32 && l < 127) {
-				b = Py_BuildValue("C", l);
-				c = Py_BuildValue("n", n);
-				PyDict_SetItem(d, b, c);
-				Py_DECREF(b);
-				Py_DECREF(c);
+				if (self->index->uppercase) {
+					l = Py_TOUPPER(l);
+				}
+
+				seq_comp[l] += counts[i + 1];
 			}
+		} else {
+			seq = pyfastx_sequence_get_subseq(self);
+			count_bytes(seq, self->seq_len, seq_comp);
 		}
-	} else {
-		seq = pyfastx_sequence_get_subseq(self);
+	}
 
-		for (i = 0; i < self->seq_len; ++i) {
-			++seq_comp[(unsigned char)seq[i]];
-		}
+	d = PyDict_New();
 
-		for (l = 32; l < 127; ++l) {
-			n = seq_comp[l];
+	for (l = 32; l < 127; ++l) {
+		n = seq_comp[l];
 
-			if (n > 0) {
-				b = Py_BuildValue("C", l);
-				c = Py_BuildValue("i", n);
-				PyDict_SetItem(d, b, c);
-				Py_DECREF(b);
-				Py_DECREF(c);
-			}
+		if (n > 0) {
+			b = Py_BuildValue("C", l);
+			c = Py_BuildValue("n", n);
+			PyDict_SetItem(d, b, c);
+			Py_DECREF(b);
+			Py_DECREF(c);
 		}
 	}
 
-	PYFASTX_SQLITE_CALL(sqlite3_reset(self->index->comp_stmt));
 	return d;
 }
 
@@ -761,8 +890,319 @@ static PySequenceMethods pyfastx_sequence_as_sequence = {
 	.sq_contains = (objobjproc)pyfastx_sequence_contains,
 };
 
+//read raw bytes of sequence at offset, gzip index is only moved back when
+//it has been moved by random access since last read
+Py_ssize_t pyfastx_sequence_read_chunk(pyfastx_Sequence *self, char *buff, Py_ssize_t offset, Py_ssize_t bytes) {
+	pyfastx_Index *index = self->index;
+
+	if (index->gzip_format) {
+		if (zran_tell(&index->gzip_index->zran) != offset && pyfastx_gzip_index_seek(index->gzip_index, offset) != ZRAN_SEEK_OK) {
+			return -1;
+		}
+
+		return pyfastx_gzip_index_read(index->gzip_index, buff, bytes);
+	} else if (index->zstd_format) {
+		if (pyfastx_zstd_seek(index->zstd_index, offset) != 0) {
+			return -1;
+		}
+
+		return pyfastx_zstd_read(index->zstd_index, buff, bytes);
+	}
+
+	FSEEK(index->fd, offset, SEEK_SET);
+	return fread(buff, 1, bytes, index->fd);
+}
+
+pyfastx_SequenceWindows *pyfastx_sequence_windows_create(pyfastx_Sequence *self, Py_ssize_t size, Py_ssize_t step, int uppercase, Py_ssize_t batch) {
+	int columns = 1;
+	pyfastx_SequenceWindows *obj = PyObject_New(pyfastx_SequenceWindows, &pyfastx_SequenceWindowsType);
+
+	if (!obj) {
+		return NULL;
+	}
+
+	obj->seq = (pyfastx_Sequence *)Py_NewRef(self);
+	obj->size = size;
+	obj->step = step;
+	obj->batch = batch;
+	obj->uppercase = uppercase;
+	obj->offset = self->offset;
+	obj->remain = self->byte_len;
+	obj->next = 0;
+	obj->chunk = (char *)malloc(PYFASTX_WINDOW_CHUNK + 1);
+	kstring_init(obj->bases);
+
+	//offset of subsequence is located for normal fasta or by line runs,
+	//otherwise the bases before subsequence are read from the start of
+	//sequence and dropped
+	obj->bases_start = (self->normal || self->located) ? 0 : 1 - self->start;
+
+	if (batch) {
+		columns = pyfastx_batch_column_init(&obj->names, batch) & pyfastx_batch_column_init(&obj->seqs, batch);
+	} else {
+		obj->names.data.s = obj->seqs.data.s = NULL;
+		obj->names.offsets = obj->seqs.offsets = NULL;
+		obj->names.validity = obj->seqs.validity = NULL;
+	}
+
+	if (!obj->chunk || !columns) {
+		Py_DECREF(obj);
+		PyErr_NoMemory();
+		return NULL;
+	}
+
+	return obj;
+}
+
+PyObject *pyfastx_sequence_windows(pyfastx_Sequence *self, PyObject *args, PyObject *kwargs) {
+	Py_ssize_t size;
+	Py_ssize_t step = 0;
+	Py_ssize_t batch = 0;
+	int uppercase = self->index->uppercase;
+
+	static char* keywords[] = {"size", "step", "uppercase", "batch", NULL};
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n|npn", keywords, &size, &step, &uppercase, &batch)) {
+		return NULL;
+	}
+
+	if (!step) {
+		step = size;
+	}
+
+	if (size <= 0 || step <= 0) {
+		PyErr_SetString(PyExc_ValueError, "window size and step must be greater than 0");
+		return NULL;
+	}
+
+	if (batch < 0) {
+		PyErr_SetString(PyExc_ValueError, "batch must not be negative");
+		return NULL;
+	}
+
+	return (PyObject *)pyfastx_sequence_windows_create(self, size, step, uppercase, batch);
+}
+
+void pyfastx_sequence_windows_dealloc(pyfastx_SequenceWindows *self) {
+	free(self->chunk);
+	free(self->bases.s);
+	pyfastx_batch_column_free(&self->names);
+	pyfastx_batch_column_free(&self->seqs);
+	Py_DECREF(self->seq);
+	PyObject_Del(self);
+}
+
+PyObject *pyfastx_sequence_windows_iter(pyfastx_SequenceWindows *self) {
+	Py_INCREF(self);
+	return (PyObject *)self;
+}
+
+/*
+keep bases from start to end of sequence in buffer, bases before start are
+dropped when they take up at least half of buffer, so each base is moved
+at most once on average and memory is bounded by window and chunk size
+*/
+int pyfastx_sequence_windows_fill(pyfastx_SequenceWindows *self, Py_ssize_t start, Py_ssize_t end) {
+	Py_ssize_t d;
+	Py_ssize_t l;
+	char *p;
+
+	d = start - self->bases_start;
+
+	if (d >= self->bases.l) {
+		self->bases_start += self->bases.l;
+		self->bases.l = 0;
+	} else if (d > 0 && d * 2 >= self->bases.l) {
+		memmove(self->bases.s, self->bases.s + d, self->bases.l - d);
+		self->bases.l -= d;
+		self->bases_start = start;
+	}
+
+	while (self->bases_start + self->bases.l < end && self->remain > 0) {
+		l = self->remain < PYFASTX_WINDOW_CHUNK ? self->remain : PYFASTX_WINDOW_CHUNK;
+		l = pyfastx_sequence_read_chunk(self->seq, self->chunk, self->offset, l);
+
+		if (l <= 0) {
+			PyErr_SetString(PyExc_RuntimeError, "failed to read sequence from file");
+			return 0;
+		}
+
+		self->offset += l;
+		self->remain -= l;
+
+		if (self->uppercase) {
+			l = remove_space_uppercase(self->chunk, l);
+		} else {
+			l = remove_space(self->chunk, l);
+		}
+
+		p = self->chunk;
+
+		//drop incoming bases before start
+		if (!self->bases.l && self->bases_start < start) {
+			d = start - self->bases_start < l ? start - self->bases_start : l;
+			self->bases_start += d;
+			p += d;
+			l -= d;
+		}
+
+		if (self->bases.l + l > self->bases.m) {
+			self->bases.m = self->bases.l + l;
+			kroundup32(self->bases.m);
+			self->bases.s = (char *)realloc(self->bases.s, self->bases.m);
+		}
+
+		memcpy(self->bases.s + self->bases.l, p, l);
+		self->bases.l += l;
+	}
+
+	return 1;
+}
+
+//get the next window, return window length or -1 if no more windows
+Py_ssize_t pyfastx_sequence_windows_step(pyfastx_SequenceWindows *self, char **window) {
+	Py_ssize_t start = self->next;
+	Py_ssize_t end;
+
+	if (start >= self->seq->seq_len) {
+		return -1;
+	}
+
+	end = start + self->size;
+
+	if (end > self->seq->seq_len) {
+		end = self->seq->seq_len;
+	}
+
+	if (!pyfastx_sequence_windows_fill(self, start, end)) {
+		return -1;
+	}
+
+	if (end > self->bases_start + self->bases.l) {
+		end = self->bases_start + self->bases.l;
+	}
+
+	self->next += self->step;
+	*window = self->bases.s + (start - self->bases_start);
+
+	return end - start;
+}
+
+PyObject *pyfastx_sequence_windows_next(pyfastx_SequenceWindows *self) {
+	Py_ssize_t l;
+	Py_ssize_t n;
+	Py_ssize_t start;
+	char *window;
+	char *name;
+	PyObject *ret;
+
+	if (!self->batch) {
+		l = pyfastx_sequence_windows_step(self, &window);
+
+		if (l < 0) {
+			return NULL;
+		}
+
+		ret = PyUnicode_New(l, 127);
+		memcpy(PyUnicode_1BYTE_DATA(ret), window, l);
+		return ret;
+	}
+
+	//window names are name:start-end with 1-based positions in sequence
+	name = (char *)malloc(strlen(self->seq->name) + 48);
+
+	if (!name) {
+		return PyErr_NoMemory();
+	}
+
+	self->names.data.l = 0;
+	self->seqs.data.l = 0;
+
+	for (n = 0; n < self->batch; ++n) {
+		start = self->next + self->seq->start;
+		l = pyfastx_sequence_windows_step(self, &window);
+
+		if (l < 0) {
+			break;
+		}
+
+		if (!pyfastx_batch_column_append(&self->names, name, sprintf(name, "%s:%zd-%zd", self->seq->name, start, start + l - 1)) || !pyfastx_batch_column_append(&self->seqs, window, l)) {
+			free(name);
+			return PyErr_NoMemory();
+		}
+
+		self->names.offsets[n+1] = self->names.data.l;
+		self->seqs.offsets[n+1] = self->seqs.data.l;
+	}
+
+	free(name);
+
+	if (!n || PyErr_Occurred()) {
+		return NULL;
+	}
+
+	return pyfastx_batch_create(&self->names, &self->seqs, NULL, NULL, n, 1, 0);
+}
+
+PyObject *pyfastx_sequence_kmers(pyfastx_Sequence *self, PyObject *args, PyObject *kwargs) {
+	return pyfastx_kmer_iter_create((PyObject *)self, NULL, NULL, args, kwargs);
+}
+
+PyObject *pyfastx_sequence_minimizers(pyfastx_Sequence *self, PyObject *args, PyObject *kwargs) {
+	return pyfastx_minimizer_iter_create((PyObject *)self, args, kwargs);
+}
+
+PyObject *pyfastx_sequence_sketch(pyfastx_Sequence *self, PyObject *args, PyObject *kwargs) {
+	return pyfastx_sketch_create((PyObject *)self, NULL, 1, NULL, args, kwargs);
+}
+
+PyObject *pyfastx_sequence_search_all(pyfastx_Sequence *self, PyObject *args, PyObject *kwargs) {
+	return pyfastx_motif_search((PyObject *)self, NULL, args, kwargs);
+}
+
+PyObject *pyfastx_sequence_search_approx(pyfastx_Sequence *self, PyObject *args, PyObject *kwargs) {
+	return pyfastx_motif_search_approx((PyObject *)self, NULL, 0, args, kwargs);
+}
+
+PyObject *pyfastx_sequence_gc_profile(pyfastx_Sequence *self, PyObject *args, PyObject *kwargs) {
+	return pyfastx_gc_profile((PyObject *)self, NULL, args, kwargs);
+}
+
+//intervals overlapping subsequence, positions are on the whole sequence
+static PyObject *pyfastx_sequence_intervals(pyfastx_Sequence *self, int track) {
+	Py_ssize_t end = self->complete ? self->seq_len : self->end;
+	return pyfastx_mask_intervals(self->index, self->id, self->id, self->start - 1, end, track);
+}
+
+PyObject *pyfastx_sequence_masks(pyfastx_Sequence *self, PyObject *args) {
+	return pyfastx_sequence_intervals(self, PYFASTX_MASK_SOFT);
+}
+
+PyObject *pyfastx_sequence_gaps(pyfastx_Sequence *self, PyObject *args) {
+	return pyfastx_sequence_intervals(self, PYFASTX_MASK_GAP);
+}
+
+PyTypeObject pyfastx_SequenceWindowsType = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "SequenceWindows",
+	.tp_basicsize = sizeof(pyfastx_SequenceWindows),
+	.tp_dealloc = (destructor)pyfastx_sequence_windows_dealloc,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_iter = (getiterfunc)pyfastx_sequence_windows_iter,
+	.tp_iternext = (iternextfunc)pyfastx_sequence_windows_next,
+};
+
 static PyMethodDef pyfastx_sequence_methods[] = {
 	{"search", (PyCFunction)pyfastx_sequence_search, METH_VARARGS|METH_KEYWORDS, NULL},
+	{"windows", (PyCFunction)pyfastx_sequence_windows, METH_VARARGS|METH_KEYWORDS, NULL},
+	{"kmers", (PyCFunction)pyfastx_sequence_kmers, METH_VARARGS|METH_KEYWORDS, NULL},
+	{"minimizers", (PyCFunction)pyfastx_sequence_minimizers, METH_VARARGS|METH_KEYWORDS, NULL},
+	{"sketch", (PyCFunction)pyfastx_sequence_sketch, METH_VARARGS|METH_KEYWORDS, NULL},
+	{"search_all", (PyCFunction)pyfastx_sequence_search_all, METH_VARARGS|METH_KEYWORDS, NULL},
+	{"search_approx", (PyCFunction)pyfastx_sequence_search_approx, METH_VARARGS|METH_KEYWORDS, NULL},
+	{"gc_profile", (PyCFunction)pyfastx_sequence_gc_profile, METH_VARARGS|METH_KEYWORDS, NULL},
+	{"masks", (PyCFunction)pyfastx_sequence_masks, METH_NOARGS, NULL},
+	{"gaps", (PyCFunction)pyfastx_sequence_gaps, METH_NOARGS, NULL},
 	{NULL, NULL, 0, NULL}
 };
 
@@ -5,6 +5,10 @@
 #include "index.h"
 #include "kseq.h"
 #include "util.h"
+#include "parallel.h"
+
+//size of raw chunk read from file by window iterator
+#define PYFASTX_WINDOW_CHUNK 1048576
 
 //make sequence class
 typedef struct {
@@ -12,8 +16,12 @@ typedef struct {
 
 	//sequence order
 	Py_ssize_t id;
-	
-	//sequence name
+
+	//name block kept across reuse of object
+	char* block;
+	Py_ssize_t block_size;
+
+	//sequence name, points to block
 	char* name;
 
 	//sequence description
@@ -58,6 +66,10 @@ typedef struct {
 	//standard fasta format with same line length
 	int normal;
 
+	//offset and byte length of subsequence of irregular sequence are
+	//located by line runs
+	int located;
+
 	//complete sequence or subsequence
 	int complete;
 
@@ -69,11 +81,57 @@ typedef struct {
 
 } pyfastx_Sequence;
 
+//fixed size windows streamed from sequence without reading whole sequence
+typedef struct {
+	PyObject_HEAD
+
+	//parent sequence
+	pyfastx_Sequence *seq;
+
+	//window size and step
+	Py_ssize_t size;
+	Py_ssize_t step;
+
+	//number of windows in each batch, 0 to yield strings
+	Py_ssize_t batch;
+
+	//convert bases to uppercase
+	int uppercase;
+
+	//file offset and byte length of sequence not read yet
+	Py_ssize_t offset;
+	Py_ssize_t remain;
+
+	//raw chunk read from file
+	char *chunk;
+
+	//despaced bases, the first base is at position bases_start of sequence,
+	//negative for bases before the start of subsequence
+	kstring_t bases;
+	Py_ssize_t bases_start;
+
+	//start position of next window, 0-based
+	Py_ssize_t next;
+
+	//name and seq columns of batch
+	pyfastx_BatchColumn names;
+	pyfastx_BatchColumn seqs;
+
+} pyfastx_SequenceWindows;
+
 extern PyTypeObject pyfastx_SequenceType;
+extern PyTypeObject pyfastx_SequenceWindowsType;
 
+pyfastx_Sequence *pyfastx_sequence_alloc(void);
+char *pyfastx_sequence_reserve(pyfastx_Sequence *self, Py_ssize_t size);
 Py_ssize_t pyfastx_sequence_length(pyfastx_Sequence* self);
 char *pyfastx_sequence_acquire(pyfastx_Sequence* self);
 int pyfastx_sequence_contains(pyfastx_Sequence *self, PyObject *key);
+pyfastx_SequenceWindows *pyfastx_sequence_windows_create(pyfastx_Sequence *self, Py_ssize_t size, Py_ssize_t step, int uppercase, Py_ssize_t batch);
+Py_ssize_t pyfastx_sequence_windows_step(pyfastx_SequenceWindows *self, char **window);
+Py_ssize_t pyfastx_sequence_read_chunk(pyfastx_Sequence *self, char *buff, Py_ssize_t offset, Py_ssize_t bytes);
+int pyfastx_sequence_locate(pyfastx_Sequence *self, Py_ssize_t start, Py_ssize_t end, Py_ssize_t *offset, Py_ssize_t *bytes);
+int pyfastx_sequence_block_counts(pyfastx_Sequence *self, Py_ssize_t *counts);
 
 char *pyfastx_sequence_get_subseq(pyfastx_Sequence* self);
 char *pyfastx_sequence_get_fullseq(pyfastx_Sequence* self);
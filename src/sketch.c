@@ -0,0 +1,675 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "sketch.h"
+#include "util.h"
+#include "parallel.h"
+
+PyObject *pyfastx_minimizer_iter_create(PyObject *parent, PyObject *args, PyObject *kwargs) {
+	int k;
+	int w;
+	int canonical = 1;
+	pyfastx_MinimizerIter *obj;
+
+	static char* keywords[] = {"k", "w", "canonical", NULL};
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "ii|p", keywords, &k, &w, &canonical)) {
+		return NULL;
+	}
+
+	if (w <= 0) {
+		PyErr_SetString(PyExc_ValueError, "w must be greater than 0");
+		return NULL;
+	}
+
+	obj = PyObject_New(pyfastx_MinimizerIter, &pyfastx_MinimizerIterType);
+
+	if (!obj) {
+		return NULL;
+	}
+
+	obj->w = w;
+	obj->head = 0;
+	obj->size = 0;
+	obj->last = -2;
+	obj->run = 0;
+	obj->emitted = -1;
+	obj->hashes = (uint64_t *)malloc(w * sizeof(uint64_t));
+	obj->values = (uint64_t *)malloc(w * sizeof(uint64_t));
+	obj->positions = (Py_ssize_t *)malloc(w * sizeof(Py_ssize_t));
+	obj->kmers = pyfastx_kmer_iter_new(parent, NULL, NULL, k, canonical);
+
+	if (!obj->kmers) {
+		Py_DECREF(obj);
+		return NULL;
+	}
+
+	if (!obj->hashes || !obj->values || !obj->positions) {
+		Py_DECREF(obj);
+		return PyErr_NoMemory();
+	}
+
+	return (PyObject *)obj;
+}
+
+void pyfastx_minimizer_iter_dealloc(pyfastx_MinimizerIter *self) {
+	free(self->hashes);
+	free(self->values);
+	free(self->positions);
+	Py_XDECREF(self->kmers);
+	PyObject_Del(self);
+}
+
+PyObject *pyfastx_minimizer_iter_iter(pyfastx_MinimizerIter *self) {
+	Py_INCREF(self);
+	return (PyObject *)self;
+}
+
+/*
+the minimizer of each window of w consecutive k-mers is the k-mer with the
+smallest hash, the leftmost one is taken if tied. k-mers in window are kept
+in a monotone deque with increasing hash, so each k-mer is pushed and
+popped at most once. A minimizer shared by adjacent windows is output once
+*/
+PyObject *pyfastx_minimizer_iter_next(pyfastx_MinimizerIter *self) {
+	uint64_t kmer;
+	uint64_t hash;
+	Py_ssize_t pos;
+	int w = self->w;
+	int i;
+
+	while (pyfastx_kmer_iter_step(self->kmers, &kmer, &pos)) {
+		//k-mers containing N are skipped, restart windows after them
+		if (pos != self->last + 1) {
+			self->size = 0;
+			self->run = 0;
+			self->emitted = -1;
+		}
+
+		self->last = pos;
+		++self->run;
+		hash = pyfastx_kmer_hash(kmer);
+
+		//drop the k-mer moved out of window from front
+		if (self->size && self->positions[self->head] <= pos - w) {
+			self->head = (self->head + 1) % w;
+			--self->size;
+		}
+
+		//drop k-mers with larger hash from back
+		while (self->size && self->hashes[(self->head + self->size - 1) % w] > hash) {
+			--self->size;
+		}
+
+		i = (self->head + self->size) % w;
+		self->hashes[i] = hash;
+		self->values[i] = kmer;
+		self->positions[i] = pos;
+		++self->size;
+
+		if (self->run >= w && self->positions[self->head] != self->emitted) {
+			self->emitted = self->positions[self->head];
+			return Py_BuildValue("nK", self->emitted, (unsigned long long)self->values[self->head]);
+		}
+	}
+
+	return NULL;
+}
+
+int pyfastx_sketch_hash_cmp(const void *a, const void *b) {
+	uint64_t x = *(const uint64_t *)a;
+	uint64_t y = *(const uint64_t *)b;
+	return (x > y) - (x < y);
+}
+
+int pyfastx_sketch_buffer_init(pyfastx_SketchBuffer *buf, Py_ssize_t size, uint64_t threshold) {
+	buf->n = 0;
+	buf->limit = size * 4 > PYFASTX_SKETCH_BUFFER ? size * 4 : PYFASTX_SKETCH_BUFFER;
+	buf->m = buf->limit;
+	buf->threshold = threshold;
+	buf->hashes = (uint64_t *)malloc(buf->m * sizeof(uint64_t));
+	return buf->hashes != NULL;
+}
+
+//sort and deduplicate hashes, only keep the smallest size hashes if size > 0
+void pyfastx_sketch_buffer_compact(pyfastx_SketchBuffer *buf, Py_ssize_t size) {
+	Py_ssize_t i;
+	Py_ssize_t n = 0;
+
+	qsort(buf->hashes, buf->n, sizeof(uint64_t), pyfastx_sketch_hash_cmp);
+
+	for (i = 0; i < buf->n; ++i) {
+		if (!n || buf->hashes[i] != buf->hashes[n-1]) {
+			buf->hashes[n++] = buf->hashes[i];
+		}
+	}
+
+	if (size && n >= size) {
+		n = size;
+		buf->threshold = buf->hashes[n-1];
+	}
+
+	buf->n = n;
+}
+
+int pyfastx_sketch_buffer_add(pyfastx_SketchBuffer *buf, uint64_t hash, Py_ssize_t size) {
+	uint64_t *tmp;
+
+	if (hash >= buf->threshold) {
+		return 1;
+	}
+
+	if (buf->n == buf->limit) {
+		pyfastx_sketch_buffer_compact(buf, size);
+
+		//FracMinHash buffer grows with the number of distinct hashes
+		if (buf->n * 2 > buf->limit) {
+			buf->limit = buf->n * 2;
+		}
+
+		if (buf->limit > buf->m) {
+			tmp = (uint64_t *)realloc(buf->hashes, buf->limit * sizeof(uint64_t));
+
+			if (!tmp) {
+				return 0;
+			}
+
+			buf->hashes = tmp;
+			buf->m = buf->limit;
+		}
+
+		if (hash >= buf->threshold) {
+			return 1;
+		}
+	}
+
+	buf->hashes[buf->n++] = hash;
+	return 1;
+}
+
+//add k-mers of sequence into buffer
+int pyfastx_sketch_buffer_add_seq(pyfastx_SketchBuffer *buf, Py_ssize_t size, pyfastx_KmerRoll *roll, char *seq, Py_ssize_t len) {
+	Py_ssize_t i;
+	uint64_t kmer;
+
+	roll->valid = 0;
+
+	for (i = 0; i < len; ++i) {
+		if (pyfastx_kmer_push(roll, seq[i], &kmer) && !pyfastx_sketch_buffer_add(buf, pyfastx_kmer_hash(kmer), size)) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+//merge compacted buffer of a thread into builder by merging sorted hashes
+void pyfastx_sketch_builder_merge(pyfastx_SketchBuilder *builder, pyfastx_SketchBuffer *buf) {
+	pyfastx_SketchBuffer *merged = &builder->merged;
+	uint64_t *out;
+	Py_ssize_t i = 0;
+	Py_ssize_t j = 0;
+	Py_ssize_t n = 0;
+	uint64_t x;
+
+	pyfastx_sketch_buffer_compact(buf, builder->size);
+
+	PyThread_acquire_lock(builder->lock, WAIT_LOCK);
+
+	out = (uint64_t *)malloc((merged->n + buf->n + 1) * sizeof(uint64_t));
+
+	if (!out) {
+		builder->error = 1;
+		PyThread_release_lock(builder->lock);
+		return;
+	}
+
+	while ((i < merged->n || j < buf->n) && (!builder->size || n < builder->size)) {
+		if (j >= buf->n || (i < merged->n && merged->hashes[i] <= buf->hashes[j])) {
+			x = merged->hashes[i++];
+
+			if (j < buf->n && buf->hashes[j] == x) {
+				++j;
+			}
+		} else {
+			x = buf->hashes[j++];
+		}
+
+		out[n++] = x;
+	}
+
+	free(merged->hashes);
+	merged->hashes = out;
+	merged->n = n;
+	merged->m = merged->limit = n + buf->n + 1;
+
+	if (builder->size && n == builder->size) {
+		builder->threshold = out[n-1];
+	}
+
+	PyThread_release_lock(builder->lock);
+}
+
+//sketch records of parsed chunk in worker thread
+void pyfastx_sketch_job(pyfastx_ParallelJob *job, void *data) {
+	pyfastx_SketchBuilder *builder = (pyfastx_SketchBuilder *)data;
+	pyfastx_KmerRoll roll = builder->roll;
+	pyfastx_SketchBuffer buf;
+	uint64_t threshold;
+	Py_ssize_t i;
+	int ok = 1;
+
+	PyThread_acquire_lock(builder->lock, WAIT_LOCK);
+	threshold = builder->threshold;
+	PyThread_release_lock(builder->lock);
+
+	if (!pyfastx_sketch_buffer_init(&buf, builder->size, threshold)) {
+		builder->error = 1;
+		return;
+	}
+
+	for (i = 0; i < job->count && ok; ++i) {
+		ok = pyfastx_sketch_buffer_add_seq(&buf, builder->size, &roll, job->seq.data.s + job->seq.offsets[i], job->seq.offsets[i+1] - job->seq.offsets[i]);
+	}
+
+	if (ok) {
+		pyfastx_sketch_builder_merge(builder, &buf);
+	} else {
+		builder->error = 1;
+	}
+
+	free(buf.hashes);
+}
+
+PyObject *pyfastx_sketch_new(uint64_t *hashes, Py_ssize_t n, int k, int canonical, Py_ssize_t size, Py_ssize_t scaled) {
+	pyfastx_Sketch *obj = PyObject_New(pyfastx_Sketch, &pyfastx_SketchType);
+
+	if (!obj) {
+		return NULL;
+	}
+
+	obj->k = k;
+	obj->canonical = canonical;
+	obj->size = size;
+	obj->scaled = scaled;
+	obj->count = n;
+	obj->hashes = PyBytes_FromStringAndSize((char *)hashes, n * sizeof(uint64_t));
+
+	if (!obj->hashes) {
+		Py_DECREF(obj);
+		return NULL;
+	}
+
+	return (PyObject *)obj;
+}
+
+/*
+build bottom-s MinHash sketch keeping the size smallest k-mer hashes, or
+FracMinHash sketch keeping hashes below 2^64/scaled if scaled > 0. If
+threads > 1, records are parsed by worker threads, each worker keeps the
+candidate hashes of a chunk and merges them into the shared sketch, the
+threshold of full sketch is passed to workers to drop hashes early.
+Sequence is sketched in a single thread if kseq is NULL
+*/
+PyObject *pyfastx_sketch_create(PyObject *parent, kseq_t *kseq, int format, pyfastx_Filter *filter, PyObject *args, PyObject *kwargs) {
+	int k = 21;
+	int canonical = 1;
+	int threads = 1;
+	int ok = 1;
+	int reason;
+	int error = 0;
+	uint64_t kmer;
+	Py_ssize_t pos;
+	Py_ssize_t size = 1000;
+	Py_ssize_t scaled = 0;
+	pyfastx_SketchBuilder builder;
+	pyfastx_SketchBuffer buf;
+	pyfastx_KmerIter *kmers;
+	pyfastx_Stream *stream;
+	pyfastx_Parallel *pool;
+	pyfastx_ParallelJob *job;
+	PyObject *ret;
+
+	static char* keywords[] = {"k", "size", "scaled", "canonical", "threads", NULL};
+	static char* seq_keywords[] = {"k", "size", "scaled", "canonical", NULL};
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, kseq ? "|innpi" : "|innp", kseq ? keywords : seq_keywords, &k, &size, &scaled, &canonical, &threads)) {
+		return NULL;
+	}
+
+	if (!pyfastx_kmer_roll_init(&builder.roll, k, canonical)) {
+		return NULL;
+	}
+
+	if (scaled < 0 || (!scaled && size <= 0)) {
+		PyErr_SetString(PyExc_ValueError, "size or scaled must be greater than 0");
+		return NULL;
+	}
+
+	if (threads <= 0) {
+		PyErr_SetString(PyExc_ValueError, "threads must be greater than 0");
+		return NULL;
+	}
+
+	//size is only used by bottom-s sketch
+	if (scaled) {
+		size = 0;
+	}
+
+	builder.size = size;
+	builder.threshold = scaled ? UINT64_MAX / scaled : UINT64_MAX;
+	builder.error = 0;
+
+	if (!kseq) {
+		kmers = pyfastx_kmer_iter_new(parent, NULL, NULL, k, canonical);
+
+		if (!kmers) {
+			return NULL;
+		}
+
+		if (!pyfastx_sketch_buffer_init(&buf, size, builder.threshold)) {
+			Py_DECREF(kmers);
+			return PyErr_NoMemory();
+		}
+
+		while (ok && pyfastx_kmer_iter_step(kmers, &kmer, &pos)) {
+			ok = pyfastx_sketch_buffer_add(&buf, pyfastx_kmer_hash(kmer), size);
+		}
+
+		Py_DECREF(kmers);
+
+		if (PyErr_Occurred()) {
+			free(buf.hashes);
+			return NULL;
+		}
+	} else if (threads > 1) {
+		if (!pyfastx_sketch_buffer_init(&builder.merged, 0, builder.threshold)) {
+			return PyErr_NoMemory();
+		}
+
+		builder.lock = PyThread_allocate_lock();
+		stream = kseq->f->f;
+
+		if (filter) {
+			pyfastx_filter_reset(filter);
+		}
+
+		pyfastx_stream_rewind(stream);
+		pyfastx_stream_readahead(stream, 1);
+		kseq_rewind(kseq);
+
+		pool = builder.lock ? pyfastx_parallel_create(stream, threads, 0, PYFASTX_SKETCH_CHUNK, format, 0, 0, 0, filter) : NULL;
+
+		if (!pool) {
+			if (builder.lock) {
+				PyThread_free_lock(builder.lock);
+			}
+
+			free(builder.merged.hashes);
+
+			if (!PyErr_Occurred()) {
+				PyErr_SetString(PyExc_RuntimeError, "can not start sketching threads");
+			}
+
+			return NULL;
+		}
+
+		pool->handler = pyfastx_sketch_job;
+		pool->data = &builder;
+
+		Py_BEGIN_ALLOW_THREADS
+		while ((job = pyfastx_parallel_next(pool)) != NULL) {
+			pyfastx_parallel_feed(pool, job);
+		}
+
+		error = pool->error;
+		pyfastx_parallel_free(pool);
+		Py_END_ALLOW_THREADS
+
+		PyThread_free_lock(builder.lock);
+		buf = builder.merged;
+		ok = !builder.error;
+	} else {
+		if (!pyfastx_sketch_buffer_init(&buf, size, builder.threshold)) {
+			return PyErr_NoMemory();
+		}
+
+		if (filter) {
+			pyfastx_filter_reset(filter);
+		}
+
+		pyfastx_stream_rewind(kseq->f->f);
+		pyfastx_stream_readahead(kseq->f->f, 1);
+		kseq_rewind(kseq);
+
+		Py_BEGIN_ALLOW_THREADS
+		while (ok && kseq_read(kseq) >= 0) {
+			if (filter) {
+				reason = pyfastx_filter_test(filter, kseq->name.s, kseq->name.l, kseq->seq.s, kseq->seq.l, kseq->qual.s, kseq->qual.l);
+				++filter->counts[reason];
+
+				if (reason) {
+					continue;
+				}
+			}
+
+			ok = pyfastx_sketch_buffer_add_seq(&buf, size, &builder.roll, kseq->seq.s, kseq->seq.l);
+		}
+		Py_END_ALLOW_THREADS
+	}
+
+	if (pyfastx_parallel_raise(error) < 0) {
+		free(buf.hashes);
+		return NULL;
+	}
+
+	if (!ok) {
+		free(buf.hashes);
+		return PyErr_NoMemory();
+	}
+
+	pyfastx_sketch_buffer_compact(&buf, size);
+	ret = pyfastx_sketch_new(buf.hashes, buf.n, k, canonical, size, scaled);
+	free(buf.hashes);
+
+	return ret;
+}
+
+void pyfastx_sketch_dealloc(pyfastx_Sketch *self) {
+	Py_XDECREF(self->hashes);
+	PyObject_Del(self);
+}
+
+Py_ssize_t pyfastx_sketch_length(pyfastx_Sketch *self) {
+	return self->count;
+}
+
+/*
+walk the union of two sorted hash lists in ascending order, stop at hashes
+larger than bound or after limit hashes of union if limit > 0, count the
+hashes of union, hashes in both and hashes in a
+*/
+void pyfastx_sketch_overlap(uint64_t *a, Py_ssize_t na, uint64_t *b, Py_ssize_t nb, uint64_t bound, Py_ssize_t limit, Py_ssize_t *both, Py_ssize_t *total, Py_ssize_t *in_a) {
+	Py_ssize_t i = 0;
+	Py_ssize_t j = 0;
+
+	*both = *total = *in_a = 0;
+
+	while ((i < na || j < nb) && (!limit || *total < limit)) {
+		if (j >= nb || (i < na && a[i] < b[j])) {
+			if (a[i] > bound) {
+				break;
+			}
+
+			++*in_a;
+			++i;
+		} else if (i >= na || b[j] < a[i]) {
+			if (b[j] > bound) {
+				break;
+			}
+
+			++j;
+		} else {
+			if (a[i] > bound) {
+				break;
+			}
+
+			++*both;
+			++*in_a;
+			++i;
+			++j;
+		}
+
+		++*total;
+	}
+}
+
+//compare two sketches, return 0 if they were not built with the same settings
+int pyfastx_sketch_compare(pyfastx_Sketch *self, PyObject *other_obj, int containment, double *ret) {
+	pyfastx_Sketch *other;
+	uint64_t *a;
+	uint64_t *b;
+	uint64_t bound = UINT64_MAX;
+	Py_ssize_t limit = 0;
+	Py_ssize_t both;
+	Py_ssize_t total;
+	Py_ssize_t in_a;
+
+	if (!PyObject_TypeCheck(other_obj, &pyfastx_SketchType)) {
+		PyErr_SetString(PyExc_TypeError, "other must be a Sketch object");
+		return 0;
+	}
+
+	other = (pyfastx_Sketch *)other_obj;
+
+	if (self->k != other->k || self->canonical != other->canonical || !self->scaled != !other->scaled) {
+		PyErr_SetString(PyExc_ValueError, "sketches must be built with the same k, canonical and sketch type");
+		return 0;
+	}
+
+	a = (uint64_t *)PyBytes_AS_STRING(self->hashes);
+	b = (uint64_t *)PyBytes_AS_STRING(other->hashes);
+
+	if (self->scaled) {
+		//compare at the larger scaled of two sketches
+		bound = UINT64_MAX / (self->scaled > other->scaled ? self->scaled : other->scaled);
+	} else if (containment) {
+		//hashes of both sketches are complete below the smaller max hash
+		if (self->count == self->size && self->count) {
+			bound = a[self->count-1];
+		}
+
+		if (other->count == other->size && other->count && b[other->count-1] < bound) {
+			bound = b[other->count-1];
+		}
+	} else {
+		limit = self->size < other->size ? self->size : other->size;
+	}
+
+	pyfastx_sketch_overlap(a, self->count, b, other->count, bound, limit, &both, &total, &in_a);
+
+	if (containment) {
+		*ret = in_a ? (double)both / in_a : 0;
+	} else {
+		*ret = total ? (double)both / total : 0;
+	}
+
+	return 1;
+}
+
+PyObject *pyfastx_sketch_jaccard(pyfastx_Sketch *self, PyObject *other) {
+	double ret;
+
+	if (!pyfastx_sketch_compare(self, other, 0, &ret)) {
+		return NULL;
+	}
+
+	return Py_BuildValue("d", ret);
+}
+
+PyObject *pyfastx_sketch_containment(pyfastx_Sketch *self, PyObject *other) {
+	double ret;
+
+	if (!pyfastx_sketch_compare(self, other, 1, &ret)) {
+		return NULL;
+	}
+
+	return Py_BuildValue("d", ret);
+}
+
+PyObject *pyfastx_sketch_get_hashes(pyfastx_Sketch *self, void* closure) {
+	PyObject *view = PyMemoryView_FromObject(self->hashes);
+	PyObject *ret;
+
+	if (!view) {
+		return NULL;
+	}
+
+	ret = PyObject_CallMethod(view, "cast", "s", "Q");
+	Py_DECREF(view);
+	return ret;
+}
+
+PyObject *pyfastx_sketch_get_k(pyfastx_Sketch *self, void* closure) {
+	return Py_BuildValue("i", self->k);
+}
+
+PyObject *pyfastx_sketch_get_size(pyfastx_Sketch *self, void* closure) {
+	return Py_BuildValue("n", self->size);
+}
+
+PyObject *pyfastx_sketch_get_scaled(pyfastx_Sketch *self, void* closure) {
+	return Py_BuildValue("n", self->scaled);
+}
+
+PyObject *pyfastx_sketch_get_canonical(pyfastx_Sketch *self, void* closure) {
+	return PyBool_FromLong(self->canonical);
+}
+
+PyObject *pyfastx_sketch_repr(pyfastx_Sketch *self) {
+	if (self->scaled) {
+		return PyUnicode_FromFormat("<Sketch> FracMinHash of %zd hashes with k=%d scaled=%zd", self->count, self->k, self->scaled);
+	}
+
+	return PyUnicode_FromFormat("<Sketch> MinHash of %zd hashes with k=%d", self->count, self->k);
+}
+
+static PyMethodDef pyfastx_sketch_methods[] = {
+	{"jaccard", (PyCFunction)pyfastx_sketch_jaccard, METH_O, NULL},
+	{"containment", (PyCFunction)pyfastx_sketch_containment, METH_O, NULL},
+	{NULL, NULL, 0, NULL}
+};
+
+static PyGetSetDef pyfastx_sketch_getsets[] = {
+	{"hashes", (getter)pyfastx_sketch_get_hashes, NULL, NULL, NULL},
+	{"k", (getter)pyfastx_sketch_get_k, NULL, NULL, NULL},
+	{"size", (getter)pyfastx_sketch_get_size, NULL, NULL, NULL},
+	{"scaled", (getter)pyfastx_sketch_get_scaled, NULL, NULL, NULL},
+	{"canonical", (getter)pyfastx_sketch_get_canonical, NULL, NULL, NULL},
+	{NULL}
+};
+
+static PySequenceMethods pyfastx_sketch_as_sequence = {
+	.sq_length = (lenfunc)pyfastx_sketch_length,
+};
+
+PyTypeObject pyfastx_SketchType = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "Sketch",
+	.tp_basicsize = sizeof(pyfastx_Sketch),
+	.tp_dealloc = (destructor)pyfastx_sketch_dealloc,
+	.tp_repr = (reprfunc)pyfastx_sketch_repr,
+	.tp_as_sequence = &pyfastx_sketch_as_sequence,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_methods = pyfastx_sketch_methods,
+	.tp_getset = pyfastx_sketch_getsets,
+};
+
+PyTypeObject pyfastx_MinimizerIterType = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "MinimizerIterator",
+	.tp_basicsize = sizeof(pyfastx_MinimizerIter),
+	.tp_dealloc = (destructor)pyfastx_minimizer_iter_dealloc,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_iter = (getiterfunc)pyfastx_minimizer_iter_iter,
+	.tp_iternext = (iternextfunc)pyfastx_minimizer_iter_next,
+};
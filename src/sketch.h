@@ -0,0 +1,97 @@
+#ifndef PYFASTX_SKETCH_H
+#define PYFASTX_SKETCH_H
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "kmer.h"
+
+//number of records in each chunk parsed by sketching threads
+#define PYFASTX_SKETCH_CHUNK 4096
+
+//min number of candidate hashes buffered before compacting
+#define PYFASTX_SKETCH_BUFFER 65536
+
+//(w,k)-minimizers of sequence found by sliding minimum over k-mer hashes
+typedef struct {
+	PyObject_HEAD
+
+	//k-mers of sequence
+	pyfastx_KmerIter *kmers;
+
+	//number of consecutive k-mers in a window
+	int w;
+
+	//ring deque of k-mers in window with increasing hash, w slots
+	uint64_t *hashes;
+	uint64_t *values;
+	Py_ssize_t *positions;
+	int head;
+	int size;
+
+	//position of last k-mer, k-mers around N are not consecutive
+	Py_ssize_t last;
+
+	//number of consecutive k-mers in current run
+	Py_ssize_t run;
+
+	//position of last output minimizer
+	Py_ssize_t emitted;
+
+} pyfastx_MinimizerIter;
+
+//bottom-s MinHash or FracMinHash sketch
+typedef struct {
+	PyObject_HEAD
+
+	int k;
+	int canonical;
+
+	//keep the s smallest hashes, 0 for FracMinHash
+	Py_ssize_t size;
+
+	//keep hashes <= 2^64/scaled, 0 for bottom-s MinHash
+	Py_ssize_t scaled;
+
+	//number of hashes
+	Py_ssize_t count;
+
+	//ascending uint64 hashes
+	PyObject *hashes;
+
+} pyfastx_Sketch;
+
+//hashes of k-mers kept by one thread before merging into sketch
+typedef struct {
+	uint64_t *hashes;
+	Py_ssize_t n;
+	Py_ssize_t m;
+
+	//compact buffer when it has this number of hashes
+	Py_ssize_t limit;
+
+	//only hashes smaller than threshold can enter sketch
+	uint64_t threshold;
+
+} pyfastx_SketchBuffer;
+
+//sketch shared by threads, merged under lock
+typedef struct {
+	Py_ssize_t size;
+	uint64_t threshold;
+
+	pyfastx_KmerRoll roll;
+	pyfastx_SketchBuffer merged;
+
+	PyThread_type_lock lock;
+
+	//failed to allocate memory
+	int error;
+
+} pyfastx_SketchBuilder;
+
+extern PyTypeObject pyfastx_MinimizerIterType;
+extern PyTypeObject pyfastx_SketchType;
+
+PyObject *pyfastx_minimizer_iter_create(PyObject *parent, PyObject *args, PyObject *kwargs);
+PyObject *pyfastx_sketch_create(PyObject *parent, kseq_t *kseq, int format, pyfastx_Filter *filter, PyObject *args, PyObject *kwargs);
+
+#endif
@@ -0,0 +1,887 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "stream.h"
+#include "util.h"
+
+void pyfastx_stream_ahead_stop(pyfastx_Stream *stream);
+
+#ifdef PYFASTX_LIBDEFLATE
+int pyfastx_inflate_backend = PYFASTX_INFLATE_LIBDEFLATE;
+#else
+int pyfastx_inflate_backend = PYFASTX_INFLATE_ZLIB;
+#endif
+
+/*check input file is whether zstd file
+@para file_obj str, input file path string
+@return bool, 1 is zstd format file, 0 is not zstd
+*/
+int is_zstd_format(PyObject *file_obj) {
+	int ret;
+	FILE* fd;
+	unsigned char magic[4] = {0};
+
+	fd = _Py_fopen_obj(file_obj, "rb");
+
+	if (fd == NULL) {
+		PyErr_Clear();
+		return 0;
+	}
+
+	ret = fread(magic, sizeof(magic), 1, fd);
+	fclose(fd);
+
+	if (ret != 1) {
+		return 0;
+	}
+
+	//zstd frame magic number 0xFD2FB528
+	if (magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+		return 1;
+	}
+
+	//skippable frame magic number 0x184D2A5?
+	if ((magic[0] & 0xf0) == 0x50 && magic[1] == 0x2a && magic[2] == 0x4d && magic[3] == 0x18) {
+		return 1;
+	}
+
+	return 0;
+}
+
+pyfastx_ZstdReader* pyfastx_zstd_open(FILE *fd, int own) {
+	size_t ret;
+	unsigned frames;
+	pyfastx_ZstdReader *reader;
+
+	reader = (pyfastx_ZstdReader *)calloc(1, sizeof(pyfastx_ZstdReader));
+	reader->fd = fd;
+	reader->own = own;
+
+	//try to read seek table from the end of file
+	reader->seekable = ZSTD_seekable_create();
+	ret = ZSTD_seekable_initFile(reader->seekable, fd);
+
+	if (ZSTD_isError(ret)) {
+		ZSTD_seekable_free(reader->seekable);
+		reader->seekable = NULL;
+	} else {
+		frames = ZSTD_seekable_getNumFrames(reader->seekable);
+
+		if (frames > 0) {
+			reader->size = ZSTD_seekable_getFrameDecompressedOffset(reader->seekable, frames-1) +
+						   ZSTD_seekable_getFrameDecompressedSize(reader->seekable, frames-1);
+		}
+
+		return reader;
+	}
+
+	//not seekable format, decompress frames one by one
+	FSEEK(fd, 0, SEEK_SET);
+
+	reader->dstream = ZSTD_createDStream();
+	ZSTD_initDStream(reader->dstream);
+
+	reader->in_size = ZSTD_DStreamInSize();
+	reader->in_buff = malloc(reader->in_size);
+	reader->input.src = reader->in_buff;
+	reader->input.size = 0;
+	reader->input.pos = 0;
+
+	return reader;
+}
+
+void pyfastx_zstd_close(pyfastx_ZstdReader *reader) {
+	if (reader->seekable) {
+		ZSTD_seekable_free(reader->seekable);
+	}
+
+	if (reader->dstream) {
+		ZSTD_freeDStream(reader->dstream);
+	}
+
+	if (reader->in_buff) {
+		free(reader->in_buff);
+	}
+
+	if (reader->own) {
+		fclose(reader->fd);
+	}
+
+	free(reader);
+}
+
+Py_ssize_t pyfastx_zstd_read(pyfastx_ZstdReader *reader, void *buff, Py_ssize_t bytes) {
+	size_t ret;
+	size_t pos;
+	ZSTD_outBuffer output;
+
+	//seekable file can decompress from any offset
+	if (reader->seekable) {
+		if (reader->offset + bytes > reader->size) {
+			bytes = reader->size - reader->offset;
+		}
+
+		if (bytes <= 0) {
+			return 0;
+		}
+
+		ret = ZSTD_seekable_decompress(reader->seekable, buff, bytes, reader->offset);
+
+		if (ZSTD_isError(ret)) {
+			return -1;
+		}
+
+		reader->offset += ret;
+		return ret;
+	}
+
+	output.dst = buff;
+	output.size = bytes;
+	output.pos = 0;
+
+	while (output.pos < output.size) {
+		if (reader->input.pos == reader->input.size && !reader->is_eof) {
+			reader->input.size = fread(reader->in_buff, 1, reader->in_size, reader->fd);
+			reader->input.pos = 0;
+			reader->is_eof = reader->input.size == 0;
+		}
+
+		pos = output.pos;
+		ret = ZSTD_decompressStream(reader->dstream, &output, &reader->input);
+
+		if (ZSTD_isError(ret)) {
+			return -1;
+		}
+
+		//no more data can be flushed
+		if (reader->is_eof && output.pos == pos) {
+			break;
+		}
+	}
+
+	reader->offset += output.pos;
+	return output.pos;
+}
+
+void pyfastx_zstd_rewind(pyfastx_ZstdReader *reader) {
+	reader->offset = 0;
+
+	if (reader->seekable) {
+		return;
+	}
+
+	FSEEK(reader->fd, 0, SEEK_SET);
+	ZSTD_DCtx_reset(reader->dstream, ZSTD_reset_session_only);
+	reader->input.size = 0;
+	reader->input.pos = 0;
+	reader->is_eof = 0;
+}
+
+//seekable file jumps to the frame directly, otherwise
+//decompress from the beginning to offset like gzseek
+int pyfastx_zstd_seek(pyfastx_ZstdReader *reader, Py_ssize_t offset) {
+	char buff[16384];
+	Py_ssize_t bytes;
+
+	if (reader->seekable) {
+		reader->offset = offset;
+		return 0;
+	}
+
+	if (offset < reader->offset) {
+		pyfastx_zstd_rewind(reader);
+	}
+
+	while (reader->offset < offset) {
+		bytes = offset - reader->offset;
+
+		if (bytes > (Py_ssize_t)sizeof(buff)) {
+			bytes = sizeof(buff);
+		}
+
+		if (pyfastx_zstd_read(reader, buff, bytes) <= 0) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+#ifdef PYFASTX_LIBDEFLATE
+/*check gzip file is whether bgzf file, the first gzip member
+should have the BC extra subfield that records the block size
+*/
+int is_bgzf_format(FILE *fd) {
+	unsigned char header[PYFASTX_BGZF_HEADER_SIZE];
+	int ret;
+
+	ret = fread(header, sizeof(header), 1, fd);
+	FSEEK(fd, 0, SEEK_SET);
+
+	if (ret != 1) {
+		return 0;
+	}
+
+	if (header[0] != 0x1f || header[1] != 0x8b || header[2] != 0x08 || !(header[3] & 0x04)) {
+		return 0;
+	}
+
+	//XLEN is 6, SI1 is B, SI2 is C and SLEN is 2
+	if (header[10] != 6 || header[11] != 0 || header[12] != 'B' || header[13] != 'C' || header[14] != 2 || header[15] != 0) {
+		return 0;
+	}
+
+	return 1;
+}
+
+pyfastx_BgzfReader* pyfastx_bgzf_open(FILE *fd) {
+	pyfastx_BgzfReader *reader;
+
+	reader = (pyfastx_BgzfReader *)calloc(1, sizeof(pyfastx_BgzfReader));
+	reader->fd = fd;
+	reader->decompressor = libdeflate_alloc_decompressor();
+	reader->in_buff = (unsigned char *)malloc(PYFASTX_BGZF_BLOCK_SIZE * 16);
+	reader->block = (unsigned char *)malloc(PYFASTX_BGZF_BLOCK_SIZE);
+
+	return reader;
+}
+
+void pyfastx_bgzf_close(pyfastx_BgzfReader *reader) {
+	libdeflate_free_decompressor(reader->decompressor);
+	free(reader->in_buff);
+	free(reader->block);
+	fclose(reader->fd);
+	free(reader);
+}
+
+//make sure the input buffer has at least bytes left to parse
+Py_ssize_t pyfastx_bgzf_fill(pyfastx_BgzfReader *reader, Py_ssize_t bytes) {
+	Py_ssize_t left = reader->in_len - reader->in_pos;
+
+	if (left >= bytes || reader->is_eof) {
+		return left;
+	}
+
+	memmove(reader->in_buff, reader->in_buff + reader->in_pos, left);
+	reader->in_pos = 0;
+	reader->in_len = left;
+	reader->in_len += fread(reader->in_buff + left, 1, PYFASTX_BGZF_BLOCK_SIZE * 16 - left, reader->fd);
+
+	if (reader->in_len < bytes) {
+		reader->is_eof = 1;
+	}
+
+	return reader->in_len;
+}
+
+/*inflate next bgzf block, the block is written into out directly if
+it has enough space, otherwise into the block buffer
+@return bytes written into out, 0 if written into block buffer or
+reach the end of file, -1 if block is damaged
+*/
+Py_ssize_t pyfastx_bgzf_next_block(pyfastx_BgzfReader *reader, unsigned char *out, Py_ssize_t size) {
+	Py_ssize_t bsize;
+	Py_ssize_t isize;
+	size_t in_bytes;
+	size_t out_bytes;
+	unsigned char *header;
+	unsigned char *dest;
+	enum libdeflate_result ret;
+
+	reader->block_pos = reader->block_len = 0;
+
+	while (1) {
+		if (pyfastx_bgzf_fill(reader, PYFASTX_BGZF_HEADER_SIZE) == 0) {
+			return 0;
+		}
+
+		if (reader->in_len - reader->in_pos < PYFASTX_BGZF_HEADER_SIZE) {
+			return -1;
+		}
+
+		header = reader->in_buff + reader->in_pos;
+
+		if (header[0] != 0x1f || header[1] != 0x8b || header[12] != 'B' || header[13] != 'C') {
+			return -1;
+		}
+
+		bsize = (header[16] | (header[17] << 8)) + 1;
+
+		if (pyfastx_bgzf_fill(reader, bsize) < bsize) {
+			return -1;
+		}
+
+		header = reader->in_buff + reader->in_pos;
+		isize = header[bsize-4] | (header[bsize-3] << 8) | (header[bsize-2] << 16) | ((Py_ssize_t)header[bsize-1] << 24);
+
+		//empty block also marks the end of file
+		if (isize == 0) {
+			reader->in_pos += bsize;
+			continue;
+		}
+
+		if (isize > PYFASTX_BGZF_BLOCK_SIZE) {
+			return -1;
+		}
+
+		dest = isize <= size ? out : reader->block;
+
+		ret = libdeflate_gzip_decompress_ex(reader->decompressor, header, bsize, dest, isize, &in_bytes, &out_bytes);
+
+		if (ret != LIBDEFLATE_SUCCESS || (Py_ssize_t)out_bytes != isize) {
+			return -1;
+		}
+
+		reader->in_pos += bsize;
+
+		if (dest == out) {
+			return isize;
+		}
+
+		reader->block_len = isize;
+		return 0;
+	}
+}
+
+Py_ssize_t pyfastx_bgzf_read(pyfastx_BgzfReader *reader, void *buff, Py_ssize_t bytes) {
+	Py_ssize_t ret;
+	Py_ssize_t len = 0;
+	unsigned char *out = (unsigned char *)buff;
+
+	while (len < bytes) {
+		if (reader->block_pos < reader->block_len) {
+			ret = reader->block_len - reader->block_pos;
+
+			if (ret > bytes - len) {
+				ret = bytes - len;
+			}
+
+			memcpy(out + len, reader->block + reader->block_pos, ret);
+			reader->block_pos += ret;
+			len += ret;
+			continue;
+		}
+
+		ret = pyfastx_bgzf_next_block(reader, out + len, bytes - len);
+
+		if (ret < 0) {
+			if (len == 0) {
+				return -1;
+			}
+
+			break;
+		}
+
+		if (ret == 0 && reader->block_len == 0) {
+			break;
+		}
+
+		len += ret;
+	}
+
+	reader->offset += len;
+	return len;
+}
+
+void pyfastx_bgzf_rewind(pyfastx_BgzfReader *reader) {
+	FSEEK(reader->fd, 0, SEEK_SET);
+	reader->in_pos = reader->in_len = 0;
+	reader->block_pos = reader->block_len = 0;
+	reader->offset = 0;
+	reader->is_eof = 0;
+}
+
+int pyfastx_bgzf_seek(pyfastx_BgzfReader *reader, Py_ssize_t offset) {
+	char buff[16384];
+	Py_ssize_t bytes;
+
+	if (offset < reader->offset) {
+		pyfastx_bgzf_rewind(reader);
+	}
+
+	while (reader->offset < offset) {
+		bytes = offset - reader->offset;
+
+		if (bytes > (Py_ssize_t)sizeof(buff)) {
+			bytes = sizeof(buff);
+		}
+
+		if (pyfastx_bgzf_read(reader, buff, bytes) <= 0) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+#endif
+
+pyfastx_Stream* pyfastx_stream_open(PyObject *file_obj) {
+	FILE *fd;
+	pyfastx_Stream *stream;
+
+	stream = (pyfastx_Stream *)calloc(1, sizeof(pyfastx_Stream));
+
+	if (is_zstd_format(file_obj)) {
+		fd = _Py_fopen_obj(file_obj, "rb");
+
+		if (fd == NULL) {
+			free(stream);
+			return NULL;
+		}
+
+		stream->zstd = pyfastx_zstd_open(fd, 1);
+		stream->cbuff = (unsigned char *)malloc(PYFASTX_STREAM_GETC_SIZE);
+		return stream;
+	}
+
+#ifdef PYFASTX_LIBDEFLATE
+	if (pyfastx_inflate_backend == PYFASTX_INFLATE_LIBDEFLATE && is_gzip_format(file_obj)) {
+		fd = _Py_fopen_obj(file_obj, "rb");
+
+		if (fd == NULL) {
+			free(stream);
+			return NULL;
+		}
+
+		if (is_bgzf_format(fd)) {
+			stream->bgzf = pyfastx_bgzf_open(fd);
+			stream->cbuff = (unsigned char *)malloc(PYFASTX_STREAM_GETC_SIZE);
+			return stream;
+		}
+
+		fclose(fd);
+	}
+#endif
+
+	stream->gzfd = pyfastx_gzip_open(file_obj, "rb");
+
+	if (stream->gzfd == NULL) {
+		free(stream);
+		return NULL;
+	}
+
+	gzbuffer(stream->gzfd, PYFASTX_GZIP_BUFFER_SIZE);
+
+	return stream;
+}
+
+void pyfastx_stream_close(pyfastx_Stream *stream) {
+	pyfastx_stream_ahead_stop(stream);
+
+	if (stream->gzfd) {
+		gzclose(stream->gzfd);
+	} else if (stream->zstd) {
+		pyfastx_zstd_close(stream->zstd);
+	}
+#ifdef PYFASTX_LIBDEFLATE
+	else {
+		pyfastx_bgzf_close(stream->bgzf);
+	}
+#endif
+
+	free(stream->cbuff);
+	free(stream);
+}
+
+//read from zstd or bgzf reader
+Py_ssize_t pyfastx_stream_read_reader(pyfastx_Stream *stream, void *buff, Py_ssize_t bytes) {
+#ifdef PYFASTX_LIBDEFLATE
+	if (stream->bgzf) {
+		return pyfastx_bgzf_read(stream->bgzf, buff, bytes);
+	}
+#endif
+
+	return pyfastx_zstd_read(stream->zstd, buff, bytes);
+}
+
+//read through gzip index, seek back first if random access has moved it
+Py_ssize_t pyfastx_stream_read_index(pyfastx_Stream *stream, void *buff, Py_ssize_t bytes) {
+	Py_ssize_t ret;
+
+	if (zran_tell(&stream->gzip_index->zran) != stream->index_offset) {
+		if (pyfastx_gzip_index_seek(stream->gzip_index, stream->index_offset) != ZRAN_SEEK_OK) {
+			return -1;
+		}
+	}
+
+	ret = pyfastx_gzip_index_read(stream->gzip_index, (char *)buff, bytes);
+
+	if (ret == ZRAN_READ_EOF) {
+		return 0;
+	}
+
+	if (ret > 0) {
+		stream->index_offset += ret;
+	}
+
+	return ret;
+}
+
+Py_ssize_t pyfastx_stream_direct_read(pyfastx_Stream *stream, void *buff, Py_ssize_t bytes) {
+	Py_ssize_t ret;
+	Py_ssize_t len;
+
+	if (stream->gzip_index) {
+		return pyfastx_stream_read_index(stream, buff, bytes);
+	}
+
+	if (stream->gzfd) {
+		return gzread(stream->gzfd, buff, bytes);
+	}
+
+	//consume the characters left by getc first
+	len = stream->clen - stream->cpos;
+
+	if (len > bytes) {
+		len = bytes;
+	}
+
+	if (len > 0) {
+		memcpy(buff, stream->cbuff + stream->cpos, len);
+		stream->cpos += len;
+	}
+
+	if (len == bytes) {
+		return len;
+	}
+
+	ret = pyfastx_stream_read_reader(stream, (char *)buff + len, bytes - len);
+
+	if (ret < 0) {
+		return len ? len : -1;
+	}
+
+	return len + ret;
+}
+
+int pyfastx_stream_direct_getc(pyfastx_Stream *stream) {
+	unsigned char c;
+
+	if (stream->gzip_index) {
+		return pyfastx_stream_read_index(stream, &c, 1) == 1 ? c : -1;
+	}
+
+	if (stream->gzfd) {
+		return gzgetc(stream->gzfd);
+	}
+
+	if (stream->cpos >= stream->clen) {
+		stream->cpos = 0;
+		stream->clen = pyfastx_stream_read_reader(stream, stream->cbuff, PYFASTX_STREAM_GETC_SIZE);
+
+		if (stream->clen <= 0) {
+			stream->clen = 0;
+			return -1;
+		}
+	}
+
+	return stream->cbuff[stream->cpos++];
+}
+
+Py_ssize_t pyfastx_stream_direct_seek(pyfastx_Stream *stream, Py_ssize_t offset) {
+	int ret;
+
+	if (stream->gzip_index) {
+		stream->index_offset = offset;
+		return offset;
+	}
+
+	if (stream->gzfd) {
+		return gzseek(stream->gzfd, offset, SEEK_SET);
+	}
+
+	stream->cpos = stream->clen = 0;
+
+#ifdef PYFASTX_LIBDEFLATE
+	if (stream->bgzf) {
+		ret = pyfastx_bgzf_seek(stream->bgzf, offset);
+	} else
+#endif
+	ret = pyfastx_zstd_seek(stream->zstd, offset);
+
+	return ret == 0 ? offset : -1;
+}
+
+Py_ssize_t pyfastx_stream_direct_tell(pyfastx_Stream *stream) {
+	Py_ssize_t offset;
+
+	if (stream->gzip_index) {
+		return stream->index_offset;
+	}
+
+	if (stream->gzfd) {
+		return gztell(stream->gzfd);
+	}
+
+#ifdef PYFASTX_LIBDEFLATE
+	if (stream->bgzf) {
+		offset = stream->bgzf->offset;
+	} else
+#endif
+	offset = stream->zstd->offset;
+
+	return offset - (stream->clen - stream->cpos);
+}
+
+void pyfastx_stream_direct_rewind(pyfastx_Stream *stream) {
+	//go back to read from the start of file by stream itself
+	stream->gzip_index = NULL;
+
+	if (stream->gzfd) {
+		gzrewind(stream->gzfd);
+		return;
+	}
+
+	stream->cpos = stream->clen = 0;
+
+#ifdef PYFASTX_LIBDEFLATE
+	if (stream->bgzf) {
+		pyfastx_bgzf_rewind(stream->bgzf);
+		return;
+	}
+#endif
+
+	pyfastx_zstd_rewind(stream->zstd);
+}
+
+//background thread fills the next buffer when requested
+void pyfastx_stream_ahead_worker(void *arg) {
+	pyfastx_Stream *stream = (pyfastx_Stream *)arg;
+
+	while (1) {
+		PyThread_acquire_lock(stream->request_lock, WAIT_LOCK);
+
+		if (stream->ahead_exit) {
+			break;
+		}
+
+		stream->next_len = pyfastx_stream_direct_read(stream, stream->next_buff, PYFASTX_STREAM_AHEAD_SIZE);
+		PyThread_release_lock(stream->ready_lock);
+	}
+
+	PyThread_release_lock(stream->ready_lock);
+}
+
+void pyfastx_stream_ahead_request(pyfastx_Stream *stream) {
+	stream->next_pending = 1;
+	PyThread_release_lock(stream->request_lock);
+}
+
+//wait for background thread to finish filling
+void pyfastx_stream_ahead_wait(pyfastx_Stream *stream) {
+	if (stream->next_pending) {
+		PyThread_acquire_lock(stream->ready_lock, WAIT_LOCK);
+		stream->next_pending = 0;
+		stream->next_ready = 1;
+	}
+}
+
+//drop the data that was read ahead before seeking
+void pyfastx_stream_ahead_discard(pyfastx_Stream *stream) {
+	pyfastx_stream_ahead_wait(stream);
+	stream->next_ready = 0;
+	stream->ahead_pos = 0;
+	stream->ahead_len = 0;
+}
+
+void pyfastx_stream_ahead_free(pyfastx_Stream *stream) {
+	if (stream->request_lock) {
+		PyThread_free_lock(stream->request_lock);
+	}
+
+	if (stream->ready_lock) {
+		PyThread_free_lock(stream->ready_lock);
+	}
+
+	free(stream->ahead_buff);
+	free(stream->next_buff);
+
+	stream->request_lock = NULL;
+	stream->ready_lock = NULL;
+	stream->ahead_buff = NULL;
+	stream->next_buff = NULL;
+	stream->readahead = 0;
+}
+
+void pyfastx_stream_ahead_stop(pyfastx_Stream *stream) {
+	if (!stream->ahead_buff) {
+		return;
+	}
+
+	pyfastx_stream_ahead_wait(stream);
+	stream->ahead_exit = 1;
+	PyThread_release_lock(stream->request_lock);
+	PyThread_acquire_lock(stream->ready_lock, WAIT_LOCK);
+	pyfastx_stream_ahead_free(stream);
+}
+
+/*turn on or off reading ahead in background thread, it should only be
+turned on for full file passes, data already read ahead is still
+consumed first after turning off
+*/
+void pyfastx_stream_readahead(pyfastx_Stream *stream, int on) {
+	if (on && !stream->ahead_buff) {
+		stream->request_lock = PyThread_allocate_lock();
+		stream->ready_lock = PyThread_allocate_lock();
+		stream->ahead_buff = (unsigned char *)malloc(PYFASTX_STREAM_AHEAD_SIZE);
+		stream->next_buff = (unsigned char *)malloc(PYFASTX_STREAM_AHEAD_SIZE);
+
+		if (!stream->request_lock || !stream->ready_lock || !stream->ahead_buff || !stream->next_buff) {
+			pyfastx_stream_ahead_free(stream);
+			return;
+		}
+
+		//both locks are held until they are released by the other side
+		PyThread_acquire_lock(stream->request_lock, NOWAIT_LOCK);
+		PyThread_acquire_lock(stream->ready_lock, NOWAIT_LOCK);
+
+		stream->ahead_pos = stream->ahead_len = 0;
+		stream->next_pending = stream->next_ready = 0;
+		stream->ahead_exit = 0;
+
+		if (PyThread_start_new_thread(pyfastx_stream_ahead_worker, stream) == PYTHREAD_INVALID_THREAD_ID) {
+			pyfastx_stream_ahead_free(stream);
+			return;
+		}
+	}
+
+	stream->readahead = on && stream->ahead_buff;
+}
+
+Py_ssize_t pyfastx_stream_read(pyfastx_Stream *stream, void *buff, Py_ssize_t bytes) {
+	Py_ssize_t len = 0;
+	Py_ssize_t ret;
+	unsigned char *tmp;
+
+	if (!stream->ahead_buff) {
+		return pyfastx_stream_direct_read(stream, buff, bytes);
+	}
+
+	while (len < bytes) {
+		ret = stream->ahead_len - stream->ahead_pos;
+
+		if (ret > 0) {
+			if (ret > bytes - len) {
+				ret = bytes - len;
+			}
+
+			memcpy((char *)buff + len, stream->ahead_buff + stream->ahead_pos, ret);
+			stream->ahead_pos += ret;
+			len += ret;
+			continue;
+		}
+
+		pyfastx_stream_ahead_wait(stream);
+
+		//swap the filled buffer in and request the next one
+		if (stream->next_ready) {
+			tmp = stream->ahead_buff;
+			stream->ahead_buff = stream->next_buff;
+			stream->next_buff = tmp;
+			stream->ahead_pos = 0;
+			stream->ahead_len = stream->next_len;
+			stream->next_ready = 0;
+
+			if (stream->ahead_len <= 0) {
+				ret = stream->ahead_len;
+				stream->ahead_len = 0;
+
+				if (ret < 0 && len == 0) {
+					return -1;
+				}
+
+				break;
+			}
+
+			if (stream->readahead) {
+				pyfastx_stream_ahead_request(stream);
+			}
+
+			continue;
+		}
+
+		if (stream->readahead) {
+			pyfastx_stream_ahead_request(stream);
+			continue;
+		}
+
+		ret = pyfastx_stream_direct_read(stream, (char *)buff + len, bytes - len);
+
+		if (ret < 0) {
+			return len ? len : -1;
+		}
+
+		len += ret;
+		break;
+	}
+
+	return len;
+}
+
+int pyfastx_stream_getc(pyfastx_Stream *stream) {
+	unsigned char c;
+
+	if (!stream->ahead_buff) {
+		return pyfastx_stream_direct_getc(stream);
+	}
+
+	if (stream->ahead_pos < stream->ahead_len) {
+		return stream->ahead_buff[stream->ahead_pos++];
+	}
+
+	return pyfastx_stream_read(stream, &c, 1) == 1 ? c : -1;
+}
+
+Py_ssize_t pyfastx_stream_seek(pyfastx_Stream *stream, Py_ssize_t offset) {
+	if (stream->ahead_buff) {
+		pyfastx_stream_ahead_discard(stream);
+	}
+
+	return pyfastx_stream_direct_seek(stream, offset);
+}
+
+Py_ssize_t pyfastx_stream_tell(pyfastx_Stream *stream) {
+	Py_ssize_t buffered = 0;
+
+	if (stream->ahead_buff) {
+		pyfastx_stream_ahead_wait(stream);
+
+		buffered = stream->ahead_len - stream->ahead_pos;
+
+		if (stream->next_ready && stream->next_len > 0) {
+			buffered += stream->next_len;
+		}
+	}
+
+	return pyfastx_stream_direct_tell(stream) - buffered;
+}
+
+/*seek to the offset from the nearest checkpoint of gzip index instead of
+inflating from the start of file, the following reads are served by gzip
+index until the stream is rewound, reading ahead is turned off as gzip
+index is shared with random access in main thread
+*/
+Py_ssize_t pyfastx_stream_seek_index(pyfastx_Stream *stream, struct pyfastx_GzipIndex *gzip_index, Py_ssize_t offset) {
+	pyfastx_stream_readahead(stream, 0);
+
+	if (stream->ahead_buff) {
+		pyfastx_stream_ahead_discard(stream);
+	}
+
+	stream->cpos = stream->clen = 0;
+	stream->gzip_index = gzip_index;
+	stream->index_offset = offset;
+
+	if (pyfastx_gzip_index_seek(gzip_index, offset) != ZRAN_SEEK_OK) {
+		return -1;
+	}
+
+	return offset;
+}
+
+void pyfastx_stream_rewind(pyfastx_Stream *stream) {
+	if (stream->ahead_buff) {
+		pyfastx_stream_ahead_discard(stream);
+	}
+
+	pyfastx_stream_direct_rewind(stream);
+}
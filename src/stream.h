@@ -0,0 +1,171 @@
+#ifndef PYFASTX_STREAM_H
+#define PYFASTX_STREAM_H
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "zlib.h"
+#include "zstd.h"
+#include "zstd_seekable.h"
+
+#ifdef PYFASTX_LIBDEFLATE
+#include "libdeflate.h"
+#endif
+
+//size of getc buffer used by zstd and bgzf stream
+#define PYFASTX_STREAM_GETC_SIZE 4096
+
+//size of buffer filled by read ahead thread
+#define PYFASTX_STREAM_AHEAD_SIZE 1048576
+
+//size of zlib internal buffer for reading gzip file
+#define PYFASTX_GZIP_BUFFER_SIZE 131072
+
+//inflate backend for streaming gzip file
+//zlib is always used by zran for random access
+#define PYFASTX_INFLATE_ZLIB 0
+#define PYFASTX_INFLATE_LIBDEFLATE 1
+
+//bgzf block has at most 64 KB compressed and uncompressed data
+#define PYFASTX_BGZF_BLOCK_SIZE 65536
+#define PYFASTX_BGZF_HEADER_SIZE 18
+
+extern int pyfastx_inflate_backend;
+
+//gzip random access index defined in util.h
+struct pyfastx_GzipIndex;
+
+//zstd decompression reader on an opened file
+typedef struct {
+	//compressed file handle
+	FILE *fd;
+
+	//close file handle when reader is freed
+	int own;
+
+	//streaming decompression context
+	ZSTD_DStream *dstream;
+
+	//compressed input buffer
+	void *in_buff;
+	size_t in_size;
+	ZSTD_inBuffer input;
+
+	//seek table of zstd seekable format
+	//NULL if the file only can be read sequentially
+	ZSTD_seekable *seekable;
+
+	//uncompressed size of seekable file
+	Py_ssize_t size;
+
+	//current uncompressed offset
+	Py_ssize_t offset;
+
+	//reach the end of compressed file
+	int is_eof;
+
+} pyfastx_ZstdReader;
+
+//bgzf reader, each block is inflated as a whole buffer by libdeflate
+typedef struct {
+	//compressed file handle
+	FILE *fd;
+
+	//whole buffer decompressor
+	struct libdeflate_decompressor *decompressor;
+
+	//compressed input buffer
+	unsigned char *in_buff;
+	Py_ssize_t in_pos;
+	Py_ssize_t in_len;
+
+	//inflated block that not fully consumed
+	unsigned char *block;
+	Py_ssize_t block_pos;
+	Py_ssize_t block_len;
+
+	//current uncompressed offset
+	Py_ssize_t offset;
+
+	//reach the end of compressed file
+	int is_eof;
+
+} pyfastx_BgzfReader;
+
+//plain, gzip or zstd compressed file stream
+typedef struct {
+	//plain or gzip file opened by zlib
+	//NULL if file is read by zstd or bgzf reader
+	gzFile gzfd;
+
+	//zstd file reader
+	pyfastx_ZstdReader *zstd;
+
+	//bgzf file reader
+	pyfastx_BgzfReader *bgzf;
+
+	//buffer for reading zstd or bgzf stream one character each time
+	unsigned char *cbuff;
+	Py_ssize_t cpos;
+	Py_ssize_t clen;
+
+	//gzip random access index that serves reading after seeking to
+	//a checkpoint, shared with random access and not owned by stream
+	struct pyfastx_GzipIndex *gzip_index;
+
+	//uncompressed offset of reading through gzip index
+	Py_ssize_t index_offset;
+
+	//read ahead in background thread for full file passes
+	int readahead;
+
+	//buffer being consumed
+	unsigned char *ahead_buff;
+	Py_ssize_t ahead_pos;
+	Py_ssize_t ahead_len;
+
+	//buffer being filled by background thread
+	unsigned char *next_buff;
+	Py_ssize_t next_len;
+
+	//a fill request was sent and has not been waited
+	int next_pending;
+
+	//next buffer was filled and has not been consumed
+	int next_ready;
+
+	//released by reader to request a fill and by thread when filled
+	PyThread_type_lock request_lock;
+	PyThread_type_lock ready_lock;
+
+	//tell background thread to exit
+	int ahead_exit;
+
+} pyfastx_Stream;
+
+int is_zstd_format(PyObject *file_obj);
+
+pyfastx_ZstdReader* pyfastx_zstd_open(FILE *fd, int own);
+void pyfastx_zstd_close(pyfastx_ZstdReader *reader);
+Py_ssize_t pyfastx_zstd_read(pyfastx_ZstdReader *reader, void *buff, Py_ssize_t bytes);
+int pyfastx_zstd_seek(pyfastx_ZstdReader *reader, Py_ssize_t offset);
+void pyfastx_zstd_rewind(pyfastx_ZstdReader *reader);
+
+#ifdef PYFASTX_LIBDEFLATE
+int is_bgzf_format(FILE *fd);
+pyfastx_BgzfReader* pyfastx_bgzf_open(FILE *fd);
+void pyfastx_bgzf_close(pyfastx_BgzfReader *reader);
+Py_ssize_t pyfastx_bgzf_read(pyfastx_BgzfReader *reader, void *buff, Py_ssize_t bytes);
+int pyfastx_bgzf_seek(pyfastx_BgzfReader *reader, Py_ssize_t offset);
+void pyfastx_bgzf_rewind(pyfastx_BgzfReader *reader);
+#endif
+
+pyfastx_Stream* pyfastx_stream_open(PyObject *file_obj);
+void pyfastx_stream_close(pyfastx_Stream *stream);
+Py_ssize_t pyfastx_stream_read(pyfastx_Stream *stream, void *buff, Py_ssize_t bytes);
+int pyfastx_stream_getc(pyfastx_Stream *stream);
+Py_ssize_t pyfastx_stream_seek(pyfastx_Stream *stream, Py_ssize_t offset);
+Py_ssize_t pyfastx_stream_tell(pyfastx_Stream *stream);
+Py_ssize_t pyfastx_stream_seek_index(pyfastx_Stream *stream, struct pyfastx_GzipIndex *gzip_index, Py_ssize_t offset);
+void pyfastx_stream_rewind(pyfastx_Stream *stream);
+void pyfastx_stream_readahead(pyfastx_Stream *stream, int on);
+
+#endif
@@ -92,10 +92,10 @@ int file_exists(PyObject *file_obj){
 }
 
 //check file is fasta file
-int fasta_validator(gzFile fd) {
+int fasta_validator(pyfastx_Stream *fd) {
 	int c;
 
-	while ((c=gzgetc(fd)) != -1) {
+	while ((c=pyfastx_stream_getc(fd)) != -1) {
 		if (isspace(c)) {
 			continue;
 		}
@@ -110,10 +110,10 @@ int fasta_validator(gzFile fd) {
 	return 0;
 }
 
-int fastq_validator(gzFile fd) {
+int fastq_validator(pyfastx_Stream *fd) {
 	int c;
 
-	while ((c=gzgetc(fd)) != -1) {
+	while ((c=pyfastx_stream_getc(fd)) != -1) {
 		if (isspace(c)) {
 			continue;
 		}
@@ -129,10 +129,10 @@ int fastq_validator(gzFile fd) {
 }
 
 //check file is fasta or fastq file
-int fasta_or_fastq(gzFile fd) {
+int fasta_or_fastq(pyfastx_Stream *fd) {
 	int c;
 
-	while ((c=gzgetc(fd)) != -1) {
+	while ((c=pyfastx_stream_getc(fd)) != -1) {
 		if (isspace(c)) {
 			continue;
 		}
@@ -236,35 +236,464 @@ int comp_map[128] = {
 	112, 113, 121, 115,  97,  97,  98, 119, 120, 114, 122, 123, 124, 125, 126, 127,
 };
 
-void reverse_complement_seq(char *seq) {
+//instruction set used by sequence kernels, detected when module is imported
+static int simd_level = PYFASTX_SIMD_NONE;
+
+//complement of IUPAC letters indexed by the low 5 bits, letters are always
+//complemented to letters of the same case, e.g. A(0x41) -> T(0x54)
+static const uint8_t comp_low[32] = {
+	 0, 20, 22,  7,  8,  5,  6,  3,  4,  9, 10, 13, 12, 11, 14, 15,
+	16, 17, 25, 19,  1,  1,  2, 23, 24, 18, 26, 27, 28, 29, 30, 31,
+};
+
+#define COMP_BASE(c) (Py_CHARMASK(c) < 128 ? comp_map[Py_CHARMASK(c)] : (c))
+
+int pyfastx_simd_init(void) {
+#if defined(PYFASTX_X86_SIMD)
+	__builtin_cpu_init();
+
+	if (__builtin_cpu_supports("avx2")) {
+		simd_level = PYFASTX_SIMD_AVX2;
+	} else if (__builtin_cpu_supports("ssse3")) {
+		simd_level = PYFASTX_SIMD_SSSE3;
+	}
+#elif defined(PYFASTX_ARM_SIMD)
+	simd_level = PYFASTX_SIMD_NEON;
+#endif
+
+	return simd_level;
+}
+
+//reverse and/or complement len bases from both ends to the middle
+static void transform_seq_scalar(char *seq, Py_ssize_t len, int reverse, int complement) {
 	char c;
 	char *p1 = seq;
-	char *p2 = seq + strlen(seq) - 1;
+	char *p2 = seq + len - 1;
+
+	if (!reverse) {
+		for (; p1 <= p2; ++p1) {
+			*p1 = COMP_BASE(*p1);
+		}
+		return;
+	}
+
+	if (!complement) {
+		while (p1 < p2) {
+			c = *p1;
+			*p1++ = *p2;
+			*p2-- = c;
+		}
+		return;
+	}
 
 	while (p1 <= p2) {
-		c = comp_map[Py_CHARMASK(*p1)];
-		*p1++ = comp_map[Py_CHARMASK(*p2)];
+		c = COMP_BASE(*p1);
+		*p1++ = COMP_BASE(*p2);
 		*p2-- = c;
 	}
 }
 
-void reverse_seq(char *seq) {
-	int c;
+#if defined(PYFASTX_X86_SIMD)
+//letters (0x40-0x7F) keep bits 5-7 and look up the low 5 bits in two
+//16-entry shuffle tables, other bytes are not changed
+__attribute__((target("ssse3")))
+static inline __m128i complement_ssse3(__m128i v) {
+	const __m128i lo = _mm_loadu_si128((const __m128i *)comp_low);
+	const __m128i hi = _mm_loadu_si128((const __m128i *)(comp_low + 16));
+	__m128i idx = _mm_and_si128(v, _mm_set1_epi8(0x1F));
+	__m128i sel = _mm_cmpgt_epi8(idx, _mm_set1_epi8(0x0F));
+	__m128i r = _mm_or_si128(_mm_andnot_si128(sel, _mm_shuffle_epi8(lo, idx)), _mm_and_si128(sel, _mm_shuffle_epi8(hi, idx)));
+	__m128i letter = _mm_cmpgt_epi8(v, _mm_set1_epi8(0x3F));
+	r = _mm_or_si128(r, _mm_and_si128(v, _mm_set1_epi8((char)0xE0)));
+	return _mm_or_si128(_mm_and_si128(letter, r), _mm_andnot_si128(letter, v));
+}
+
+__attribute__((target("ssse3")))
+static inline __m128i reverse_ssse3(__m128i v) {
+	return _mm_shuffle_epi8(v, _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+__attribute__((target("ssse3")))
+static void transform_seq_ssse3(char *seq, Py_ssize_t len, int reverse, int complement) {
+	__m128i a, b;
 	char *p1 = seq;
-	char *p2 = seq + strlen(seq) - 1;
+	char *p2 = seq + len;
 
-	while (p1 < p2) {
-		c = *p1;
-		*p1++ = *p2;
-		*p2-- = c;
+	//swap 16 bytes from head with 16 bytes from tail
+	while (p2 - p1 >= 32) {
+		a = _mm_loadu_si128((const __m128i *)p1);
+		b = _mm_loadu_si128((const __m128i *)(p2 - 16));
+
+		if (complement) {
+			a = complement_ssse3(a);
+			b = complement_ssse3(b);
+		}
+
+		if (reverse) {
+			_mm_storeu_si128((__m128i *)p1, reverse_ssse3(b));
+			_mm_storeu_si128((__m128i *)(p2 - 16), reverse_ssse3(a));
+		} else {
+			_mm_storeu_si128((__m128i *)p1, a);
+			_mm_storeu_si128((__m128i *)(p2 - 16), b);
+		}
+
+		p1 += 16;
+		p2 -= 16;
 	}
+
+	transform_seq_scalar(p1, p2 - p1, reverse, complement);
 }
 
-void complement_seq(char *seq) {
-	int c;
+__attribute__((target("avx2")))
+static inline __m256i complement_avx2(__m256i v) {
+	const __m256i lo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)comp_low));
+	const __m256i hi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(comp_low + 16)));
+	__m256i idx = _mm256_and_si256(v, _mm256_set1_epi8(0x1F));
+	__m256i sel = _mm256_cmpgt_epi8(idx, _mm256_set1_epi8(0x0F));
+	__m256i r = _mm256_blendv_epi8(_mm256_shuffle_epi8(lo, idx), _mm256_shuffle_epi8(hi, idx), sel);
+	__m256i letter = _mm256_cmpgt_epi8(v, _mm256_set1_epi8(0x3F));
+	r = _mm256_or_si256(r, _mm256_and_si256(v, _mm256_set1_epi8((char)0xE0)));
+	return _mm256_blendv_epi8(v, r, letter);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i reverse_avx2(__m256i v) {
+	const __m256i idx = _mm256_setr_epi8(
+		15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+		15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0
+	);
+
+	//reverse bytes in each 128-bit lane, then swap the two lanes
+	return _mm256_permute4x64_epi64(_mm256_shuffle_epi8(v, idx), 0x4E);
+}
+
+__attribute__((target("avx2")))
+static void transform_seq_avx2(char *seq, Py_ssize_t len, int reverse, int complement) {
+	__m256i a, b;
+	char *p1 = seq;
+	char *p2 = seq + len;
+
+	while (p2 - p1 >= 64) {
+		a = _mm256_loadu_si256((const __m256i *)p1);
+		b = _mm256_loadu_si256((const __m256i *)(p2 - 32));
 
-	while ((c = *seq)) {
-		*seq++ = comp_map[Py_CHARMASK(c)];
+		if (complement) {
+			a = complement_avx2(a);
+			b = complement_avx2(b);
+		}
+
+		if (reverse) {
+			_mm256_storeu_si256((__m256i *)p1, reverse_avx2(b));
+			_mm256_storeu_si256((__m256i *)(p2 - 32), reverse_avx2(a));
+		} else {
+			_mm256_storeu_si256((__m256i *)p1, a);
+			_mm256_storeu_si256((__m256i *)(p2 - 32), b);
+		}
+
+		p1 += 32;
+		p2 -= 32;
+	}
+
+	transform_seq_ssse3(p1, p2 - p1, reverse, complement);
+}
+#endif
+
+#if defined(PYFASTX_ARM_SIMD)
+static inline uint8x16_t complement_neon(uint8x16_t v, uint8x16x2_t table) {
+	uint8x16_t r = vqtbl2q_u8(table, vandq_u8(v, vdupq_n_u8(0x1F)));
+	uint8x16_t letter = vcgtq_s8(vreinterpretq_s8_u8(v), vdupq_n_s8(0x3F));
+	r = vorrq_u8(r, vandq_u8(v, vdupq_n_u8(0xE0)));
+	return vbslq_u8(letter, r, v);
+}
+
+static inline uint8x16_t reverse_neon(uint8x16_t v) {
+	v = vrev64q_u8(v);
+	return vextq_u8(v, v, 8);
+}
+
+static void transform_seq_neon(char *seq, Py_ssize_t len, int reverse, int complement) {
+	uint8x16_t a, b;
+	uint8x16x2_t table;
+	uint8_t *p1 = (uint8_t *)seq;
+	uint8_t *p2 = (uint8_t *)seq + len;
+
+	table.val[0] = vld1q_u8(comp_low);
+	table.val[1] = vld1q_u8(comp_low + 16);
+
+	while (p2 - p1 >= 32) {
+		a = vld1q_u8(p1);
+		b = vld1q_u8(p2 - 16);
+
+		if (complement) {
+			a = complement_neon(a, table);
+			b = complement_neon(b, table);
+		}
+
+		if (reverse) {
+			vst1q_u8(p1, reverse_neon(b));
+			vst1q_u8(p2 - 16, reverse_neon(a));
+		} else {
+			vst1q_u8(p1, a);
+			vst1q_u8(p2 - 16, b);
+		}
+
+		p1 += 16;
+		p2 -= 16;
+	}
+
+	transform_seq_scalar((char *)p1, p2 - p1, reverse, complement);
+}
+#endif
+
+static void transform_seq(char *seq, Py_ssize_t len, int reverse, int complement) {
+	switch (simd_level) {
+#if defined(PYFASTX_X86_SIMD)
+		case PYFASTX_SIMD_AVX2:
+			transform_seq_avx2(seq, len, reverse, complement);
+			break;
+
+		case PYFASTX_SIMD_SSSE3:
+			transform_seq_ssse3(seq, len, reverse, complement);
+			break;
+#elif defined(PYFASTX_ARM_SIMD)
+		case PYFASTX_SIMD_NEON:
+			transform_seq_neon(seq, len, reverse, complement);
+			break;
+#endif
+		default:
+			transform_seq_scalar(seq, len, reverse, complement);
+	}
+}
+
+void reverse_complement_seq(char *seq, Py_ssize_t len) {
+	transform_seq(seq, len, 1, 1);
+}
+
+void reverse_seq(char *seq, Py_ssize_t len) {
+	transform_seq(seq, len, 1, 0);
+}
+
+void complement_seq(char *seq, Py_ssize_t len) {
+	transform_seq(seq, len, 0, 1);
+}
+
+//letters counted by vector compares, other bytes fall back to scalar histogram
+static const char hist_letters[10] = {'A', 'C', 'G', 'T', 'N', 'a', 'c', 'g', 't', 'n'};
+
+//bytes counted into interleaved tables before adding to counts
+#define HIST_CHUNK 1073741824
+
+//histogram of bytes with four interleaved tables, so that runs of the same
+//letter do not wait for the increment of one counter
+static void count_bytes_scalar(const uint8_t *s, Py_ssize_t len, Py_ssize_t *counts) {
+	int j;
+	Py_ssize_t i;
+	Py_ssize_t n;
+	uint32_t t[4][256];
+
+	//clearing tables costs more than counting short lines
+	if (len < 1024) {
+		for (i = 0; i < len; ++i) {
+			++counts[s[i]];
+		}
+		return;
+	}
+
+	while (len > 0) {
+		n = len < HIST_CHUNK ? len : HIST_CHUNK;
+		memset(t, 0, sizeof(t));
+
+		for (i = 0; i + 4 <= n; i += 4) {
+			++t[0][s[i]];
+			++t[1][s[i+1]];
+			++t[2][s[i+2]];
+			++t[3][s[i+3]];
+		}
+
+		for (; i < n; ++i) {
+			++t[0][s[i]];
+		}
+
+		for (j = 0; j < 256; ++j) {
+			counts[j] += t[0][j] + t[1][j] + t[2][j] + t[3][j];
+		}
+
+		s += n;
+		len -= n;
+	}
+}
+
+/*
+letters of hist_letters are counted in 8-bit lanes by subtracting compare
+masks, lanes are summed every 255 vectors. if the vectors summed contain
+other bytes, they and all bytes after them are counted by scalar histogram
+*/
+#if defined(PYFASTX_X86_SIMD)
+__attribute__((target("ssse3")))
+static void count_bytes_ssse3(const uint8_t *s, Py_ssize_t len, Py_ssize_t *counts) {
+	int i, k, n;
+	Py_ssize_t total;
+	Py_ssize_t sums[10];
+	__m128i v, t;
+	__m128i acc[10];
+	const __m128i zero = _mm_setzero_si128();
+
+	while (len >= 16) {
+		n = len / 16 < 255 ? len / 16 : 255;
+
+		for (k = 0; k < 10; ++k) {
+			acc[k] = zero;
+		}
+
+		for (i = 0; i < n; ++i) {
+			v = _mm_loadu_si128((const __m128i *)(s + i * 16));
+
+			for (k = 0; k < 10; ++k) {
+				acc[k] = _mm_sub_epi8(acc[k], _mm_cmpeq_epi8(v, _mm_set1_epi8(hist_letters[k])));
+			}
+		}
+
+		total = 0;
+
+		for (k = 0; k < 10; ++k) {
+			t = _mm_sad_epu8(acc[k], zero);
+			sums[k] = _mm_cvtsi128_si32(t) + _mm_extract_epi16(t, 4);
+			total += sums[k];
+		}
+
+		if (total != n * 16) {
+			break;
+		}
+
+		for (k = 0; k < 10; ++k) {
+			counts[(uint8_t)hist_letters[k]] += sums[k];
+		}
+
+		s += n * 16;
+		len -= n * 16;
+	}
+
+	count_bytes_scalar(s, len, counts);
+}
+
+__attribute__((target("avx2")))
+static void count_bytes_avx2(const uint8_t *s, Py_ssize_t len, Py_ssize_t *counts) {
+	int i, k, n;
+	Py_ssize_t total;
+	Py_ssize_t sums[10];
+	__m256i v, t;
+	__m256i acc[10];
+	const __m256i zero = _mm256_setzero_si256();
+
+	while (len >= 32) {
+		n = len / 32 < 255 ? len / 32 : 255;
+
+		for (k = 0; k < 10; ++k) {
+			acc[k] = zero;
+		}
+
+		for (i = 0; i < n; ++i) {
+			v = _mm256_loadu_si256((const __m256i *)(s + i * 32));
+
+			for (k = 0; k < 10; ++k) {
+				acc[k] = _mm256_sub_epi8(acc[k], _mm256_cmpeq_epi8(v, _mm256_set1_epi8(hist_letters[k])));
+			}
+		}
+
+		total = 0;
+
+		for (k = 0; k < 10; ++k) {
+			t = _mm256_sad_epu8(acc[k], zero);
+			sums[k] = _mm256_extract_epi16(t, 0) + _mm256_extract_epi16(t, 4) + _mm256_extract_epi16(t, 8) + _mm256_extract_epi16(t, 12);
+			total += sums[k];
+		}
+
+		if (total != n * 32) {
+			count_bytes_scalar(s, len, counts);
+			return;
+		}
+
+		for (k = 0; k < 10; ++k) {
+			counts[(uint8_t)hist_letters[k]] += sums[k];
+		}
+
+		s += n * 32;
+		len -= n * 32;
+	}
+
+	count_bytes_ssse3(s, len, counts);
+}
+#endif
+
+#if defined(PYFASTX_ARM_SIMD)
+static void count_bytes_neon(const uint8_t *s, Py_ssize_t len, Py_ssize_t *counts) {
+	int i, k, n;
+	Py_ssize_t total;
+	Py_ssize_t sums[10];
+	uint8x16_t v;
+	uint8x16_t acc[10];
+
+	while (len >= 16) {
+		n = len / 16 < 255 ? len / 16 : 255;
+
+		for (k = 0; k < 10; ++k) {
+			acc[k] = vdupq_n_u8(0);
+		}
+
+		for (i = 0; i < n; ++i) {
+			v = vld1q_u8(s + i * 16);
+
+			for (k = 0; k < 10; ++k) {
+				acc[k] = vsubq_u8(acc[k], vceqq_u8(v, vdupq_n_u8(hist_letters[k])));
+			}
+		}
+
+		total = 0;
+
+		for (k = 0; k < 10; ++k) {
+			sums[k] = vaddlvq_u8(acc[k]);
+			total += sums[k];
+		}
+
+		if (total != n * 16) {
+			break;
+		}
+
+		for (k = 0; k < 10; ++k) {
+			counts[(uint8_t)hist_letters[k]] += sums[k];
+		}
+
+		s += n * 16;
+		len -= n * 16;
+	}
+
+	count_bytes_scalar(s, len, counts);
+}
+#endif
+
+/*
+add the number of occurrences of each byte value in seq to counts, counts
+must have 256 entries
+*/
+void count_bytes(const char *seq, Py_ssize_t len, Py_ssize_t *counts) {
+	const uint8_t *s = (const uint8_t *)seq;
+
+	switch (simd_level) {
+#if defined(PYFASTX_X86_SIMD)
+		case PYFASTX_SIMD_AVX2:
+			count_bytes_avx2(s, len, counts);
+			break;
+
+		case PYFASTX_SIMD_SSSE3:
+			count_bytes_ssse3(s, len, counts);
+			break;
+#elif defined(PYFASTX_ARM_SIMD)
+		case PYFASTX_SIMD_NEON:
+			count_bytes_neon(s, len, counts);
+			break;
+#endif
+		default:
+			count_bytes_scalar(s, len, counts);
 	}
 }
 
@@ -300,6 +729,36 @@ int is_subset(char *seq1, char *seq2) {
 	return 1;
 }
 
+//append n to packed string as a varint of 7-bit groups with the lowest group first
+void pyfastx_varint_put(kstring_t *packed, size_t n) {
+	if (packed->l + 10 > packed->m) {
+		packed->m = packed->l + 10;
+		kroundup32(packed->m);
+		packed->s = (char *)realloc(packed->s, packed->m);
+	}
+
+	for (; n >= 128; n >>= 7) {
+		packed->s[packed->l++] = (n & 127) | 128;
+	}
+
+	packed->s[packed->l++] = n;
+}
+
+//decode varint at p into n and return the position after it
+const unsigned char *pyfastx_varint_get(const unsigned char *p, const unsigned char *end, size_t *n) {
+	int shift;
+
+	for (*n = 0, shift = 0; p < end; shift += 7) {
+		*n |= (size_t)(*p & 127) << shift;
+
+		if (!(*p++ & 128)) {
+			break;
+		}
+	}
+
+	return p;
+}
+
 /*check input file is whether gzip file
 @para file_name str, input file path string
 @return bool, 1 is gzip formmat file, 0 is not gzip
@@ -395,7 +854,7 @@ int is_gzip_format(PyObject* file_obj){
 	return index_size;
 }*/
 
-int pyfastx_gzip_index_write(sqlite3_stmt* stmt, const void *buff, size_t bytes) {
+int pyfastx_gzip_index_write_blob(sqlite3_stmt* stmt, const void *buff, size_t bytes) {
 	int ret;
 
 	PYFASTX_SQLITE_CALL(
@@ -418,7 +877,7 @@ fail:
 	return SQLITE_ERROR;
 }
 
-int pyfastx_gzip_index_read(sqlite3_stmt* stmt, void *buff) {
+int pyfastx_gzip_index_read_blob(sqlite3_stmt* stmt, void *buff) {
 	int ret;
 	size_t bytes;
 	
@@ -439,14 +898,48 @@ fail:
 	return SQLITE_ERROR;
 }
 
-int pyfastx_gzip_index_export(zran_index_t* gzip_index, sqlite3* index_db) {
+//decompress a raw deflate checkpoint window
+int pyfastx_gzip_window_inflate(uint8_t *window, uint32_t size, uint8_t *cdata, uint32_t clen) {
+	int ret;
+	z_stream strm;
+
+	memset(&strm, 0, sizeof(z_stream));
+
+	if (inflateInit2(&strm, -15) != Z_OK) {
+		return Z_MEM_ERROR;
+	}
+
+	strm.next_in = cdata;
+	strm.avail_in = clen;
+	strm.next_out = window;
+	strm.avail_out = size;
+
+	ret = inflate(&strm, Z_FINISH);
+	inflateEnd(&strm);
+
+	if (ret != Z_STREAM_END || strm.total_out != size) {
+		return Z_DATA_ERROR;
+	}
+
+	return Z_OK;
+}
+
+int pyfastx_gzip_index_export(pyfastx_GzipIndex* gzip_index, sqlite3* index_db) {
 	int ret;
 	uint8_t flags = 0;
+	uint8_t version = PYFASTX_GZIP_INDEX_VERSION;
+
+	uint32_t i;
+	uint32_t bound;
+	uint8_t *cdata = NULL;
 
+	zran_index_t *zindex = &gzip_index->zran;
 	zran_point_t *point;
 	zran_point_t *list_end;
 
-	sqlite3_stmt *stmt;
+	sqlite3_stmt *stmt = NULL;
+
+	z_stream strm;
 
 	char *sql = "PRAGMA synchronous=OFF; BEGIN TRANSACTION;";
 	PYFASTX_SQLITE_CALL(ret = sqlite3_exec(index_db, sql, NULL, NULL, NULL));
@@ -458,91 +951,123 @@ int pyfastx_gzip_index_export(zran_index_t* gzip_index, sqlite3* index_db) {
 	if (ret != SQLITE_OK) goto fail;
 
 	//write ID and version
-	ret = pyfastx_gzip_index_write(stmt, ZRAN_INDEX_FILE_ID, sizeof(char)*5);
+	ret = pyfastx_gzip_index_write_blob(stmt, ZRAN_INDEX_FILE_ID, sizeof(char)*5);
 	if (ret != SQLITE_OK) goto fail;
 	
-	ret = pyfastx_gzip_index_write(stmt, &ZRAN_INDEX_FILE_VERSION, 1);
+	ret = pyfastx_gzip_index_write_blob(stmt, &version, 1);
 	if (ret != SQLITE_OK) goto fail;
 
 	//write flags
-	ret = pyfastx_gzip_index_write(stmt, &flags, 1);
+	ret = pyfastx_gzip_index_write_blob(stmt, &flags, 1);
 	if (ret != SQLITE_OK) goto fail;
 
 	//write compressed size
-	ret = pyfastx_gzip_index_write(stmt, &gzip_index->compressed_size, sizeof(gzip_index->compressed_size));
+	ret = pyfastx_gzip_index_write_blob(stmt, &zindex->compressed_size, sizeof(zindex->compressed_size));
 	if (ret != SQLITE_OK) goto fail;
 
 	//write uncompressed size
-	ret = pyfastx_gzip_index_write(stmt, &gzip_index->uncompressed_size, sizeof(gzip_index->uncompressed_size));
+	ret = pyfastx_gzip_index_write_blob(stmt, &zindex->uncompressed_size, sizeof(zindex->uncompressed_size));
 	if (ret != SQLITE_OK) goto fail;
 
 	//write spacing
-	ret = pyfastx_gzip_index_write(stmt, &gzip_index->spacing, sizeof(gzip_index->spacing));
+	ret = pyfastx_gzip_index_write_blob(stmt, &zindex->spacing, sizeof(zindex->spacing));
 	if (ret != SQLITE_OK) goto fail;
 
 	//write window size
-	ret = pyfastx_gzip_index_write(stmt, &gzip_index->window_size, sizeof(gzip_index->window_size));
+	ret = pyfastx_gzip_index_write_blob(stmt, &zindex->window_size, sizeof(zindex->window_size));
 	if (ret != SQLITE_OK) goto fail;
 
 	//write number of points
-	ret = pyfastx_gzip_index_write(stmt, &gzip_index->npoints, sizeof(gzip_index->npoints));
+	ret = pyfastx_gzip_index_write_blob(stmt, &zindex->npoints, sizeof(zindex->npoints));
 	if (ret != SQLITE_OK) goto fail;
 
 	//all points offset
-	point = gzip_index->list;
-	list_end = gzip_index->list + gzip_index->npoints;
+	point = zindex->list;
+	list_end = zindex->list + zindex->npoints;
 	while (point < list_end) {
 		//write compressed offset
-		ret = pyfastx_gzip_index_write(stmt, &point->cmp_offset, sizeof(point->cmp_offset));
+		ret = pyfastx_gzip_index_write_blob(stmt, &point->cmp_offset, sizeof(point->cmp_offset));
 		if (ret != SQLITE_OK) goto fail;
 
 		//write uncompressed offset
-		ret = pyfastx_gzip_index_write(stmt, &point->uncmp_offset, sizeof(point->uncmp_offset));
+		ret = pyfastx_gzip_index_write_blob(stmt, &point->uncmp_offset, sizeof(point->uncmp_offset));
 		if (ret != SQLITE_OK) goto fail;
 
 		//write bit offset
-		ret = pyfastx_gzip_index_write(stmt, &point->bits, sizeof(point->bits));
+		ret = pyfastx_gzip_index_write_blob(stmt, &point->bits, sizeof(point->bits));
 		if (ret != SQLITE_OK) goto fail;
 
 		//write data flag
 		flags = (point->data != NULL) ? 1 : 0;
-		ret = pyfastx_gzip_index_write(stmt, &flags, 1);
+		ret = pyfastx_gzip_index_write_blob(stmt, &flags, 1);
 		if (ret != SQLITE_OK) goto fail;
 
 		++point;
 	}
 
+	//the windows are compressed with raw deflate and released
+	//from memory, they will be fetched from index file when used
+	gzip_index->rowids = (sqlite3_int64 *)calloc(zindex->npoints, sizeof(sqlite3_int64));
+	if (gzip_index->rowids == NULL) goto fail;
+
+	memset(&strm, 0, sizeof(z_stream));
+	if (deflateInit2(&strm, Z_BEST_SPEED, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) goto fail;
+	bound = deflateBound(&strm, zindex->window_size);
+
+	cdata = (uint8_t *)malloc(bound);
+	if (cdata == NULL) goto deflate_fail;
+
 	//write window data
-	point = gzip_index->list;
-	list_end = gzip_index->list + gzip_index->npoints;
-	while (point < list_end) {
+	for (i = 0, point = zindex->list; i < zindex->npoints; ++i, ++point) {
 		if (point->data == NULL) {
-			++point;
 			continue;
 		}
 
+		deflateReset(&strm);
+		strm.next_in = point->data;
+		strm.avail_in = zindex->window_size;
+		strm.next_out = cdata;
+		strm.avail_out = bound;
+
+		if (deflate(&strm, Z_FINISH) != Z_STREAM_END) goto deflate_fail;
+
 		//write checkpoint data
-		ret = pyfastx_gzip_index_write(stmt, point->data, gzip_index->window_size);
-		if (ret != SQLITE_OK) goto fail;
+		ret = pyfastx_gzip_index_write_blob(stmt, cdata, strm.total_out);
+		if (ret != SQLITE_OK) goto deflate_fail;
 
-		++point;
+		gzip_index->rowids[i] = sqlite3_last_insert_rowid(index_db);
+
+		free(point->data);
+		point->data = NULL;
 	}
 
+	free(cdata);
+	deflateEnd(&strm);
+
 	PYFASTX_SQLITE_CALL(ret = sqlite3_finalize(stmt));
+	stmt = NULL;
 	if (ret != SQLITE_OK) goto fail;
 
 	PYFASTX_SQLITE_CALL(sqlite3_exec(index_db, "COMMIT;", NULL, NULL, NULL));
 
+	gzip_index->version = PYFASTX_GZIP_INDEX_VERSION;
+
 	return ZRAN_EXPORT_OK;
 
+deflate_fail:
+	deflateEnd(&strm);
+	free(cdata);
+
 fail:
+	PYFASTX_SQLITE_CALL(sqlite3_finalize(stmt));
 	return ZRAN_EXPORT_WRITE_ERROR;
 }
 
-int pyfastx_gzip_index_import(zran_index_t* gzip_index, sqlite3* index_db) {
+int pyfastx_gzip_index_import(pyfastx_GzipIndex* gzip_index, sqlite3* index_db) {
 	int ret;
 
 	uint64_t i;
+	zran_index_t *zindex = &gzip_index->zran;
 	zran_point_t *point;
 	zran_point_t *list_end;
 
@@ -556,52 +1081,53 @@ int pyfastx_gzip_index_import(zran_index_t* gzip_index, sqlite3* index_db) {
 	uint64_t uncompressed_size;
 	uint32_t spacing;
 	uint32_t window_size;
-	uint32_t npoints;
+	uint32_t npoints = 0;
 	zran_point_t *new_list = NULL;
+	sqlite3_int64 *rowids = NULL;
 
 	sqlite3_stmt *stmt;
 
 	PYFASTX_SQLITE_CALL(
-		ret = sqlite3_prepare_v2(index_db, "SELECT * FROM gzindex", -1, &stmt, NULL);
+		ret = sqlite3_prepare_v2(index_db, "SELECT * FROM gzindex ORDER BY ID", -1, &stmt, NULL);
 	);
 	if (ret != SQLITE_OK) goto fail;
 
-	gzip_index->flags |= ZRAN_SKIP_CRC_CHECK;
+	zindex->flags |= ZRAN_SKIP_CRC_CHECK;
 	
 	//read and verify ID
-	ret = pyfastx_gzip_index_read(stmt, file_id);
+	ret = pyfastx_gzip_index_read_blob(stmt, file_id);
 	if (ret != SQLITE_OK) goto read_error;
 
 	if (memcmp(file_id, ZRAN_INDEX_FILE_ID, sizeof(file_id))) goto unknown_format;
 
 	//read format version and check
-	ret = pyfastx_gzip_index_read(stmt, &version);
+	ret = pyfastx_gzip_index_read_blob(stmt, &version);
 	if (ret != SQLITE_OK) goto read_error;
 
-	if (version > ZRAN_INDEX_FILE_VERSION) goto unsupported_version;
+	if (version > PYFASTX_GZIP_INDEX_VERSION) goto unsupported_version;
 
 	//read flags
-	ret = pyfastx_gzip_index_read(stmt, &flags);
+	ret = pyfastx_gzip_index_read_blob(stmt, &flags);
 	if (ret != SQLITE_OK) goto read_error;
 
 	//read compressed size and check
-	ret = pyfastx_gzip_index_read(stmt, &compressed_size);
+	ret = pyfastx_gzip_index_read_blob(stmt, &compressed_size);
 	if (ret != SQLITE_OK) goto read_error;
 
-	if (compressed_size != gzip_index->compressed_size) goto inconsistent;
+	if (compressed_size != zindex->compressed_size) goto inconsistent;
 
 	//read uncompressed size and check
-	ret = pyfastx_gzip_index_read(stmt, &uncompressed_size);
+	ret = pyfastx_gzip_index_read_blob(stmt, &uncompressed_size);
 	if (ret != SQLITE_OK) goto read_error;
 
-	if (uncompressed_size != 0 && gzip_index->uncompressed_size != 0 && gzip_index->uncompressed_size != uncompressed_size) goto inconsistent;
+	if (uncompressed_size != 0 && zindex->uncompressed_size != 0 && zindex->uncompressed_size != uncompressed_size) goto inconsistent;
 
 	//read spacing
-	ret = pyfastx_gzip_index_read(stmt, &spacing);
+	ret = pyfastx_gzip_index_read_blob(stmt, &spacing);
 	if (ret != SQLITE_OK) goto read_error;
 
 	//read window size
-	ret = pyfastx_gzip_index_read(stmt, &window_size);
+	ret = pyfastx_gzip_index_read_blob(stmt, &window_size);
 	if (ret != SQLITE_OK) goto read_error;
 
 	//check spacing and window size
@@ -609,7 +1135,7 @@ int pyfastx_gzip_index_import(zran_index_t* gzip_index, sqlite3* index_db) {
 	if (spacing < window_size) goto fail;
 
 	//read no. of points
-	ret = pyfastx_gzip_index_read(stmt, &npoints);
+	ret = pyfastx_gzip_index_read_blob(stmt, &npoints);
 	if (ret != SQLITE_OK) goto read_error;
 
 	new_list = calloc(1, sizeof(zran_point_t) * max(npoints, 8));
@@ -619,17 +1145,17 @@ int pyfastx_gzip_index_import(zran_index_t* gzip_index, sqlite3* index_db) {
 	if (dataflags == NULL) goto memory_error;
 
 	for (i = 0, point = new_list; i < npoints; ++i, ++point) {
-		ret = pyfastx_gzip_index_read(stmt, &point->cmp_offset);
+		ret = pyfastx_gzip_index_read_blob(stmt, &point->cmp_offset);
 		if (ret != SQLITE_OK) goto read_error;
 
-		ret = pyfastx_gzip_index_read(stmt, &point->uncmp_offset);
+		ret = pyfastx_gzip_index_read_blob(stmt, &point->uncmp_offset);
 		if (ret != SQLITE_OK) goto read_error;
 
-		ret = pyfastx_gzip_index_read(stmt, &point->bits);
+		ret = pyfastx_gzip_index_read_blob(stmt, &point->bits);
 		if (ret != SQLITE_OK) goto read_error;
 
 		if (version >= 1) {
-			ret = pyfastx_gzip_index_read(stmt, &flags);
+			ret = pyfastx_gzip_index_read_blob(stmt, &flags);
 			if (ret != SQLITE_OK) goto read_error;
 		} else {
 			flags = (point == new_list) ? 0 : 1;
@@ -638,47 +1164,60 @@ int pyfastx_gzip_index_import(zran_index_t* gzip_index, sqlite3* index_db) {
 		dataflags[i] = flags;
 	}
 
-	for (i = 0, point = new_list; i < npoints; ++i, ++point) {
-		if (dataflags[i] == 0) {
+	//windows are not read here, only the ID of each window row is kept
+	//and the window will be fetched by the ID when it is used
+	rowids = (sqlite3_int64 *)calloc(max(npoints, 1), sizeof(sqlite3_int64));
+	if (rowids == NULL) goto memory_error;
+
+	for (i = 0; i < npoints; ++i) {
+		if (!dataflags[i]) {
 			continue;
 		}
 
-		point->data = calloc(1, window_size);
-		if (point->data == NULL) goto memory_error;
+		PYFASTX_SQLITE_CALL(ret = sqlite3_step(stmt));
+		if (ret != SQLITE_ROW) goto window_mismatch;
 
-		ret = pyfastx_gzip_index_read(stmt, point->data);
-		if (ret != SQLITE_OK) goto read_error;
+		PYFASTX_SQLITE_CALL(rowids[i] = sqlite3_column_int64(stmt, 0));
 	}
 
+	//each checkpoint with data flag must have exactly one window row
+	PYFASTX_SQLITE_CALL(ret = sqlite3_step(stmt));
+	if (ret != SQLITE_DONE) goto window_mismatch;
+
 	PYFASTX_SQLITE_CALL(ret = sqlite3_finalize(stmt));
+	stmt = NULL;
 	if (ret != SQLITE_OK) goto fail;
 
-	if (gzip_index->uncompressed_size == 0 && uncompressed_size != 0) {
-		gzip_index->uncompressed_size = uncompressed_size;
+	if (zindex->uncompressed_size == 0 && uncompressed_size != 0) {
+		zindex->uncompressed_size = uncompressed_size;
 	}
 
-	if (gzip_index->spacing != spacing) {
-		gzip_index->spacing = spacing;
+	if (zindex->spacing != spacing) {
+		zindex->spacing = spacing;
 	}
 
-	if (gzip_index->window_size != window_size) {
-		gzip_index->window_size = window_size;
+	if (zindex->window_size != window_size) {
+		zindex->window_size = window_size;
 	}
 
-	point = gzip_index->list + 1;
-	list_end = gzip_index->list + gzip_index->npoints;
+	point = zindex->list + 1;
+	list_end = zindex->list + zindex->npoints;
 
 	while (point < list_end) {
 		free(point->data);
 		++point;
 	}
 
-	free(gzip_index->list);
-	gzip_index->list = new_list;
-	gzip_index->npoints = npoints;
-	gzip_index->size = max(npoints, 8);
+	free(zindex->list);
+	zindex->list = new_list;
+	zindex->npoints = npoints;
+	zindex->size = max(npoints, 8);
 	free(dataflags);
 
+	free(gzip_index->rowids);
+	gzip_index->rowids = rowids;
+	gzip_index->version = version;
+
 	return ZRAN_IMPORT_OK;
 
 fail:
@@ -705,12 +1244,20 @@ unsupported_version:
 	ret = ZRAN_IMPORT_UNSUPPORTED_VERSION;
 	goto cleanup;
 
+window_mismatch:
+	ret = PYFASTX_GZIP_IMPORT_WINDOW_MISMATCH;
+	goto cleanup;
+
 cleanup:
+	if (stmt != NULL) {
+		PYFASTX_SQLITE_CALL(sqlite3_finalize(stmt));
+	}
+
 	if (new_list != NULL) {
 		point    = new_list + 1;
 		list_end = new_list + npoints;
 
-		while (point < list_end && point->data != NULL) {
+		while (point < list_end) {
 			free(point->data);
 			++point;
 		}
@@ -718,6 +1265,10 @@ cleanup:
 		free(new_list);
 	}
 
+	if (rowids != NULL) {
+		free(rowids);
+	}
+
 	if (dataflags != NULL) {
 		free(dataflags);
 	}
@@ -725,10 +1276,210 @@ cleanup:
 	return ret;
 }
 
-void pyfastx_build_gzip_index(zran_index_t* gzip_index, sqlite3* index_db) {
+pyfastx_GzipIndex* pyfastx_gzip_index_init(FILE *fd) {
+	pyfastx_GzipIndex *gzip_index;
+
+	gzip_index = (pyfastx_GzipIndex *)malloc(sizeof(pyfastx_GzipIndex));
+	gzip_index->rowids = NULL;
+	gzip_index->window_stmt = NULL;
+	gzip_index->version = PYFASTX_GZIP_INDEX_VERSION;
+	gzip_index->cached = NULL;
+	gzip_index->cache_num = 0;
+	gzip_index->cache_size = 0;
+
+	//initial zran index
+	zran_init(&gzip_index->zran, fd, NULL, 1048576, 32768, 16384, ZRAN_AUTO_BUILD);
+
+	return gzip_index;
+}
+
+//must be called before the index database is closed
+void pyfastx_gzip_index_free(pyfastx_GzipIndex* gzip_index) {
+	if (gzip_index->window_stmt) {
+		PYFASTX_SQLITE_CALL(sqlite3_finalize(gzip_index->window_stmt));
+	}
+
+	free(gzip_index->rowids);
+	free(gzip_index->cached);
+
+	zran_free(&gzip_index->zran);
+	free(gzip_index);
+}
+
+//find the last checkpoint at or before the uncompressed offset
+uint32_t pyfastx_gzip_index_locate(zran_index_t *zindex, uint64_t offset) {
+	uint32_t mid;
+	uint32_t low = 0;
+	uint32_t high = zindex->npoints ? zindex->npoints - 1 : 0;
+
+	while (low < high) {
+		mid = low + (high - low + 1) / 2;
+
+		if (zindex->list[mid].uncmp_offset <= offset) {
+			low = mid;
+		} else {
+			high = mid - 1;
+		}
+	}
+
+	return low;
+}
+
+//read checkpoint window from index file into point data
+int pyfastx_gzip_index_fetch(pyfastx_GzipIndex* gzip_index, uint32_t i) {
 	int ret;
+	uint32_t bytes;
+	const void *cdata;
+
+	zran_index_t *zindex = &gzip_index->zran;
+	zran_point_t *point = zindex->list + i;
+
+	point->data = (uint8_t *)malloc(zindex->window_size);
+	if (point->data == NULL) {
+		return -1;
+	}
+
+	PYFASTX_SQLITE_CALL(
+		sqlite3_bind_int64(gzip_index->window_stmt, 1, gzip_index->rowids[i]);
+		ret = sqlite3_step(gzip_index->window_stmt);
+		cdata = sqlite3_column_blob(gzip_index->window_stmt, 0);
+		bytes = sqlite3_column_bytes(gzip_index->window_stmt, 0);
+	);
 
-	ret = zran_build_index(gzip_index, 0, 0);
+	if (ret != SQLITE_ROW) {
+		ret = Z_DATA_ERROR;
+	} else if (gzip_index->version >= 2) {
+		ret = pyfastx_gzip_window_inflate(point->data, zindex->window_size, (uint8_t *)cdata, bytes);
+	} else if (bytes == zindex->window_size) {
+		memcpy(point->data, cdata, bytes);
+		ret = Z_OK;
+	} else {
+		ret = Z_DATA_ERROR;
+	}
+
+	PYFASTX_SQLITE_CALL(sqlite3_reset(gzip_index->window_stmt));
+
+	if (ret != Z_OK) {
+		free(point->data);
+		point->data = NULL;
+		return -1;
+	}
+
+	return 0;
+}
+
+//move checkpoint to the most recently used end of window cache
+int pyfastx_gzip_index_touch(pyfastx_GzipIndex* gzip_index, uint32_t i) {
+	uint32_t k;
+	uint32_t *cached;
+
+	for (k = gzip_index->cache_num; k > 0; --k) {
+		if (gzip_index->cached[k-1] == i) {
+			memmove(gzip_index->cached+k-1, gzip_index->cached+k, (gzip_index->cache_num-k)*sizeof(uint32_t));
+			gzip_index->cached[gzip_index->cache_num-1] = i;
+			return 0;
+		}
+	}
+
+	if (gzip_index->cache_num == gzip_index->cache_size) {
+		gzip_index->cache_size = gzip_index->cache_size ? gzip_index->cache_size * 2 : PYFASTX_GZIP_WINDOW_CACHE;
+		cached = (uint32_t *)realloc(gzip_index->cached, gzip_index->cache_size*sizeof(uint32_t));
+
+		if (cached == NULL) {
+			return -1;
+		}
+
+		gzip_index->cached = cached;
+	}
+
+	gzip_index->cached[gzip_index->cache_num++] = i;
+
+	return 0;
+}
+
+//make sure the window of checkpoint where inflation restarts for the
+//uncompressed offset is in memory and release least recently used windows
+int pyfastx_gzip_index_prepare(pyfastx_GzipIndex* gzip_index, Py_ssize_t offset) {
+	uint32_t i;
+	uint32_t k;
+	uint32_t n;
+
+	zran_point_t *point;
+	zran_index_t *zindex = &gzip_index->zran;
+
+	if (gzip_index->window_stmt == NULL || zindex->npoints == 0) {
+		return 0;
+	}
+
+	i = pyfastx_gzip_index_locate(zindex, offset);
+
+	//the first checkpoint at stream start has no window
+	if (!gzip_index->rowids[i]) {
+		return 0;
+	}
+
+	point = zindex->list + i;
+
+	if (point->data == NULL && pyfastx_gzip_index_fetch(gzip_index, i) != 0) {
+		return -1;
+	}
+
+	if (pyfastx_gzip_index_touch(gzip_index, i) != 0) {
+		return -1;
+	}
+
+	//evict from the least recently used end
+	if (gzip_index->cache_num > PYFASTX_GZIP_WINDOW_CACHE) {
+		n = gzip_index->cache_num - PYFASTX_GZIP_WINDOW_CACHE;
+
+		for (k = 0; k < n; ++k) {
+			point = zindex->list + gzip_index->cached[k];
+			free(point->data);
+			point->data = NULL;
+		}
+
+		memmove(gzip_index->cached, gzip_index->cached + n, PYFASTX_GZIP_WINDOW_CACHE*sizeof(uint32_t));
+		gzip_index->cache_num = PYFASTX_GZIP_WINDOW_CACHE;
+	}
+
+	return 0;
+}
+
+//prepare statement to fetch checkpoint windows from index file
+void pyfastx_gzip_index_attach(pyfastx_GzipIndex* gzip_index, sqlite3* index_db) {
+	int ret;
+
+	PYFASTX_SQLITE_CALL(
+		ret = sqlite3_prepare_v2(index_db, "SELECT content FROM gzindex WHERE ID=? LIMIT 1", -1, &gzip_index->window_stmt, NULL);
+	);
+
+	if (ret != SQLITE_OK) {
+		PyErr_SetString(PyExc_RuntimeError, "failed to prepare gzip index window reader");
+	}
+}
+
+int pyfastx_gzip_index_seek(pyfastx_GzipIndex* gzip_index, Py_ssize_t offset) {
+	if (pyfastx_gzip_index_prepare(gzip_index, offset) != 0) {
+		return ZRAN_SEEK_FAIL;
+	}
+
+	return zran_seek(&gzip_index->zran, offset, SEEK_SET, NULL);
+}
+
+Py_ssize_t pyfastx_gzip_index_read(pyfastx_GzipIndex* gzip_index, char *buff, Py_ssize_t bytes) {
+	Py_ssize_t offset = zran_tell(&gzip_index->zran);
+
+	if (pyfastx_gzip_index_prepare(gzip_index, offset) != 0) {
+		return -1;
+	}
+
+	return zran_read(&gzip_index->zran, buff, bytes);
+}
+
+void pyfastx_build_gzip_index(pyfastx_GzipIndex* gzip_index, sqlite3* index_db) {
+	int ret;
+
+	ret = zran_build_index(&gzip_index->zran, 0, 0);
 	if (ret != 0) {
 		PyErr_Format(PyExc_RuntimeError, "failed to build gzip index return %d", ret);
 		return;
@@ -739,9 +1490,11 @@ void pyfastx_build_gzip_index(zran_index_t* gzip_index, sqlite3* index_db) {
 		PyErr_Format(PyExc_RuntimeError, "failed to save gzip index return %d", ret);
 		return;
 	}
+
+	pyfastx_gzip_index_attach(gzip_index, index_db);
 }
 
-void pyfastx_load_gzip_index(zran_index_t* gzip_index, sqlite3* index_db) {
+void pyfastx_load_gzip_index(pyfastx_GzipIndex* gzip_index, sqlite3* index_db) {
 	int ret;
 	int rows;
 
@@ -760,10 +1513,26 @@ void pyfastx_load_gzip_index(zran_index_t* gzip_index, sqlite3* index_db) {
 	}
 
 	ret = pyfastx_gzip_index_import(gzip_index, index_db);
+
+	//window rows do not match checkpoints, rebuild the gzip index
+	if (ret == PYFASTX_GZIP_IMPORT_WINDOW_MISMATCH) {
+		PYFASTX_SQLITE_CALL(ret = sqlite3_exec(index_db, "DELETE FROM gzindex;", NULL, NULL, NULL));
+
+		if (ret != SQLITE_OK) {
+			PyErr_SetString(PyExc_RuntimeError, "failed to clear broken gzip index");
+			return;
+		}
+
+		pyfastx_build_gzip_index(gzip_index, index_db);
+		return;
+	}
+
 	if (ret != ZRAN_IMPORT_OK) {
 		PyErr_Format(PyExc_RuntimeError, "failed to import gzip index return %d", ret);
 		return;
 	}
+
+	pyfastx_gzip_index_attach(gzip_index, index_db);
 }
 
 char *str_n_str(char *haystack, char *needle, Py_ssize_t len, Py_ssize_t size) {
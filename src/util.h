@@ -6,19 +6,77 @@
 #include "sqlite3.h"
 #include "zran.h"
 #include "zlib.h"
+#include "stream.h"
+#include "kseq.h"
 #include "time.h"
 
+//gzip index format version written by pyfastx
+//version 2 stores checkpoint windows as raw deflate streams
+#define PYFASTX_GZIP_INDEX_VERSION 2
+
+//gzip index import failed as window rows do not match checkpoints
+#define PYFASTX_GZIP_IMPORT_WINDOW_MISMATCH -16
+
+//maximum number of inflated checkpoint windows kept in memory
+#define PYFASTX_GZIP_WINDOW_CACHE 64
+
+//number of freed Sequence and Read objects kept for reuse
+#define PYFASTX_FREELIST_SIZE 64
+
+//string blocks larger than this are released instead of reused
+#define PYFASTX_FREELIST_BLOCK 65536
+
+//instruction sets of sequence kernels selected at runtime
+#define PYFASTX_SIMD_NONE 0
+#define PYFASTX_SIMD_SSSE3 1
+#define PYFASTX_SIMD_AVX2 2
+#define PYFASTX_SIMD_NEON 3
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#define PYFASTX_X86_SIMD
+	#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+	#define PYFASTX_ARM_SIMD
+	#include <arm_neon.h>
+#endif
+
+//gzip random access index, only the checkpoint offsets are loaded
+//eagerly, windows are fetched from index file when first used
+typedef struct pyfastx_GzipIndex {
+	//indexed_gzip random access index
+	zran_index_t zran;
+
+	//gzindex row of each checkpoint window, 0 if no window
+	//NULL if all windows are resident in memory
+	sqlite3_int64 *rowids;
+
+	//statement to fetch window by row
+	sqlite3_stmt *window_stmt;
+
+	//gzip index format version of stored windows
+	int version;
+
+	//checkpoints with inflated window, least recently used first
+	uint32_t *cached;
+	uint32_t cache_num;
+	uint32_t cache_size;
+
+} pyfastx_GzipIndex;
+
 int file_exists(PyObject *file_obj);
 void upper_string(char *str, Py_ssize_t len);
 Py_ssize_t remove_space(char *str, Py_ssize_t len);
 Py_ssize_t remove_space_uppercase(char *str, Py_ssize_t len);
-void reverse_seq(char *seq);
-void reverse_complement_seq(char *seq);
+void reverse_seq(char *seq, Py_ssize_t len);
+void complement_seq(char *seq, Py_ssize_t len);
+void reverse_complement_seq(char *seq, Py_ssize_t len);
+void count_bytes(const char *seq, Py_ssize_t len, Py_ssize_t *counts);
+int pyfastx_simd_init(void);
+void pyfastx_varint_put(kstring_t *packed, size_t n);
+const unsigned char *pyfastx_varint_get(const unsigned char *p, const unsigned char *end, size_t *n);
 
 int is_gzip_format(PyObject *file_obj);
 //void truncate_seq(char *seq, uint32_t start, uint32_t end);
-void complement_seq(char *seq);
-void reverse_seq(char *seq);
 //Py_ssize_t sum_array(Py_ssize_t arr[], int num);
 //char *int_to_str(int c);
 int is_subset(char *seq1, char *seq2);
@@ -32,13 +90,17 @@ gzFile pyfastx_gzip_open(PyObject *path, const char *mode);
 char *str_n_str(char *haystack, char *needle, Py_ssize_t len, Py_ssize_t size);
 
 //int64_t zran_readline(zran_index_t *index, char *linebuf, uint32_t bufsize);
-void pyfastx_build_gzip_index(zran_index_t* gzip_index, sqlite3* index_db);
-void pyfastx_load_gzip_index(zran_index_t* gzip_index, sqlite3* index_db);
+pyfastx_GzipIndex* pyfastx_gzip_index_init(FILE *fd);
+void pyfastx_gzip_index_free(pyfastx_GzipIndex* gzip_index);
+int pyfastx_gzip_index_seek(pyfastx_GzipIndex* gzip_index, Py_ssize_t offset);
+Py_ssize_t pyfastx_gzip_index_read(pyfastx_GzipIndex* gzip_index, char *buff, Py_ssize_t bytes);
+void pyfastx_build_gzip_index(pyfastx_GzipIndex* gzip_index, sqlite3* index_db);
+void pyfastx_load_gzip_index(pyfastx_GzipIndex* gzip_index, sqlite3* index_db);
 
 //a simple fasta/q validator
-int fasta_validator(gzFile fd);
-int fastq_validator(gzFile fd);
-int fasta_or_fastq(gzFile fd);
+int fasta_validator(pyfastx_Stream *fd);
+int fastq_validator(pyfastx_Stream *fd);
+int fasta_or_fastq(pyfastx_Stream *fd);
 
 //read line
 /*ssize_t get_until_delim(char **buf, int delimiter, FILE *fp);
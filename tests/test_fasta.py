@@ -1,5 +1,9 @@
 import os
+import gzip
+import zlib
 import random
+import struct
+import sqlite3
 import pyfastx
 import pyfaidx
 import unittest
@@ -9,6 +13,7 @@ root_dir = join(os.path.dirname(os.path.abspath(__file__)), '..')
 data_dir = join(os.path.dirname(os.path.abspath(__file__)), 'data')
 
 gzip_fasta = join(data_dir, 'test.fa.gz')
+zstd_fasta = join(data_dir, 'test.fa.zst')
 flat_fasta = join(data_dir, 'test.fa')
 rna_fasta = join(data_dir, 'rna.fa')
 protein_fasta = join(data_dir, 'protein.fa')
@@ -36,6 +41,9 @@ class FastaTest(unittest.TestCase):
 		if os.path.exists('{}.fxi'.format(flat_fasta)):
 			os.remove('{}.fxi'.format(flat_fasta))
 
+		if os.path.exists('{}.fxi'.format(zstd_fasta)):
+			os.remove('{}.fxi'.format(zstd_fasta))
+
 		if os.path.exists('{}.fai'.format(flat_fasta)):
 			os.remove('{}.fai'.format(flat_fasta))
 
@@ -52,6 +60,10 @@ class FastaTest(unittest.TestCase):
 		# gzip check test
 		self.assertEqual(pyfastx.gzip_check(gzip_fasta), self.fastx.is_gzip)
 
+		# zstd check test
+		self.assertTrue(pyfastx.zstd_check(zstd_fasta))
+		self.assertFalse(pyfastx.zstd_check(gzip_fasta))
+
 		# version test
 		with open(join(root_dir, 'src', 'version.h')) as fh:
 			version = fh.read().split()[2].strip('"')
@@ -60,6 +72,12 @@ class FastaTest(unittest.TestCase):
 		#reverse complement
 		self.assertEqual(pyfastx.reverse_complement('ATGC'), 'GCAT')
 
+		#reverse complement keeps case and IUPAC codes at any length
+		comp = str.maketrans('ACGTUMRWSYKVHDBNacgtumrwsykvhdbn', 'TGCAAKYWSRMBDHVNtgcaakywsrmbdhvn')
+		for n in [0, 1, 15, 16, 31, 33, 63, 64, 65, 127, 1000]:
+			seq = ''.join(random.choice('ACGTUMRWSYKVHDBNacgtumrwsykvhdbn-*.') for _ in range(n))
+			self.assertEqual(pyfastx.reverse_complement(seq), seq.translate(comp)[::-1])
+
 	def test_build(self):
 		self.fastx = pyfastx.Fasta(gzip_fasta, build_index=False)
 
@@ -118,6 +136,31 @@ class FastaTest(unittest.TestCase):
 		name = self.faidx[idx].name
 		self.assertTrue(name in self.fastx)
 
+	def test_full_index(self):
+		expect = self.fasta.composition
+
+		for i, s in enumerate(self.faidx):
+			seq = s[:].seq
+			self.assertEqual(self.fasta[i].composition, {b: seq.count(b) for b in set(seq)})
+
+		#index created by old versions stores one comp row for each letter
+		del self.fasta
+
+		db = sqlite3.connect('{}.fxi'.format(flat_fasta))
+		db.executescript("""
+			DROP TABLE comp;
+			DROP TABLE block;
+			CREATE TABLE comp (ID INTEGER PRIMARY KEY, seqid INTEGER, abc INTEGER, num INTEGER);
+			INSERT INTO comp VALUES (NULL, 0, 65, 1);
+		""")
+		db.close()
+
+		self.fasta = pyfastx.Fasta(flat_fasta, full_index=True)
+		self.assertEqual(self.fasta.composition, expect)
+
+		idx = self.get_random_index()
+		self.assertEqual(self.fasta[idx].composition, self.fastx[idx].composition)
+
 	#test repr
 	def test_repr(self):
 		expect = "<Fasta> {} contains {} sequences".format(gzip_fasta, self.count)
@@ -159,6 +202,34 @@ class FastaTest(unittest.TestCase):
 		self.assertEqual(expect, seq.seq)
 		self.assertEqual(expect, seq.seq)
 
+	def test_zstd(self):
+		fa = pyfastx.Fasta(zstd_fasta)
+		self.assertEqual(len(fa), self.count)
+		self.assertFalse(fa.is_gzip)
+
+		#random access from seekable zstd file
+		for _ in range(20):
+			idx = self.get_random_index()
+			expect = self.faidx[idx]
+			self.assertEqual(fa[idx].seq, expect[:].seq)
+
+			start = random.randint(1, len(expect))
+			end = random.randint(start, len(expect))
+			self.assertEqual(fa[idx][start-1:end].seq, expect[start-1:end].seq)
+
+		#read sequence line by line
+		idx = self.get_random_index()
+		self.assertEqual(''.join(fa[idx]), self.faidx[idx][:].seq)
+
+		#reload index
+		del fa
+		fa = pyfastx.Fasta(zstd_fasta)
+		idx = self.get_random_index()
+		self.assertEqual(fa[idx].seq, self.faidx[idx][:].seq)
+
+		for name, seq in pyfastx.Fasta(zstd_fasta, build_index=False):
+			self.assertEqual(seq, str(self.faidx[name]))
+
 	def test_iter_tuple(self):
 		fa = pyfastx.Fasta(gzip_fasta, build_index=False)
 		
@@ -166,6 +237,46 @@ class FastaTest(unittest.TestCase):
 			expect = str(self.faidx[name])
 			self.assertEqual(expect, seq)
 
+	def test_batches(self):
+		names = []
+
+		for batch in self.fastx.batches(30):
+			self.assertLessEqual(len(batch), 30)
+			self.assertIsNone(batch.quals)
+			self.assertEqual(len(batch.seq_offsets), len(batch) + 1)
+			self.assertEqual(batch.seq_offsets[-1], len(batch.seqs))
+
+			for name, seq in batch:
+				self.assertEqual(seq, str(self.faidx[name]))
+				names.append(name)
+
+		self.assertEqual(len(names), self.count)
+
+		with self.assertRaises(ValueError):
+			self.fastx.batches(0)
+
+	def test_iter_range(self):
+		seqs = [(s.id, s.name, s.seq) for s in self.fastx]
+
+		self.assertEqual([(s.id, s.name, s.seq) for s in self.fastx.iter_range(3, 7)], seqs[2:7])
+		self.assertEqual([s.id for s in self.fastx.iter_range(self.count-1)], [self.count-1, self.count])
+
+		for fa in [self.fastx, self.fasta]:
+			for shards in [1, 3, 8]:
+				result = [(s.id, s.name, s.seq) for k in range(shards) for s in fa.iter_range(shards=shards, shard=k)]
+				self.assertEqual(result, seqs)
+
+		#shards of file without index are snapped to sequence headers
+		fa = pyfastx.Fasta(flat_fasta, build_index=False)
+		result = [r for k in range(5) for r in fa.iter_range(shards=5, shard=k)]
+		self.assertEqual(result, list(fa))
+
+		with self.assertRaises(RuntimeError):
+			fa.iter_range(1, 10)
+
+		with self.assertRaises(ValueError):
+			self.fastx.iter_range(shards=2, shard=2)
+
 	def test_iter_upper(self):
 		fa = pyfastx.Fasta(flat_fasta, build_index=False, uppercase=True)
 
@@ -279,6 +390,143 @@ class FastaTest(unittest.TestCase):
 		self.assertEqual('', left)
 		self.assertEqual('', right)
 
+	def test_search_all(self):
+		hits = self.fasta.search_all('ACGT', strand='+')
+		expect = []
+		for i, seq in enumerate(self.faidx):
+			bases = str(seq)
+			expect.extend((i, j+1, '+') for j in range(len(bases)-3) if bases[j:j+4] == 'ACGT')
+
+		self.assertEqual(list(hits), expect)
+		self.assertEqual(list(hits.indexes), [h[0] for h in expect])
+
+		#ACGT is its own reverse complement
+		hits = self.fastx.search_all('ACGT')
+		self.assertEqual(len(hits), 2 * len(expect))
+		self.assertEqual(len(self.fastx.search_all('ACGT', max_hits=10)), 10)
+
+	def test_gc_profile(self):
+		profile = self.fastx.gc_profile(100, 50)
+		expect = [(i, s) for i in range(self.count) for s in range(1, len(self.faidx[i])+1, 50)]
+		self.assertEqual(list(zip(profile.indexes, profile.starts)), expect)
+		self.assertEqual(list(profile)[:5], list(zip(profile.indexes, profile.starts, profile.ends, profile.gc, profile.skew))[:5])
+		self.assertEqual(profile[-1][:2], expect[-1])
+		self.assertEqual(bytes(profile.gc[-3:]), bytes(self.fastx[self.count-1].gc_profile(100, 50).gc[-3:]))
+
+	def test_masks(self):
+		mask_fasta = join(data_dir, 'mask.fa')
+		seqs = ['ACGTacgtNNNNacgNNnnGT', 'nnnnACGT', 'ACGTACGT', 'acgtNN']
+
+		with open(mask_fasta, 'w') as fw:
+			for i, s in enumerate(seqs):
+				fw.write('>seq{}\n{}\n{}\n'.format(i, s[:10], s[10:]))
+
+		fa = pyfastx.Fasta(mask_fasta, mask_index=True)
+
+		masks = fa.masks()
+		self.assertEqual(len(masks), 5)
+		self.assertEqual(masks.bases, 17)
+		self.assertEqual(list(zip(masks.indexes, masks.starts, masks.ends)), [(0, 5, 8), (0, 13, 15), (0, 18, 19), (1, 1, 4), (3, 1, 4)])
+		self.assertEqual(list(masks), list(zip(masks.indexes, masks.starts, masks.ends)))
+		self.assertEqual(masks[-1], (3, 1, 4))
+
+		gaps = fa.gaps()
+		self.assertEqual(list(zip(gaps.indexes, gaps.starts, gaps.ends)), [(0, 9, 12), (0, 16, 19), (1, 1, 4), (3, 5, 6)])
+		self.assertEqual(len(fa[2].gaps()), 0)
+
+		#index created by old versions has no mask table
+		del fa
+
+		db = sqlite3.connect('{}.fxi'.format(mask_fasta))
+		db.execute("DROP TABLE mask")
+		db.close()
+
+		fa = pyfastx.Fasta(mask_fasta)
+		self.assertEqual(bytes(fa.gaps().starts), bytes(gaps.starts))
+
+		del fa
+		os.remove(mask_fasta)
+		os.remove('{}.fxi'.format(mask_fasta))
+
+	def test_gzip_windows(self):
+		#large gzip file with more checkpoints than cached windows
+		big_fasta = join(data_dir, 'big.fa.gz')
+		table = bytes.maketrans(bytes(range(256)), b'ACGT' * 64)
+		seqs = [os.urandom(12000000).translate(table) for i in range(6)]
+
+		with gzip.open(big_fasta, 'wb', compresslevel=1) as fh:
+			for i, seq in enumerate(seqs):
+				fh.write('>s{}\n'.format(i).encode())
+				fh.write(b'\n'.join(seq[j:j+60] for j in range(0, len(seq), 60)))
+				fh.write(b'\n')
+
+		def check_slices(fa):
+			for i in range(200):
+				idx = random.randint(0, len(seqs)-1)
+				start = random.randint(0, len(seqs[idx])-1)
+				end = min(start + random.randint(1, 5000), len(seqs[idx]))
+				self.assertEqual(fa[idx][start:end].seq, seqs[idx][start:end].decode())
+
+			#slice crosses several checkpoints
+			self.assertEqual(fa[2][500000:3700000].seq, seqs[2][500000:3700000].decode())
+
+		try:
+			fa = pyfastx.Fasta(big_fasta)
+			check_slices(fa)
+
+			#reopen with saved index
+			del fa
+			fa = pyfastx.Fasta(big_fasta)
+			check_slices(fa)
+			del fa
+
+			#index created by old versions stores uncompressed windows, and
+			#window rows may not follow the checkpoint rows continuously
+			db = sqlite3.connect('{}.fxi'.format(big_fasta))
+			npoints = struct.unpack('<I', db.execute("SELECT content FROM gzindex WHERE ID=8").fetchone()[0])[0]
+			head = 8 + npoints * 4
+			rows = db.execute("SELECT ID, content FROM gzindex WHERE ID>?", (head,)).fetchall()
+			self.assertGreater(len(rows), 64)
+
+			db.execute("UPDATE gzindex SET content=? WHERE ID=2", (b'\x01',))
+			db.execute("DELETE FROM gzindex WHERE ID>?", (head,))
+			db.executemany("INSERT INTO gzindex VALUES (?,?)", [(i + 100, zlib.decompress(c, -15)) for i, c in rows])
+			db.commit()
+			db.close()
+
+			fa = pyfastx.Fasta(big_fasta)
+			check_slices(fa)
+			del fa
+
+			#gzip index is rebuilt if window rows are missing
+			db = sqlite3.connect('{}.fxi'.format(big_fasta))
+			db.execute("DELETE FROM gzindex WHERE ID=(SELECT MAX(ID) FROM gzindex)")
+			db.commit()
+			db.close()
+
+			fa = pyfastx.Fasta(big_fasta)
+			check_slices(fa)
+			del fa
+
+		finally:
+			if os.path.exists(big_fasta):
+				os.remove(big_fasta)
+
+			if os.path.exists('{}.fxi'.format(big_fasta)):
+				os.remove('{}.fxi'.format(big_fasta))
+
+	def test_search_approx(self):
+		pattern = str(self.faidx[3])[50:72]
+		hits = self.fasta.search_approx(pattern, max_edits=3)
+		self.assertIn((self.fasta[3].name, 51, 72, '+', 0), hits)
+		self.assertEqual(hits, self.fastx.search_approx(pattern, max_edits=3, threads=3))
+
+		expect = []
+		for i in range(self.count):
+			expect.extend(self.fasta[i].search_approx(pattern, max_edits=3))
+
+		self.assertEqual(hits, expect)
+
 	def test_no_upper(self):
 		fa = pyfastx.Fasta(flat_fasta, uppercase=False)
 		self.assertEqual(self.fastx[0].seq, fa[0].seq)
@@ -7,6 +7,7 @@ join = os.path.join
 data_dir = join(os.path.dirname(os.path.abspath(__file__)), 'data')
 
 gzip_fastq = join(data_dir, 'test.fq.gz')
+zstd_fastq = join(data_dir, 'test.fq.zst')
 flat_fastq = join(data_dir, 'test.fq')
 
 class FastqTest(unittest.TestCase):
@@ -54,6 +55,9 @@ class FastqTest(unittest.TestCase):
 		if os.path.exists('{}.fxi'.format(flat_fastq)):
 			os.remove('{}.fxi'.format(flat_fastq))
 
+		if os.path.exists('{}.fxi'.format(zstd_fastq)):
+			os.remove('{}.fxi'.format(zstd_fastq))
+
 	def get_random_read(self):
 		return random.randint(0, len(self.fastq)-1)
 
@@ -168,6 +172,22 @@ class FastqTest(unittest.TestCase):
 			self.assertEqual(read.seq, self.reads[i][1])
 			self.assertEqual(read.qual, self.reads[i][2])
 
+		#reads from iteration are the same as random access
+		for fq in [self.fastq, self.flatq]:
+			for read in fq:
+				expect = fq[read.id - 1]
+				self.assertEqual(read.id, expect.id)
+				self.assertEqual(read.description, expect.description)
+				self.assertEqual(read.raw, expect.raw)
+				self.assertEqual(len(read), len(expect))
+
+		#kept reads are not affected by reusing freed reads
+		kept = [read for read in self.fastq if read.id % 100 == 1]
+		for read in kept:
+			self.assertEqual(read.name, self.reads[read.id-1][0])
+			self.assertEqual(read.seq, self.reads[read.id-1][1])
+			self.assertEqual(read.qual, self.reads[read.id-1][2])
+
 		#test reference of read made from loop
 		for read in self.fastq:
 			break
@@ -176,6 +196,49 @@ class FastqTest(unittest.TestCase):
 		self.assertEqual(expect, read.seq)
 		self.assertEqual(expect, read.seq)
 
+	def test_iter_range(self):
+		reads = [(r.id, r.name, r.seq, r.qual) for r in self.fastq]
+
+		for fq in [self.fastq, self.flatq]:
+			self.assertEqual([(r.id, r.name, r.seq, r.qual) for r in fq.iter_range(10, 20)], reads[9:20])
+
+			for shards in [1, 4, 7]:
+				result = [(r.id, r.name, r.seq, r.qual) for k in range(shards) for r in fq.iter_range(shards=shards, shard=k)]
+				self.assertEqual(result, reads)
+
+		#random access while iterating reads in range from gzip file
+		for read in self.fastq.iter_range(50, 60):
+			self.assertEqual(self.fastq[0].seq, self.reads[0][1])
+			self.assertEqual(read.seq, self.reads[read.id-1][1])
+
+		#shards of file without index are snapped to read headers
+		fq = pyfastx.Fastq(flat_fastq, build_index=False)
+		result = [r for k in range(6) for r in fq.iter_range(shards=6, shard=k)]
+		self.assertEqual(result, list(fq))
+
+		with self.assertRaises(RuntimeError):
+			pyfastx.Fastq(gzip_fastq, build_index=False).iter_range(shards=2, shard=0)
+
+	def test_zstd(self):
+		#zstd file without seek table
+		fq = pyfastx.Fastq(zstd_fastq)
+		self.assertEqual(len(fq), len(self.reads))
+		self.assertFalse(fq.is_gzip)
+
+		for _ in range(20):
+			idx = self.get_random_read()
+			read = fq[idx]
+			self.assertEqual(read.name, self.reads[idx][0])
+			self.assertEqual(read.seq, self.reads[idx][1])
+			self.assertEqual(read.qual, self.reads[idx][2])
+
+		for i, read in enumerate(fq):
+			self.assertEqual(read.seq, self.reads[i][1])
+
+		for i, (name, seq, qual) in enumerate(pyfastx.Fastq(zstd_fastq, build_index=False)):
+			self.assertEqual(name, self.reads[i][0])
+			self.assertEqual(qual, self.reads[i][2])
+
 	def test_iter_tuple(self):
 		i = -1
 		for name, seq, qual in pyfastx.Fastq(flat_fastq, build_index=False):
@@ -184,6 +247,79 @@ class FastqTest(unittest.TestCase):
 			self.assertEqual(seq, self.reads[i][1])
 			self.assertEqual(qual, self.reads[i][2])
 
+	def test_batches(self):
+		i = -1
+		for batch in self.fastq.batches(size=64):
+			self.assertEqual(len(batch.quals), len(batch.seqs))
+			self.assertEqual(bytes(batch.qual_offsets), bytes(batch.seq_offsets))
+
+			for name, seq, qual in batch:
+				i += 1
+				self.assertEqual(name, self.reads[i][0])
+				self.assertEqual(seq, self.reads[i][1])
+				self.assertEqual(qual, self.reads[i][2])
+
+		self.assertEqual(i + 1, len(self.reads))
+
+	def test_pair(self):
+		r1file = 'test_R1.fq'
+		r2file = 'test_R2.fq'
+		with open(r1file, 'w') as f1, open(r2file, 'w') as f2:
+			for i in range(len(self.reads)):
+				name, seq, qual = self.reads[i]
+				f1.write("@{}/1\n{}\n+\n{}\n".format(name, seq, qual))
+				f2.write("@{}/2\n{}\n+\n{}\n".format(name, seq[::-1], qual[::-1]))
+
+		pair = pyfastx.FastqPair(r1file, r2file)
+		pairs = list(pair)
+		self.assertEqual(len(pairs), len(self.reads))
+		self.assertEqual(pairs[0][0], ("{}/1".format(self.reads[0][0]), self.reads[0][1], self.reads[0][2]))
+		self.assertEqual(pairs[0][1][1], self.reads[0][1][::-1])
+
+		#batches of pairs
+		i = -1
+		for batch1, batch2 in pair.batches(size=300):
+			self.assertEqual(len(batch1), len(batch2))
+			for read1, read2 in zip(batch1, batch2):
+				i += 1
+				self.assertEqual((read1, read2), pairs[i])
+		self.assertEqual(i + 1, len(self.reads))
+
+		#batches have own readers independent of iterating the pair
+		it = iter(pair)
+		self.assertEqual(next(it), pairs[0])
+		batch_iter1 = pair.batches(size=100)
+		batch_iter2 = pair.batches(size=100)
+		batch1, batch2 = next(batch_iter1)
+		self.assertEqual((batch1[0], batch2[0]), pairs[0])
+		self.assertEqual(next(it), pairs[1])
+		batch1, batch2 = next(batch_iter2)
+		self.assertEqual((batch1[99], batch2[99]), pairs[99])
+		batch1, batch2 = next(batch_iter1)
+		self.assertEqual((batch1[0], batch2[0]), pairs[100])
+		self.assertEqual(next(it), pairs[2])
+
+		#interleaved output and input
+		ilfile = 'test_interleaved.fq.gz'
+		self.assertEqual(pair.write_interleaved(ilfile), len(self.reads))
+		self.assertEqual(list(pyfastx.FastqPair(ilfile)), pairs)
+
+		#mates with different names
+		with open(r2file, 'w') as f2:
+			for i in range(len(self.reads)):
+				name, seq, qual = self.reads[len(self.reads)-i-1]
+				f2.write("@{}/2\n{}\n+\n{}\n".format(name, seq, qual))
+
+		with self.assertRaises(ValueError):
+			list(pyfastx.FastqPair(r1file, r2file))
+
+		self.assertEqual(len(list(pyfastx.FastqPair(r1file, r2file, check_name=False))), len(self.reads))
+
+		del pair
+		os.remove(r1file)
+		os.remove(r2file)
+		os.remove(ilfile)
+
 	def test_read_len(self):
 		lens = [len(it[1]) for it in self.reads.values()]
 
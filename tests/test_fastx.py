@@ -1,13 +1,22 @@
 import os
+import gzip
 import pyfaidx
 import pyfastx
 import unittest
 
+try:
+	import pyarrow
+except ImportError:
+	pyarrow = None
+
 join = os.path.join
 data_dir = join(os.path.dirname(os.path.abspath(__file__)), 'data')
 
 gzip_fasta = join(data_dir, 'test.fa.gz')
 gzip_fastq = join(data_dir, 'test.fq.gz')
+zstd_fasta = join(data_dir, 'test.fa.zst')
+zstd_fastq = join(data_dir, 'test.fq.zst')
+bgzf_fastq = join(data_dir, 'test.fq.bgz')
 flat_fasta = join(data_dir, 'test.fa')
 flat_fastq = join(data_dir, 'test.fq')
 
@@ -53,6 +62,315 @@ class FastxTest(unittest.TestCase):
 			self.assertEqual(r[1], seq)
 			self.assertEqual(r[2], qual)
 
+	def test_zstd_iter(self):
+		for name, seq in pyfastx.Fastx(zstd_fasta):
+			self.assertEqual(str(self.faidx[name]), seq)
+
+		fq = list(pyfastx.Fastx(zstd_fastq))
+		self.assertEqual(fq, list(pyfastx.Fastx(flat_fastq)))
+
+	def test_inflate_backend(self):
+		expect = list(pyfastx.Fastx(flat_fastq))
+		backend = pyfastx.inflate_backend()
+
+		for name in ['zlib', 'libdeflate']:
+			try:
+				self.assertEqual(pyfastx.inflate_backend(name), name)
+			except ValueError:
+				continue
+
+			self.assertEqual(list(pyfastx.Fastx(bgzf_fastq)), expect)
+			self.assertEqual(list(pyfastx.Fastx(gzip_fastq)), expect)
+
+		pyfastx.inflate_backend(backend)
+
+		with self.assertRaises(ValueError):
+			pyfastx.inflate_backend('inflate')
+
+	def test_batches(self):
+		expect = list(pyfastx.Fastx(gzip_fastq, comment=True))
+		batches = list(pyfastx.Fastx(gzip_fastq, comment=True).batches(100))
+
+		self.assertEqual([r for b in batches for r in b], expect)
+
+		batch = batches[0]
+		self.assertEqual(batch[-1], expect[99])
+		self.assertEqual(batch.names[batch.name_offsets[1]:batch.name_offsets[2]].decode(), expect[1][0])
+		self.assertEqual(batch.comments[batch.comment_offsets[2]:batch.comment_offsets[3]].decode(), expect[2][3])
+
+		with self.assertRaises(IndexError):
+			batch[100]
+
+	def test_batches_threads(self):
+		for file_name in [gzip_fasta, gzip_fastq]:
+			expect = list(pyfastx.Fastx(file_name, comment=True))
+
+			batches = pyfastx.Fastx(file_name, comment=True).batches(37, threads=3)
+			self.assertEqual([r for b in batches for r in b], expect)
+
+			batches = pyfastx.Fastx(file_name, comment=True).batches(37, threads=3, ordered=False)
+			self.assertEqual(sorted(r for b in batches for r in b), sorted(expect))
+
+		with self.assertRaises(ValueError):
+			pyfastx.Fastx(gzip_fastq).batches(threads=0)
+
+		#column buffers of a too large batch can not be allocated
+		for threads in [1, 2]:
+			with self.assertRaises(MemoryError):
+				pyfastx.Fastx(gzip_fastq).batches(2**50, threads=threads)
+
+	def test_batches_reader(self):
+		expect = list(pyfastx.Fastx(gzip_fastq))
+		fx = pyfastx.Fastx(gzip_fastq)
+
+		#batch iterators do not share reader with each other or parent
+		it = iter(fx)
+		next(it)
+		first = fx.batches(3)
+		self.assertEqual(list(next(first)), expect[:3])
+		second = fx.batches(3, threads=2)
+		self.assertEqual(list(next(second)), expect[:3])
+		self.assertEqual(list(next(first)), expect[3:6])
+		self.assertEqual(next(it), expect[1])
+		self.assertEqual([r for b in second for r in b], expect[3:])
+
+	def test_batches_comment(self):
+		mixed_fasta = join(data_dir, 'comment.fa')
+
+		with open(mixed_fasta, 'w') as fw:
+			fw.write('>a x y\nACGT\n>b\nAC\n>c \nGG\n>d z\nTT\n>e\nA\n')
+
+		try:
+			expect = list(pyfastx.Fastx(mixed_fasta, comment=True))
+			self.assertEqual([r[2] for r in expect], ['x y', None, None, 'z', None])
+
+			for threads in [1, 2]:
+				batches = pyfastx.Fastx(mixed_fasta, comment=True).batches(2, threads=threads)
+				self.assertEqual([r for b in batches for r in b], expect)
+
+			if pyarrow is not None:
+				table = pyarrow.table(pyfastx.Fastx(mixed_fasta, comment=True).batches(2))
+				self.assertEqual(table.column('comment').to_pylist(), [r[2] for r in expect])
+		finally:
+			os.remove(mixed_fasta)
+
+	def test_batches_fastq_layout(self):
+		reads = list(pyfastx.Fastx(gzip_fastq, comment=True))
+		layout_fastq = join(data_dir, 'layout.fq')
+
+		def write(reads, sep='\n', blank=(), wrap=0):
+			with open(layout_fastq, 'w', newline='') as fw:
+				for i, (name, seq, qual, comment) in enumerate(reads):
+					if i in blank:
+						fw.write(sep)
+
+					lines = ['@{} {}'.format(name, comment) if comment else '@' + name]
+
+					if wrap:
+						lines.extend(seq[j:j+wrap] for j in range(0, len(seq), wrap))
+						lines.append('+')
+						lines.extend(qual[j:j+wrap] for j in range(0, len(qual), wrap))
+					else:
+						lines.extend([seq, '+', qual])
+
+					fw.write(sep.join(lines) + sep)
+
+		try:
+			#blank lines between records, crlf line ends and multiple line records
+			for args in [dict(blank=(5, 77, 300)), dict(sep='\r\n'), dict(wrap=60), dict(sep='\r\n', blank=(1, 2), wrap=30)]:
+				write(reads, **args)
+				expect = list(pyfastx.Fastx(layout_fastq, comment=True))
+				self.assertEqual(len(expect), len(reads))
+
+				for threads in [1, 2, 3]:
+					batches = pyfastx.Fastx(layout_fastq, comment=True).batches(7, threads=threads)
+					self.assertEqual([r for b in batches for r in b], expect)
+
+			#quality longer than sequence is reported by threads
+			with open(layout_fastq, 'w') as fw:
+				fw.write('@a\nACGT\n+\nIIII\n@b\nACGT\n+\nIIIIII\n@c\nAC\n+\nII\n')
+
+			with self.assertRaises(RuntimeError):
+				list(pyfastx.Fastx(layout_fastq).batches(1, threads=2))
+		finally:
+			if os.path.exists(layout_fastq):
+				os.remove(layout_fastq)
+
+	def test_filters(self):
+		reads = list(pyfastx.Fastx(gzip_fastq))
+		names = set(r[0] for r in reads[::3])
+		expect = [r for r in reads if r[0] in names and sum(map(ord, r[2])) >= 69 * len(r[2])]
+
+		fx = pyfastx.Fastx(gzip_fastq, min_mean_qual=36, names=names)
+		self.assertEqual(list(fx), expect)
+
+		counts = fx.filter_counts
+		self.assertEqual(counts['passed'], len(expect))
+		self.assertEqual(counts['names'], len(reads) - len(names))
+		self.assertEqual(sum(counts.values()), len(reads))
+
+		batches = fx.batches(37, threads=3)
+		self.assertEqual([r for b in batches for r in b], expect)
+		self.assertEqual(fx.filter_counts, counts)
+
+		seqs = list(pyfastx.Fastx(gzip_fasta))
+		expect = [s for s in seqs if 500 <= len(s[1]) <= 5000]
+		fx = pyfastx.Fastx(gzip_fasta, min_len=500, max_len=5000)
+		self.assertEqual([r for b in fx.batches(10) for r in b], expect)
+		self.assertIsNone(pyfastx.Fastx(gzip_fasta).filter_counts)
+
+	def test_kmers(self):
+		comp = str.maketrans('ACGT', 'TGCA')
+
+		for file_name in [gzip_fasta, gzip_fastq]:
+			expect = {}
+			for record in pyfastx.Fastx(file_name):
+				seq = record[1].upper()
+				for i in range(len(seq)-6):
+					kmer = seq[i:i+7]
+					if not set(kmer) - set('ACGT'):
+						kmer = min(kmer, kmer.translate(comp)[::-1])
+						expect[kmer] = expect.get(kmer, 0) + 1
+
+			result = [pyfastx.kmer_decode(k, 7) for k in pyfastx.Fastx(file_name).kmers(7, canonical=True)]
+			self.assertEqual(len(result), sum(expect.values()))
+			self.assertEqual(set(result), set(expect))
+
+			for threads in [1, 3]:
+				counts = pyfastx.Fastx(file_name).count_kmers(7, canonical=True, threads=threads)
+				self.assertEqual(dict(zip([pyfastx.kmer_decode(k, 7) for k in counts.kmers], counts.counts)), expect)
+				self.assertEqual(counts.total, sum(expect.values()))
+				self.assertEqual(list(counts.kmers), sorted(counts.kmers))
+
+			kmer = next(iter(expect))
+			self.assertEqual(counts[kmer], expect[kmer])
+			self.assertEqual(counts[kmer.translate(comp)[::-1]], expect[kmer])
+
+		#records are filtered before counting
+		fx = pyfastx.Fastx(gzip_fasta, min_len=500)
+		expect = sum(1 for n, s in fx for i in range(len(s)-4) if not set(s[i:i+5].upper()) - set('ACGT'))
+		self.assertEqual(fx.count_kmers(5).total, expect)
+		self.assertEqual(sum(1 for k in fx.kmers(5)), expect)
+
+		with self.assertRaises(ValueError):
+			pyfastx.Fastx(gzip_fasta).count_kmers(0)
+
+		with self.assertRaises(ValueError):
+			counts['ACGTN']
+
+		self.assertEqual(pyfastx.kmer_decode(4**5-1, 5), 'TTTTT')
+
+		with self.assertRaises(ValueError):
+			pyfastx.kmer_decode(4**5, 5)
+
+		with self.assertRaises(OverflowError):
+			pyfastx.kmer_decode(-1, 5)
+
+	def test_kmers_threads(self):
+		#a blank line between records must not change chunks of threads
+		blank_fastq = join(data_dir, 'blank.fq')
+		blank_fasta = join(data_dir, 'blank.fa')
+		bases = 'ACGT'
+
+		with open(blank_fastq, 'w') as fq, open(blank_fasta, 'w') as fa:
+			for i in range(20000):
+				seq = 'ACGTACGT' + ''.join(bases[(i >> j) & 3] for j in range(0, 16, 2))
+
+				if i == 10:
+					fq.write('\n')
+					fa.write('\n')
+
+				fq.write('@r{}\n{}\n+\n{}\n'.format(i, seq, 'I' * len(seq)))
+				fa.write('>r{}\n{}\n'.format(i, seq))
+
+		try:
+			counts = pyfastx.Fastx(blank_fastq).count_kmers(4)
+			self.assertEqual(counts.total, 20000 * 13)
+
+			sketch = pyfastx.Fastx(blank_fastq).sketch(9, size=100)
+			hits = pyfastx.Fasta(blank_fasta).search_approx('ACGTACGTAAAA', max_edits=1)
+
+			for threads in [2, 4]:
+				result = pyfastx.Fastx(blank_fastq).count_kmers(4, threads=threads)
+				self.assertEqual(bytes(result.kmers), bytes(counts.kmers))
+				self.assertEqual(bytes(result.counts), bytes(counts.counts))
+
+				result = pyfastx.Fastx(blank_fastq).sketch(9, size=100, threads=threads)
+				self.assertEqual(bytes(result.hashes), bytes(sketch.hashes))
+
+				result = pyfastx.Fasta(blank_fasta).search_approx('ACGTACGTAAAA', max_edits=1, threads=threads)
+				self.assertEqual(result, hits)
+		finally:
+			for file_name in [blank_fastq, blank_fasta, blank_fasta + '.fxi']:
+				if os.path.exists(file_name):
+					os.remove(file_name)
+
+	def test_sketch(self):
+		for file_name in [gzip_fasta, gzip_fastq]:
+			bottom = pyfastx.Fastx(file_name).sketch(15, size=200)
+			frac = pyfastx.Fastx(file_name).sketch(15, scaled=20)
+
+			self.assertEqual(len(bottom), 200)
+			self.assertEqual(list(bottom.hashes), sorted(set(bottom.hashes)))
+			self.assertEqual(list(frac.hashes[:200]), list(bottom.hashes))
+			self.assertTrue(all(h < 2**64 // 20 for h in frac.hashes))
+
+			#merged sketch of threads is the same
+			self.assertEqual(bytes(pyfastx.Fastx(file_name).sketch(15, size=200, threads=3).hashes), bytes(bottom.hashes))
+			self.assertEqual(bytes(pyfastx.Fastx(file_name).sketch(15, scaled=20, threads=3).hashes), bytes(frac.hashes))
+
+			self.assertEqual(bottom.jaccard(bottom), 1)
+			self.assertEqual(frac.containment(frac), 1)
+
+		#subset of file is contained in file
+		part = pyfastx.Fastx(gzip_fasta, max_len=300).sketch(15, scaled=10)
+		full = pyfastx.Fastx(gzip_fasta).sketch(15, scaled=10)
+		self.assertEqual(part.containment(full), 1)
+		self.assertLess(full.containment(part), 1)
+		self.assertAlmostEqual(part.jaccard(full), len(part) / len(full))
+
+		with self.assertRaises(ValueError):
+			part.jaccard(pyfastx.Fastx(gzip_fasta).sketch(15))
+
+	def test_arrow_capsule(self):
+		batches = pyfastx.Fastx(gzip_fastq).batches(100)
+		schema, array = next(batches).__arrow_c_array__()
+
+		self.assertIn('arrow_schema', repr(schema))
+		self.assertIn('arrow_array', repr(array))
+		self.assertIn('arrow_array_stream', repr(batches.__arrow_c_stream__()))
+
+	@unittest.skipIf(pyarrow is None, "pyarrow is not installed")
+	def test_arrow_table(self):
+		expect = list(pyfastx.Fastx(gzip_fastq))
+		table = pyarrow.table(pyfastx.Fastx(gzip_fastq).batches(300))
+
+		self.assertEqual(table.column_names, ['name', 'seq', 'qual'])
+		self.assertEqual(list(zip(*table.to_pydict().values())), expect)
+
+		table = pyarrow.table(pyfastx.Fasta(flat_fasta).index_table())
+		self.assertEqual(table.column('name').to_pylist(), list(self.faidx.keys()))
+
+	def test_readahead(self):
+		#larger than read ahead buffer to swap buffers several times
+		big_fastq = join(data_dir, 'readahead.fq.gz')
+
+		with open(flat_fastq, 'rb') as fh:
+			data = fh.read()
+
+		with gzip.open(big_fastq, 'wb') as fw:
+			for i in range(12):
+				fw.write(data)
+
+		try:
+			expect = list(pyfastx.Fastx(flat_fastq)) * 12
+			self.assertEqual(list(pyfastx.Fastx(big_fastq)), expect)
+
+			fq = pyfastx.Fastq(big_fastq, build_index=False)
+			self.assertEqual([(r[0], r[1], r[2]) for r in fq], expect)
+		finally:
+			os.remove(big_fastq)
+
 	def test_fastx_repr(self):
 		fa = pyfastx.Fastx(gzip_fasta, "fasta")
 		self.assertEqual(repr(fa), "<Fastx> fasta {}".format(gzip_fasta))
@@ -1,4 +1,6 @@
 import os
+import re
+import math
 import random
 import pyfastx
 import pyfaidx
@@ -171,6 +173,170 @@ class SequenceTest(unittest.TestCase):
 		result = fxi_seq.search(segment)
 		self.assertEqual(expect, result)
 
+		# test seq search in antisense strand, query is not modified
+		query = pyfastx.reverse_complement(segment)
+		result = fxi_seq.search(query, '-')
+		self.assertEqual(expect + len(segment) - 1, result)
+		self.assertEqual(query, pyfastx.reverse_complement(segment))
+
+	def test_seq_windows(self):
+		idx = self.get_random_index()
+		expect = str(self.faidx[idx])
+
+		for seq in [self.fastx[idx], self.fasta[idx]]:
+			self.assertEqual(list(seq.windows(100, uppercase=True)), [expect[i:i+100] for i in range(0, len(expect), 100)])
+			self.assertEqual(list(seq.windows(50, 17, uppercase=True)), [expect[i:i+50] for i in range(0, len(expect), 17)])
+
+			#windows of subsequence
+			sub = seq[10:len(seq)-10]
+			self.assertEqual(list(sub.windows(64, uppercase=True)), [expect[10:-10][i:i+64] for i in range(0, len(expect)-20, 64)])
+
+			#windows in batches named with positions
+			result = [r for b in seq.windows(100, batch=8, uppercase=True) for r in b]
+			self.assertEqual(result[1], ('{}:101-{}'.format(seq.name, min(200, len(expect))), expect[100:200]))
+			self.assertEqual(len(result), (len(expect) + 99) // 100)
+
+		with self.assertRaises(ValueError):
+			self.fastx[idx].windows(0)
+
+	def test_seq_kmers(self):
+		idx = self.get_random_index()
+		expect = str(self.faidx[idx])
+
+		for seq in [self.fastx[idx], self.fasta[idx][5:len(expect)-5]]:
+			bases = expect if len(seq) == len(expect) else expect[5:-5]
+			kmers = [bases[i:i+11] for i in range(len(bases)-10)]
+			kmers = [k for k in kmers if not set(k) - set('ACGT')]
+			self.assertEqual([pyfastx.kmer_decode(k, 11) for k in seq.kmers(11)], kmers)
+
+		with self.assertRaises(ValueError):
+			self.fastx[idx].kmers(32)
+
+	def test_seq_minimizers(self):
+		mask = (1 << 64) - 1
+
+		def kmer_hash(x):
+			x ^= x >> 33
+			x = (x * 0xff51afd7ed558ccd) & mask
+			x ^= x >> 33
+			x = (x * 0xc4ceb9fe1a85ec53) & mask
+			return x ^ (x >> 33)
+
+		seq = self.fasta[self.get_random_index()]
+		bases = seq.seq.upper()
+
+		#positions of k-mers without N
+		positions = [i for i in range(len(bases)-8) if not set(bases[i:i+9]) - set('ACGT')]
+		kmers = dict(zip(positions, seq.kmers(9, canonical=True)))
+
+		expect = []
+		for i in range(len(positions)-4):
+			window = positions[i:i+5]
+			if window[-1] - window[0] != 4:
+				continue
+
+			best = min(window, key=lambda j: (kmer_hash(kmers[j]), j))
+			if not expect or expect[-1][0] != best:
+				expect.append((best, kmers[best]))
+
+		self.assertEqual(list(seq.minimizers(9, 5)), expect)
+
+		#sketch of all forward k-mers
+		sketch = seq.sketch(9, scaled=1, canonical=False)
+		self.assertEqual(list(sketch.hashes), sorted(set(kmer_hash(k) for k in seq.kmers(9))))
+
+		with self.assertRaises(ValueError):
+			seq.minimizers(9, 0)
+
+	def test_seq_search_all(self):
+		seq = self.fasta[self.get_random_index()]
+		bases = seq.seq.upper()
+
+		#GANTC on + strand and its reverse complement GANTC on - strand
+		expect = [i+1 for i in range(len(bases)-4) if re.match('GA[ACGT]TC', bases[i:i+5])]
+		hits = seq.search_all('GANTC')
+		self.assertEqual(list(hits.positions), sorted(expect + expect))
+		self.assertEqual(list(hits.strands), [1, -1] * len(expect))
+
+		#RY on - strand is RY, overlapped hits are all reported
+		expect = [(0, i+1, '-') for i in range(len(bases)-1) if bases[i] in 'AG' and bases[i+1] in 'CT']
+		self.assertEqual(list(seq.search_all('RY', strand='-')), expect)
+		self.assertEqual(len(seq.search_all('RY', strand='+', iupac=False)), bases.count('RY'))
+		self.assertEqual(len(seq.search_all('A', max_hits=3)), 3)
+
+		#hits of subsequence are relative to subsequence
+		sub = seq[10:len(seq)-10]
+		expect = [i+1 for i in range(len(bases)-21) if bases[10+i:12+i] == 'CA']
+		self.assertEqual(list(sub.search_all('ca', strand='+').positions), expect)
+
+		with self.assertRaises(ValueError):
+			seq.search_all('A' * 65)
+
+		with self.assertRaises(ValueError):
+			seq.search_all('ACGT', strand='x')
+
+	def test_seq_search_approx(self):
+		def edit_distance(p, t):
+			prev = list(range(len(t)+1))
+			for i in range(1, len(p)+1):
+				cur = [i] + [0] * len(t)
+				for j in range(1, len(t)+1):
+					cur[j] = min(prev[j-1] + (p[i-1] != t[j-1]), prev[j] + 1, cur[j-1] + 1)
+				prev = cur
+			return prev[-1]
+
+		seq = self.fasta[self.get_random_index()]
+		bases = seq.seq.upper()
+		pattern = bases[100:112]
+
+		#pattern with a deletion and a mismatch
+		query = pattern[:3] + pattern[4:8] + ('C' if pattern[8] == 'A' else 'A') + pattern[9:]
+		hits = seq.search_approx(query, max_edits=2, strand='+', iupac=False)
+		self.assertTrue(any(h[1] <= 112 and h[2] >= 101 for h in hits))
+
+		for name, start, end, strand, edits in hits:
+			self.assertEqual(edit_distance(query, bases[start-1:end]), edits)
+			self.assertTrue(edits <= 2)
+
+		#exact hits on - strand
+		hits = seq.search_approx(pyfastx.reverse_complement(pattern), max_edits=0, strand='-')
+		expect = [i+1 for i in range(len(bases)-11) if bases[i:i+12] == pattern]
+		self.assertEqual([h[1] for h in hits], expect)
+
+		with self.assertRaises(ValueError):
+			seq.search_approx('ACGT', max_edits=4)
+
+	def test_seq_gc_profile(self):
+		seq = self.fasta[self.get_random_index()]
+		bases = seq.seq.upper()
+
+		#undefined values are nan
+		def values(xs):
+			return [None if math.isnan(x) else round(x, 6) for x in xs]
+
+		expect_gc = []
+		expect_skew = []
+		for i in range(0, len(bases), 20):
+			w = bases[i:i+50]
+			g, c, at = w.count('G'), w.count('C'), w.count('A') + w.count('T')
+			expect_gc.append(round((g+c)/(g+c+at)*100, 6) if g+c+at else None)
+			expect_skew.append(round((g-c)/(g+c), 6) if g+c else None)
+
+		profile = seq.gc_profile(50, 20)
+		self.assertEqual(len(profile), len(expect_gc))
+		self.assertEqual(list(profile.starts), list(range(1, len(bases)+1, 20)))
+		self.assertEqual(list(profile.ends), [min(i+50, len(bases)) for i in range(0, len(bases), 20)])
+		self.assertEqual(values(profile.gc), expect_gc)
+		self.assertEqual(values(profile.skew), expect_skew)
+
+		#cumulative skew and profile of whole sequence
+		profile = seq.gc_profile(50, 20, cumulative=True)
+		self.assertAlmostEqual(profile.skew[-1], sum(x for x in expect_skew if x is not None), places=4)
+		self.assertAlmostEqual(seq.gc_profile(len(seq)).gc[0], seq.gc_content, places=3)
+
+		with self.assertRaises(ValueError):
+			seq.gc_profile(0)
+
 	def test_seq_repr(self):
 		s = self.fastx[0]
 		n = s.name
@@ -187,6 +353,94 @@ class SequenceTest(unittest.TestCase):
 		fas = pyfastx.Fasta(flat_fasta, full_index=True)
 		self.assertEqual(self.fastx[idx].composition, fas[idx].composition)
 
+	def test_block_compo(self):
+		block_fasta = join(data_dir, 'block.fa')
+		bases = ''.join(random.choice('ACGTNacgtn') for _ in range(20000))
+		bases = bases[:15000] + 'R' + bases[15001:]
+
+		with open(block_fasta, 'w') as fw:
+			fw.write('>block\n')
+
+			for i in range(0, len(bases), 70):
+				fw.write(bases[i:i+70] + '\n')
+
+		fa = pyfastx.Fasta(block_fasta, full_index=True)
+
+		for start, end in [(10, 9000), (4096, 8192), (100, 14000), (5000, 19999), (3, 20000)]:
+			expect = bases[start:end]
+			result = fa['block'][start:end]
+
+			content = {}
+			for b in expect:
+				content[b] = content.get(b, 0) + 1
+
+			gc = sum(expect.upper().count(b) for b in 'GC')
+			acgt = sum(expect.upper().count(b) for b in 'ACGT')
+			skew = expect.upper().count('G') - expect.upper().count('C')
+
+			self.assertEqual(result.composition, content)
+			self.assertAlmostEqual(result.gc_content, gc/acgt*100, places=3)
+			self.assertAlmostEqual(result.gc_skew, skew/gc, places=5)
+
+		del fa
+		os.remove(block_fasta)
+		os.remove('{}.fxi'.format(block_fasta))
+
+	def test_irregular_slice(self):
+		ragged_fasta = join(data_dir, 'ragged.fa')
+		bases = ''.join(random.choice('ACGTN') for _ in range(10000))
+
+		with open(ragged_fasta, 'w') as fw:
+			fw.write('>ragged\n')
+
+			i = 0
+			while i < len(bases):
+				size = random.randint(1, 120)
+				fw.write(bases[i:i+size] + '\n')
+				i += size
+
+		fa = pyfastx.Fasta(ragged_fasta)
+		seq = fa['ragged']
+
+		for start, end in [(0, 1), (10, 90), (500, 7000), (3, 10000), (9999, 10000)]:
+			self.assertEqual(seq[start:end].seq, bases[start:end])
+			self.assertEqual(seq[start:end][5:50].seq, bases[start:end][5:50])
+			self.assertEqual(list(seq[start:end].windows(30, 20)), [bases[start:end][i:i+30] for i in range(0, end-start, 20)])
+
+			left, right = fa.flank('ragged', start+1, end, 20)
+			self.assertEqual(left, bases[max(0, start-20):start])
+			self.assertEqual(right, bases[end:end+20])
+
+		del seq
+		del fa
+		os.remove(ragged_fasta)
+		os.remove('{}.fxi'.format(ragged_fasta))
+
+	def test_seq_masks(self):
+		mask_fasta = join(data_dir, 'seqmask.fa')
+		bases = ''.join(random.choice(['ACGT', 'acgt', 'NNNN', 'nn']) for _ in range(2000))
+
+		with open(mask_fasta, 'w') as fw:
+			fw.write('>mask\n')
+
+			for i in range(0, len(bases), 60):
+				fw.write(bases[i:i+60] + '\n')
+
+		fa = pyfastx.Fasta(mask_fasta)
+		seq = fa['mask']
+
+		for start, end in [(0, len(bases)), (10, 90), (3001, 3002), (500, 7000)]:
+			soft = [(m.start()+1, m.end()) for m in re.finditer('[a-z]+', bases) if m.start() < end and m.end() > start]
+			gaps = [(m.start()+1, m.end()) for m in re.finditer('[Nn]+', bases) if m.start() < end and m.end() > start]
+
+			self.assertEqual(list(zip(seq[start:end].masks().starts, seq[start:end].masks().ends)), soft)
+			self.assertEqual(list(zip(seq[start:end].gaps().starts, seq[start:end].gaps().ends)), gaps)
+
+		del seq
+		del fa
+		os.remove(mask_fasta)
+		os.remove('{}.fxi'.format(mask_fasta))
+
 	def test_seq_exception(self):
 		with self.assertRaises(RuntimeError):
 			for line in self.fastx[0][10:20]: